@@ -16,6 +16,44 @@
           "AdditionalOptions": ["/std:c++17"]
         }
       },
+      "sources": [
+        "src/async_job.cpp",
+        "src/background_writer.cpp",
+        "src/bindings.cpp",
+        "src/broadcast_ack.cpp",
+        "src/broadcast_dispatcher.cpp",
+        "src/broadcast_timeline.cpp",
+        "src/camera_director.cpp",
+        "src/channel_spec.cpp",
+        "src/channel_spec_napi.cpp",
+        "src/checksum.cpp",
+        "src/corner_analyzer.cpp",
+        "src/csv_export.cpp",
+        "src/downsample.cpp",
+        "src/file_util.cpp",
+        "src/history.cpp",
+        "src/ibt_align.cpp",
+        "src/ibt_catalog.cpp",
+        "src/ibt_file.cpp",
+        "src/ibt_file_napi.cpp",
+        "src/ibt_tail.cpp",
+        "src/incident_detector.cpp",
+        "src/interpolator.cpp",
+        "src/lap_delta.cpp",
+        "src/lap_stats.cpp",
+        "src/position_filter.cpp",
+        "src/recording.cpp",
+        "src/relative.cpp",
+        "src/resampler.cpp",
+        "src/resampler_napi.cpp",
+        "src/sanity_filter.cpp",
+        "src/session_log.cpp",
+        "src/session_yaml.cpp",
+        "src/tick_clock.cpp",
+        "src/tick_hub.cpp",
+        "src/track_order.cpp",
+        "src/video_sync.cpp"
+      ],
       "conditions": [
         [
           "OS=='win'",
@@ -3,7 +3,7 @@ var __importDefault = (this && this.__importDefault) || function (mod) {
     return (mod && mod.__esModule) ? mod : { "default": mod };
 };
 Object.defineProperty(exports, "__esModule", { value: true });
-exports.constants = exports.IRacingClient = void 0;
+exports.constants = exports.alignIbtAsync = exports.alignIbt = exports.RecordingFile = exports.Recorder = exports.VideoSync = exports.SessionLog = exports.IbtCatalog = exports.IbtTail = exports.PositionFilter = exports.getSanityFilterStats = exports.setSanityFilter = exports.LapStats = exports.CornerAnalyzer = exports.IncidentDetector = exports.Relative = exports.CameraDirector = exports.BroadcastTimeline = exports.BroadcastAcks = exports.BroadcastDispatcher = exports.downsample = exports.History = exports.LapDelta = exports.IbtFile = exports.Resampler = exports.Interpolator = exports.IRacingClient = void 0;
 const events_1 = require("events");
 const path_1 = __importDefault(require("path"));
 /**
@@ -54,6 +54,155 @@ const constants = binding.constants ?? {
     CameraFocusMode: emptyEnum()
 };
 exports.constants = constants;
+/**
+ * Native sub-tick interpolator. Instances are fed by every tick a client
+ * polls, so they only update while a client is started.
+ */
+const Interpolator = binding.Interpolator;
+exports.Interpolator = Interpolator;
+/**
+ * Native fixed-rate resampler over the live tick stream. Like Interpolator,
+ * it is fed by the ticks a started client polls.
+ */
+const Resampler = binding.Resampler;
+exports.Resampler = Resampler;
+/**
+ * Native reader for .ibt telemetry files; works without the sim running.
+ */
+const IbtFile = binding.IbtFile;
+exports.IbtFile = IbtFile;
+/**
+ * Native lap traces and live delta time for the player car, fed by the
+ * ticks a started client polls.
+ */
+const LapDelta = binding.LapDelta;
+exports.LapDelta = LapDelta;
+/**
+ * Native ring buffers of recent telemetry for charting, fed by the ticks a
+ * started client polls.
+ */
+const History = binding.History;
+exports.History = History;
+/**
+ * Native LTTB and min/max downsampling of any x/y series.
+ */
+const downsample = binding.downsample;
+exports.downsample = downsample;
+/**
+ * Configure the native sanity filter that clamps or masks NaNs, out-of-range
+ * values and implausible jumps in live telemetry; null disables it.
+ */
+const setSanityFilter = binding.setSanityFilter;
+exports.setSanityFilter = setSanityFilter;
+/**
+ * Counts of the samples the sanity filter replaced, per channel.
+ */
+const getSanityFilterStats = binding.getSanityFilterStats;
+exports.getSanityFilterStats = getSanityFilterStats;
+/**
+ * Align several .ibt files of one session on SessionTime or lap distance,
+ * decoded in parallel into a shared columnar frame.
+ */
+const alignIbt = binding.alignIbt;
+exports.alignIbt = alignIbt;
+/**
+ * alignIbt on the libuv thread pool, with progress in files and cancellation
+ * through an AbortSignal.
+ */
+const alignIbtAsync = binding.alignIbtAsync;
+exports.alignIbtAsync = alignIbtAsync;
+/**
+ * Native queued, rate-limited broadcast dispatcher. Sends on its own thread
+ * to the sim, or records to a mock sink for tests.
+ */
+const BroadcastDispatcher = binding.BroadcastDispatcher;
+exports.BroadcastDispatcher = BroadcastDispatcher;
+/**
+ * Native confirmation of camera and replay broadcasts against telemetry.
+ * Conditions are matched on every tick a client polls.
+ */
+const BroadcastAcks = binding.BroadcastAcks;
+exports.BroadcastAcks = BroadcastAcks;
+/**
+ * Native camera/replay scripts sent at SessionTime or replay positions.
+ * Cues are timed from the ticks a client polls.
+ */
+const BroadcastTimeline = binding.BroadcastTimeline;
+exports.BroadcastTimeline = BroadcastTimeline;
+/**
+ * Native automatic camera director: scores battles and incidents every tick
+ * and switches the broadcast camera through a debounced policy.
+ */
+const CameraDirector = binding.CameraDirector;
+exports.CameraDirector = CameraDirector;
+/**
+ * Native relative/radar query: cars ahead and behind a car with their gaps,
+ * from a track order kept sorted tick to tick.
+ */
+const Relative = binding.Relative;
+exports.Relative = Relative;
+/**
+ * Native incident detector: off-track excursions, sudden stops, player spins and
+ * incident count jumps, queued as compact events with replay frame numbers.
+ */
+const IncidentDetector = binding.IncidentDetector;
+exports.IncidentDetector = IncidentDetector;
+/**
+ * Native corner analysis of the player car: corners segmented from a reference
+ * lap, with entry/min/exit speed, brake point and time per corner every lap.
+ */
+const CornerAnalyzer = binding.CornerAnalyzer;
+exports.CornerAnalyzer = CornerAnalyzer;
+/**
+ * Native per-lap speed traps and channel min/max for every car, kept up to date
+ * tick by tick so lap crossings cost nothing.
+ */
+const LapStats = binding.LapStats;
+exports.LapStats = LapStats;
+/**
+ * Native Kalman smoothing of every car's CarIdxLapDistPct, with lap wrap handled,
+ * for steady map positions and gaps.
+ */
+const PositionFilter = binding.PositionFilter;
+exports.PositionFilter = PositionFilter;
+/**
+ * Native follower of an .ibt file the sim is still writing, delivering
+ * new records as they land.
+ */
+const IbtTail = binding.IbtTail;
+exports.IbtTail = IbtTail;
+/**
+ * Native index of a directory tree of .ibt files: session metadata and per-lap
+ * summaries in a compact on-disk file with fast filtered queries.
+ */
+const IbtCatalog = binding.IbtCatalog;
+exports.IbtCatalog = IbtCatalog;
+/**
+ * Native change log of the session info YAML: every revision with its
+ * SessionTime and update count, stored as line deltas in an optional journal,
+ * with the session info at any point of a session on request.
+ */
+const SessionLog = binding.SessionLog;
+exports.SessionLog = SessionLog;
+/**
+ * Native timecode sidecar for video captures: every tick's monotonic stamp
+ * and video frame next to SessionTick, SessionTime and ReplayFrameNum, with
+ * interpolated lookups from any of them to the rest.
+ */
+const VideoSync = binding.VideoSync;
+exports.VideoSync = VideoSync;
+/**
+ * Native crash-safe recorder: channels of every tick in fixed-size chunks,
+ * each with its own header, tick range and CRC-32.
+ */
+const Recorder = binding.Recorder;
+exports.Recorder = Recorder;
+/**
+ * Native reader for recordings, seeking by time through the chunk headers
+ * and skipping damaged chunks.
+ */
+const RecordingFile = binding.RecordingFile;
+exports.RecordingFile = RecordingFile;
 class IRacingClient extends events_1.EventEmitter {
     _pollIntervalMs;
     _waitTimeoutMs;
@@ -63,17 +212,22 @@ class IRacingClient extends events_1.EventEmitter {
     _timer;
     _connected;
     _lastSessionUpdate;
+    _broadcastQueue;
+    _dispatcher;
+    _acks;
+    _ackTimer;
     /**
      * Create a new telemetry client with optional polling configuration.
      * @param options.pollIntervalMs Poll interval in milliseconds.
      * @param options.waitTimeoutMs Wait timeout in milliseconds passed to the native wait.
      * @param options.telemetryVariables Names of telemetry variables to read on each tick.
      * @param options.emitSessionOnConnect Emit session payload immediately on connect.
+     * @param options.broadcastQueue Send broadcast messages through a native rate-limited queue.
      * @returns A new IRacingClient instance.
      */
     constructor(options = {}) {
         super();
-        const { pollIntervalMs = 16, waitTimeoutMs = 0, telemetryVariables, emitSessionOnConnect = true } = options;
+        const { pollIntervalMs = 16, waitTimeoutMs = 0, telemetryVariables, emitSessionOnConnect = true, broadcastQueue = false } = options;
         const hasTelemetryOptions = Object.prototype.hasOwnProperty.call(options, 'telemetryVariables');
         // Validate and normalize options to known-safe defaults.
         this._pollIntervalMs = Number.isFinite(pollIntervalMs) ? pollIntervalMs : 16;
@@ -81,10 +235,14 @@ class IRacingClient extends events_1.EventEmitter {
         this._telemetryVars = Array.isArray(telemetryVariables) ? telemetryVariables.slice() : [];
         this._useAllTelemetry = !hasTelemetryOptions;
         this._emitSessionOnConnect = emitSessionOnConnect !== false;
+        this._broadcastQueue = broadcastQueue === true ? {} : broadcastQueue || null;
         // Initialize runtime state.
         this._timer = null;
         this._connected = false;
         this._lastSessionUpdate = -1;
+        this._dispatcher = null;
+        this._acks = null;
+        this._ackTimer = null;
     }
     /**
      * Override the telemetry variables to read on each poll.
@@ -150,6 +308,52 @@ class IRacingClient extends events_1.EventEmitter {
     getVarValue(name, entry) {
         return binding.getVarValue(name, entry);
     }
+    /**
+     * Get timing for the most recent telemetry tick, stamped natively when the
+     * sim signalled that the data was ready.
+     * @returns Tick timing or null before the first tick.
+     */
+    getTickTiming() {
+        return binding.getTickTiming();
+    }
+    /**
+     * Get the running fit between SessionTime and the monotonic clock.
+     * @returns Fit parameters or null until enough ticks have been stamped.
+     */
+    getClockFit() {
+        return binding.getClockFit();
+    }
+    /**
+     * Map a SessionTime to the monotonic clock used for tick stamps.
+     * @param sessionTime Session time in seconds.
+     * @returns Monotonic time in milliseconds or null without a fit.
+     */
+    sessionTimeToMonotonic(sessionTime) {
+        return binding.sessionTimeToMonotonic(sessionTime);
+    }
+    /**
+     * Map a monotonic timestamp to SessionTime.
+     * @param monotonicMs Monotonic time in milliseconds.
+     * @returns Session time in seconds or null without a fit.
+     */
+    monotonicToSessionTime(monotonicMs) {
+        return binding.monotonicToSessionTime(monotonicMs);
+    }
+    /**
+     * Map a SessionTime to wall-clock time.
+     * @param sessionTime Session time in seconds.
+     * @returns Unix epoch milliseconds or null without a fit.
+     */
+    sessionTimeToWall(sessionTime) {
+        return binding.sessionTimeToWall(sessionTime);
+    }
+    /**
+     * Read the monotonic clock used for tick stamps.
+     * @returns Monotonic time in milliseconds.
+     */
+    nowMonotonic() {
+        return binding.nowMonotonic();
+    }
     /**
      * Send a raw broadcast message with optional third parameter.
      * @param msg Broadcast message id.
@@ -159,12 +363,13 @@ class IRacingClient extends events_1.EventEmitter {
      * @returns void
      */
     broadcastMsg(msg, var1, var2, var3) {
+        const send = this._broadcastSender();
         // Use the 3-argument native call only when a valid third value is provided.
         if (Number.isFinite(var3)) {
-            binding.broadcastMsg(msg, var1, var2, var3);
+            send(msg, var1, var2, var3);
             return;
         }
-        binding.broadcastMsg(msg, var1, var2);
+        send(msg, var1, var2);
     }
     /**
      * Send a broadcast message that expects a float value parameter.
@@ -174,7 +379,14 @@ class IRacingClient extends events_1.EventEmitter {
      * @returns void
      */
     broadcastMsgFloat(msg, var1, value) {
-        binding.broadcastMsg(msg, var1, value);
+        this._broadcastSender()(msg, var1, value);
+    }
+    /**
+     * Read the counters of the broadcast queue.
+     * @returns Queue statistics, or null when the client sends directly.
+     */
+    getBroadcastStats() {
+        return this._dispatcher ? this._dispatcher.getStats() : null;
     }
     /**
      * Switch camera by car position.
@@ -305,6 +517,97 @@ class IRacingClient extends events_1.EventEmitter {
     videoCapture(mode) {
         this.broadcastMsg(constants.BroadcastMsg.VideoCapture, mode, 0);
     }
+    /**
+      * Switch camera by car position and wait until the sim shows it.
+      * @param carPos Car position index.
+      * @param group Camera group.
+      * @param camera Camera index.
+      * @param options.timeoutMs Reject when telemetry does not confirm the switch in time.
+      * @returns Promise resolved with the confirming tick.
+      */
+    switchCameraByPosAsync(carPos, group, camera, options = {}) {
+        return this._sendAcknowledged(() => this.switchCameraByPos(carPos, group, camera), {
+            kind: 'camera',
+            carPos,
+            group,
+            camera,
+            timeoutMs: options.timeoutMs
+        });
+    }
+    /**
+      * Switch camera by driver number and wait until the sim shows it.
+      * @param driverNum Driver number or string identifier.
+      * @param group Camera group.
+      * @param camera Camera index.
+      * @param options.timeoutMs Reject when telemetry does not confirm the switch in time.
+      * @returns Promise resolved with the confirming tick.
+      */
+    switchCameraByNumAsync(driverNum, group, camera, options = {}) {
+        return this._sendAcknowledged(() => this.switchCameraByNum(driverNum, group, camera), {
+            kind: 'camera',
+            carIdx: this._carIdxForNumber(driverNum),
+            group,
+            camera,
+            timeoutMs: options.timeoutMs
+        });
+    }
+    /**
+      * Set replay playback speed and wait until the sim reports it.
+      * @param speed Playback speed.
+      * @param slowMotion Slow motion flag value.
+      * @param options.timeoutMs Reject when telemetry does not confirm the change in time.
+      * @returns Promise resolved with the confirming tick.
+      */
+    replaySetPlaySpeedAsync(speed, slowMotion = 0, options = {}) {
+        return this._sendAcknowledged(() => this.replaySetPlaySpeed(speed, slowMotion), {
+            kind: 'replaySpeed',
+            speed,
+            slowMotion,
+            timeoutMs: options.timeoutMs
+        });
+    }
+    /**
+      * Set replay position by frame number and wait until the replay gets there.
+      * @param mode Position mode enum value.
+      * @param frameNumber Frame number.
+      * @param options.timeoutMs Reject when telemetry does not confirm the seek in time.
+      * @returns Promise resolved with the confirming tick.
+      */
+    replaySetPlayPositionAsync(mode, frameNumber, options = {}) {
+        return this._sendAcknowledged(() => this.replaySetPlayPosition(mode, frameNumber), {
+            kind: 'replayFrame',
+            mode,
+            frame: frameNumber,
+            timeoutMs: options.timeoutMs
+        });
+    }
+    /**
+      * Search the replay and wait until the replay jumps.
+      * @param mode Replay search mode enum value.
+      * @param options.timeoutMs Reject when the replay does not jump in time.
+      * @returns Promise resolved with the confirming tick.
+      */
+    replaySearchAsync(mode, options = {}) {
+        return this._sendAcknowledged(() => this.replaySearch(mode), {
+            kind: 'replayJump',
+            timeoutMs: options.timeoutMs
+        });
+    }
+    /**
+      * Search replay by session time and wait until the replay gets there.
+      * @param sessionNum Session number.
+      * @param sessionTimeMs Session time in milliseconds.
+      * @param options.timeoutMs Reject when telemetry does not confirm the seek in time.
+      * @returns Promise resolved with the confirming tick.
+      */
+    replaySearchSessionTimeAsync(sessionNum, sessionTimeMs, options = {}) {
+        return this._sendAcknowledged(() => this.replaySearchSessionTime(sessionNum, sessionTimeMs), {
+            kind: 'replaySessionTime',
+            sessionNum,
+            sessionTime: sessionTimeMs / 1000,
+            timeoutMs: options.timeoutMs
+        });
+    }
     /**
      * Start the polling loop if not already running.
      * @returns void
@@ -330,12 +633,85 @@ class IRacingClient extends events_1.EventEmitter {
             this._timer = null;
         }
     }
+    /**
+     * Pick the native path for broadcast messages: the queued dispatcher when
+     * the client was created with broadcastQueue, otherwise a direct send.
+     * @returns Function that sends or queues one broadcast message.
+     */
+    _broadcastSender() {
+        if (!this._broadcastQueue) {
+            return binding.broadcastMsg;
+        }
+        // Created on first use so clients that never broadcast start no thread.
+        if (!this._dispatcher) {
+            this._dispatcher = new BroadcastDispatcher({ ...this._broadcastQueue, sink: 'sim' });
+        }
+        const dispatcher = this._dispatcher;
+        return (msg, var1, var2, var3) => dispatcher.send(msg, var1, var2, var3);
+    }
+    /**
+      * Send a broadcast and watch telemetry for its effect.
+      * @param send Sends the broadcast.
+      * @param condition Telemetry that confirms it.
+      * @returns Promise settled by the native matcher.
+      */
+    _sendAcknowledged(send, condition) {
+        try {
+            send();
+        } catch (error) {
+            return Promise.reject(error);
+        }
+        // Created on first use; the matcher then runs on every polled tick.
+        if (!this._acks) {
+            this._acks = new BroadcastAcks();
+        }
+        const ack = this._acks.expect(condition);
+        this._scheduleAckExpiry();
+        return ack;
+    }
+    /**
+      * Time out acknowledgements on their own timer, so they settle even when
+      * polling stops. The timer is unref'd and rearmed for the next deadline.
+      * @returns void
+      */
+    _scheduleAckExpiry() {
+        if (this._ackTimer) {
+            clearTimeout(this._ackTimer);
+            this._ackTimer = null;
+        }
+        const nextMs = this._acks ? this._acks.expire() : null;
+        if (nextMs === null) {
+            return;
+        }
+        // The extra millisecond covers timers firing on a clock rounded down.
+        this._ackTimer = setTimeout(() => this._scheduleAckExpiry(), Math.ceil(nextMs) + 1);
+        this._ackTimer.unref();
+    }
+    /**
+      * Look up the car index of a driver number in the session info.
+      * @param driverNum Car number, as a number or a string with leading zeros.
+      * @returns Car index, or -1 when it cannot be found.
+      */
+    _carIdxForNumber(driverNum) {
+        const driverInfo = binding.getSessionInfoObj()?.DriverInfo;
+        const drivers = (driverInfo?.Drivers ?? []);
+        const match = drivers.find((driver) =>
+            typeof driverNum === 'string'
+                ? String(driver.CarNumber) === driverNum
+                : Number(driver.CarNumberRaw) === driverNum
+        );
+        return match ? Number(match.CarIdx) : -1;
+    }
     /**
      * Poll native state and emit events.
      * @returns void
      */
     _tick() {
         try {
+            // Time out acknowledgements even when no ticks arrive.
+            if (this._acks) {
+                this._acks.expire();
+            }
             // Wait for new data and read connection state.
             const hadData = binding.waitForData(this._waitTimeoutMs);
             const isConnected = binding.isConnected();
@@ -362,16 +738,18 @@ class IRacingClient extends events_1.EventEmitter {
                 if (binding.wasSessionInfoUpdated()) {
                     this._emitSessionUpdate();
                 }
-                // Emit all telemetry variables, or only the configured subset.
+                // Emit all telemetry variables, or only the configured subset,
+                // along with the native timing for this tick.
+                const timing = binding.getTickTiming();
                 if (this._useAllTelemetry) {
                     const telemetry = binding.readAllVars();
                     if (telemetry) {
-                        this.emit('telemetry', telemetry);
+                        this.emit('telemetry', telemetry, timing);
                     }
                 }
                 else if (this._telemetryVars.length > 0) {
                     const telemetry = binding.readVars(this._telemetryVars);
-                    this.emit('telemetry', telemetry);
+                    this.emit('telemetry', telemetry, timing);
                 }
             }
         }
@@ -0,0 +1,84 @@
+// libFuzzer entry point for the .ibt reader: each input is written to a temp
+// file and opened, decoded column by column and record by record, and
+// resampled, the way an ingestion server handles uploaded files.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "channel_spec.h"
+#include "ibt_file.h"
+#include "resampler.h"
+#include "session_yaml.h"
+
+namespace {
+
+const std::string& InputPath()
+{
+  static const std::string path = "/tmp/ibt_open_fuzzer." + std::to_string(getpid()) + ".ibt";
+  return path;
+}
+
+bool WriteInput(const uint8_t* data, size_t size)
+{
+  std::FILE* file = std::fopen(InputPath().c_str(), "wb");
+  if (!file) {
+    return false;
+  }
+  bool ok = std::fwrite(data, 1, size, file) == size;
+  return std::fclose(file) == 0 && ok;
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+  using namespace irsdk_node;
+
+  if (!WriteInput(data, size)) {
+    return 0;
+  }
+  IbtFile file;
+  std::string error;
+  if (!file.Open(InputPath(), &error)) {
+    return 0;
+  }
+  ParseSessionYaml(file.session_info());
+
+  const std::vector<IbtVar>& vars = file.vars();
+  std::vector<double> column;
+  ResampleOptions options;
+  for (size_t i = 0; i < vars.size(); ++i) {
+    file.ReadColumn(static_cast<int>(i), 0, &column);
+    file.ReadColumn(static_cast<int>(i), vars[i].count - 1, &column);
+    if (options.channels.size() < 8) {
+      options.channels.push_back(ChannelSpec{vars[i].name, InferChannelKind(vars[i].name)});
+    }
+  }
+
+  double sum = 0.0;
+  ForEachIbtRecord(file, 0, file.record_count(), [&](const IbtRecordSource& source, int index) {
+    (void)index;
+    for (size_t i = 0; i < vars.size(); ++i) {
+      for (int entry = 0; entry < vars[i].count; ++entry) {
+        sum += source.GetDouble(static_cast<int>(i), entry);
+      }
+    }
+    return true;
+  });
+
+  ResampledSeries series;
+  ResampleIbt(file, options, &series, &error);
+  options.mode = ResampleMode::kHold;
+  options.max_gap_s = 0.0;
+  options.drop_gaps = true;
+  ResampleIbt(file, options, &series, &error);
+  // Keep the decoded values live so the decode loop is not optimized away.
+  volatile double sink = sum;
+  (void)sink;
+  return 0;
+}
@@ -3,168 +3,254 @@
 
 #include <node_api.h>
 
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+
+#include <atomic>
 #include <cerrno>
 #include <cctype>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <initializer_list>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include "irsdk_defines.h"
 #include "irsdk_client.h"
+#include "bindings.h"
+#include "broadcast_dispatcher.h"
+#include "napi_util.h"
+#include "sanity_filter.h"
+#include "telemetry_source.h"
+#include "tick_clock.h"
+#include "tick_hub.h"
 
 namespace {
 
-// Helper macro to convert N-API status codes into JS exceptions.
-#define NAPI_CALL(env, call)                                    \
-  do {                                                          \
-    napi_status status = (call);                                \
-    if (status != napi_ok) {                                    \
-      const napi_extended_error_info* error_info = nullptr;     \
-      napi_get_last_error_info((env), &error_info);             \
-      const char* msg = error_info && error_info->error_message \
-                            ? error_info->error_message         \
-                            : "napi error";                    \
-      napi_throw_error((env), nullptr, msg);                    \
-      return nullptr;                                           \
-    }                                                           \
-  } while (0)
+using irsdk_node::CheckNapi;
+using irsdk_node::GetNull;
+using irsdk_node::GetString;
+using irsdk_node::MakeBool;
+using irsdk_node::MakeDouble;
+using irsdk_node::MakeInt;
+
+// Sends broadcast commands straight to the sim. Safe to call from the
+// dispatcher thread: irsdk_broadcastMsg only posts a window message.
+class SimSink : public irsdk_node::BroadcastSink {
+ public:
+  void Send(const irsdk_node::BroadcastCommand& command) override
+  {
+    irsdk_BroadcastMsg msg = static_cast<irsdk_BroadcastMsg>(command.msg);
+    int var1 = command.msg == irsdk_BroadcastCamSwitchNum
+        ? irsdk_padCarNum(command.var1, command.car_num_zeros)
+        : command.var1;
+    if (command.is_float) {
+      irsdk_broadcastMsg(msg, var1, command.value);
+    } else if (command.has_var3) {
+      irsdk_broadcastMsg(msg, var1, command.var2, command.var3);
+    } else {
+      irsdk_broadcastMsg(msg, var1, command.var2);
+    }
+  }
+};
 
-static bool CheckNapi(napi_env env, napi_status status)
+// Read a telemetry variable value and return the appropriate JS type.
+static napi_value ReadVarValue(napi_env env, int idx, int type, int entry)
 {
-  if (status == napi_ok) {
-    return true;
+  irsdkClient& client = irsdkClient::instance();
+  switch (type) {
+    case irsdk_bool:
+      return MakeBool(env, client.getVarBool(idx, entry));
+    case irsdk_char:
+    case irsdk_int:
+    case irsdk_bitField:
+      return MakeInt(env, client.getVarInt(idx, entry));
+    case irsdk_float:
+    case irsdk_double: {
+      double value = 0.0;
+      if (irsdk_node::SanityFilter::Instance().Lookup(idx, entry, &value)) {
+        return MakeDouble(env, value);
+      }
+      return MakeDouble(env, type == irsdk_float ? static_cast<double>(client.getVarFloat(idx, entry))
+                                                 : client.getVarDouble(idx, entry));
+    }
+    default:
+      break;
   }
 
-  const napi_extended_error_info* error_info = nullptr;
-  napi_get_last_error_info(env, &error_info);
-  const char* msg = error_info && error_info->error_message ? error_info->error_message : "napi error";
-  napi_throw_error(env, nullptr, msg);
-  return false;
-}
-
-// Basic N-API value constructors used across the bindings.
-static napi_value MakeBool(napi_env env, bool value)
-{
   napi_value result = nullptr;
-  NAPI_CALL(env, napi_get_boolean(env, value, &result));
+  NAPI_CALL(env, napi_get_null(env, &result));
   return result;
 }
 
-static napi_value MakeInt(napi_env env, int value)
-{
-  napi_value result = nullptr;
-  NAPI_CALL(env, napi_create_int32(env, value, &result));
-  return result;
-}
+// Tick timing shared by the polling calls. Variable indices are cached per
+// connection because they can change when the sim reconnects.
+struct TickTimingState {
+  irsdk_node::TickClock clock;
+  int status_id = -1;
+  int session_time_idx = -1;
+  int session_tick_idx = -1;
+};
 
-static napi_value MakeDouble(napi_env env, double value)
+static TickTimingState& TickTiming()
 {
-  napi_value result = nullptr;
-  NAPI_CALL(env, napi_create_double(env, value, &result));
-  return result;
+  static TickTimingState state;
+  return state;
 }
 
-// Extract a UTF-8 string from a JS value.
-static bool GetString(napi_env env, napi_value value, std::string* out)
+// Newest tick count across the shared memory buffers, or -1 if unmapped.
+static int LatestBufferTickCount()
 {
-  size_t len = 0;
-  napi_status status = napi_get_value_string_utf8(env, value, nullptr, 0, &len);
-  if (status != napi_ok) {
-    return false;
+  const irsdk_header* header = irsdk_getHeader();
+  if (!header) {
+    return -1;
   }
-
-  std::string temp;
-  temp.resize(len + 1);
-  status = napi_get_value_string_utf8(env, value, &temp[0], len + 1, &len);
-  if (status != napi_ok) {
-    return false;
+  int latest = -1;
+  for (int i = 0; i < header->numBuf && i < IRSDK_MAX_BUFS; ++i) {
+    if (header->varBuf[i].tickCount > latest) {
+      latest = header->varBuf[i].tickCount;
+    }
   }
-
-  *out = std::string(temp.c_str(), len);
-  return true;
+  return latest;
 }
 
-static bool ParseCarNumberArg(napi_env env, napi_value value, int* out)
+// irsdkClient keeps the sample waitForData copied to itself; reach it through
+// a derived class to find which shared memory buffer it came from.
+struct ClientSample : irsdkClient {
+  static const char* Data(const irsdkClient& client) { return client.*(&ClientSample::m_data); }
+  static int Size(const irsdkClient& client) { return client.*(&ClientSample::m_nData); }
+};
+
+// Tick count of the shared memory buffer waitForData copied, or -1 if the
+// sim has reused that buffer since. The newest buffer may already be a tick
+// past the copy, so match the bytes rather than take the newest count.
+static int CopiedBufferTickCount()
 {
-  napi_valuetype type = napi_undefined;
-  if (!CheckNapi(env, napi_typeof(env, value, &type))) {
-    return false;
+  const irsdk_header* header = irsdk_getHeader();
+  const irsdkClient& client = irsdkClient::instance();
+  const char* sample = ClientSample::Data(client);
+  if (!header || !sample || ClientSample::Size(client) != header->bufLen) {
+    return -1;
   }
-
-  if (type == napi_string) {
-    std::string text;
-    if (!GetString(env, value, &text) || text.empty()) {
-      napi_throw_type_error(env, nullptr, "car number must be a non-empty numeric string");
-      return false;
+  int copied = -1;
+  for (int i = 0; i < header->numBuf && i < IRSDK_MAX_BUFS; ++i) {
+    int tick_count = header->varBuf[i].tickCount;
+    // Re-read the count so a buffer rewritten during the compare is skipped.
+    if (tick_count > copied && std::memcmp(irsdk_getData(i), sample, header->bufLen) == 0 &&
+        header->varBuf[i].tickCount == tick_count) {
+      copied = tick_count;
     }
+  }
+  return copied;
+}
 
-    size_t index = 0;
-    while (index < text.size() && text[index] == '0') {
-      index += 1;
+// Watches the SDK data-ready event on a background thread so each tick is
+// stamped when the sim signalled it rather than when JS got around to polling.
+class DataReadyWatcher {
+ public:
+  // process.exit() skips the env cleanup hook; never leave the thread joinable.
+  ~DataReadyWatcher() { Stop(); }
+
+  void Start()
+  {
+    if (running_.exchange(true)) {
+      return;
     }
+    thread_ = std::thread([this]() { Run(); });
+  }
 
-    size_t zero_count = index;
-    std::string digits = text.substr(index);
+  void Stop()
+  {
+    if (!running_.exchange(false)) {
+      return;
+    }
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
 
-    int num = 0;
-    if (digits.empty()) {
-      zero_count = text.size() > 0 ? text.size() - 1 : 0;
-      num = 0;
-    } else {
-      for (char ch : digits) {
-        if (!std::isdigit(static_cast<unsigned char>(ch))) {
-          napi_throw_type_error(env, nullptr, "car number must be numeric");
-          return false;
+ private:
+  void Run()
+  {
+    HANDLE event = nullptr;
+    while (running_) {
+      // The event only exists while the sim is running.
+      if (!event) {
+        event = OpenEventA(SYNCHRONIZE, FALSE, IRSDK_DATAVALIDEVENTNAME);
+        if (!event) {
+          Sleep(250);
+          continue;
         }
       }
 
-      errno = 0;
-      char* end = nullptr;
-      long parsed = std::strtol(digits.c_str(), &end, 10);
-      if (errno == ERANGE || end == digits.c_str() || *end != '\0') {
-        napi_throw_type_error(env, nullptr, "car number is out of range");
-        return false;
+      DWORD result = WaitForSingleObject(event, 100);
+      if (result == WAIT_OBJECT_0) {
+        int tick_count = LatestBufferTickCount();
+        if (tick_count >= 0) {
+          TickTiming().clock.RecordSignal(tick_count);
+        }
+      } else if (result == WAIT_FAILED) {
+        CloseHandle(event);
+        event = nullptr;
       }
-      num = static_cast<int>(parsed);
     }
-
-    *out = irsdk_padCarNum(num, static_cast<int>(zero_count));
-    return true;
+    if (event) {
+      CloseHandle(event);
+    }
   }
 
-  int32_t num = 0;
-  if (!CheckNapi(env, napi_get_value_int32(env, value, &num))) {
-    return false;
-  }
-  *out = irsdk_padCarNum(num, 0);
-  return true;
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+};
+
+static DataReadyWatcher& Watcher()
+{
+  static DataReadyWatcher watcher;
+  return watcher;
 }
 
-// Read a telemetry variable value and return the appropriate JS type.
-static napi_value ReadVarValue(napi_env env, int idx, int type, int entry)
+static void StopWatcher(void* arg)
+{
+  (void)arg;
+  Watcher().Stop();
+}
+
+// Telemetry source backed by the sample the SDK client last copied.
+// The layout only changes when the client reconnects.
+class LiveTelemetrySource : public irsdk_node::TelemetrySource {
+ public:
+  int FindVar(const char* name) const override { return irsdkClient::instance().getVarIdx(name); }
+  int VarType(int idx) const override { return irsdkClient::instance().getVarType(idx); }
+  int VarCount(int idx) const override { return irsdkClient::instance().getVarCount(idx); }
+  double GetDouble(int idx, int entry) const override { return irsdkClient::instance().getVarDouble(idx, entry); }
+  int LayoutId() const override { return irsdkClient::instance().getStatusID(); }
+};
+
+// Stamp the tick that waitForData just copied out of shared memory.
+static const irsdk_node::TickStamp& StampLatestTick()
 {
   irsdkClient& client = irsdkClient::instance();
-  switch (type) {
-    case irsdk_bool:
-      return MakeBool(env, client.getVarBool(idx, entry));
-    case irsdk_char:
-    case irsdk_int:
-    case irsdk_bitField:
-      return MakeInt(env, client.getVarInt(idx, entry));
-    case irsdk_float:
-      return MakeDouble(env, static_cast<double>(client.getVarFloat(idx, entry)));
-    case irsdk_double:
-      return MakeDouble(env, client.getVarDouble(idx, entry));
-    default:
-      break;
+  TickTimingState& timing = TickTiming();
+
+  int status_id = client.getStatusID();
+  if (status_id != timing.status_id) {
+    timing.clock.Reset();
+    timing.status_id = status_id;
+    timing.session_time_idx = client.getVarIdx("SessionTime");
+    timing.session_tick_idx = client.getVarIdx("SessionTick");
+    // A new connection starts its session info over.
+    irsdk_node::TickHub::Instance().SetSessionInfo(nullptr, -1);
   }
 
-  napi_value result = nullptr;
-  NAPI_CALL(env, napi_get_null(env, &result));
-  return result;
+  double session_time = timing.session_time_idx >= 0 ? client.getVarDouble(timing.session_time_idx) : 0.0;
+  int session_tick = timing.session_tick_idx >= 0 ? client.getVarInt(timing.session_tick_idx) : 0;
+  timing.clock.Stamp(CopiedBufferTickCount(), session_time, session_tick);
+  return timing.clock.LastStamp();
 }
 
 // Blocks until new telemetry is ready or the timeout elapses.
@@ -184,6 +270,23 @@ static napi_value WaitForData(napi_env env, napi_callback_info info)
   }
 
   bool ready = irsdkClient::instance().waitForData(timeout_ms);
+  if (ready) {
+    // Native consumers see every tick this call delivers, before JS does,
+    // and both read it through the sanity filter when one is configured.
+    LiveTelemetrySource live;
+    const irsdk_node::TickStamp& stamp = StampLatestTick();
+    // Read the session info through the raw SDK calls: getSessionStr would
+    // mark it as read and hide the change from wasSessionInfoUpdated.
+    irsdk_node::TickHub& hub = irsdk_node::TickHub::Instance();
+    int session_update = irsdk_getSessionInfoStrUpdate();
+    if (session_update != hub.session_update()) {
+      hub.SetSessionInfo(irsdk_getSessionInfoStr(), session_update);
+    }
+    irsdk_node::SanityFilter& filter = irsdk_node::SanityFilter::Instance();
+    filter.Apply(live, stamp.session_time);
+    irsdk_node::SanitizedSource source(live, filter);
+    hub.DispatchTick(source, stamp);
+  }
   return MakeBool(env, ready);
 }
 
@@ -215,43 +318,118 @@ static napi_value WasSessionInfoUpdated(napi_env env, napi_callback_info info)
   return MakeBool(env, irsdkClient::instance().wasSessionStrUpdated());
 }
 
+// Read a single numeric argument, throwing a TypeError when it is missing.
+static bool GetDoubleArg(napi_env env, napi_callback_info info, const char* usage, double* out)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  if (!CheckNapi(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr))) {
+    return false;
+  }
+  if (argc < 1) {
+    napi_throw_type_error(env, nullptr, usage);
+    return false;
+  }
+  return CheckNapi(env, napi_get_value_double(env, args[0], out));
+}
+
+// Returns timing for the most recent tick delivered by waitForData.
+static napi_value GetTickTiming(napi_env env, napi_callback_info info)
+{
+  (void)info;
+  const irsdk_node::TickClock& clock = TickTiming().clock;
+  if (!clock.HasStamp()) {
+    return GetNull(env);
+  }
+
+  const irsdk_node::TickStamp& stamp = clock.LastStamp();
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_set_named_property(env, result, "monotonicMs", MakeDouble(env, stamp.monotonic_ms)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "wallMs", MakeDouble(env, stamp.wall_ms)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "sessionTime", MakeDouble(env, stamp.session_time)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "sessionTick", MakeInt(env, stamp.session_tick)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "tickCount", MakeInt(env, stamp.tick_count)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "fromSignal", MakeBool(env, stamp.from_signal)));
+  return result;
+}
+
+// Returns the current SessionTime -> monotonic fit, or null until enough ticks arrived.
+static napi_value GetClockFit(napi_env env, napi_callback_info info)
+{
+  (void)info;
+  const irsdk_node::TickClock& clock = TickTiming().clock;
+  if (!clock.HasFit()) {
+    return GetNull(env);
+  }
+
+  const irsdk_node::ClockFit& fit = clock.Fit();
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_set_named_property(env, result, "slope", MakeDouble(env, fit.slope)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "interceptMs", MakeDouble(env, fit.intercept_ms)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "residualMs", MakeDouble(env, fit.residual_ms)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "samples", MakeInt(env, fit.samples)));
+  return result;
+}
+
+static napi_value SessionTimeToMonotonic(napi_env env, napi_callback_info info)
+{
+  double session_time = 0.0;
+  if (!GetDoubleArg(env, info, "sessionTimeToMonotonic expects (sessionTime)", &session_time)) {
+    return nullptr;
+  }
+  const irsdk_node::TickClock& clock = TickTiming().clock;
+  if (!clock.HasFit()) {
+    return GetNull(env);
+  }
+  return MakeDouble(env, clock.SessionTimeToMonotonic(session_time));
+}
+
+static napi_value MonotonicToSessionTime(napi_env env, napi_callback_info info)
+{
+  double monotonic_ms = 0.0;
+  if (!GetDoubleArg(env, info, "monotonicToSessionTime expects (monotonicMs)", &monotonic_ms)) {
+    return nullptr;
+  }
+  const irsdk_node::TickClock& clock = TickTiming().clock;
+  if (!clock.HasFit()) {
+    return GetNull(env);
+  }
+  return MakeDouble(env, clock.MonotonicToSessionTime(monotonic_ms));
+}
+
+static napi_value SessionTimeToWall(napi_env env, napi_callback_info info)
+{
+  double session_time = 0.0;
+  if (!GetDoubleArg(env, info, "sessionTimeToWall expects (sessionTime)", &session_time)) {
+    return nullptr;
+  }
+  const irsdk_node::TickClock& clock = TickTiming().clock;
+  if (!clock.HasFit()) {
+    return GetNull(env);
+  }
+  return MakeDouble(env, clock.SessionTimeToWall(session_time));
+}
+
+// Current value of the monotonic clock used for tick stamps.
+static napi_value NowMonotonic(napi_env env, napi_callback_info info)
+{
+  (void)info;
+  return MakeDouble(env, irsdk_node::TickClock::NowMonotonicMs());
+}
+
 static napi_value BroadcastMsg(napi_env env, napi_callback_info info)
 {
   size_t argc = 4;
   napi_value args[4];
   NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
 
-  if (argc < 3) {
-    napi_throw_type_error(env, nullptr, "broadcastMsg expects (msg, var1, var2[, var3])");
+  irsdk_node::BroadcastCommand command;
+  if (!irsdk_node::ParseBroadcastCommand(env, argc, args, &command)) {
     return nullptr;
   }
-
-  int32_t msg = 0;
-  int32_t var1 = 0;
-  NAPI_CALL(env, napi_get_value_int32(env, args[0], &msg));
-  if (msg == irsdk_BroadcastCamSwitchNum) {
-    if (!ParseCarNumberArg(env, args[1], &var1)) {
-      return nullptr;
-    }
-  } else {
-    NAPI_CALL(env, napi_get_value_int32(env, args[1], &var1));
-  }
-
-  if (msg == irsdk_BroadcastFFBCommand) {
-    double value = 0.0;
-    NAPI_CALL(env, napi_get_value_double(env, args[2], &value));
-    irsdk_broadcastMsg(static_cast<irsdk_BroadcastMsg>(msg), var1, static_cast<float>(value));
-  } else if (argc >= 4) {
-    int32_t var2 = 0;
-    int32_t var3 = 0;
-    NAPI_CALL(env, napi_get_value_int32(env, args[2], &var2));
-    NAPI_CALL(env, napi_get_value_int32(env, args[3], &var3));
-    irsdk_broadcastMsg(static_cast<irsdk_BroadcastMsg>(msg), var1, var2, var3);
-  } else {
-    int32_t var2 = 0;
-    NAPI_CALL(env, napi_get_value_int32(env, args[2], &var2));
-    irsdk_broadcastMsg(static_cast<irsdk_BroadcastMsg>(msg), var1, var2);
-  }
+  irsdk_node::SimBroadcastSink()->Send(command);
 
   napi_value result = nullptr;
   NAPI_CALL(env, napi_get_undefined(env, &result));
@@ -816,11 +994,25 @@ static napi_value Init(napi_env env, napi_value exports)
     {"readVars", nullptr, ReadVars, nullptr, nullptr, nullptr, napi_default, nullptr},
     {"readAllVars", nullptr, ReadAllVars, nullptr, nullptr, nullptr, napi_default, nullptr},
     {"getVarHeaders", nullptr, GetVarHeaders, nullptr, nullptr, nullptr, napi_default, nullptr},
-    {"broadcastMsg", nullptr, BroadcastMsg, nullptr, nullptr, nullptr, napi_default, nullptr}
+    {"broadcastMsg", nullptr, BroadcastMsg, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getTickTiming", nullptr, GetTickTiming, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getClockFit", nullptr, GetClockFit, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"sessionTimeToMonotonic", nullptr, SessionTimeToMonotonic, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"monotonicToSessionTime", nullptr, MonotonicToSessionTime, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"sessionTimeToWall", nullptr, SessionTimeToWall, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"nowMonotonic", nullptr, NowMonotonic, nullptr, nullptr, nullptr, napi_default, nullptr}
   };
 
   NAPI_CALL(env, napi_define_properties(env, exports, sizeof(descriptors) / sizeof(descriptors[0]), descriptors));
 
+  if (!irsdk_node::RegisterSharedBindings(env, exports)) {
+    return nullptr;
+  }
+
+  // Stamp ticks from the data-ready signal for as long as the module is loaded.
+  Watcher().Start();
+  NAPI_CALL(env, napi_add_env_cleanup_hook(env, StopWatcher, nullptr));
+
   napi_value constants = nullptr;
   NAPI_CALL(env, napi_create_object(env, &constants));
 
@@ -936,5 +1128,15 @@ static napi_value Init(napi_env env, napi_value exports)
 
 }  // namespace
 
+namespace irsdk_node {
+
+BroadcastSink* SimBroadcastSink()
+{
+  static SimSink sink;
+  return &sink;
+}
+
+}  // namespace irsdk_node
+
 // N-API module entry point.
 NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
@@ -1,5 +1,6 @@
 // Stub bindings for non-Windows platforms.
-// Provides the same surface area but throws a clear error when called.
+// Provides the same surface area; SDK calls throw a clear error, while the
+// platform-independent components from bindings.cpp work as usual.
 
 #include <node_api.h>
 
@@ -7,36 +8,13 @@
 #include <utility>
 
 #include "irsdk_defines.h"
+#include "bindings.h"
+#include "broadcast_dispatcher.h"
+#include "napi_util.h"
 
 namespace {
 
-// Helper macro to convert N-API status codes into JS exceptions.
-#define NAPI_CALL(env, call)                                    \
-  do {                                                          \
-    napi_status status = (call);                                \
-    if (status != napi_ok) {                                    \
-      const napi_extended_error_info* error_info = nullptr;     \
-      napi_get_last_error_info((env), &error_info);             \
-      const char* msg = error_info && error_info->error_message \
-                            ? error_info->error_message         \
-                            : "napi error";                    \
-      napi_throw_error((env), nullptr, msg);                    \
-      return nullptr;                                           \
-    }                                                           \
-  } while (0)
-
-static bool CheckNapi(napi_env env, napi_status status)
-{
-  if (status == napi_ok) {
-    return true;
-  }
-
-  const napi_extended_error_info* error_info = nullptr;
-  napi_get_last_error_info(env, &error_info);
-  const char* msg = error_info && error_info->error_message ? error_info->error_message : "napi error";
-  napi_throw_error(env, nullptr, msg);
-  return false;
-}
+using irsdk_node::CheckNapi;
 
 // Throw on use to signal that the native bindings are Windows-only.
 static napi_value ThrowUnsupported(napi_env env, napi_callback_info info)
@@ -89,11 +67,21 @@ static napi_value Init(napi_env env, napi_value exports)
     {"readVars", nullptr, ThrowUnsupported, nullptr, nullptr, nullptr, napi_default, nullptr},
     {"readAllVars", nullptr, ThrowUnsupported, nullptr, nullptr, nullptr, napi_default, nullptr},
     {"getVarHeaders", nullptr, ThrowUnsupported, nullptr, nullptr, nullptr, napi_default, nullptr},
-    {"broadcastMsg", nullptr, ThrowUnsupported, nullptr, nullptr, nullptr, napi_default, nullptr}
+    {"broadcastMsg", nullptr, ThrowUnsupported, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getTickTiming", nullptr, ThrowUnsupported, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getClockFit", nullptr, ThrowUnsupported, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"sessionTimeToMonotonic", nullptr, ThrowUnsupported, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"monotonicToSessionTime", nullptr, ThrowUnsupported, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"sessionTimeToWall", nullptr, ThrowUnsupported, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"nowMonotonic", nullptr, ThrowUnsupported, nullptr, nullptr, nullptr, napi_default, nullptr}
   };
 
   NAPI_CALL(env, napi_define_properties(env, exports, sizeof(descriptors) / sizeof(descriptors[0]), descriptors));
 
+  if (!irsdk_node::RegisterSharedBindings(env, exports)) {
+    return nullptr;
+  }
+
   napi_value constants = nullptr;
   NAPI_CALL(env, napi_create_object(env, &constants));
 
@@ -209,5 +197,15 @@ static napi_value Init(napi_env env, napi_value exports)
 
 }  // namespace
 
+namespace irsdk_node {
+
+// No sim to talk to; dispatchers can still use the mock sink.
+BroadcastSink* SimBroadcastSink()
+{
+  return nullptr;
+}
+
+}  // namespace irsdk_node
+
 // N-API module entry point.
 NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
@@ -0,0 +1,287 @@
+// Promise-based jobs on the libuv thread pool for .ibt processing.
+
+#include "async_job.h"
+
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "napi_util.h"
+#include "tick_clock.h"
+
+namespace irsdk_node {
+
+namespace {
+
+constexpr double kProgressIntervalMs = 50.0;
+
+using CancelFlag = std::shared_ptr<std::atomic<bool>>;
+
+// Latest progress of a job, shared between the workers and the main thread.
+// At most one call is queued at a time, and calls still queued when the job
+// settles are dropped so onProgress never runs after the promise settles.
+struct ProgressState {
+  std::mutex mutex;
+  double done = 0.0;
+  double total = 0.0;
+  bool fresh = false;   // Not yet delivered to onProgress.
+  bool queued = false;  // A call is waiting on the main thread.
+  bool settled = false;
+  double last_queued_ms = -std::numeric_limits<double>::infinity();
+};
+
+using ProgressPtr = std::shared_ptr<ProgressState>;
+
+class Job : public JobControl {
+ public:
+  bool Update(double done, double total) override
+  {
+    if (cancelled->load()) {
+      return false;
+    }
+    if (progress_call) {
+      std::lock_guard<std::mutex> lock(progress->mutex);
+      progress->done = done;
+      progress->total = total;
+      progress->fresh = true;
+      double now = TickClock::NowMonotonicMs();
+      if (!progress->queued && now - progress->last_queued_ms >= kProgressIntervalMs) {
+        progress->queued = true;
+        progress->last_queued_ms = now;
+        if (napi_call_threadsafe_function(progress_call, nullptr, napi_tsfn_nonblocking) != napi_ok) {
+          progress->queued = false;
+        }
+      }
+    }
+    return !cancelled->load();
+  }
+
+  CancelFlag cancelled = std::make_shared<std::atomic<bool>>(false);
+  ProgressPtr progress = std::make_shared<ProgressState>();
+  JobExecute execute;
+  JobComplete complete;
+  napi_async_work work = nullptr;
+  napi_deferred deferred = nullptr;
+  napi_threadsafe_function progress_call = nullptr;
+  napi_ref on_progress = nullptr;
+  napi_ref owner = nullptr;
+  napi_ref signal = nullptr;
+  napi_ref listener = nullptr;
+  bool ok = false;
+  std::string error;
+};
+
+napi_value MakeAbortError(napi_env env)
+{
+  napi_value code = nullptr;
+  napi_value message = nullptr;
+  napi_value error = nullptr;
+  NAPI_CALL(env, napi_create_string_utf8(env, "ABORT_ERR", NAPI_AUTO_LENGTH, &code));
+  NAPI_CALL(env, napi_create_string_utf8(env, "The operation was aborted", NAPI_AUTO_LENGTH, &message));
+  NAPI_CALL(env, napi_create_error(env, code, message, &error));
+  NAPI_CALL(env, napi_set_named_property(env, error, "name", MakeString(env, "AbortError")));
+  return error;
+}
+
+void CallOnProgress(napi_env env, napi_value callback, double done, double total)
+{
+  napi_value args[2] = {MakeDouble(env, done), MakeDouble(env, total)};
+  napi_call_function(env, GetUndefined(env), callback, 2, args, nullptr);
+}
+
+void CallProgress(napi_env env, napi_value callback, void* context, void* data)
+{
+  (void)data;
+  ProgressState* state = static_cast<ProgressPtr*>(context)->get();
+  double done = 0.0;
+  double total = 0.0;
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->queued = false;
+    if (state->settled || !state->fresh) {
+      return;
+    }
+    state->fresh = false;
+    done = state->done;
+    total = state->total;
+  }
+  if (env && callback) {
+    CallOnProgress(env, callback, done, total);
+  }
+}
+
+void FinalizeProgress(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  delete static_cast<ProgressPtr*>(data);
+}
+
+napi_value OnAbort(napi_env env, napi_callback_info info)
+{
+  void* data = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, nullptr, nullptr, nullptr, &data));
+  (*static_cast<CancelFlag*>(data))->store(true);
+  return GetUndefined(env);
+}
+
+void FinalizeCancelFlag(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  delete static_cast<CancelFlag*>(data);
+}
+
+// Call signal[method]('abort', listener).
+void CallSignal(napi_env env, napi_value signal, const char* method, napi_value listener)
+{
+  napi_value fn = nullptr;
+  napi_value args[2] = {MakeString(env, "abort"), listener};
+  if (napi_get_named_property(env, signal, method, &fn) == napi_ok) {
+    napi_call_function(env, signal, fn, 2, args, nullptr);
+  }
+}
+
+napi_value GetReference(napi_env env, napi_ref ref)
+{
+  napi_value value = nullptr;
+  napi_get_reference_value(env, ref, &value);
+  return value;
+}
+
+void ExecuteJob(napi_env env, void* data)
+{
+  (void)env;
+  Job* job = static_cast<Job*>(data);
+  job->ok = job->execute(job, &job->error);
+}
+
+void CompleteJob(napi_env env, napi_status status, void* data)
+{
+  std::unique_ptr<Job> job(static_cast<Job*>(data));
+  bool ok = status == napi_ok && job->ok;
+  napi_value thrown = nullptr;
+  if (job->progress_call) {
+    bool fresh = false;
+    {
+      std::lock_guard<std::mutex> lock(job->progress->mutex);
+      job->progress->settled = true;
+      fresh = job->progress->fresh;
+    }
+    // Deliver the final count the throttle held back before settling.
+    if (ok && fresh) {
+      CallOnProgress(env, GetReference(env, job->on_progress), job->progress->done, job->progress->total);
+      bool pending = false;
+      if (napi_is_exception_pending(env, &pending) == napi_ok && pending) {
+        napi_get_and_clear_last_exception(env, &thrown);
+      }
+    }
+    napi_release_threadsafe_function(job->progress_call, napi_tsfn_release);
+    napi_delete_reference(env, job->on_progress);
+  }
+  if (job->signal) {
+    CallSignal(env, GetReference(env, job->signal), "removeEventListener", GetReference(env, job->listener));
+    napi_delete_reference(env, job->signal);
+    napi_delete_reference(env, job->listener);
+  }
+
+  napi_value result = job->complete(env, ok);
+  if (ok && !result) {
+    // Building the result threw; reject with that exception.
+    napi_get_and_clear_last_exception(env, &result);
+    ok = false;
+  } else if (!ok) {
+    if (job->cancelled->load() || status == napi_cancelled) {
+      result = MakeAbortError(env);
+    } else {
+      napi_value message = nullptr;
+      napi_create_string_utf8(env, job->error.c_str(), NAPI_AUTO_LENGTH, &message);
+      napi_create_error(env, nullptr, message, &result);
+    }
+  }
+  if (ok) {
+    napi_resolve_deferred(env, job->deferred, result);
+  } else {
+    napi_reject_deferred(env, job->deferred, result);
+  }
+
+  if (job->owner) {
+    napi_delete_reference(env, job->owner);
+  }
+  napi_delete_async_work(env, job->work);
+  if (thrown) {
+    // Surface a throwing onProgress the way the queued calls do.
+    napi_throw(env, thrown);
+  }
+}
+
+}  // namespace
+
+napi_value QueueJob(napi_env env,
+                    const char* name,
+                    napi_value owner,
+                    napi_value job_options,
+                    JobExecute execute,
+                    JobComplete complete)
+{
+  napi_value on_progress = nullptr;
+  napi_value signal = nullptr;
+  bool has_progress = GetOptionalProperty(env, job_options, "onProgress", &on_progress);
+  bool has_signal = GetOptionalProperty(env, job_options, "signal", &signal);
+  if (has_progress) {
+    napi_valuetype type = napi_undefined;
+    NAPI_CALL(env, napi_typeof(env, on_progress, &type));
+    if (type != napi_function) {
+      napi_throw_type_error(env, nullptr, "onProgress must be a function");
+      return nullptr;
+    }
+  }
+  bool aborted = false;
+  if (has_signal && !GetOptionalBool(env, signal, "aborted", &aborted)) {
+    return nullptr;
+  }
+
+  std::unique_ptr<Job> job(new Job());
+  job->execute = std::move(execute);
+  job->complete = std::move(complete);
+  napi_value promise = nullptr;
+  NAPI_CALL(env, napi_create_promise(env, &job->deferred, &promise));
+  if (aborted) {
+    job->complete(env, false);
+    NAPI_CALL(env, napi_reject_deferred(env, job->deferred, MakeAbortError(env)));
+    return promise;
+  }
+
+  napi_value resource_name = MakeString(env, name);
+  if (has_progress) {
+    auto* context = new ProgressPtr(job->progress);
+    if (napi_create_threadsafe_function(env, on_progress, nullptr, resource_name, 0, 1, context, FinalizeProgress,
+                                        context, CallProgress, &job->progress_call) != napi_ok) {
+      delete context;
+      napi_throw_error(env, nullptr, "failed to create the progress callback");
+      return nullptr;
+    }
+    NAPI_CALL(env, napi_create_reference(env, on_progress, 1, &job->on_progress));
+  }
+  if (has_signal) {
+    napi_value listener = nullptr;
+    auto* flag = new CancelFlag(job->cancelled);
+    NAPI_CALL(env, napi_create_function(env, "onAbort", NAPI_AUTO_LENGTH, OnAbort, flag, &listener));
+    NAPI_CALL(env, napi_add_finalizer(env, listener, flag, FinalizeCancelFlag, nullptr, nullptr));
+    NAPI_CALL(env, napi_create_reference(env, signal, 1, &job->signal));
+    NAPI_CALL(env, napi_create_reference(env, listener, 1, &job->listener));
+    CallSignal(env, signal, "addEventListener", listener);
+  }
+  if (owner) {
+    NAPI_CALL(env, napi_create_reference(env, owner, 1, &job->owner));
+  }
+
+  NAPI_CALL(env, napi_create_async_work(env, nullptr, resource_name, ExecuteJob, CompleteJob, job.get(), &job->work));
+  NAPI_CALL(env, napi_queue_async_work(env, job->work));
+  job.release();
+  return promise;
+}
+
+}  // namespace irsdk_node
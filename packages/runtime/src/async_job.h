@@ -0,0 +1,38 @@
+// Promise-based jobs on the libuv thread pool for .ibt processing, with
+// progress callbacks through a threadsafe function and cancellation through
+// an AbortSignal, so large files never block the event loop.
+
+#ifndef IRSDK_NODE_ASYNC_JOB_H_
+#define IRSDK_NODE_ASYNC_JOB_H_
+
+#include <node_api.h>
+
+#include <functional>
+#include <string>
+
+#include "job_control.h"
+
+namespace irsdk_node {
+
+// Runs on a pool thread. Returns false with error set on failure.
+using JobExecute = std::function<bool(JobControl* control, std::string* error)>;
+
+// Runs on the main thread once the work has ended, successfully or not. When
+// it succeeded, the returned value resolves the promise.
+using JobComplete = std::function<napi_value(napi_env env, bool ok)>;
+
+// Queue execute and return a promise for its result. The signal and
+// onProgress properties of job_options, usually the method's own options,
+// control the job: aborting the signal cancels it, which then rejects with an
+// AbortError, and onProgress(done, total) is called at most every 50 ms.
+// owner, when set, is kept alive until the job settles.
+napi_value QueueJob(napi_env env,
+                    const char* name,
+                    napi_value owner,
+                    napi_value job_options,
+                    JobExecute execute,
+                    JobComplete complete);
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_ASYNC_JOB_H_
@@ -0,0 +1,101 @@
+// Appends to a file from a thread of its own.
+
+#include "background_writer.h"
+
+#include <utility>
+
+#include "file_util.h"
+
+namespace irsdk_node {
+
+BackgroundWriter::BackgroundWriter(std::string path) : path_(std::move(path))
+{
+  worker_ = std::thread(&BackgroundWriter::Run, this);
+}
+
+BackgroundWriter::~BackgroundWriter()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+void BackgroundWriter::Append(std::string data)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(Op{false, std::move(data)});
+  }
+  wake_.notify_one();
+}
+
+void BackgroundWriter::Replace(std::string data)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.clear();
+    queue_.push_back(Op{true, std::move(data)});
+  }
+  wake_.notify_one();
+}
+
+bool BackgroundWriter::Wait(std::string* error)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this]() { return queue_.empty() && !busy_; });
+  if (failed_) {
+    *error = last_error_;
+    return false;
+  }
+  return true;
+}
+
+bool BackgroundWriter::failed() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return failed_;
+}
+
+std::string BackgroundWriter::last_error() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return last_error_;
+}
+
+void BackgroundWriter::Run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wake_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+    // Stopping still writes what was queued before it.
+    if (queue_.empty()) {
+      break;
+    }
+    Op op = std::move(queue_.front());
+    queue_.pop_front();
+    if (op.replace || !failed_) {
+      busy_ = true;
+      lock.unlock();
+      std::string error;
+      bool ok = op.replace ? WriteFileAtomically(path_, op.data, &error) : AppendToFile(path_, op.data);
+      lock.lock();
+      busy_ = false;
+      if (ok) {
+        failed_ = failed_ && !op.replace;
+      } else {
+        failed_ = true;
+        last_error_ = op.replace ? error : "cannot write " + path_;
+      }
+    }
+    if (queue_.empty()) {
+      idle_.notify_all();
+    }
+  }
+}
+
+}  // namespace irsdk_node
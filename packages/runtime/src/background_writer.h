@@ -0,0 +1,64 @@
+// Appends to a file from a thread of its own, so the write and its fsync
+// stay off the thread that produces the data, e.g. the one running live
+// ticks.
+
+#ifndef IRSDK_NODE_BACKGROUND_WRITER_H_
+#define IRSDK_NODE_BACKGROUND_WRITER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace irsdk_node {
+
+class BackgroundWriter {
+ public:
+  explicit BackgroundWriter(std::string path);
+  // Writes whatever is queued, then stops the thread.
+  ~BackgroundWriter();
+
+  BackgroundWriter(const BackgroundWriter&) = delete;
+  BackgroundWriter& operator=(const BackgroundWriter&) = delete;
+
+  // Queue data to append to the file.
+  void Append(std::string data);
+  // Queue replacing the file with data, dropping the writes queued before
+  // it.
+  void Replace(std::string data);
+
+  // Wait for the queued writes. Returns false while the file lacks data
+  // because a write failed, until a Replace succeeds.
+  bool Wait(std::string* error);
+
+  // A failed append may leave a torn record at the end of the file, so
+  // appends are dropped until the caller queues a Replace with everything.
+  bool failed() const;
+  // The last error writing the file.
+  std::string last_error() const;
+
+ private:
+  struct Op {
+    bool replace;
+    std::string data;
+  };
+
+  void Run();
+
+  std::string path_;
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable idle_;
+  std::deque<Op> queue_;
+  bool busy_ = false;
+  bool stopping_ = false;
+  bool failed_ = false;
+  std::string last_error_;
+
+  std::thread worker_;
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_BACKGROUND_WRITER_H_
@@ -0,0 +1,36 @@
+// Registration of the platform-independent native components.
+
+#include "bindings.h"
+
+namespace irsdk_node {
+
+napi_value RegisterSharedBindings(napi_env env, napi_value exports)
+{
+  if (!RegisterInterpolator(env, exports) ||
+      !RegisterResampler(env, exports) ||
+      !RegisterIbtFile(env, exports) ||
+      !RegisterLapDelta(env, exports) ||
+      !RegisterHistory(env, exports) ||
+      !RegisterDownsample(env, exports) ||
+      !RegisterBroadcastDispatcher(env, exports) ||
+      !RegisterBroadcastAcks(env, exports) ||
+      !RegisterBroadcastTimeline(env, exports) ||
+      !RegisterCameraDirector(env, exports) ||
+      !RegisterRelative(env, exports) ||
+      !RegisterIncidentDetector(env, exports) ||
+      !RegisterCornerAnalyzer(env, exports) ||
+      !RegisterLapStats(env, exports) ||
+      !RegisterSanityFilter(env, exports) ||
+      !RegisterPositionFilter(env, exports) ||
+      !RegisterIbtTail(env, exports) ||
+      !RegisterIbtCatalog(env, exports) ||
+      !RegisterIbtAlign(env, exports) ||
+      !RegisterSessionLog(env, exports) ||
+      !RegisterVideoSync(env, exports) ||
+      !RegisterRecording(env, exports)) {
+    return nullptr;
+  }
+  return exports;
+}
+
+}  // namespace irsdk_node
@@ -0,0 +1,39 @@
+// Registration of the platform-independent native components.
+// Both addon.cpp and addon_stub.cpp expose these on the module exports.
+
+#ifndef IRSDK_NODE_BINDINGS_H_
+#define IRSDK_NODE_BINDINGS_H_
+
+#include <node_api.h>
+
+namespace irsdk_node {
+
+napi_value RegisterBroadcastAcks(napi_env env, napi_value exports);
+napi_value RegisterBroadcastDispatcher(napi_env env, napi_value exports);
+napi_value RegisterBroadcastTimeline(napi_env env, napi_value exports);
+napi_value RegisterCameraDirector(napi_env env, napi_value exports);
+napi_value RegisterCornerAnalyzer(napi_env env, napi_value exports);
+napi_value RegisterDownsample(napi_env env, napi_value exports);
+napi_value RegisterHistory(napi_env env, napi_value exports);
+napi_value RegisterIbtAlign(napi_env env, napi_value exports);
+napi_value RegisterIbtCatalog(napi_env env, napi_value exports);
+napi_value RegisterIbtFile(napi_env env, napi_value exports);
+napi_value RegisterIbtTail(napi_env env, napi_value exports);
+napi_value RegisterIncidentDetector(napi_env env, napi_value exports);
+napi_value RegisterInterpolator(napi_env env, napi_value exports);
+napi_value RegisterLapDelta(napi_env env, napi_value exports);
+napi_value RegisterLapStats(napi_env env, napi_value exports);
+napi_value RegisterPositionFilter(napi_env env, napi_value exports);
+napi_value RegisterRecording(napi_env env, napi_value exports);
+napi_value RegisterRelative(napi_env env, napi_value exports);
+napi_value RegisterResampler(napi_env env, napi_value exports);
+napi_value RegisterSanityFilter(napi_env env, napi_value exports);
+napi_value RegisterSessionLog(napi_env env, napi_value exports);
+napi_value RegisterVideoSync(napi_env env, napi_value exports);
+
+// Register every shared component on the exports object.
+napi_value RegisterSharedBindings(napi_env env, napi_value exports);
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_BINDINGS_H_
@@ -0,0 +1,432 @@
+// Confirmation of camera and replay broadcasts against live telemetry.
+
+#include "broadcast_ack.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "bindings.h"
+#include "napi_util.h"
+#include "tick_clock.h"
+
+namespace irsdk_node {
+
+AckMatcher::AckMatcher(SettledCallback on_settled) : on_settled_(std::move(on_settled)) {}
+
+int AckMatcher::Expect(const AckCondition& condition, double now_ms)
+{
+  Pending pending;
+  pending.id = next_id_++;
+  pending.condition = condition;
+  pending.created_ms = now_ms;
+  pending.deadline_ms = now_ms + std::max(0.0, condition.timeout_ms);
+  pending.base_frame = has_last_ ? last_.frame : -1;
+  pending_.push_back(pending);
+  return pending.id;
+}
+
+void AckMatcher::Read(const TelemetrySource& source, Snapshot* out)
+{
+  auto read_int = [&source](VarHandle& var, int fallback) {
+    return var.Resolve(source) ? static_cast<int>(var.Get(source)) : fallback;
+  };
+  out->cam_car_idx = read_int(cam_car_idx_var_, -1);
+  out->cam_group = read_int(cam_group_var_, 0);
+  out->cam_camera = read_int(cam_camera_var_, 0);
+  out->frame = read_int(frame_var_, -1);
+  out->frame_end = read_int(frame_end_var_, -1);
+  out->session_num = read_int(session_num_var_, -1);
+  out->replay_time = replay_time_var_.Resolve(source) ? replay_time_var_.Get(source) : 0.0;
+  out->speed = read_int(speed_var_, 0);
+  out->slow_motion = read_int(slow_motion_var_, 0) != 0;
+}
+
+int AckMatcher::CarAtPosition(const TelemetrySource& source, int position)
+{
+  if (!position_var_.Resolve(source)) {
+    return -1;
+  }
+  for (int i = 0; i < position_var_.count(); ++i) {
+    if (static_cast<int>(position_var_.Get(source, i)) == position) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool AckMatcher::Matches(const TelemetrySource& source, Pending* pending, const Snapshot& now)
+{
+  const AckCondition& c = pending->condition;
+  switch (c.kind) {
+    case AckKind::kCamera: {
+      int car = c.car_idx;
+      // Positions are only known once the session has classified cars.
+      // Until a car holds the position the switch cannot be confirmed, since
+      // the group and camera alone match any car.
+      if (car < 0 && c.car_pos > 0) {
+        car = CarAtPosition(source, c.car_pos);
+        if (car < 0) {
+          return false;
+        }
+      }
+      return (car < 0 || now.cam_car_idx == car) && (c.group <= 0 || now.cam_group == c.group) &&
+             (c.camera <= 0 || now.cam_camera == c.camera);
+    }
+    case AckKind::kReplayFrame: {
+      if (c.frame_mode == 2) {
+        return now.frame_end >= 0 && std::abs(now.frame_end - c.frame) <= c.tolerance_frames;
+      }
+      if (c.frame_mode == 1 && pending->base_frame < 0) {
+        // Added before the first tick: count from the first frame seen.
+        pending->base_frame = now.frame;
+      }
+      int target = c.frame_mode == 1 ? pending->base_frame + c.frame : c.frame;
+      return now.frame >= 0 && std::abs(now.frame - target) <= c.tolerance_frames;
+    }
+    case AckKind::kReplaySessionTime:
+      return now.session_num == c.session_num && std::fabs(now.replay_time - c.session_time) <= c.tolerance_s;
+    case AckKind::kReplaySpeed:
+      return now.speed == c.speed && now.slow_motion == c.slow_motion;
+    case AckKind::kReplayJump: {
+      bool jumped = pending->base_frame >= 0 && now.frame >= 0 &&
+                    std::abs(now.frame - pending->base_frame) >= c.min_jump_frames;
+      // Normal playback moves a few frames per tick; compare tick to tick.
+      pending->base_frame = now.frame;
+      return jumped;
+    }
+  }
+  return false;
+}
+
+void AckMatcher::OnTick(const TelemetrySource& source, const TickStamp& stamp)
+{
+  Snapshot now;
+  Read(source, &now);
+  last_ = now;
+  has_last_ = true;
+  if (pending_.empty()) {
+    return;
+  }
+
+  // Settle after the sweep: the callback may add or cancel conditions.
+  std::vector<std::pair<Pending, bool>> settled;
+  size_t kept = 0;
+  for (size_t i = 0; i < pending_.size(); ++i) {
+    Pending& pending = pending_[i];
+    if (Matches(source, &pending, now)) {
+      settled.emplace_back(pending, true);
+    } else if (stamp.monotonic_ms >= pending.deadline_ms) {
+      settled.emplace_back(pending, false);
+    } else {
+      pending_[kept++] = pending;
+    }
+  }
+  pending_.resize(kept);
+  for (const auto& entry : settled) {
+    Settle(entry.first, entry.second, !entry.second, stamp.session_time, stamp.monotonic_ms);
+  }
+}
+
+void AckMatcher::Expire(double now_ms)
+{
+  std::vector<Pending> expired;
+  size_t kept = 0;
+  for (size_t i = 0; i < pending_.size(); ++i) {
+    if (now_ms >= pending_[i].deadline_ms) {
+      expired.push_back(pending_[i]);
+    } else {
+      pending_[kept++] = pending_[i];
+    }
+  }
+  pending_.resize(kept);
+  for (const Pending& pending : expired) {
+    Settle(pending, false, true, 0.0, now_ms);
+  }
+}
+
+double AckMatcher::NextDeadline() const
+{
+  double next = -1.0;
+  for (const Pending& pending : pending_) {
+    if (next < 0.0 || pending.deadline_ms < next) {
+      next = pending.deadline_ms;
+    }
+  }
+  return next;
+}
+
+void AckMatcher::CancelAll(double now_ms)
+{
+  std::vector<Pending> cancelled;
+  cancelled.swap(pending_);
+  for (const Pending& pending : cancelled) {
+    Settle(pending, false, false, 0.0, now_ms);
+  }
+}
+
+void AckMatcher::Settle(const Pending& pending, bool matched, bool timed_out, double session_time,
+                        double monotonic_ms)
+{
+  AckOutcome outcome;
+  outcome.id = pending.id;
+  outcome.matched = matched;
+  outcome.timed_out = timed_out;
+  outcome.timeout_ms = pending.condition.timeout_ms;
+  outcome.latency_ms = monotonic_ms - pending.created_ms;
+  outcome.session_time = session_time;
+  outcome.monotonic_ms = monotonic_ms;
+  on_settled_(outcome);
+}
+
+namespace {
+
+// JS wrapper that keeps the matcher attached to the live tick stream and owns
+// the promise of every pending condition. While any is pending, self is a
+// strong reference, so the wrapper is not collected under an awaited promise.
+struct AckHandle {
+  napi_env env = nullptr;
+  napi_ref self = nullptr;
+  std::unique_ptr<AckMatcher> matcher;
+  std::vector<std::pair<int, napi_deferred>> deferreds;
+  bool attached = false;
+
+  void Detach()
+  {
+    if (attached) {
+      TickHub::Instance().Remove(matcher.get());
+      attached = false;
+    }
+  }
+
+  void OnSettled(const AckOutcome& outcome);
+};
+
+napi_value MakeAckResult(napi_env env, const AckOutcome& outcome)
+{
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_set_named_property(env, result, "latencyMs", MakeDouble(env, outcome.latency_ms)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "sessionTime", MakeDouble(env, outcome.session_time)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "monotonicMs", MakeDouble(env, outcome.monotonic_ms)));
+  return result;
+}
+
+napi_value MakeAckError(napi_env env, const AckOutcome& outcome)
+{
+  char message[96];
+  if (outcome.timed_out) {
+    std::snprintf(message, sizeof(message), "broadcast not acknowledged within %.0f ms", outcome.timeout_ms);
+  } else {
+    std::snprintf(message, sizeof(message), "broadcast acknowledgement cancelled");
+  }
+  napi_value text = nullptr;
+  napi_value code = nullptr;
+  napi_value error = nullptr;
+  NAPI_CALL(env, napi_create_string_utf8(env, message, NAPI_AUTO_LENGTH, &text));
+  NAPI_CALL(env, napi_create_string_utf8(env, outcome.timed_out ? "ETIMEDOUT" : "ECANCELED", NAPI_AUTO_LENGTH,
+                                         &code));
+  NAPI_CALL(env, napi_create_error(env, code, text, &error));
+  return error;
+}
+
+void AckHandle::OnSettled(const AckOutcome& outcome)
+{
+  napi_deferred deferred = nullptr;
+  for (size_t i = 0; i < deferreds.size(); ++i) {
+    if (deferreds[i].first == outcome.id) {
+      deferred = deferreds[i].second;
+      deferreds.erase(deferreds.begin() + static_cast<std::ptrdiff_t>(i));
+      break;
+    }
+  }
+  if (!deferred) {
+    return;
+  }
+  if (deferreds.empty()) {
+    napi_reference_unref(env, self, nullptr);
+  }
+
+  // Runs inside the call that delivered the tick or expired the condition.
+  napi_handle_scope scope = nullptr;
+  if (napi_open_handle_scope(env, &scope) != napi_ok) {
+    return;
+  }
+  if (outcome.matched) {
+    napi_resolve_deferred(env, deferred, MakeAckResult(env, outcome));
+  } else {
+    napi_reject_deferred(env, deferred, MakeAckError(env, outcome));
+  }
+  napi_close_handle_scope(env, scope);
+}
+
+void FinalizeAcks(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  AckHandle* handle = static_cast<AckHandle*>(data);
+  // Pending conditions keep the wrapper alive, so only environment teardown
+  // gets here with promises unsettled, and no JS can run to observe them.
+  handle->Detach();
+  if (handle->self) {
+    napi_delete_reference(env, handle->self);
+  }
+  delete handle;
+}
+
+napi_value AcksConstructor(napi_env env, napi_callback_info info)
+{
+  size_t argc = 0;
+  napi_value self = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, nullptr, &self, nullptr));
+
+  auto* handle = new AckHandle();
+  handle->env = env;
+  handle->matcher.reset(new AckMatcher([handle](const AckOutcome& outcome) { handle->OnSettled(outcome); }));
+  napi_status status = napi_wrap(env, self, handle, FinalizeAcks, nullptr, nullptr);
+  if (status != napi_ok) {
+    delete handle;
+    CheckNapi(env, status);
+    return nullptr;
+  }
+  status = napi_create_reference(env, self, 0, &handle->self);
+  if (status != napi_ok) {
+    CheckNapi(env, status);
+    return nullptr;
+  }
+
+  TickHub::Instance().Add(handle->matcher.get());
+  handle->attached = true;
+  return self;
+}
+
+bool ParseAckCondition(napi_env env, napi_value value, AckCondition* out)
+{
+  std::string kind;
+  napi_value kind_value = nullptr;
+  if (!GetOptionalProperty(env, value, "kind", &kind_value) || !GetString(env, kind_value, &kind)) {
+    napi_throw_type_error(env, nullptr, "expect expects ({ kind, ..., timeoutMs? })");
+    return false;
+  }
+
+  int slow_motion = 0;
+  if (!GetOptionalDouble(env, value, "timeoutMs", &out->timeout_ms) ||
+      !GetOptionalInt(env, value, "carIdx", &out->car_idx) ||
+      !GetOptionalInt(env, value, "carPos", &out->car_pos) ||
+      !GetOptionalInt(env, value, "group", &out->group) ||
+      !GetOptionalInt(env, value, "camera", &out->camera) ||
+      !GetOptionalInt(env, value, "mode", &out->frame_mode) ||
+      !GetOptionalInt(env, value, "frame", &out->frame) ||
+      !GetOptionalInt(env, value, "toleranceFrames", &out->tolerance_frames) ||
+      !GetOptionalInt(env, value, "sessionNum", &out->session_num) ||
+      !GetOptionalDouble(env, value, "sessionTime", &out->session_time) ||
+      !GetOptionalDouble(env, value, "toleranceS", &out->tolerance_s) ||
+      !GetOptionalInt(env, value, "speed", &out->speed) ||
+      !GetOptionalInt(env, value, "slowMotion", &slow_motion) ||
+      !GetOptionalInt(env, value, "minJumpFrames", &out->min_jump_frames)) {
+    return false;
+  }
+  out->slow_motion = slow_motion != 0;
+
+  if (kind == "camera") {
+    out->kind = AckKind::kCamera;
+  } else if (kind == "replayFrame") {
+    out->kind = AckKind::kReplayFrame;
+  } else if (kind == "replaySessionTime") {
+    out->kind = AckKind::kReplaySessionTime;
+  } else if (kind == "replaySpeed") {
+    out->kind = AckKind::kReplaySpeed;
+  } else if (kind == "replayJump") {
+    out->kind = AckKind::kReplayJump;
+  } else {
+    napi_throw_type_error(env, nullptr,
+                          "kind must be 'camera', 'replayFrame', 'replaySessionTime', 'replaySpeed' or 'replayJump'");
+    return false;
+  }
+  return true;
+}
+
+napi_value AcksExpect(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  AckHandle* handle = UnwrapThis<AckHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  AckCondition condition;
+  if (!ParseAckCondition(env, argc >= 1 ? args[0] : nullptr, &condition)) {
+    return nullptr;
+  }
+  if (!handle->attached) {
+    napi_throw_error(env, nullptr, "BroadcastAcks is closed");
+    return nullptr;
+  }
+
+  napi_deferred deferred = nullptr;
+  napi_value promise = nullptr;
+  NAPI_CALL(env, napi_create_promise(env, &deferred, &promise));
+  if (handle->deferreds.empty()) {
+    NAPI_CALL(env, napi_reference_ref(env, handle->self, nullptr));
+  }
+  int id = handle->matcher->Expect(condition, TickClock::NowMonotonicMs());
+  handle->deferreds.emplace_back(id, deferred);
+  return promise;
+}
+
+napi_value AcksExpire(napi_env env, napi_callback_info info)
+{
+  AckHandle* handle = UnwrapThis<AckHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  double now_ms = TickClock::NowMonotonicMs();
+  handle->matcher->Expire(now_ms);
+  double next = handle->matcher->NextDeadline();
+  return next < 0.0 ? GetNull(env) : MakeDouble(env, std::max(0.0, next - now_ms));
+}
+
+napi_value AcksGetPending(napi_env env, napi_callback_info info)
+{
+  AckHandle* handle = UnwrapThis<AckHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  return MakeDouble(env, static_cast<double>(handle->matcher->pending()));
+}
+
+napi_value AcksClose(napi_env env, napi_callback_info info)
+{
+  AckHandle* handle = UnwrapThis<AckHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  handle->Detach();
+  handle->matcher->CancelAll(TickClock::NowMonotonicMs());
+  return GetUndefined(env);
+}
+
+}  // namespace
+
+napi_value RegisterBroadcastAcks(napi_env env, napi_value exports)
+{
+  napi_property_descriptor methods[] = {
+    {"expect", nullptr, AcksExpect, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"expire", nullptr, AcksExpire, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getPending", nullptr, AcksGetPending, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"close", nullptr, AcksClose, nullptr, nullptr, nullptr, napi_default, nullptr}
+  };
+
+  napi_value constructor = nullptr;
+  NAPI_CALL(env, napi_define_class(env, "BroadcastAcks", NAPI_AUTO_LENGTH, AcksConstructor, nullptr,
+                                   sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "BroadcastAcks", constructor));
+  return exports;
+}
+
+}  // namespace irsdk_node
@@ -0,0 +1,134 @@
+// Confirmation of camera and replay broadcasts against live telemetry.
+// Conditions are checked natively on every tick; the JS wrapper settles one
+// promise per condition.
+
+#ifndef IRSDK_NODE_BROADCAST_ACK_H_
+#define IRSDK_NODE_BROADCAST_ACK_H_
+
+#include <functional>
+#include <vector>
+
+#include "telemetry_source.h"
+#include "tick_hub.h"
+
+namespace irsdk_node {
+
+enum class AckKind {
+  kCamera,             // CamCarIdx / CamGroupNumber / CamCameraNumber.
+  kReplayFrame,        // ReplayFrameNum (or ReplayFrameNumEnd) reached.
+  kReplaySessionTime,  // ReplaySessionNum / ReplaySessionTime reached.
+  kReplaySpeed,        // ReplayPlaySpeed / ReplayPlaySlowMotion.
+  kReplayJump          // ReplayFrameNum jumped, e.g. after a replay search.
+};
+
+struct AckCondition {
+  AckKind kind = AckKind::kCamera;
+  double timeout_ms = 2000.0;
+
+  // kCamera. Fields <= 0 (or < 0 for car_idx) are not checked. car_pos is
+  // mapped to a car through CarIdxPosition on every tick, and the condition
+  // stays pending while no car holds that position.
+  int car_idx = -1;
+  int car_pos = 0;
+  int group = 0;
+  int camera = 0;
+
+  // kReplayFrame. frame_mode follows irsdk_RpyPosMode: 0 from the start,
+  // 1 relative to the frame seen when the condition was added, 2 from the end.
+  int frame_mode = 0;
+  int frame = 0;
+  int tolerance_frames = 30;
+
+  // kReplaySessionTime.
+  int session_num = 0;
+  double session_time = 0.0;
+  double tolerance_s = 1.0;
+
+  // kReplaySpeed.
+  int speed = 1;
+  bool slow_motion = false;
+
+  // kReplayJump: frames the replay must move between consecutive ticks.
+  int min_jump_frames = 60;
+};
+
+struct AckOutcome {
+  int id;
+  bool matched;
+  bool timed_out;        // Unmatched and not cancelled.
+  double timeout_ms;     // The condition's timeout.
+  double latency_ms;     // From Expect() to the matching tick or the timeout.
+  double session_time;   // SessionTime of the matching tick.
+  double monotonic_ms;   // Tick stamp of the match, or the time of the timeout.
+};
+
+class AckMatcher : public TickListener {
+ public:
+  using SettledCallback = std::function<void(const AckOutcome&)>;
+
+  explicit AckMatcher(SettledCallback on_settled);
+
+  void OnTick(const TelemetrySource& source, const TickStamp& stamp) override;
+
+  // Start watching for a condition. Returns its id for the settled callback.
+  int Expect(const AckCondition& condition, double now_ms);
+
+  // Time out conditions whose deadline passed, for when no ticks arrive.
+  void Expire(double now_ms);
+
+  // Earliest deadline of the pending conditions, or -1 when none is pending.
+  double NextDeadline() const;
+
+  // Settle every pending condition as unmatched.
+  void CancelAll(double now_ms);
+
+  size_t pending() const { return pending_.size(); }
+
+ private:
+  struct Pending {
+    int id;
+    AckCondition condition;
+    double created_ms;
+    double deadline_ms;
+    int base_frame;  // Frame the kReplayFrame/kReplayJump conditions start from.
+  };
+
+  struct Snapshot {
+    int cam_car_idx = -1;
+    int cam_group = 0;
+    int cam_camera = 0;
+    int frame = -1;
+    int frame_end = -1;
+    int session_num = -1;
+    double replay_time = 0.0;
+    int speed = 0;
+    bool slow_motion = false;
+  };
+
+  void Read(const TelemetrySource& source, Snapshot* out);
+  bool Matches(const TelemetrySource& source, Pending* pending, const Snapshot& now);
+  int CarAtPosition(const TelemetrySource& source, int position);
+  void Settle(const Pending& pending, bool matched, bool timed_out, double session_time, double monotonic_ms);
+
+  SettledCallback on_settled_;
+  std::vector<Pending> pending_;
+  int next_id_ = 1;
+
+  bool has_last_ = false;
+  Snapshot last_;
+
+  VarHandle cam_car_idx_var_{"CamCarIdx"};
+  VarHandle cam_group_var_{"CamGroupNumber"};
+  VarHandle cam_camera_var_{"CamCameraNumber"};
+  VarHandle frame_var_{"ReplayFrameNum"};
+  VarHandle frame_end_var_{"ReplayFrameNumEnd"};
+  VarHandle session_num_var_{"ReplaySessionNum"};
+  VarHandle replay_time_var_{"ReplaySessionTime"};
+  VarHandle speed_var_{"ReplayPlaySpeed"};
+  VarHandle slow_motion_var_{"ReplayPlaySlowMotion"};
+  VarHandle position_var_{"CarIdxPosition"};
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_BROADCAST_ACK_H_
@@ -0,0 +1,433 @@
+// Queued, rate-limited delivery of broadcast messages to the sim.
+
+#include "broadcast_dispatcher.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "bindings.h"
+#include "irsdk_defines.h"
+#include "napi_util.h"
+#include "tick_clock.h"
+
+namespace irsdk_node {
+
+namespace {
+
+// Commands that set state the sim only needs the latest value of share a
+// key; everything else (chat, pit, relative replay searches and frame
+// steps) returns -1 and is always delivered.
+int CoalesceKey(const BroadcastCommand& command)
+{
+  switch (command.msg) {
+    case irsdk_BroadcastCamSwitchPos:
+    case irsdk_BroadcastCamSwitchNum:
+      return 1;
+    case irsdk_BroadcastCamSetState:
+      return 2;
+    case irsdk_BroadcastReplaySetPlaySpeed:
+      return 3;
+    case irsdk_BroadcastReplaySetPlayPosition:
+      // A step from the current frame adds to the ones before it.
+      return command.var1 == irsdk_RpyPos_Current ? -1 : 4;
+    case irsdk_BroadcastReplaySearchSessionTime:
+      return 4;
+    case irsdk_BroadcastFFBCommand:
+      return 100 + command.var1;
+    default:
+      return -1;
+  }
+}
+
+bool ParseCarNumber(napi_env env, napi_value value, int* num, int* zero_count)
+{
+  napi_valuetype type = napi_undefined;
+  if (!CheckNapi(env, napi_typeof(env, value, &type))) {
+    return false;
+  }
+
+  *zero_count = 0;
+  if (type != napi_string) {
+    return CheckNapi(env, napi_get_value_int32(env, value, num));
+  }
+
+  std::string text;
+  if (!GetString(env, value, &text) || text.empty()) {
+    napi_throw_type_error(env, nullptr, "car number must be a non-empty numeric string");
+    return false;
+  }
+
+  size_t index = 0;
+  while (index < text.size() && text[index] == '0') {
+    index += 1;
+  }
+
+  std::string digits = text.substr(index);
+  if (digits.empty()) {
+    *zero_count = static_cast<int>(text.size() - 1);
+    *num = 0;
+    return true;
+  }
+
+  for (char ch : digits) {
+    if (!std::isdigit(static_cast<unsigned char>(ch))) {
+      napi_throw_type_error(env, nullptr, "car number must be numeric");
+      return false;
+    }
+  }
+
+  errno = 0;
+  char* end = nullptr;
+  long parsed = std::strtol(digits.c_str(), &end, 10);
+  if (errno == ERANGE || end == digits.c_str() || *end != '\0') {
+    napi_throw_type_error(env, nullptr, "car number is out of range");
+    return false;
+  }
+  *zero_count = static_cast<int>(index);
+  *num = static_cast<int>(parsed);
+  return true;
+}
+
+}  // namespace
+
+void MockBroadcastSink::Send(const BroadcastCommand& command)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.push_back(Entry{command, TickClock::NowMonotonicMs()});
+}
+
+std::vector<MockBroadcastSink::Entry> MockBroadcastSink::Entries() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_;
+}
+
+BroadcastDispatcher::BroadcastDispatcher(BroadcastSink* sink, const DispatcherOptions& options)
+    : sink_(sink),
+      options_(options),
+      tokens_(std::max(1, options.burst)),
+      refilled_(Clock::now())
+{
+  options_.burst = std::max(1, options_.burst);
+  options_.max_queue = std::max<size_t>(1, options_.max_queue);
+  worker_ = std::thread([this]() { Run(); });
+}
+
+BroadcastDispatcher::~BroadcastDispatcher()
+{
+  Stop();
+}
+
+bool BroadcastDispatcher::Enqueue(const BroadcastCommand& command)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (stopping_) {
+    return false;
+  }
+
+  // The latest command takes the place of a queued one it replaces at the
+  // tail, so it still follows every command queued before it.
+  int key = options_.coalesce ? CoalesceKey(command) : -1;
+  if (key >= 0) {
+    for (auto it = queue_.begin(); it != queue_.end(); ++it) {
+      if (CoalesceKey(*it) == key) {
+        queue_.erase(it);
+        queue_.push_back(command);
+        coalesced_ += 1;
+        return true;
+      }
+    }
+  }
+
+  if (queue_.size() >= options_.max_queue) {
+    dropped_ += 1;
+    return false;
+  }
+  queue_.push_back(command);
+  wake_.notify_one();
+  return true;
+}
+
+void BroadcastDispatcher::Clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  queue_.clear();
+}
+
+void BroadcastDispatcher::Stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    queue_.clear();
+  }
+  wake_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+DispatcherStats BroadcastDispatcher::Stats() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return DispatcherStats{queue_.size(), sent_, coalesced_, dropped_};
+}
+
+void BroadcastDispatcher::Refill(Clock::time_point now)
+{
+  double elapsed = std::chrono::duration<double>(now - refilled_).count();
+  refilled_ = now;
+  tokens_ = std::min(static_cast<double>(options_.burst), tokens_ + elapsed * options_.rate_per_second);
+}
+
+void BroadcastDispatcher::Run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wake_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+    if (stopping_) {
+      break;
+    }
+
+    if (options_.rate_per_second > 0.0) {
+      Refill(Clock::now());
+      if (tokens_ < 1.0) {
+        // Sleep until the next token; new commands may coalesce meanwhile.
+        auto wait = std::chrono::duration<double>((1.0 - tokens_) / options_.rate_per_second);
+        wake_.wait_for(lock, std::chrono::duration_cast<Clock::duration>(wait), [this]() { return stopping_; });
+        continue;
+      }
+      tokens_ -= 1.0;
+    }
+
+    BroadcastCommand command = queue_.front();
+    queue_.pop_front();
+    lock.unlock();
+    sink_->Send(command);
+    lock.lock();
+    sent_ += 1;
+  }
+}
+
+bool ParseBroadcastCommand(napi_env env, size_t argc, napi_value* args, BroadcastCommand* out)
+{
+  if (argc < 3) {
+    napi_throw_type_error(env, nullptr, "broadcastMsg expects (msg, var1, var2[, var3])");
+    return false;
+  }
+
+  BroadcastCommand command;
+  if (!CheckNapi(env, napi_get_value_int32(env, args[0], &command.msg))) {
+    return false;
+  }
+  if (command.msg == irsdk_BroadcastCamSwitchNum) {
+    if (!ParseCarNumber(env, args[1], &command.var1, &command.car_num_zeros)) {
+      return false;
+    }
+  } else if (!CheckNapi(env, napi_get_value_int32(env, args[1], &command.var1))) {
+    return false;
+  }
+
+  if (command.msg == irsdk_BroadcastFFBCommand) {
+    double value = 0.0;
+    if (!CheckNapi(env, napi_get_value_double(env, args[2], &value))) {
+      return false;
+    }
+    command.is_float = true;
+    command.value = static_cast<float>(value);
+  } else {
+    if (!CheckNapi(env, napi_get_value_int32(env, args[2], &command.var2))) {
+      return false;
+    }
+    if (argc >= 4 && !IsNullish(env, args[3])) {
+      if (!CheckNapi(env, napi_get_value_int32(env, args[3], &command.var3))) {
+        return false;
+      }
+      command.has_var3 = true;
+    }
+  }
+  *out = command;
+  return true;
+}
+
+bool ParseBroadcastSink(napi_env env, napi_value options, std::unique_ptr<MockBroadcastSink>* mock,
+                        BroadcastSink** out)
+{
+  std::string sink = "sim";
+  if (!GetOptionalString(env, options, "sink", &sink)) {
+    return false;
+  }
+  if (sink == "mock") {
+    mock->reset(new MockBroadcastSink());
+    *out = mock->get();
+  } else if (sink == "sim") {
+    *out = SimBroadcastSink();
+    if (!*out) {
+      napi_throw_error(env, nullptr, "iRacing SDK native bindings are supported on Windows only");
+      return false;
+    }
+  } else {
+    napi_throw_type_error(env, nullptr, "sink must be 'sim' or 'mock'");
+    return false;
+  }
+  return true;
+}
+
+napi_value MakeSentLog(napi_env env, const MockBroadcastSink& sink)
+{
+  std::vector<MockBroadcastSink::Entry> entries = sink.Entries();
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_array_with_length(env, entries.size(), &result));
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const BroadcastCommand& command = entries[i].command;
+    napi_value entry = nullptr;
+    NAPI_CALL(env, napi_create_object(env, &entry));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "msg", MakeInt(env, command.msg)));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "var1", MakeInt(env, command.var1)));
+    if (command.is_float) {
+      NAPI_CALL(env, napi_set_named_property(env, entry, "value", MakeDouble(env, command.value)));
+    } else {
+      NAPI_CALL(env, napi_set_named_property(env, entry, "var2", MakeInt(env, command.var2)));
+    }
+    if (command.has_var3) {
+      NAPI_CALL(env, napi_set_named_property(env, entry, "var3", MakeInt(env, command.var3)));
+    }
+    NAPI_CALL(env, napi_set_named_property(env, entry, "timeMs", MakeDouble(env, entries[i].monotonic_ms)));
+    NAPI_CALL(env, napi_set_element(env, result, static_cast<uint32_t>(i), entry));
+  }
+  return result;
+}
+
+namespace {
+
+struct DispatcherHandle {
+  std::unique_ptr<MockBroadcastSink> mock;
+  std::unique_ptr<BroadcastDispatcher> dispatcher;
+};
+
+void FinalizeDispatcher(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  delete static_cast<DispatcherHandle*>(data);
+}
+
+napi_value DispatcherConstructor(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value self = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+  napi_value options_value = argc >= 1 ? args[0] : nullptr;
+  DispatcherOptions options;
+  int max_queue = static_cast<int>(options.max_queue);
+  if (!GetOptionalDouble(env, options_value, "ratePerSecond", &options.rate_per_second) ||
+      !GetOptionalInt(env, options_value, "burst", &options.burst) ||
+      !GetOptionalInt(env, options_value, "maxQueue", &max_queue) ||
+      !GetOptionalBool(env, options_value, "coalesce", &options.coalesce)) {
+    return nullptr;
+  }
+  options.max_queue = static_cast<size_t>(std::max(1, max_queue));
+
+  std::unique_ptr<DispatcherHandle> handle(new DispatcherHandle());
+  BroadcastSink* target = nullptr;
+  if (!ParseBroadcastSink(env, options_value, &handle->mock, &target)) {
+    return nullptr;
+  }
+
+  handle->dispatcher.reset(new BroadcastDispatcher(target, options));
+  NAPI_CALL(env, napi_wrap(env, self, handle.get(), FinalizeDispatcher, nullptr, nullptr));
+  handle.release();
+  return self;
+}
+
+napi_value DispatcherSend(napi_env env, napi_callback_info info)
+{
+  size_t argc = 4;
+  napi_value args[4];
+  DispatcherHandle* handle = UnwrapThis<DispatcherHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  BroadcastCommand command;
+  if (!ParseBroadcastCommand(env, argc, args, &command)) {
+    return nullptr;
+  }
+  return MakeBool(env, handle->dispatcher->Enqueue(command));
+}
+
+napi_value DispatcherGetStats(napi_env env, napi_callback_info info)
+{
+  DispatcherHandle* handle = UnwrapThis<DispatcherHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  DispatcherStats stats = handle->dispatcher->Stats();
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_set_named_property(env, result, "queued", MakeDouble(env, static_cast<double>(stats.queued))));
+  NAPI_CALL(env, napi_set_named_property(env, result, "sent", MakeDouble(env, static_cast<double>(stats.sent))));
+  NAPI_CALL(env, napi_set_named_property(env, result, "coalesced",
+                                         MakeDouble(env, static_cast<double>(stats.coalesced))));
+  NAPI_CALL(env, napi_set_named_property(env, result, "dropped", MakeDouble(env, static_cast<double>(stats.dropped))));
+  return result;
+}
+
+// Commands delivered to the mock sink, or null for the sim sink.
+napi_value DispatcherGetSentLog(napi_env env, napi_callback_info info)
+{
+  DispatcherHandle* handle = UnwrapThis<DispatcherHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  if (!handle->mock) {
+    return GetNull(env);
+  }
+  return MakeSentLog(env, *handle->mock);
+}
+
+napi_value DispatcherClear(napi_env env, napi_callback_info info)
+{
+  DispatcherHandle* handle = UnwrapThis<DispatcherHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  handle->dispatcher->Clear();
+  return GetUndefined(env);
+}
+
+napi_value DispatcherClose(napi_env env, napi_callback_info info)
+{
+  DispatcherHandle* handle = UnwrapThis<DispatcherHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  handle->dispatcher->Stop();
+  return GetUndefined(env);
+}
+
+}  // namespace
+
+napi_value RegisterBroadcastDispatcher(napi_env env, napi_value exports)
+{
+  napi_property_descriptor methods[] = {
+    {"send", nullptr, DispatcherSend, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getStats", nullptr, DispatcherGetStats, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getSentLog", nullptr, DispatcherGetSentLog, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"clear", nullptr, DispatcherClear, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"close", nullptr, DispatcherClose, nullptr, nullptr, nullptr, napi_default, nullptr}
+  };
+
+  napi_value constructor = nullptr;
+  NAPI_CALL(env, napi_define_class(env, "BroadcastDispatcher", NAPI_AUTO_LENGTH, DispatcherConstructor, nullptr,
+                                   sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "BroadcastDispatcher", constructor));
+  return exports;
+}
+
+}  // namespace irsdk_node
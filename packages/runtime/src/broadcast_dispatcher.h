@@ -0,0 +1,132 @@
+// Queued, rate-limited delivery of broadcast messages to the sim.
+// The sink that talks to the sim is provided by addon.cpp; tests and other
+// platforms can dispatch to a recording mock sink instead.
+
+#ifndef IRSDK_NODE_BROADCAST_DISPATCHER_H_
+#define IRSDK_NODE_BROADCAST_DISPATCHER_H_
+
+#include <node_api.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace irsdk_node {
+
+struct BroadcastCommand {
+  int msg = 0;
+  int var1 = 0;
+  int var2 = 0;
+  int var3 = 0;
+  bool has_var3 = false;
+  // FFBCommand carries a float value in place of var2.
+  bool is_float = false;
+  float value = 0.0f;
+  // Leading zeros of a CamSwitchNum car number ("007"); padded when sent.
+  int car_num_zeros = 0;
+};
+
+class BroadcastSink {
+ public:
+  virtual ~BroadcastSink() = default;
+
+  // Called from the dispatcher thread.
+  virtual void Send(const BroadcastCommand& command) = 0;
+};
+
+// Sink that sends to the sim, or nullptr where the SDK is unavailable.
+// Defined by addon.cpp and addon_stub.cpp.
+BroadcastSink* SimBroadcastSink();
+
+// Records every command with its send time on the monotonic tick clock.
+class MockBroadcastSink : public BroadcastSink {
+ public:
+  struct Entry {
+    BroadcastCommand command;
+    double monotonic_ms;
+  };
+
+  void Send(const BroadcastCommand& command) override;
+  std::vector<Entry> Entries() const;
+
+ private:
+  mutable std::mutex mutex_;
+  std::vector<Entry> entries_;
+};
+
+struct DispatcherOptions {
+  double rate_per_second = 20.0;  // <= 0 disables the limit.
+  int burst = 1;
+  size_t max_queue = 64;
+  bool coalesce = true;
+};
+
+struct DispatcherStats {
+  size_t queued;
+  size_t sent;
+  size_t coalesced;
+  size_t dropped;
+};
+
+class BroadcastDispatcher {
+ public:
+  BroadcastDispatcher(BroadcastSink* sink, const DispatcherOptions& options);
+  ~BroadcastDispatcher();
+  BroadcastDispatcher(const BroadcastDispatcher&) = delete;
+  BroadcastDispatcher& operator=(const BroadcastDispatcher&) = delete;
+
+  // Queue a command. A queued command of the same kind (camera target,
+  // camera state, replay speed, replay position, FFB setting) is replaced
+  // in place so the latest wins. Returns false when the queue is full.
+  bool Enqueue(const BroadcastCommand& command);
+
+  // Drop everything not yet sent.
+  void Clear();
+
+  // Stop the worker; queued commands are discarded.
+  void Stop();
+
+  DispatcherStats Stats() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  void Run();
+  void Refill(Clock::time_point now);
+
+  BroadcastSink* sink_;
+  DispatcherOptions options_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<BroadcastCommand> queue_;
+  bool stopping_ = false;
+  double tokens_;
+  Clock::time_point refilled_;
+  size_t sent_ = 0;
+  size_t coalesced_ = 0;
+  size_t dropped_ = 0;
+  std::thread worker_;
+};
+
+// Parse broadcastMsg-style arguments (msg, var1, var2[, var3]). var1 may be a
+// car number string for CamSwitchNum; FFBCommand takes a float var2.
+bool ParseBroadcastCommand(napi_env env, size_t argc, napi_value* args, BroadcastCommand* out);
+
+// Pick the sink named by the `sink` option ('sim' or 'mock'). A mock sink is
+// created in *mock, which must outlive any user of *out.
+bool ParseBroadcastSink(napi_env env, napi_value options, std::unique_ptr<MockBroadcastSink>* mock,
+                        BroadcastSink** out);
+
+// Array of { msg, var1, var2 | value, var3?, timeMs } for the commands a mock
+// sink recorded.
+napi_value MakeSentLog(napi_env env, const MockBroadcastSink& sink);
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_BROADCAST_DISPATCHER_H_
@@ -0,0 +1,404 @@
+// Camera/replay scripts executed on a native thread at telemetry positions.
+
+#include "broadcast_timeline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include "bindings.h"
+#include "napi_util.h"
+#include "tick_clock.h"
+
+namespace irsdk_node {
+
+namespace {
+
+// Waits can wake a scheduler quantum late; the last stretch before a cue is
+// spent yielding instead.
+constexpr double kSpinMs = 4.0;
+// Fastest replay speed, used to tell playback from seeks.
+constexpr double kMaxSpeed = 16.0;
+constexpr double kRateAlpha = 0.2;
+
+const char* BaseVarName(TimelineBase base)
+{
+  switch (base) {
+    case TimelineBase::kReplaySessionTime:
+      return "ReplaySessionTime";
+    case TimelineBase::kReplayFrame:
+      return "ReplayFrameNum";
+    case TimelineBase::kSessionTime:
+      break;
+  }
+  return "SessionTime";
+}
+
+// Base units per millisecond at normal speed.
+double NominalRate(TimelineBase base)
+{
+  return base == TimelineBase::kReplayFrame ? 0.06 : 0.001;
+}
+
+}  // namespace
+
+BroadcastTimeline::BroadcastTimeline(BroadcastSink* sink, std::vector<TimelineCue> cues,
+                                     const TimelineOptions& options)
+    : sink_(sink),
+      cues_(std::move(cues)),
+      options_(options),
+      position_var_(BaseVarName(options.base))
+{
+  if (options_.max_late < 0.0) {
+    options_.max_late = options_.base == TimelineBase::kReplayFrame ? 30.0 : 0.5;
+  }
+  std::stable_sort(cues_.begin(), cues_.end(),
+                   [](const TimelineCue& a, const TimelineCue& b) { return a.at < b.at; });
+  reports_.resize(cues_.size());
+  for (size_t i = 0; i < cues_.size(); ++i) {
+    reports_[i] = CueReport{cues_[i].at, CueState::kPending, 0.0, 0.0, std::numeric_limits<double>::quiet_NaN()};
+  }
+  worker_ = std::thread([this]() { Run(); });
+}
+
+BroadcastTimeline::~BroadcastTimeline()
+{
+  Stop();
+}
+
+void BroadcastTimeline::Stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+void BroadcastTimeline::OnTick(const TelemetrySource& source, const TickStamp& stamp)
+{
+  if (!position_var_.Resolve(source)) {
+    return;
+  }
+  Anchor current;
+  current.valid = true;
+  current.monotonic_ms = stamp.monotonic_ms;
+  current.position = position_var_.Get(source);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  Anchor previous = anchor_;
+  if (previous.valid && current.monotonic_ms > previous.monotonic_ms) {
+    double rate = (current.position - previous.position) / (current.monotonic_ms - previous.monotonic_ms);
+    if (rate < 0.0 || rate > kMaxSpeed * NominalRate(options_.base)) {
+      // A seek or new session: keep the playback rate, move the anchor.
+      current.rate = previous.rate;
+      previous.valid = false;
+    } else if (rate == 0.0 || previous.rate == 0.0) {
+      current.rate = rate;
+    } else {
+      current.rate = previous.rate + kRateAlpha * (rate - previous.rate);
+    }
+  } else {
+    current.rate = previous.valid ? previous.rate : 0.0;
+  }
+  MeasureDeviations(previous, current);
+  anchor_ = current;
+  wake_.notify_all();
+}
+
+void BroadcastTimeline::MeasureDeviations(const Anchor& previous, const Anchor& current)
+{
+  for (CueReport& report : reports_) {
+    if (report.state != CueState::kSent || !std::isnan(report.deviation) ||
+        report.sent_ms > current.monotonic_ms) {
+      continue;
+    }
+    if (previous.valid && report.sent_ms >= previous.monotonic_ms) {
+      double span = current.monotonic_ms - previous.monotonic_ms;
+      double u = span > 0.0 ? (report.sent_ms - previous.monotonic_ms) / span : 1.0;
+      report.deviation = previous.position + u * (current.position - previous.position) - report.at;
+    } else {
+      // Sent before a seek or the first tick; there is nothing to compare with.
+      report.deviation = std::numeric_limits<double>::infinity();
+    }
+  }
+}
+
+void BroadcastTimeline::Run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_ && next_ < cues_.size()) {
+    if (!anchor_.valid || anchor_.rate <= 0.0) {
+      wake_.wait(lock);
+      continue;
+    }
+
+    const TimelineCue& cue = cues_[next_];
+    double now = TickClock::NowMonotonicMs();
+    double position = anchor_.position + (now - anchor_.monotonic_ms) * anchor_.rate;
+    if (position - cue.at > options_.max_late) {
+      reports_[next_].state = CueState::kSkipped;
+      next_ += 1;
+      continue;
+    }
+
+    double due = anchor_.monotonic_ms + (cue.at - anchor_.position) / anchor_.rate;
+    double wait = due - options_.lead_ms - now;
+    if (wait > kSpinMs) {
+      // Every tick wakes the worker to re-plan with the fresh anchor.
+      wake_.wait_for(lock, std::chrono::duration<double, std::milli>(wait - kSpinMs));
+      continue;
+    }
+    if (wait > 0.0) {
+      lock.unlock();
+      std::this_thread::yield();
+      lock.lock();
+      continue;
+    }
+
+    CueReport& report = reports_[next_];
+    report.state = CueState::kSent;
+    report.due_ms = due;
+    report.sent_ms = now;
+    BroadcastCommand command = cue.command;
+    next_ += 1;
+    lock.unlock();
+    sink_->Send(command);
+    lock.lock();
+  }
+}
+
+std::vector<CueReport> BroadcastTimeline::Report() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return reports_;
+}
+
+bool BroadcastTimeline::Done() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return next_ >= cues_.size();
+}
+
+namespace {
+
+// JS wrapper that keeps the timeline attached to the live tick stream until
+// close() or garbage collection.
+struct TimelineHandle {
+  std::unique_ptr<MockBroadcastSink> mock;
+  std::unique_ptr<BroadcastTimeline> timeline;
+  bool attached = false;
+
+  void Detach()
+  {
+    if (attached) {
+      TickHub::Instance().Remove(timeline.get());
+      attached = false;
+    }
+    timeline->Stop();
+  }
+};
+
+void FinalizeTimeline(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  TimelineHandle* handle = static_cast<TimelineHandle*>(data);
+  handle->Detach();
+  delete handle;
+}
+
+// Read { at, msg, var1, var2, var3? } cues.
+bool ParseCues(napi_env env, napi_value value, std::vector<TimelineCue>* out)
+{
+  bool is_array = false;
+  if (!CheckNapi(env, napi_is_array(env, value, &is_array))) {
+    return false;
+  }
+  if (!is_array) {
+    napi_throw_type_error(env, nullptr, "cues must be an array");
+    return false;
+  }
+  uint32_t length = 0;
+  if (!CheckNapi(env, napi_get_array_length(env, value, &length))) {
+    return false;
+  }
+
+  static const char* kFields[] = {"msg", "var1", "var2", "var3"};
+  out->clear();
+  for (uint32_t i = 0; i < length; ++i) {
+    napi_value element = nullptr;
+    if (!CheckNapi(env, napi_get_element(env, value, i, &element))) {
+      return false;
+    }
+    TimelineCue cue;
+    napi_value at = nullptr;
+    if (!GetOptionalProperty(env, element, "at", &at) || napi_get_value_double(env, at, &cue.at) != napi_ok) {
+      napi_throw_type_error(env, nullptr, "each cue expects { at, msg, var1, var2, var3? }");
+      return false;
+    }
+    napi_value args[4];
+    size_t argc = 0;
+    while (argc < 4 && GetOptionalProperty(env, element, kFields[argc], &args[argc])) {
+      argc += 1;
+    }
+    if (!ParseBroadcastCommand(env, argc, args, &cue.command)) {
+      return false;
+    }
+    out->push_back(cue);
+  }
+  return true;
+}
+
+napi_value TimelineConstructor(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value self = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+  napi_value options_value = argc >= 1 ? args[0] : nullptr;
+  napi_value cues_value = nullptr;
+  if (!GetOptionalProperty(env, options_value, "cues", &cues_value)) {
+    napi_throw_type_error(env, nullptr, "BroadcastTimeline expects ({ cues, timeBase?, leadMs?, maxLate?, sink? })");
+    return nullptr;
+  }
+  std::vector<TimelineCue> cues;
+  if (!ParseCues(env, cues_value, &cues)) {
+    return nullptr;
+  }
+
+  TimelineOptions options;
+  std::string time_base = "sessionTime";
+  if (!GetOptionalString(env, options_value, "timeBase", &time_base) ||
+      !GetOptionalDouble(env, options_value, "leadMs", &options.lead_ms) ||
+      !GetOptionalDouble(env, options_value, "maxLate", &options.max_late)) {
+    return nullptr;
+  }
+  if (time_base == "sessionTime") {
+    options.base = TimelineBase::kSessionTime;
+  } else if (time_base == "replaySessionTime") {
+    options.base = TimelineBase::kReplaySessionTime;
+  } else if (time_base == "replayFrame") {
+    options.base = TimelineBase::kReplayFrame;
+  } else {
+    napi_throw_type_error(env, nullptr, "timeBase must be 'sessionTime', 'replaySessionTime' or 'replayFrame'");
+    return nullptr;
+  }
+
+  std::unique_ptr<TimelineHandle> handle(new TimelineHandle());
+  BroadcastSink* sink = nullptr;
+  if (!ParseBroadcastSink(env, options_value, &handle->mock, &sink)) {
+    return nullptr;
+  }
+  handle->timeline.reset(new BroadcastTimeline(sink, std::move(cues), options));
+  napi_status status = napi_wrap(env, self, handle.get(), FinalizeTimeline, nullptr, nullptr);
+  if (status != napi_ok) {
+    handle->timeline->Stop();
+    CheckNapi(env, status);
+    return nullptr;
+  }
+
+  TickHub::Instance().Add(handle->timeline.get());
+  handle->attached = true;
+  handle.release();
+  return self;
+}
+
+const char* CueStateName(CueState state)
+{
+  switch (state) {
+    case CueState::kSent:
+      return "sent";
+    case CueState::kSkipped:
+      return "skipped";
+    case CueState::kPending:
+      break;
+  }
+  return "pending";
+}
+
+napi_value TimelineGetReport(napi_env env, napi_callback_info info)
+{
+  TimelineHandle* handle = UnwrapThis<TimelineHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+
+  std::vector<CueReport> reports = handle->timeline->Report();
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_array_with_length(env, reports.size(), &result));
+  for (size_t i = 0; i < reports.size(); ++i) {
+    const CueReport& report = reports[i];
+    bool sent = report.state == CueState::kSent;
+    bool measured = sent && std::isfinite(report.deviation);
+    napi_value entry = nullptr;
+    NAPI_CALL(env, napi_create_object(env, &entry));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "at", MakeDouble(env, report.at)));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "state", MakeString(env, CueStateName(report.state))));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "dueMs", sent ? MakeDouble(env, report.due_ms) : GetNull(env)));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "sentMs", sent ? MakeDouble(env, report.sent_ms) : GetNull(env)));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "deviation",
+                                           measured ? MakeDouble(env, report.deviation) : GetNull(env)));
+    NAPI_CALL(env, napi_set_element(env, result, static_cast<uint32_t>(i), entry));
+  }
+  return result;
+}
+
+napi_value TimelineIsDone(napi_env env, napi_callback_info info)
+{
+  TimelineHandle* handle = UnwrapThis<TimelineHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  return MakeBool(env, handle->timeline->Done());
+}
+
+// Commands delivered to the mock sink, or null for the sim sink.
+napi_value TimelineGetSentLog(napi_env env, napi_callback_info info)
+{
+  TimelineHandle* handle = UnwrapThis<TimelineHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  if (!handle->mock) {
+    return GetNull(env);
+  }
+  return MakeSentLog(env, *handle->mock);
+}
+
+napi_value TimelineClose(napi_env env, napi_callback_info info)
+{
+  TimelineHandle* handle = UnwrapThis<TimelineHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  handle->Detach();
+  return GetUndefined(env);
+}
+
+}  // namespace
+
+napi_value RegisterBroadcastTimeline(napi_env env, napi_value exports)
+{
+  napi_property_descriptor methods[] = {
+    {"getReport", nullptr, TimelineGetReport, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"isDone", nullptr, TimelineIsDone, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getSentLog", nullptr, TimelineGetSentLog, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"close", nullptr, TimelineClose, nullptr, nullptr, nullptr, napi_default, nullptr}
+  };
+
+  napi_value constructor = nullptr;
+  NAPI_CALL(env, napi_define_class(env, "BroadcastTimeline", NAPI_AUTO_LENGTH, TimelineConstructor, nullptr,
+                                   sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "BroadcastTimeline", constructor));
+  return exports;
+}
+
+}  // namespace irsdk_node
@@ -0,0 +1,92 @@
+// Camera/replay scripts executed on a native thread at telemetry positions.
+// Ticks anchor the script clock; a worker thread predicts when each cue's
+// position is reached and sends it without waiting for the JS event loop.
+
+#ifndef IRSDK_NODE_BROADCAST_TIMELINE_H_
+#define IRSDK_NODE_BROADCAST_TIMELINE_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "broadcast_dispatcher.h"
+#include "telemetry_source.h"
+#include "tick_hub.h"
+
+namespace irsdk_node {
+
+enum class TimelineBase { kSessionTime, kReplaySessionTime, kReplayFrame };
+
+struct TimelineCue {
+  double at = 0.0;  // Position in units of the timeline base.
+  BroadcastCommand command;
+};
+
+struct TimelineOptions {
+  TimelineBase base = TimelineBase::kSessionTime;
+  // Send this long before the predicted time, to cover the sim's latency.
+  double lead_ms = 0.0;
+  // Cues overtaken by more than this (base units) are skipped; < 0 selects
+  // half a second, or 30 frames.
+  double max_late = -1.0;
+};
+
+enum class CueState { kPending, kSent, kSkipped };
+
+struct CueReport {
+  double at;
+  CueState state;
+  double due_ms;     // Predicted monotonic time of `at` when the cue was sent.
+  double sent_ms;
+  // Position (base units) at the send time minus `at`. NaN until the next
+  // tick, infinite when a seek made it unmeasurable.
+  double deviation;
+};
+
+class BroadcastTimeline : public TickListener {
+ public:
+  BroadcastTimeline(BroadcastSink* sink, std::vector<TimelineCue> cues, const TimelineOptions& options);
+  ~BroadcastTimeline() override;
+  BroadcastTimeline(const BroadcastTimeline&) = delete;
+  BroadcastTimeline& operator=(const BroadcastTimeline&) = delete;
+
+  void OnTick(const TelemetrySource& source, const TickStamp& stamp) override;
+
+  // Stop the worker; cues not yet sent stay pending.
+  void Stop();
+
+  std::vector<CueReport> Report() const;
+  bool Done() const;
+
+ private:
+  // Latest tick position and the rate it advances at.
+  struct Anchor {
+    bool valid = false;
+    double monotonic_ms = 0.0;
+    double position = 0.0;
+    double rate = 0.0;  // Base units per millisecond; 0 while paused.
+  };
+
+  void Run();
+  void MeasureDeviations(const Anchor& previous, const Anchor& current);
+
+  BroadcastSink* sink_;
+  std::vector<TimelineCue> cues_;
+  TimelineOptions options_;
+  VarHandle position_var_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+  Anchor anchor_;
+  size_t next_ = 0;
+  std::vector<CueReport> reports_;
+  std::thread worker_;
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_BROADCAST_TIMELINE_H_
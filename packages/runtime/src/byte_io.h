@@ -0,0 +1,118 @@
+// Little-endian encoding for the package's own binary files, matching the
+// byte order of .ibt files.
+
+#ifndef IRSDK_NODE_BYTE_IO_H_
+#define IRSDK_NODE_BYTE_IO_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace irsdk_node {
+
+template <typename T>
+void Put(std::string* out, T value)
+{
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  out->append(bytes, sizeof(T));
+}
+
+template <typename T>
+void PutAt(char* out, T value)
+{
+  std::memcpy(out, &value, sizeof(T));
+}
+
+// Unaligned read of a value the caller has bounds-checked.
+template <typename T>
+T GetAt(const char* data)
+{
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+// A uint32 length, then the bytes.
+inline void PutString(std::string* out, const std::string& text)
+{
+  Put<uint32_t>(out, static_cast<uint32_t>(text.size()));
+  out->append(text);
+}
+
+// LEB128: seven bits per byte, low bits first.
+inline void PutVarint(std::string* out, uint64_t value)
+{
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+// Bounds-checked reader over an encoded buffer.
+class Cursor {
+ public:
+  Cursor(const char* data, size_t size) : data_(data), size_(size) {}
+
+  template <typename T>
+  bool Get(T* value)
+  {
+    if (size_ - pos_ < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(value, data_ + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return true;
+  }
+
+  bool GetString(std::string* text)
+  {
+    uint32_t len = 0;
+    if (!Get(&len) || size_ - pos_ < len) {
+      return false;
+    }
+    text->assign(data_ + pos_, len);
+    pos_ += len;
+    return true;
+  }
+
+  bool GetVarint(uint64_t* value)
+  {
+    *value = 0;
+    for (int shift = 0; shift < 64 && pos_ < size_; shift += 7) {
+      uint8_t byte = static_cast<uint8_t>(data_[pos_++]);
+      *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool GetView(uint64_t length, std::string_view* view)
+  {
+    if (size_ - pos_ < length) {
+      return false;
+    }
+    *view = std::string_view(data_ + pos_, static_cast<size_t>(length));
+    pos_ += static_cast<size_t>(length);
+    return true;
+  }
+
+  // Reject counts that could not fit in what is left, before allocating.
+  bool Fits(uint32_t count, size_t min_size) const { return count <= (size_ - pos_) / min_size; }
+  size_t left() const { return size_ - pos_; }
+  bool done() const { return pos_ == size_; }
+
+ private:
+  const char* data_;
+  size_t size_;
+  size_t pos_ = 0;
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_BYTE_IO_H_
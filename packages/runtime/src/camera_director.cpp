@@ -0,0 +1,342 @@
+// Automatic camera direction from battles and incidents.
+
+#include "camera_director.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "bindings.h"
+#include "irsdk_defines.h"
+#include "napi_util.h"
+
+namespace irsdk_node {
+
+CameraDirector::CameraDirector(BroadcastSink* sink, const DirectorOptions& options) : sink_(sink), options_(options) {}
+
+bool CameraDirector::ReadCars(const TelemetrySource& source, double dt_s)
+{
+  if (!positions_.Update(source, dt_s)) {
+    return false;
+  }
+  size_t n = static_cast<size_t>(positions_.count());
+  class_position_.assign(n, 0);
+  class_.assign(n, 0);
+  pit_.assign(n, false);
+
+  bool has_class_position = class_position_var_.Resolve(source);
+  bool has_class = class_var_.Resolve(source);
+  bool has_pit = pit_var_.Resolve(source);
+  for (size_t car = 0; car < n; ++car) {
+    int i = static_cast<int>(car);
+    class_position_[car] = has_class_position ? static_cast<int>(class_position_var_.Get(source, i)) : 0;
+    class_[car] = has_class ? static_cast<int>(class_var_.Get(source, i)) : 0;
+    pit_[car] = has_pit && pit_var_.Get(source, i) != 0.0;
+  }
+  return true;
+}
+
+void CameraDirector::Score()
+{
+  candidates_.clear();
+  const std::vector<int>& order = positions_.order().order();
+  size_t n = order.size();
+
+  // Pair i is order[i] chasing the car ahead of it, wrapping at the line.
+  if (n >= 2) {
+    std::vector<double> gaps(n, 0.0);
+    std::vector<double> scores(n, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+      int behind = order[i];
+      int ahead = order[(i + 1) % n];
+      double gap_pct = positions_.ForwardGap(behind, ahead);
+      double rate = positions_.rate(behind) > 0.0 ? positions_.rate(behind) : positions_.rate(ahead);
+      // Same lap and class only: lapped traffic is not a battle.
+      bool same_lap = std::fabs(positions_.distance(ahead) - positions_.distance(behind) - gap_pct) < 0.5;
+      if (pit_[behind] || pit_[ahead] || class_[behind] != class_[ahead] || !same_lap || rate <= 0.0) {
+        continue;
+      }
+      double gap_s = gap_pct / rate;
+      if (gap_s >= options_.battle_gap_s) {
+        continue;
+      }
+      // Battles for the lead of a class count most.
+      double weight = 1.0 / std::sqrt(static_cast<double>(std::max(1, class_position_[ahead])));
+      gaps[i] = gap_s;
+      scores[i] = (1.0 - gap_s / options_.battle_gap_s) * weight;
+    }
+
+    // Join neighbouring battling pairs into trains, starting after a gap so
+    // a train across the line is not split.
+    size_t start = 0;
+    while (start < n && scores[start] > 0.0) {
+      ++start;
+    }
+    start = start == n ? 0 : start;
+    bool open = false;
+    DirectorCandidate train{};
+    for (size_t k = 1; k <= n; ++k) {
+      size_t i = (start + k) % n;
+      if (scores[i] > 0.0) {
+        if (!open) {
+          train = DirectorCandidate{CandidateKind::kBattle, order[i], order[(i + 1) % n], 1, gaps[i], 0.0};
+          open = true;
+        } else if (gaps[i] < train.gap_s) {
+          train.car_idx = order[i];
+          train.gap_s = gaps[i];
+        }
+        train.first_car_idx = order[(i + 1) % n];
+        train.cars += 1;
+        train.score += scores[i];
+      } else if (open) {
+        candidates_.push_back(train);
+        open = false;
+      }
+    }
+    if (open) {
+      candidates_.push_back(train);
+    }
+  }
+
+  for (int car : order) {
+    size_t c = static_cast<size_t>(car);
+    if (positions_.surface(car) == irsdk_OffTrack && !pit_[c]) {
+      candidates_.push_back(DirectorCandidate{CandidateKind::kIncident, car, car, 1, 0.0, options_.incident_weight});
+    }
+  }
+  std::stable_sort(candidates_.begin(), candidates_.end(),
+                   [](const DirectorCandidate& a, const DirectorCandidate& b) { return a.score > b.score; });
+}
+
+void CameraDirector::Decide(const TelemetrySource& source, double now_ms)
+{
+  target_score_ = 0.0;
+  for (const DirectorCandidate& candidate : candidates_) {
+    if (candidate.car_idx == target_ || candidate.first_car_idx == target_) {
+      target_score_ = std::max(target_score_, candidate.score);
+    }
+  }
+  if (candidates_.empty() || (target_ >= 0 && now_ms - since_ms_ < options_.min_dwell_s * 1000.0)) {
+    return;
+  }
+
+  const DirectorCandidate& best = candidates_.front();
+  if (best.car_idx == target_ || best.first_car_idx == target_ ||
+      (target_score_ > 0.0 && best.score < target_score_ * options_.switch_factor)) {
+    return;
+  }
+  int position = position_var_.Resolve(source) ? static_cast<int>(position_var_.Get(source, best.car_idx)) : 0;
+  if (position <= 0) {
+    return;
+  }
+
+  target_ = best.car_idx;
+  target_score_ = best.score;
+  since_ms_ = now_ms;
+  switches_ += 1;
+  if (!options_.enabled) {
+    return;
+  }
+  BroadcastCommand command;
+  command.msg = irsdk_BroadcastCamSwitchPos;
+  command.var1 = position;
+  command.var2 = options_.group;
+  if (command.var2 <= 0 && group_var_.Resolve(source)) {
+    command.var2 = static_cast<int>(group_var_.Get(source));
+  }
+  command.var3 = options_.camera;
+  command.has_var3 = true;
+  sink_->Send(command);
+}
+
+void CameraDirector::OnTick(const TelemetrySource& source, const TickStamp& stamp)
+{
+  double dt = has_prev_ ? stamp.session_time - prev_time_ : 0.0;
+  if (dt < 0.0) {
+    // New session: start over.
+    has_prev_ = false;
+    dt = 0.0;
+    positions_.Reset();
+    target_ = -1;
+  }
+  if (has_prev_ && dt == 0.0) {
+    return;
+  }
+  if (!ReadCars(source, dt)) {
+    return;
+  }
+  has_prev_ = true;
+  prev_time_ = stamp.session_time;
+  Score();
+  Decide(source, stamp.monotonic_ms);
+}
+
+namespace {
+
+// JS wrapper that keeps the director attached to the live tick stream until
+// close() or garbage collection.
+struct DirectorHandle {
+  std::unique_ptr<MockBroadcastSink> mock;
+  std::unique_ptr<CameraDirector> director;
+  bool attached = false;
+
+  void Detach()
+  {
+    if (attached) {
+      TickHub::Instance().Remove(director.get());
+      attached = false;
+    }
+  }
+};
+
+void FinalizeDirector(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  DirectorHandle* handle = static_cast<DirectorHandle*>(data);
+  handle->Detach();
+  delete handle;
+}
+
+napi_value DirectorConstructor(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value self = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+  napi_value options_value = argc >= 1 ? args[0] : nullptr;
+  DirectorOptions options;
+  if (!GetOptionalDouble(env, options_value, "battleGapS", &options.battle_gap_s) ||
+      !GetOptionalDouble(env, options_value, "incidentWeight", &options.incident_weight) ||
+      !GetOptionalDouble(env, options_value, "minDwellS", &options.min_dwell_s) ||
+      !GetOptionalDouble(env, options_value, "switchFactor", &options.switch_factor) ||
+      !GetOptionalInt(env, options_value, "group", &options.group) ||
+      !GetOptionalInt(env, options_value, "camera", &options.camera) ||
+      !GetOptionalBool(env, options_value, "enabled", &options.enabled)) {
+    return nullptr;
+  }
+  if (!(options.battle_gap_s > 0.0)) {
+    napi_throw_range_error(env, nullptr, "battleGapS must be positive");
+    return nullptr;
+  }
+
+  std::unique_ptr<DirectorHandle> handle(new DirectorHandle());
+  BroadcastSink* sink = nullptr;
+  if (!ParseBroadcastSink(env, options_value, &handle->mock, &sink)) {
+    return nullptr;
+  }
+  handle->director.reset(new CameraDirector(sink, options));
+  NAPI_CALL(env, napi_wrap(env, self, handle.get(), FinalizeDirector, nullptr, nullptr));
+
+  TickHub::Instance().Add(handle->director.get());
+  handle->attached = true;
+  handle.release();
+  return self;
+}
+
+napi_value DirectorGetCandidates(napi_env env, napi_callback_info info)
+{
+  DirectorHandle* handle = UnwrapThis<DirectorHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+
+  const std::vector<DirectorCandidate>& candidates = handle->director->candidates();
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_array_with_length(env, candidates.size(), &result));
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    const DirectorCandidate& candidate = candidates[i];
+    napi_value entry = nullptr;
+    NAPI_CALL(env, napi_create_object(env, &entry));
+    const char* kind = candidate.kind == CandidateKind::kBattle ? "battle" : "incident";
+    NAPI_CALL(env, napi_set_named_property(env, entry, "kind", MakeString(env, kind)));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "carIdx", MakeInt(env, candidate.car_idx)));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "frontCarIdx", MakeInt(env, candidate.first_car_idx)));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "cars", MakeInt(env, candidate.cars)));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "gapS", MakeDouble(env, candidate.gap_s)));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "score", MakeDouble(env, candidate.score)));
+    NAPI_CALL(env, napi_set_element(env, result, static_cast<uint32_t>(i), entry));
+  }
+  return result;
+}
+
+napi_value DirectorGetState(napi_env env, napi_callback_info info)
+{
+  DirectorHandle* handle = UnwrapThis<DirectorHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  DirectorState state = handle->director->state();
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_set_named_property(env, result, "carIdx", MakeInt(env, state.car_idx)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "score", MakeDouble(env, state.score)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "sinceMs",
+                                         state.car_idx >= 0 ? MakeDouble(env, state.since_ms) : GetNull(env)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "switches", MakeInt(env, state.switches)));
+  return result;
+}
+
+napi_value DirectorSetEnabled(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  DirectorHandle* handle = UnwrapThis<DirectorHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  bool enabled = false;
+  if (argc < 1 || napi_get_value_bool(env, args[0], &enabled) != napi_ok) {
+    napi_throw_type_error(env, nullptr, "setEnabled expects (enabled)");
+    return nullptr;
+  }
+  handle->director->SetEnabled(enabled);
+  return GetUndefined(env);
+}
+
+// Commands delivered to the mock sink, or null for the sim sink.
+napi_value DirectorGetSentLog(napi_env env, napi_callback_info info)
+{
+  DirectorHandle* handle = UnwrapThis<DirectorHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  if (!handle->mock) {
+    return GetNull(env);
+  }
+  return MakeSentLog(env, *handle->mock);
+}
+
+napi_value DirectorClose(napi_env env, napi_callback_info info)
+{
+  DirectorHandle* handle = UnwrapThis<DirectorHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  handle->Detach();
+  return GetUndefined(env);
+}
+
+}  // namespace
+
+napi_value RegisterCameraDirector(napi_env env, napi_value exports)
+{
+  napi_property_descriptor methods[] = {
+    {"getCandidates", nullptr, DirectorGetCandidates, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getState", nullptr, DirectorGetState, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"setEnabled", nullptr, DirectorSetEnabled, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getSentLog", nullptr, DirectorGetSentLog, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"close", nullptr, DirectorClose, nullptr, nullptr, nullptr, napi_default, nullptr}
+  };
+
+  napi_value constructor = nullptr;
+  NAPI_CALL(env, napi_define_class(env, "CameraDirector", NAPI_AUTO_LENGTH, DirectorConstructor, nullptr,
+                                   sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "CameraDirector", constructor));
+  return exports;
+}
+
+}  // namespace irsdk_node
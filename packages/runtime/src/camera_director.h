@@ -0,0 +1,88 @@
+// Automatic camera direction: scores battles and incidents on every tick and
+// switches the broadcast camera to the best one through a debounced policy.
+
+#ifndef IRSDK_NODE_CAMERA_DIRECTOR_H_
+#define IRSDK_NODE_CAMERA_DIRECTOR_H_
+
+#include <vector>
+
+#include "broadcast_dispatcher.h"
+#include "telemetry_source.h"
+#include "tick_hub.h"
+#include "track_order.h"
+
+namespace irsdk_node {
+
+struct DirectorOptions {
+  double battle_gap_s = 1.0;     // Cars closer than this on the same lap are battling.
+  double incident_weight = 1.5;  // Score of a car that is off track.
+  double min_dwell_s = 5.0;      // Never cut sooner than this after a switch.
+  double switch_factor = 1.5;    // A new target must outscore the current one by this.
+  int group = 0;                 // Camera group; 0 keeps the current group.
+  int camera = 0;
+  bool enabled = true;           // When false, scores are kept but no switches are sent.
+};
+
+enum class CandidateKind { kBattle, kIncident };
+
+struct DirectorCandidate {
+  CandidateKind kind;
+  int car_idx;        // Car to focus: the chasing car of a battle.
+  int first_car_idx;  // Front car of the battle.
+  int cars;           // Cars in the battle train.
+  double gap_s;       // Closest gap in the train.
+  double score;
+};
+
+struct DirectorState {
+  int car_idx;   // Current target, -1 before the first switch.
+  double score;  // Its score on the last tick.
+  double since_ms;
+  int switches;
+};
+
+class CameraDirector : public TickListener {
+ public:
+  CameraDirector(BroadcastSink* sink, const DirectorOptions& options);
+
+  void OnTick(const TelemetrySource& source, const TickStamp& stamp) override;
+
+  void SetEnabled(bool enabled) { options_.enabled = enabled; }
+
+  // Candidates of the last tick, best first.
+  const std::vector<DirectorCandidate>& candidates() const { return candidates_; }
+  DirectorState state() const { return DirectorState{target_, target_score_, since_ms_, switches_}; }
+
+ private:
+  bool ReadCars(const TelemetrySource& source, double dt_s);
+  void Score();
+  void Decide(const TelemetrySource& source, double now_ms);
+
+  BroadcastSink* sink_;
+  DirectorOptions options_;
+  TrackPositions positions_;
+
+  VarHandle position_var_{"CarIdxPosition"};
+  VarHandle class_position_var_{"CarIdxClassPosition"};
+  VarHandle class_var_{"CarIdxClass"};
+  VarHandle pit_var_{"CarIdxOnPitRoad"};
+  VarHandle group_var_{"CamGroupNumber"};
+
+  // Per car, indexed by CarIdx.
+  std::vector<int> class_position_;
+  std::vector<int> class_;
+  std::vector<bool> pit_;
+
+  bool has_prev_ = false;
+  double prev_time_ = 0.0;
+  std::vector<DirectorCandidate> candidates_;
+
+  int target_ = -1;
+  double target_score_ = 0.0;
+  double since_ms_ = 0.0;
+  int switches_ = 0;
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_CAMERA_DIRECTOR_H_
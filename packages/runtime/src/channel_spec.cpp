@@ -0,0 +1,61 @@
+// Channel selections shared by the components that blend telemetry values.
+
+#include "channel_spec.h"
+
+#include <cmath>
+
+namespace irsdk_node {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kTwoPi = 2.0 * kPi;
+
+double WrapAngle(double value)
+{
+  return value - kTwoPi * std::floor((value + kPi) / kTwoPi);
+}
+
+bool EndsWith(const std::string& value, const char* suffix)
+{
+  size_t len = std::char_traits<char>::length(suffix);
+  return value.size() >= len && value.compare(value.size() - len, len, suffix) == 0;
+}
+
+}  // namespace
+
+ChannelKind InferChannelKind(const std::string& name)
+{
+  if (EndsWith(name, "LapDistPct")) {
+    return ChannelKind::kLapDistPct;
+  }
+  if (name == "Yaw" || name == "YawNorth" || name == "Pitch" || name == "Roll") {
+    return ChannelKind::kAngle;
+  }
+  return ChannelKind::kLinear;
+}
+
+double BlendChannel(ChannelKind kind, double from, double to, double fraction)
+{
+  switch (kind) {
+    case ChannelKind::kLapDistPct: {
+      // Cars in the garage or not yet loaded report -1; never blend those.
+      if (from < 0.0 || to < 0.0) {
+        return to;
+      }
+      double delta = to - from;
+      delta -= std::round(delta);
+      double value = from + delta * fraction;
+      return value - std::floor(value);
+    }
+    case ChannelKind::kAngle: {
+      double delta = WrapAngle(to - from);
+      return WrapAngle(from + delta * fraction);
+    }
+    case ChannelKind::kLinear:
+    default:
+      return from + (to - from) * fraction;
+  }
+}
+
+}  // namespace irsdk_node
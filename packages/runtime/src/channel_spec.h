@@ -0,0 +1,35 @@
+// Channel selections shared by the components that blend telemetry values.
+
+#ifndef IRSDK_NODE_CHANNEL_SPEC_H_
+#define IRSDK_NODE_CHANNEL_SPEC_H_
+
+#include <node_api.h>
+
+#include <string>
+#include <vector>
+
+namespace irsdk_node {
+
+enum class ChannelKind {
+  kLinear,      // Plain scalar.
+  kLapDistPct,  // Wraps at 1.0; negative values mark cars not in the world.
+  kAngle,       // Radians, wrapped to [-pi, pi).
+};
+
+struct ChannelSpec {
+  std::string name;
+  ChannelKind kind;
+};
+
+// Guess the channel kind from well-known telemetry names.
+ChannelKind InferChannelKind(const std::string& name);
+
+// Blend two samples of a channel; fractions above 1 extrapolate.
+double BlendChannel(ChannelKind kind, double from, double to, double fraction);
+
+// Parse a JS array of channel names or { name, kind } objects.
+bool ParseChannelSpecs(napi_env env, napi_value value, std::vector<ChannelSpec>* out);
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_CHANNEL_SPEC_H_
@@ -0,0 +1,81 @@
+// Parsing of channel selections passed from JS.
+
+#include "channel_spec.h"
+
+#include "napi_util.h"
+
+namespace irsdk_node {
+
+namespace {
+
+bool ParseChannelKind(napi_env env, const std::string& text, ChannelKind* out)
+{
+  if (text == "linear") {
+    *out = ChannelKind::kLinear;
+  } else if (text == "lapDistPct") {
+    *out = ChannelKind::kLapDistPct;
+  } else if (text == "angle") {
+    *out = ChannelKind::kAngle;
+  } else {
+    napi_throw_type_error(env, nullptr, "channel kind must be 'linear', 'lapDistPct' or 'angle'");
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+bool ParseChannelSpecs(napi_env env, napi_value value, std::vector<ChannelSpec>* out)
+{
+  bool is_array = false;
+  if (!CheckNapi(env, napi_is_array(env, value, &is_array))) {
+    return false;
+  }
+  if (!is_array) {
+    napi_throw_type_error(env, nullptr, "channels must be an array");
+    return false;
+  }
+
+  uint32_t length = 0;
+  if (!CheckNapi(env, napi_get_array_length(env, value, &length))) {
+    return false;
+  }
+  for (uint32_t i = 0; i < length; ++i) {
+    napi_value element = nullptr;
+    if (!CheckNapi(env, napi_get_element(env, value, i, &element))) {
+      return false;
+    }
+
+    napi_valuetype type = napi_undefined;
+    if (!CheckNapi(env, napi_typeof(env, element, &type))) {
+      return false;
+    }
+
+    ChannelSpec channel;
+    if (type == napi_string) {
+      GetString(env, element, &channel.name);
+      channel.kind = InferChannelKind(channel.name);
+    } else if (type == napi_object) {
+      if (!GetOptionalString(env, element, "name", &channel.name)) {
+        return false;
+      }
+      channel.kind = InferChannelKind(channel.name);
+      std::string kind;
+      if (!GetOptionalString(env, element, "kind", &kind)) {
+        return false;
+      }
+      if (!kind.empty() && !ParseChannelKind(env, kind, &channel.kind)) {
+        return false;
+      }
+    }
+
+    if (channel.name.empty()) {
+      napi_throw_type_error(env, nullptr, "each channel needs a name");
+      return false;
+    }
+    out->push_back(channel);
+  }
+  return true;
+}
+
+}  // namespace irsdk_node
@@ -0,0 +1,23 @@
+// Checksums for on-disk formats: CRC-32 to validate records, FNV-1a to
+// fingerprint content.
+
+#ifndef IRSDK_NODE_CHECKSUM_H_
+#define IRSDK_NODE_CHECKSUM_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace irsdk_node {
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+
+// CRC-32 (IEEE, as used by zip and PNG). Pass the previous result to continue
+// over more data.
+uint32_t Crc32(const void* data, size_t size, uint32_t crc = 0);
+
+// 64-bit FNV-1a. Pass the previous result to continue over more data.
+uint64_t Fnv1a64(const void* data, size_t size, uint64_t hash = kFnvOffset);
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_CHECKSUM_H_
@@ -0,0 +1,325 @@
+// Corner segmentation and per-corner metrics for the player car.
+
+#include "corner_analyzer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+
+#include "bindings.h"
+#include "napi_util.h"
+
+namespace irsdk_node {
+
+namespace {
+
+enum Channel { kSpeed, kSteering, kLatAccel, kBrake, kChannelCount };
+
+std::vector<ChannelSpec> CornerChannels()
+{
+  return {{"Speed", ChannelKind::kLinear},
+          {"SteeringWheelAngle", ChannelKind::kLinear},
+          {"LatAccel", ChannelKind::kLinear},
+          {"Brake", ChannelKind::kLinear}};
+}
+
+}  // namespace
+
+CornerAnalyzer::CornerAnalyzer(const CornerOptions& options)
+    : options_(options),
+      lap_(CornerChannels(), options.grid_points)
+{
+}
+
+double CornerAnalyzer::Value(const LapTrace& trace, int point, int channel) const
+{
+  return trace.values[static_cast<size_t>(point) * kChannelCount + static_cast<size_t>(channel)];
+}
+
+void CornerAnalyzer::SegmentTrace(const LapTrace& trace)
+{
+  corners_.clear();
+  best_times_.clear();
+  int n = grid_points();
+  int min_points = std::max(1, static_cast<int>(options_.min_length * n));
+  int merge_points = static_cast<int>(options_.merge_gap * n);
+
+  // Runs of lateral load, with short straights between them joined.
+  std::vector<Corner> runs;
+  for (int p = 0; p < n; ++p) {
+    double lat = Value(trace, p, kLatAccel);
+    bool active = std::isnan(lat) ? std::fabs(Value(trace, p, kSteering)) >= options_.steering
+                                  : std::fabs(lat) >= options_.lat_accel;
+    if (!active) {
+      continue;
+    }
+    if (!runs.empty() && p - runs.back().exit <= merge_points + 1) {
+      runs.back().exit = p;
+    } else {
+      runs.push_back(Corner{p, p, p});
+    }
+  }
+
+  int floor = 0;
+  for (const Corner& run : runs) {
+    if (run.exit - run.entry + 1 < min_points) {
+      continue;
+    }
+    Corner corner = run;
+    // Start at the braking zone that leads into the corner, allowing a short
+    // coast between releasing the brake and turning in.
+    int last_brake = -1;
+    for (int p = run.entry - 1; p >= floor && run.entry - p <= merge_points + 1; --p) {
+      if (Value(trace, p, kBrake) >= options_.brake) {
+        last_brake = p;
+        break;
+      }
+    }
+    if (last_brake >= 0) {
+      corner.entry = last_brake;
+      while (corner.entry > floor && Value(trace, corner.entry - 1, kBrake) >= options_.brake) {
+        --corner.entry;
+      }
+    }
+    corner.apex = corner.entry;
+    for (int p = corner.entry; p <= corner.exit; ++p) {
+      if (Value(trace, p, kSpeed) < Value(trace, corner.apex, kSpeed)) {
+        corner.apex = p;
+      }
+    }
+    corners_.push_back(corner);
+    floor = corner.exit + 1;
+  }
+  best_times_.assign(corners_.size(), std::numeric_limits<double>::infinity());
+}
+
+void CornerAnalyzer::Measure(const LapTrace& trace)
+{
+  int n = grid_points();
+  last_.lap = trace.lap;
+  last_.lap_time = trace.lap_time;
+  last_.corners.clear();
+  int floor = 0;
+  for (size_t i = 0; i < corners_.size(); ++i) {
+    const Corner& corner = corners_[i];
+    CornerMetrics metrics;
+    metrics.entry_speed = Value(trace, corner.entry, kSpeed);
+    metrics.exit_speed = Value(trace, corner.exit, kSpeed);
+    int slowest = corner.entry;
+    for (int p = corner.entry; p <= corner.exit; ++p) {
+      if (Value(trace, p, kSpeed) < Value(trace, slowest, kSpeed)) {
+        slowest = p;
+      }
+    }
+    metrics.min_speed = Value(trace, slowest, kSpeed);
+    metrics.min_speed_pct = static_cast<double>(slowest) / n;
+
+    // This lap's brake point may be earlier or later than the reference's.
+    metrics.brake_pct = -1.0;
+    for (int p = floor; p <= corner.apex; ++p) {
+      if (Value(trace, p, kBrake) >= options_.brake) {
+        metrics.brake_pct = static_cast<double>(p) / n;
+        break;
+      }
+    }
+    metrics.time_s = trace.times[static_cast<size_t>(corner.exit)] - trace.times[static_cast<size_t>(corner.entry)];
+    best_times_[i] = std::min(best_times_[i], metrics.time_s);
+    metrics.best_time_s = best_times_[i];
+    last_.corners.push_back(metrics);
+    floor = corner.exit + 1;
+  }
+}
+
+bool CornerAnalyzer::Segment(bool best)
+{
+  const LapTrace* trace = best ? lap_.best() : lap_.last();
+  if (!trace) {
+    return false;
+  }
+  SegmentTrace(*trace);
+  Measure(*lap_.last());
+  return true;
+}
+
+void CornerAnalyzer::OnTick(const TelemetrySource& source, const TickStamp& stamp)
+{
+  lap_.OnTick(source, stamp);
+  const LapTrace* last = lap_.last();
+  if (!last || (last->lap == seen_lap_ && last->lap_time == seen_lap_time_)) {
+    return;
+  }
+  seen_lap_ = last->lap;
+  seen_lap_time_ = last->lap_time;
+  // Ovals and laps without load yield no corners; try again next lap.
+  if (corners_.empty()) {
+    SegmentTrace(*last);
+  }
+  Measure(*last);
+}
+
+namespace {
+
+// JS wrapper that keeps the analyzer attached to the live tick stream until
+// close() or garbage collection.
+struct CornerAnalyzerHandle {
+  std::unique_ptr<CornerAnalyzer> analyzer;
+  bool attached = false;
+
+  void Detach()
+  {
+    if (attached) {
+      TickHub::Instance().Remove(analyzer.get());
+      attached = false;
+    }
+  }
+};
+
+void FinalizeCornerAnalyzer(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  CornerAnalyzerHandle* handle = static_cast<CornerAnalyzerHandle*>(data);
+  handle->Detach();
+  delete handle;
+}
+
+napi_value CornerAnalyzerConstructor(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value self = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+  napi_value options = argc >= 1 ? args[0] : nullptr;
+  CornerOptions parsed;
+  if (!GetOptionalInt(env, options, "gridPoints", &parsed.grid_points) ||
+      !GetOptionalDouble(env, options, "latAccel", &parsed.lat_accel) ||
+      !GetOptionalDouble(env, options, "steering", &parsed.steering) ||
+      !GetOptionalDouble(env, options, "brake", &parsed.brake) ||
+      !GetOptionalDouble(env, options, "minLengthPct", &parsed.min_length) ||
+      !GetOptionalDouble(env, options, "mergeGapPct", &parsed.merge_gap)) {
+    return nullptr;
+  }
+
+  auto* handle = new CornerAnalyzerHandle();
+  handle->analyzer.reset(new CornerAnalyzer(parsed));
+  napi_status status = napi_wrap(env, self, handle, FinalizeCornerAnalyzer, nullptr, nullptr);
+  if (status != napi_ok) {
+    delete handle;
+    CheckNapi(env, status);
+    return nullptr;
+  }
+
+  TickHub::Instance().Add(handle->analyzer.get());
+  handle->attached = true;
+  return self;
+}
+
+napi_value CornerAnalyzerGetCorners(napi_env env, napi_callback_info info)
+{
+  CornerAnalyzerHandle* handle = UnwrapThis<CornerAnalyzerHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  const CornerAnalyzer& analyzer = *handle->analyzer;
+  double n = analyzer.grid_points();
+  const std::vector<Corner>& corners = analyzer.corners();
+
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_array_with_length(env, corners.size(), &result));
+  for (size_t i = 0; i < corners.size(); ++i) {
+    napi_value item = nullptr;
+    NAPI_CALL(env, napi_create_object(env, &item));
+    NAPI_CALL(env, napi_set_named_property(env, item, "entryPct", MakeDouble(env, corners[i].entry / n)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "apexPct", MakeDouble(env, corners[i].apex / n)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "exitPct", MakeDouble(env, corners[i].exit / n)));
+    NAPI_CALL(env, napi_set_element(env, result, static_cast<uint32_t>(i), item));
+  }
+  return result;
+}
+
+napi_value CornerAnalyzerGetLastLap(napi_env env, napi_callback_info info)
+{
+  CornerAnalyzerHandle* handle = UnwrapThis<CornerAnalyzerHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  const CornerLap& lap = handle->analyzer->last();
+  if (lap.lap_time <= 0.0) {
+    return GetNull(env);
+  }
+
+  napi_value corners = nullptr;
+  NAPI_CALL(env, napi_create_array_with_length(env, lap.corners.size(), &corners));
+  for (size_t i = 0; i < lap.corners.size(); ++i) {
+    const CornerMetrics& metrics = lap.corners[i];
+    napi_value item = nullptr;
+    NAPI_CALL(env, napi_create_object(env, &item));
+    NAPI_CALL(env, napi_set_named_property(env, item, "entrySpeed", MakeDouble(env, metrics.entry_speed)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "minSpeed", MakeDouble(env, metrics.min_speed)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "minSpeedPct", MakeDouble(env, metrics.min_speed_pct)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "exitSpeed", MakeDouble(env, metrics.exit_speed)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "brakePct",
+                                           metrics.brake_pct >= 0.0 ? MakeDouble(env, metrics.brake_pct)
+                                                                    : GetNull(env)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "timeS", MakeDouble(env, metrics.time_s)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "bestTimeS", MakeDouble(env, metrics.best_time_s)));
+    NAPI_CALL(env, napi_set_element(env, corners, static_cast<uint32_t>(i), item));
+  }
+
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_set_named_property(env, result, "lap", MakeInt(env, lap.lap)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "lapTime", MakeDouble(env, lap.lap_time)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "corners", corners));
+  return result;
+}
+
+napi_value CornerAnalyzerSegment(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  CornerAnalyzerHandle* handle = UnwrapThis<CornerAnalyzerHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  std::string which;
+  if (argc < 1 || !GetString(env, args[0], &which) || (which != "best" && which != "last")) {
+    napi_throw_type_error(env, nullptr, "segment expects ('best' | 'last')");
+    return nullptr;
+  }
+  return MakeBool(env, handle->analyzer->Segment(which == "best"));
+}
+
+napi_value CornerAnalyzerClose(napi_env env, napi_callback_info info)
+{
+  CornerAnalyzerHandle* handle = UnwrapThis<CornerAnalyzerHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  handle->Detach();
+  return GetUndefined(env);
+}
+
+}  // namespace
+
+napi_value RegisterCornerAnalyzer(napi_env env, napi_value exports)
+{
+  napi_property_descriptor methods[] = {
+    {"getCorners", nullptr, CornerAnalyzerGetCorners, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getLastLap", nullptr, CornerAnalyzerGetLastLap, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"segment", nullptr, CornerAnalyzerSegment, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"close", nullptr, CornerAnalyzerClose, nullptr, nullptr, nullptr, napi_default, nullptr}
+  };
+
+  napi_value constructor = nullptr;
+  NAPI_CALL(env, napi_define_class(env, "CornerAnalyzer", NAPI_AUTO_LENGTH, CornerAnalyzerConstructor, nullptr,
+                                   sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "CornerAnalyzer", constructor));
+  return exports;
+}
+
+}  // namespace irsdk_node
@@ -0,0 +1,80 @@
+// Corners of the track found on a reference lap of the player car, and
+// entry/minimum/exit speed, brake point and segment time for every lap.
+
+#ifndef IRSDK_NODE_CORNER_ANALYZER_H_
+#define IRSDK_NODE_CORNER_ANALYZER_H_
+
+#include <vector>
+
+#include "lap_delta.h"
+#include "telemetry_source.h"
+#include "tick_hub.h"
+
+namespace irsdk_node {
+
+struct CornerOptions {
+  int grid_points = 1000;
+  double lat_accel = 5.0;      // |LatAccel| (m/s^2) that makes a point part of a corner.
+  double steering = 0.15;      // |SteeringWheelAngle| (rad), used when LatAccel is missing.
+  double brake = 0.1;          // Brake pedal that counts as braking.
+  double min_length = 0.002;   // Shorter corners (fraction of a lap) are dropped...
+  double merge_gap = 0.005;    // ...and corners closer than this are joined.
+};
+
+// A corner as grid indices into the lap traces: entry is the start of the
+// braking zone leading into it, exit the end of lateral load.
+struct Corner {
+  int entry;
+  int apex;  // Slowest point on the reference lap.
+  int exit;
+};
+
+struct CornerMetrics {
+  double entry_speed;
+  double min_speed;
+  double min_speed_pct;
+  double exit_speed;
+  double brake_pct;  // First braking point before the apex, -1 without braking.
+  double time_s;     // From entry to exit.
+  double best_time_s;
+};
+
+struct CornerLap {
+  int lap = -1;
+  double lap_time = 0.0;
+  std::vector<CornerMetrics> corners;
+};
+
+class CornerAnalyzer : public TickListener {
+ public:
+  explicit CornerAnalyzer(const CornerOptions& options);
+
+  void OnTick(const TelemetrySource& source, const TickStamp& stamp) override;
+
+  // Segment from the best or last completed lap; false when there is none.
+  // The first completed lap is used until this is called.
+  bool Segment(bool best);
+
+  int grid_points() const { return lap_.grid_points(); }
+  const std::vector<Corner>& corners() const { return corners_; }
+  // Metrics of the last completed lap; lap_time is 0 before the first one.
+  const CornerLap& last() const { return last_; }
+
+ private:
+  void SegmentTrace(const LapTrace& trace);
+  void Measure(const LapTrace& trace);
+  double Value(const LapTrace& trace, int point, int channel) const;
+
+  CornerOptions options_;
+  LapDelta lap_;
+  int seen_lap_ = -1;
+  double seen_lap_time_ = 0.0;
+
+  std::vector<Corner> corners_;
+  std::vector<double> best_times_;
+  CornerLap last_;
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_CORNER_ANALYZER_H_
@@ -0,0 +1,455 @@
+// CSV/TSV export of .ibt files and live history.
+
+#include "csv_export.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "file_util.h"
+#include "history.h"
+#include "ibt_file.h"
+#include "irsdk_defines.h"
+#include "napi_util.h"
+#include "tick_clock.h"
+
+namespace irsdk_node {
+
+namespace {
+
+// Room for one formatted cell and its delimiter. Fixed notation is only used
+// below kFixedLimit, so the widest cell is a sign, 15 integer digits, the
+// point and kMaxPrecision decimals.
+constexpr size_t kMaxCell = 48;
+constexpr double kFixedLimit = 1e15;
+constexpr int kMaxPrecision = 17;
+
+// Blocks are sized so their worst-case text stays around this many bytes.
+constexpr size_t kBlockBytes = 4 << 20;
+constexpr size_t kMinBlockRows = 64;
+constexpr size_t kMaxBlockRows = 16384;
+
+// Format rows [first, first + count) at *cursor, advancing it. Returns false
+// with error set when the rows cannot be read.
+using BlockFormatter =
+    std::function<bool(size_t worker, size_t first, size_t count, char** cursor, int64_t* rows, std::string* error)>;
+
+char* WriteInt(char* p, int64_t value)
+{
+  return std::to_chars(p, p + kMaxCell, value).ptr;
+}
+
+// Non-finite values are left as empty cells.
+template <typename T>
+char* WriteReal(char* p, T value, int precision)
+{
+  if (!std::isfinite(value)) {
+    return p;
+  }
+  if (precision >= 0 && std::fabs(value) < kFixedLimit) {
+    return std::to_chars(p, p + kMaxCell, value, std::chars_format::fixed, precision).ptr;
+  }
+  return std::to_chars(p, p + kMaxCell, value).ptr;
+}
+
+// History samples were widened to double from the sim's types; write them in
+// the narrowest form that reproduces the value.
+char* WriteSample(char* p, double value, int precision)
+{
+  if (!std::isfinite(value)) {
+    return p;
+  }
+  if (precision < 0 && value == std::trunc(value) && std::fabs(value) < kFixedLimit) {
+    return WriteInt(p, static_cast<int64_t>(value));
+  }
+  float narrow = static_cast<float>(value);
+  if (static_cast<double>(narrow) == value) {
+    return WriteReal(p, narrow, precision);
+  }
+  return WriteReal(p, value, precision);
+}
+
+struct IbtColumn {
+  int type;
+  int offset;  // Byte offset of the entry within a record.
+};
+
+// Format a value straight from its on-disk type, so floats keep their
+// shortest float form rather than the digits of their double widening.
+char* WriteIbtValue(char* p, const char* record, const IbtColumn& column, int precision)
+{
+  const char* data = record + column.offset;
+  switch (column.type) {
+    case irsdk_char:
+      return WriteInt(p, static_cast<unsigned char>(*data));
+    case irsdk_bool:
+      *p = *data != 0 ? '1' : '0';
+      return p + 1;
+    case irsdk_int: {
+      int32_t value = 0;
+      std::memcpy(&value, data, sizeof(value));
+      return WriteInt(p, value);
+    }
+    case irsdk_bitField: {
+      uint32_t value = 0;
+      std::memcpy(&value, data, sizeof(value));
+      return WriteInt(p, value);
+    }
+    case irsdk_float: {
+      float value = 0.0f;
+      std::memcpy(&value, data, sizeof(value));
+      return WriteReal(p, value, precision);
+    }
+    case irsdk_double: {
+      double value = 0.0;
+      std::memcpy(&value, data, sizeof(value));
+      return WriteReal(p, value, precision);
+    }
+    default:
+      return p;
+  }
+}
+
+size_t WorkerCount(const CsvExportOptions& options, size_t blocks)
+{
+  size_t workers = options.threads > 0 ? static_cast<size_t>(options.threads)
+                                       : std::max(1u, std::thread::hardware_concurrency());
+  return std::max<size_t>(1, std::min(workers, blocks));
+}
+
+size_t BlockRows(size_t columns)
+{
+  size_t row_bytes = columns * kMaxCell + 1;
+  return std::min(kMaxBlockRows, std::max(kMinBlockRows, kBlockBytes / row_bytes));
+}
+
+// Write the header and then `rows` rows in blocks of block_rows. Workers
+// format blocks in claim order while this thread writes finished blocks in
+// sequence; a block is only claimed once the one `window` places before it
+// has been written, which bounds the text held in memory.
+bool WriteCsv(const std::string& out_path,
+              const std::vector<std::string>& names,
+              const CsvExportOptions& options,
+              size_t rows,
+              size_t block_rows,
+              size_t workers,
+              const BlockFormatter& format,
+              CsvExportStats* stats,
+              std::string* error,
+              JobControl* control)
+{
+  std::FILE* out = OpenFile(out_path, "wb");
+  if (!out) {
+    *error = "cannot create file: " + out_path;
+    return false;
+  }
+
+  // Channel names never contain delimiters or quotes, so nothing is quoted.
+  std::string header;
+  if (options.header) {
+    for (size_t i = 0; i < names.size(); ++i) {
+      if (i > 0) {
+        header += options.delimiter;
+      }
+      header += names[i];
+    }
+    header += '\n';
+  }
+  bool failed = std::fwrite(header.data(), 1, header.size(), out) != header.size();
+  std::string failure = failed ? "cannot write " + out_path : std::string();
+  stats->bytes = static_cast<int64_t>(header.size());
+  stats->rows = 0;
+
+  const size_t row_bytes = names.size() * kMaxCell + 1;
+  const size_t blocks = (rows + block_rows - 1) / block_rows;
+  const size_t window = workers * 2;
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::vector<std::string> slots(window);
+  std::vector<bool> ready(window, false);
+  size_t next = 0;
+  size_t written = 0;
+
+  auto work = [&](size_t worker) {
+    std::string text;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+      changed.wait(lock, [&]() { return failed || next >= blocks || next < written + window; });
+      if (failed || next >= blocks) {
+        return;
+      }
+      size_t block = next++;
+      lock.unlock();
+
+      size_t first = block * block_rows;
+      size_t count = std::min(block_rows, rows - first);
+      text.resize(count * row_bytes);
+      char* cursor = &text[0];
+      int64_t kept = 0;
+      std::string block_error;
+      bool ok = format(worker, first, count, &cursor, &kept, &block_error);
+      text.resize(static_cast<size_t>(cursor - text.data()));
+
+      lock.lock();
+      if (!ok) {
+        if (!failed) {
+          failed = true;
+          failure = block_error;
+        }
+        changed.notify_all();
+        return;
+      }
+      stats->rows += kept;
+      // The slot's previous text has been written; hand its buffer back for reuse.
+      slots[block % window].swap(text);
+      ready[block % window] = true;
+      changed.notify_all();
+    }
+  };
+
+  std::vector<std::thread> pool;
+  if (!failed) {
+    for (size_t i = 0; i < std::min(workers, blocks); ++i) {
+      pool.emplace_back(work, i);
+    }
+  }
+
+  std::string text;
+  for (size_t block = 0; block < blocks; ++block) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      changed.wait(lock, [&]() { return failed || ready[block % window]; });
+      if (failed) {
+        break;
+      }
+      text.swap(slots[block % window]);
+      ready[block % window] = false;
+      written = block + 1;
+    }
+    changed.notify_all();
+    if (std::fwrite(text.data(), 1, text.size(), out) != text.size()) {
+      std::lock_guard<std::mutex> lock(mutex);
+      failed = true;
+      failure = "cannot write " + out_path;
+      changed.notify_all();
+      break;
+    }
+    stats->bytes += static_cast<int64_t>(text.size());
+    if (control && !control->Update(static_cast<double>(std::min(rows, (block + 1) * block_rows)), rows)) {
+      std::lock_guard<std::mutex> lock(mutex);
+      failed = true;
+      failure = "export was cancelled";
+      changed.notify_all();
+      break;
+    }
+  }
+  for (std::thread& thread : pool) {
+    thread.join();
+  }
+
+  if (std::fclose(out) != 0 && !failed) {
+    failed = true;
+    failure = "cannot write " + out_path;
+  }
+  stats->columns = static_cast<int>(names.size());
+  if (failed) {
+    RemoveFile(out_path);
+    *error = failure;
+  }
+  return !failed;
+}
+
+bool HasTimeRange(const CsvExportOptions& options)
+{
+  return std::isfinite(options.start) || std::isfinite(options.end);
+}
+
+bool InTimeRange(const CsvExportOptions& options, double time)
+{
+  return time >= options.start && time <= options.end;
+}
+
+}  // namespace
+
+bool ExportIbtCsv(const IbtFile& file, const std::string& out_path, const CsvExportOptions& options,
+                  CsvExportStats* stats, std::string* error, JobControl* control)
+{
+  double start_ms = TickClock::NowMonotonicMs();
+  const std::vector<IbtVar>& vars = file.vars();
+  std::vector<std::string> names;
+  std::vector<IbtColumn> columns;
+  auto add = [&](const IbtVar& var) {
+    int width = var.type == irsdk_double ? 8 : (var.type == irsdk_char || var.type == irsdk_bool ? 1 : 4);
+    for (int entry = 0; entry < var.count; ++entry) {
+      names.push_back(var.count > 1 ? var.name + "[" + std::to_string(entry) + "]" : var.name);
+      columns.push_back({var.type, var.offset + entry * width});
+    }
+  };
+  if (options.channels.empty()) {
+    for (const IbtVar& var : vars) {
+      add(var);
+    }
+  } else {
+    for (const std::string& name : options.channels) {
+      int idx = file.FindVar(name);
+      if (idx < 0) {
+        *error = "unknown channel '" + name + "'";
+        return false;
+      }
+      add(vars[idx]);
+    }
+  }
+
+  const bool by_time = HasTimeRange(options);
+  int time_idx = file.FindVar("SessionTime");
+  if (by_time && time_idx < 0) {
+    *error = "file has no SessionTime channel";
+    return false;
+  }
+
+  const size_t rows = static_cast<size_t>(file.record_count());
+  const size_t block_rows = BlockRows(columns.size());
+  const size_t workers = WorkerCount(options, (rows + block_rows - 1) / block_rows);
+
+  // Each worker reads through its own handle so reads never share a file
+  // position.
+  std::vector<std::unique_ptr<IbtFile>> readers;
+  for (size_t i = 0; i < workers; ++i) {
+    readers.emplace_back(new IbtFile());
+    if (!readers.back()->Open(file.path(), error)) {
+      return false;
+    }
+  }
+  std::vector<std::vector<char>> buffers(workers);
+  const size_t record_length = static_cast<size_t>(file.record_length());
+
+  BlockFormatter format = [&](size_t worker, size_t first, size_t count, char** cursor, int64_t* kept,
+                              std::string* block_error) {
+    std::vector<char>& records = buffers[worker];
+    if (!readers[worker]->ReadRecords(static_cast<int>(first), static_cast<int>(count), &records)) {
+      *block_error = "failed to read records";
+      return false;
+    }
+    char* p = *cursor;
+    for (size_t i = 0; i < count; ++i) {
+      const char* record = records.data() + i * record_length;
+      if (by_time && !InTimeRange(options, DecodeVarValue(record, vars[time_idx], 0))) {
+        continue;
+      }
+      for (size_t c = 0; c < columns.size(); ++c) {
+        if (c > 0) {
+          *p++ = options.delimiter;
+        }
+        p = WriteIbtValue(p, record, columns[c], options.precision);
+      }
+      *p++ = '\n';
+      ++*kept;
+    }
+    *cursor = p;
+    return true;
+  };
+
+  bool ok = WriteCsv(out_path, names, options, rows, block_rows, workers, format, stats, error, control);
+  stats->elapsed_ms = TickClock::NowMonotonicMs() - start_ms;
+  return ok;
+}
+
+bool ExportHistoryCsv(const History& history, const std::string& out_path, const CsvExportOptions& options,
+                      CsvExportStats* stats, std::string* error)
+{
+  double start_ms = TickClock::NowMonotonicMs();
+  const std::vector<std::string>& channels = options.channels.empty() ? history.channels() : options.channels;
+
+  // Snapshot the ring buffers so the workers never touch the live history.
+  std::vector<std::string> names{"SessionTime"};
+  std::vector<double> times;
+  std::vector<std::vector<double>> columns(channels.size());
+  history.Times(&times);
+  for (size_t i = 0; i < channels.size(); ++i) {
+    if (!history.Values(channels[i], &columns[i])) {
+      *error = "unknown channel '" + channels[i] + "'";
+      return false;
+    }
+    names.push_back(channels[i]);
+  }
+
+  const size_t rows = times.size();
+  const size_t block_rows = BlockRows(names.size());
+  const size_t workers = WorkerCount(options, (rows + block_rows - 1) / block_rows);
+
+  BlockFormatter format = [&](size_t worker, size_t first, size_t count, char** cursor, int64_t* kept,
+                              std::string* block_error) {
+    (void)worker;
+    (void)block_error;
+    char* p = *cursor;
+    for (size_t row = first; row < first + count; ++row) {
+      if (!InTimeRange(options, times[row])) {
+        continue;
+      }
+      p = WriteSample(p, times[row], -1);
+      for (const std::vector<double>& column : columns) {
+        *p++ = options.delimiter;
+        p = WriteSample(p, column[row], options.precision);
+      }
+      *p++ = '\n';
+      ++*kept;
+    }
+    *cursor = p;
+    return true;
+  };
+
+  bool ok = WriteCsv(out_path, names, options, rows, block_rows, workers, format, stats, error, nullptr);
+  stats->elapsed_ms = TickClock::NowMonotonicMs() - start_ms;
+  return ok;
+}
+
+bool ParseCsvExportOptions(napi_env env, napi_value value, CsvExportOptions* out)
+{
+  napi_value channels_value = nullptr;
+  if (GetOptionalProperty(env, value, "channels", &channels_value) &&
+      !GetStringArray(env, channels_value, &out->channels)) {
+    return false;
+  }
+
+  std::string format;
+  if (!GetOptionalString(env, value, "format", &format) ||
+      !GetOptionalInt(env, value, "threads", &out->threads) ||
+      !GetOptionalInt(env, value, "precision", &out->precision) ||
+      !GetOptionalDouble(env, value, "start", &out->start) ||
+      !GetOptionalDouble(env, value, "end", &out->end) ||
+      !GetOptionalBool(env, value, "header", &out->header)) {
+    return false;
+  }
+  if (format.empty() || format == "csv") {
+    out->delimiter = ',';
+  } else if (format == "tsv") {
+    out->delimiter = '\t';
+  } else {
+    napi_throw_type_error(env, nullptr, "format must be 'csv' or 'tsv'");
+    return false;
+  }
+  if (out->precision > kMaxPrecision) {
+    napi_throw_range_error(env, nullptr, "precision must be at most 17");
+    return false;
+  }
+  return true;
+}
+
+napi_value MakeCsvExportStats(napi_env env, const CsvExportStats& stats)
+{
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_set_named_property(env, result, "rows", MakeDouble(env, static_cast<double>(stats.rows))));
+  NAPI_CALL(env, napi_set_named_property(env, result, "columns", MakeInt(env, stats.columns)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "bytes", MakeDouble(env, static_cast<double>(stats.bytes))));
+  NAPI_CALL(env, napi_set_named_property(env, result, "elapsedMs", MakeDouble(env, stats.elapsed_ms)));
+  return result;
+}
+
+}  // namespace irsdk_node
@@ -0,0 +1,59 @@
+// CSV/TSV export of .ibt files and live history for spreadsheet work.
+// Rows are split into blocks that worker threads format with to_chars, and
+// the blocks are written out in order as they complete.
+
+#ifndef IRSDK_NODE_CSV_EXPORT_H_
+#define IRSDK_NODE_CSV_EXPORT_H_
+
+#include <node_api.h>
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "job_control.h"
+
+namespace irsdk_node {
+
+class History;
+class IbtFile;
+
+struct CsvExportOptions {
+  std::vector<std::string> channels;  // Empty exports every channel.
+  char delimiter = ',';
+  int threads = 0;     // 0 picks one per core.
+  int precision = -1;  // Fixed decimals for float channels; < 0 writes the shortest exact form.
+  // SessionTime range of the exported rows.
+  double start = -std::numeric_limits<double>::infinity();
+  double end = std::numeric_limits<double>::infinity();
+  bool header = true;
+};
+
+struct CsvExportStats {
+  int64_t rows = 0;
+  int columns = 0;
+  int64_t bytes = 0;
+  double elapsed_ms = 0.0;
+};
+
+// Export records of an .ibt file. Array channels expand to one column per
+// entry, named "Name[i]". Each worker reads the file through its own handle.
+// Progress is reported in records; a failed or cancelled export removes the
+// partial file.
+bool ExportIbtCsv(const IbtFile& file, const std::string& out_path, const CsvExportOptions& options,
+                  CsvExportStats* stats, std::string* error, JobControl* control = nullptr);
+
+// Export a history as a SessionTime column followed by its channels.
+bool ExportHistoryCsv(const History& history, const std::string& out_path, const CsvExportOptions& options,
+                      CsvExportStats* stats, std::string* error);
+
+// Parse { channels?, format?, threads?, precision?, start?, end?, header? }.
+bool ParseCsvExportOptions(napi_env env, napi_value value, CsvExportOptions* out);
+
+// { rows, columns, bytes, elapsedMs }.
+napi_value MakeCsvExportStats(napi_env env, const CsvExportStats& stats);
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_CSV_EXPORT_H_
@@ -0,0 +1,204 @@
+// Chart-oriented downsampling of long telemetry series.
+
+#include "downsample.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "bindings.h"
+#include "napi_util.h"
+
+namespace irsdk_node {
+
+namespace {
+
+void Lttb(const double* x, const double* y, size_t n, size_t width, size_t base, std::vector<size_t>* out)
+{
+  out->push_back(base);
+  double every = static_cast<double>(n - 2) / static_cast<double>(width - 2);
+  size_t a = 0;
+  for (size_t bucket = 0; bucket + 2 < width; ++bucket) {
+    // Average of the next bucket is the third point of the triangle.
+    size_t avg_start = static_cast<size_t>(std::floor((bucket + 1) * every)) + 1;
+    size_t avg_end = std::min(static_cast<size_t>(std::floor((bucket + 2) * every)) + 1, n);
+    double avg_x = 0.0;
+    double avg_y = 0.0;
+    size_t avg_count = 0;
+    for (size_t j = avg_start; j < avg_end; ++j) {
+      if (!std::isnan(y[j])) {
+        avg_x += x[j];
+        avg_y += y[j];
+        avg_count += 1;
+      }
+    }
+    if (avg_count > 0) {
+      avg_x /= static_cast<double>(avg_count);
+      avg_y /= static_cast<double>(avg_count);
+    } else {
+      avg_x = x[std::min(avg_start, n - 1)];
+      avg_y = y[a];
+    }
+
+    size_t range_start = static_cast<size_t>(std::floor(bucket * every)) + 1;
+    size_t range_end = static_cast<size_t>(std::floor((bucket + 1) * every)) + 1;
+    size_t next = range_start;
+    double max_area = -1.0;
+    for (size_t j = range_start; j < range_end; ++j) {
+      double area = std::fabs((x[a] - avg_x) * (y[j] - y[a]) - (x[a] - x[j]) * (avg_y - y[a]));
+      if (area > max_area) {
+        max_area = area;
+        next = j;
+      }
+    }
+    out->push_back(base + next);
+    a = next;
+  }
+  out->push_back(base + n - 1);
+}
+
+void MinMax(const double* x, const double* y, size_t n, size_t width, size_t base, std::vector<size_t>* out)
+{
+  double x0 = x[0];
+  double span = x[n - 1] - x0;
+  size_t i = 0;
+  for (size_t bucket = 0; bucket < width && i < n; ++bucket) {
+    double limit = bucket + 1 == width ? x[n - 1] : x0 + span * static_cast<double>(bucket + 1) / width;
+    size_t min_idx = n;
+    size_t max_idx = n;
+    for (; i < n && (x[i] < limit || (bucket + 1 == width && x[i] <= limit)); ++i) {
+      if (std::isnan(y[i])) {
+        continue;
+      }
+      if (min_idx == n || y[i] < y[min_idx]) {
+        min_idx = i;
+      }
+      if (max_idx == n || y[i] > y[max_idx]) {
+        max_idx = i;
+      }
+    }
+    if (min_idx == n) {
+      continue;
+    }
+    size_t first = std::min(min_idx, max_idx);
+    size_t second = std::max(min_idx, max_idx);
+    out->push_back(base + first);
+    if (second != first) {
+      out->push_back(base + second);
+    }
+  }
+}
+
+}  // namespace
+
+void DownsampleIndices(const double* x, const double* y, size_t n, const DownsampleOptions& options,
+                       std::vector<size_t>* out)
+{
+  size_t lo = static_cast<size_t>(std::lower_bound(x, x + n, options.start) - x);
+  size_t hi = static_cast<size_t>(std::upper_bound(x, x + n, options.end) - x);
+  if (hi <= lo) {
+    return;
+  }
+  size_t count = hi - lo;
+  if (options.method == DownsampleMethod::kMinMax && count > 2 * options.width) {
+    MinMax(x + lo, y + lo, count, options.width, lo, out);
+  } else if (options.method == DownsampleMethod::kLttb && count > options.width && options.width >= 3) {
+    Lttb(x + lo, y + lo, count, options.width, lo, out);
+  } else if (options.method == DownsampleMethod::kLttb && count > options.width) {
+    // Too narrow for a middle bucket: keep the ends LTTB always keeps.
+    out->push_back(lo);
+    if (options.width == 2) {
+      out->push_back(hi - 1);
+    }
+  } else {
+    for (size_t i = lo; i < hi; ++i) {
+      out->push_back(i);
+    }
+  }
+}
+
+bool ParseDownsampleOptions(napi_env env, napi_value value, DownsampleOptions* out)
+{
+  int width = static_cast<int>(out->width);
+  std::string method;
+  if (!GetOptionalInt(env, value, "width", &width) ||
+      !GetOptionalString(env, value, "method", &method) ||
+      !GetOptionalDouble(env, value, "start", &out->start) ||
+      !GetOptionalDouble(env, value, "end", &out->end)) {
+    return false;
+  }
+  if (width < 1) {
+    napi_throw_range_error(env, nullptr, "width must be at least 1");
+    return false;
+  }
+  out->width = static_cast<size_t>(width);
+  if (method.empty() || method == "lttb") {
+    out->method = DownsampleMethod::kLttb;
+  } else if (method == "minmax") {
+    out->method = DownsampleMethod::kMinMax;
+  } else {
+    napi_throw_type_error(env, nullptr, "method must be 'lttb' or 'minmax'");
+    return false;
+  }
+  return true;
+}
+
+napi_value MakeDownsampled(napi_env env, const double* x, const double* y, size_t n,
+                           const DownsampleOptions& options)
+{
+  std::vector<size_t> indices;
+  DownsampleIndices(x, y, n, options, &indices);
+  std::vector<double> out_x(indices.size());
+  std::vector<double> out_y(indices.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    out_x[i] = x[indices[i]];
+    out_y[i] = y[indices[i]];
+  }
+
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_set_named_property(env, result, "x", MakeFloat64Array(env, out_x)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "y", MakeFloat64Array(env, out_y)));
+  return result;
+}
+
+namespace {
+
+// downsample(x: Float64Array, y: Float64Array, options)
+napi_value Downsample(napi_env env, napi_callback_info info)
+{
+  size_t argc = 3;
+  napi_value args[3];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+  double* x = nullptr;
+  double* y = nullptr;
+  size_t x_len = 0;
+  size_t y_len = 0;
+  if (argc < 2 || !GetFloat64Array(env, args[0], &x, &x_len) || !GetFloat64Array(env, args[1], &y, &y_len)) {
+    napi_throw_type_error(env, nullptr, "downsample expects (x: Float64Array, y: Float64Array, options?)");
+    return nullptr;
+  }
+  if (x_len != y_len) {
+    napi_throw_range_error(env, nullptr, "x and y must have the same length");
+    return nullptr;
+  }
+
+  DownsampleOptions options;
+  if (!ParseDownsampleOptions(env, argc >= 3 ? args[2] : nullptr, &options)) {
+    return nullptr;
+  }
+  return MakeDownsampled(env, x, y, x_len, options);
+}
+
+}  // namespace
+
+napi_value RegisterDownsample(napi_env env, napi_value exports)
+{
+  napi_value fn = nullptr;
+  NAPI_CALL(env, napi_create_function(env, "downsample", NAPI_AUTO_LENGTH, Downsample, nullptr, &fn));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "downsample", fn));
+  return exports;
+}
+
+}  // namespace irsdk_node
@@ -0,0 +1,42 @@
+// Chart-oriented downsampling of long telemetry series: Largest-Triangle-
+// Three-Buckets and min/max per bucket.
+
+#ifndef IRSDK_NODE_DOWNSAMPLE_H_
+#define IRSDK_NODE_DOWNSAMPLE_H_
+
+#include <node_api.h>
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace irsdk_node {
+
+enum class DownsampleMethod {
+  kLttb,    // Exactly `width` points that keep the visual shape.
+  kMinMax,  // Minimum and maximum of each of `width` equal x-ranges.
+};
+
+struct DownsampleOptions {
+  size_t width = 1000;
+  DownsampleMethod method = DownsampleMethod::kLttb;
+  // Only points with start <= x <= end are considered; x must be ascending.
+  double start = -std::numeric_limits<double>::infinity();
+  double end = std::numeric_limits<double>::infinity();
+};
+
+// Append the indices of the points to keep, in ascending order. NaN values
+// are never chosen over real ones.
+void DownsampleIndices(const double* x, const double* y, size_t n, const DownsampleOptions& options,
+                       std::vector<size_t>* out);
+
+// Parse { width, method?, start?, end? }.
+bool ParseDownsampleOptions(napi_env env, napi_value value, DownsampleOptions* out);
+
+// Downsample x/y and return { x: Float64Array, y: Float64Array }.
+napi_value MakeDownsampled(napi_env env, const double* x, const double* y, size_t n,
+                           const DownsampleOptions& options);
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_DOWNSAMPLE_H_
@@ -0,0 +1,239 @@
+// Portable file helpers: UTF-8 paths on Windows and 64-bit offsets.
+
+#include "file_util.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <system_error>
+
+#include "byte_io.h"
+#include "checksum.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace irsdk_node {
+
+#ifdef _WIN32
+static std::wstring Widen(const std::string& text)
+{
+  int len = MultiByteToWideChar(CP_UTF8, 0, text.c_str(), static_cast<int>(text.size()), nullptr, 0);
+  std::wstring wide(static_cast<size_t>(len > 0 ? len : 0), L'\0');
+  if (len > 0) {
+    MultiByteToWideChar(CP_UTF8, 0, text.c_str(), static_cast<int>(text.size()), &wide[0], len);
+  }
+  return wide;
+}
+#endif
+
+std::FILE* OpenFile(const std::string& path, const char* mode)
+{
+#ifdef _WIN32
+  return _wfopen(Widen(path).c_str(), Widen(mode).c_str());
+#else
+  return std::fopen(path.c_str(), mode);
+#endif
+}
+
+bool SeekFile(std::FILE* file, int64_t offset)
+{
+#ifdef _WIN32
+  return _fseeki64(file, offset, SEEK_SET) == 0;
+#else
+  return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+int64_t TellFile(std::FILE* file)
+{
+#ifdef _WIN32
+  return _ftelli64(file);
+#else
+  return static_cast<int64_t>(ftello(file));
+#endif
+}
+
+int64_t FileSize(std::FILE* file)
+{
+#ifdef _WIN32
+  if (_fseeki64(file, 0, SEEK_END) != 0) {
+    return -1;
+  }
+#else
+  if (fseeko(file, 0, SEEK_END) != 0) {
+    return -1;
+  }
+#endif
+  return TellFile(file);
+}
+
+namespace {
+
+bool EndsWithNoCase(const std::string& text, const std::string& suffix)
+{
+  if (text.size() < suffix.size()) {
+    return false;
+  }
+  return std::equal(suffix.begin(), suffix.end(), text.end() - static_cast<std::ptrdiff_t>(suffix.size()),
+                    [](char a, char b) {
+                      return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+                    });
+}
+
+}  // namespace
+
+bool ListFiles(const std::string& dir, const std::string& extension, std::vector<ListedFile>* out,
+               std::string* error)
+{
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  fs::recursive_directory_iterator it(fs::u8path(dir), fs::directory_options::skip_permission_denied, ec);
+  if (ec) {
+    *error = "cannot list directory: " + dir;
+    return false;
+  }
+  out->clear();
+  for (fs::recursive_directory_iterator end; it != end; it.increment(ec)) {
+    if (ec) {
+      ec.clear();
+      continue;
+    }
+    const fs::directory_entry& entry = *it;
+    std::string path = entry.path().u8string();
+    if (!EndsWithNoCase(path, extension) || !entry.is_regular_file(ec)) {
+      continue;
+    }
+    ListedFile file;
+    file.path = path;
+    file.size = static_cast<int64_t>(entry.file_size(ec));
+    file.mtime = static_cast<int64_t>(entry.last_write_time(ec).time_since_epoch().count());
+    if (!ec) {
+      out->push_back(std::move(file));
+    }
+  }
+  std::sort(out->begin(), out->end(), [](const ListedFile& a, const ListedFile& b) { return a.path < b.path; });
+  return true;
+}
+
+bool FlushFile(std::FILE* file)
+{
+  if (std::fflush(file) != 0) {
+    return false;
+  }
+#ifdef _WIN32
+  return _commit(_fileno(file)) == 0;
+#else
+  return fsync(fileno(file)) == 0;
+#endif
+}
+
+bool RenameFile(const std::string& from, const std::string& to)
+{
+#ifdef _WIN32
+  return MoveFileExW(Widen(from).c_str(), Widen(to).c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+  return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+bool RemoveFile(const std::string& path)
+{
+#ifdef _WIN32
+  return DeleteFileW(Widen(path).c_str()) != 0;
+#else
+  return std::remove(path.c_str()) == 0;
+#endif
+}
+
+bool ReadAt(std::FILE* file, int64_t offset, char* out, size_t size)
+{
+  return SeekFile(file, offset) && std::fread(out, 1, size, file) == size;
+}
+
+bool ReadWholeFile(std::FILE* file, std::string* out)
+{
+  int64_t size = FileSize(file);
+  if (size < 0 || !SeekFile(file, 0)) {
+    return false;
+  }
+  out->assign(static_cast<size_t>(size), '\0');
+  return out->empty() || std::fread(&(*out)[0], 1, out->size(), file) == out->size();
+}
+
+bool WriteFileAtomically(const std::string& path, const std::string& data, std::string* error)
+{
+  std::string temp = path + ".tmp";
+  std::FILE* file = OpenFile(temp, "wb");
+  if (!file) {
+    *error = "cannot write " + temp;
+    return false;
+  }
+  bool written = std::fwrite(data.data(), 1, data.size(), file) == data.size() && FlushFile(file);
+  written = std::fclose(file) == 0 && written;
+  if (!written || !RenameFile(temp, path)) {
+    RemoveFile(temp);
+    *error = "cannot write " + path;
+    return false;
+  }
+  return true;
+}
+
+bool AppendToFile(const std::string& path, const std::string& data)
+{
+  std::FILE* file = OpenFile(path, "ab");
+  if (!file) {
+    return false;
+  }
+  bool written = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+  written = FlushFile(file) && written;
+  return std::fclose(file) == 0 && written;
+}
+
+std::string FrameRecord(const std::string& payload)
+{
+  std::string record;
+  Put<uint32_t>(&record, static_cast<uint32_t>(payload.size()));
+  Put<uint32_t>(&record, Crc32(payload.data(), payload.size()));
+  record.append(payload);
+  return record;
+}
+
+bool NextFramedRecord(const std::string& data, size_t* pos, const char** payload, uint32_t* length)
+{
+  Cursor cursor(data.data() + *pos, data.size() - *pos);
+  uint32_t crc = 0;
+  if (!cursor.Get(length) || !cursor.Get(&crc) || cursor.left() < *length) {
+    return false;
+  }
+  *payload = data.data() + *pos + kFrameHeaderBytes;
+  if (Crc32(*payload, *length) != crc) {
+    return false;
+  }
+  *pos += kFrameHeaderBytes + *length;
+  return true;
+}
+
+bool SkipToFramedRecord(const std::string& data, size_t* pos)
+{
+  const char* payload = nullptr;
+  uint32_t length = 0;
+  for (size_t next = *pos + 1; next + kFrameHeaderBytes <= data.size(); ++next) {
+    size_t at = next;
+    if (NextFramedRecord(data, &at, &payload, &length) && length > 0) {
+      *pos = next;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace irsdk_node
@@ -0,0 +1,72 @@
+// Portable file helpers: UTF-8 paths on Windows and 64-bit offsets.
+
+#ifndef IRSDK_NODE_FILE_UTIL_H_
+#define IRSDK_NODE_FILE_UTIL_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace irsdk_node {
+
+// fopen that accepts UTF-8 paths on every platform.
+std::FILE* OpenFile(const std::string& path, const char* mode);
+
+bool SeekFile(std::FILE* file, int64_t offset);
+int64_t TellFile(std::FILE* file);
+
+// Size of an open file in bytes, or -1 on error. Leaves the position at the end.
+int64_t FileSize(std::FILE* file);
+
+struct ListedFile {
+  std::string path;  // UTF-8.
+  int64_t size;
+  int64_t mtime;     // Opaque modification stamp, only for comparison.
+};
+
+// Regular files under dir, recursively, whose names end with extension
+// (case-insensitive), sorted by path. Unreadable subdirectories are skipped.
+bool ListFiles(const std::string& dir, const std::string& extension, std::vector<ListedFile>* out,
+               std::string* error);
+
+// Flush stdio buffers and ask the OS to put the data on disk.
+bool FlushFile(std::FILE* file);
+
+// Move from over to, replacing to atomically where the platform allows.
+bool RenameFile(const std::string& from, const std::string& to);
+
+bool RemoveFile(const std::string& path);
+
+// Read exactly size bytes at offset.
+bool ReadAt(std::FILE* file, int64_t offset, char* out, size_t size);
+
+// Read an open file from its start to its end.
+bool ReadWholeFile(std::FILE* file, std::string* out);
+
+// Write data to path + ".tmp", put it on disk and move it over path, so
+// readers find either the old contents or the new.
+bool WriteFileAtomically(const std::string& path, const std::string& data, std::string* error);
+
+// Append data to path and put it on disk. A failed append may leave part of
+// data behind.
+bool AppendToFile(const std::string& path, const std::string& data);
+
+// Journal records: the payload's length and CRC-32 as uint32, then the
+// payload.
+constexpr size_t kFrameHeaderBytes = 8;
+
+std::string FrameRecord(const std::string& payload);
+
+// Take the record at *pos of data and move past it. Returns false at the end
+// of data, or at a record cut short or damaged, leaving *pos there.
+bool NextFramedRecord(const std::string& data, size_t* pos, const char** payload, uint32_t* length);
+
+// Move *pos past damaged bytes to the next intact record. Empty records are
+// skipped too, as any run of zeros would pass for one. Returns false, leaving
+// *pos there, when no intact record follows.
+bool SkipToFramedRecord(const std::string& data, size_t* pos);
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_FILE_UTIL_H_
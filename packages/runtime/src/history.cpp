@@ -0,0 +1,290 @@
+// Ring buffers of recent live telemetry, keyed by SessionTime.
+
+#include "history.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include "bindings.h"
+#include "csv_export.h"
+#include "downsample.h"
+#include "napi_util.h"
+
+namespace irsdk_node {
+
+History::History(std::vector<std::string> channels, size_t capacity)
+    : names_(std::move(channels)),
+      capacity_(std::max<size_t>(2, capacity))
+{
+  for (const std::string& name : names_) {
+    vars_.emplace_back(name);
+  }
+  values_.resize(names_.size());
+}
+
+void History::Clear()
+{
+  start_ = 0;
+  size_ = 0;
+  times_.clear();
+  for (std::vector<double>& column : values_) {
+    column.clear();
+  }
+  last_session_tick_ = -1;
+}
+
+void History::OnTick(const TelemetrySource& source, const TickStamp& stamp)
+{
+  if (size_ > 0 && stamp.session_tick == last_session_tick_) {
+    return;
+  }
+  // Keep times ascending: a new session starts a new history.
+  if (size_ > 0 && stamp.session_time < times_[Physical(size_ - 1)]) {
+    Clear();
+  }
+  last_session_tick_ = stamp.session_tick;
+
+  size_t slot = 0;
+  if (size_ < capacity_) {
+    slot = size_;
+    times_.push_back(0.0);
+    for (std::vector<double>& column : values_) {
+      column.push_back(0.0);
+    }
+    size_ += 1;
+  } else {
+    slot = start_;
+    start_ = (start_ + 1) % capacity_;
+  }
+
+  times_[slot] = stamp.session_time;
+  for (size_t i = 0; i < vars_.size(); ++i) {
+    values_[i][slot] = vars_[i].Resolve(source) ? vars_[i].Get(source) : std::numeric_limits<double>::quiet_NaN();
+  }
+}
+
+bool History::Series(const std::string& name, std::vector<double>* times, std::vector<double>* values) const
+{
+  if (!Values(name, values)) {
+    return false;
+  }
+  Times(times);
+  return true;
+}
+
+void History::Times(std::vector<double>* times) const
+{
+  times->resize(size_);
+  for (size_t i = 0; i < size_; ++i) {
+    (*times)[i] = times_[Physical(i)];
+  }
+}
+
+bool History::Values(const std::string& name, std::vector<double>* values) const
+{
+  auto it = std::find(names_.begin(), names_.end(), name);
+  if (it == names_.end()) {
+    return false;
+  }
+  const std::vector<double>& column = values_[static_cast<size_t>(it - names_.begin())];
+  values->resize(size_);
+  for (size_t i = 0; i < size_; ++i) {
+    (*values)[i] = column[Physical(i)];
+  }
+  return true;
+}
+
+namespace {
+
+// JS wrapper that keeps the history attached to the live tick stream until
+// close() or garbage collection.
+struct HistoryHandle {
+  std::unique_ptr<History> history;
+  bool attached = false;
+
+  void Detach()
+  {
+    if (attached) {
+      TickHub::Instance().Remove(history.get());
+      attached = false;
+    }
+  }
+};
+
+void FinalizeHistory(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  HistoryHandle* handle = static_cast<HistoryHandle*>(data);
+  handle->Detach();
+  delete handle;
+}
+
+napi_value HistoryConstructor(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value self = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+  napi_value options = argc >= 1 ? args[0] : nullptr;
+  napi_value channels_value = nullptr;
+  if (!GetOptionalProperty(env, options, "channels", &channels_value)) {
+    napi_throw_type_error(env, nullptr, "History expects ({ channels, capacity? })");
+    return nullptr;
+  }
+  std::vector<std::string> channels;
+  if (!GetStringArray(env, channels_value, &channels)) {
+    return nullptr;
+  }
+  // One hour at 60 Hz.
+  int capacity = 216000;
+  if (!GetOptionalInt(env, options, "capacity", &capacity)) {
+    return nullptr;
+  }
+
+  auto* handle = new HistoryHandle();
+  handle->history.reset(new History(std::move(channels), static_cast<size_t>(std::max(2, capacity))));
+  napi_status status = napi_wrap(env, self, handle, FinalizeHistory, nullptr, nullptr);
+  if (status != napi_ok) {
+    delete handle;
+    CheckNapi(env, status);
+    return nullptr;
+  }
+
+  TickHub::Instance().Add(handle->history.get());
+  handle->attached = true;
+  return self;
+}
+
+napi_value HistoryGetSeries(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  HistoryHandle* handle = UnwrapThis<HistoryHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  std::string name;
+  if (argc < 1 || !GetString(env, args[0], &name)) {
+    napi_throw_type_error(env, nullptr, "getSeries expects (name)");
+    return nullptr;
+  }
+
+  std::vector<double> times;
+  std::vector<double> values;
+  if (!handle->history->Series(name, &times, &values)) {
+    return GetNull(env);
+  }
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_set_named_property(env, result, "time", MakeFloat64Array(env, times)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "values", MakeFloat64Array(env, values)));
+  return result;
+}
+
+napi_value HistoryDownsample(napi_env env, napi_callback_info info)
+{
+  size_t argc = 2;
+  napi_value args[2];
+  HistoryHandle* handle = UnwrapThis<HistoryHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  std::string name;
+  if (argc < 1 || !GetString(env, args[0], &name)) {
+    napi_throw_type_error(env, nullptr, "downsample expects (name, { width, method?, start?, end? })");
+    return nullptr;
+  }
+  DownsampleOptions options;
+  if (!ParseDownsampleOptions(env, argc >= 2 ? args[1] : nullptr, &options)) {
+    return nullptr;
+  }
+
+  std::vector<double> times;
+  std::vector<double> values;
+  if (!handle->history->Series(name, &times, &values)) {
+    return GetNull(env);
+  }
+  return MakeDownsampled(env, times.data(), values.data(), times.size(), options);
+}
+
+napi_value HistoryExportCsv(napi_env env, napi_callback_info info)
+{
+  size_t argc = 2;
+  napi_value args[2];
+  HistoryHandle* handle = UnwrapThis<HistoryHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  std::string out_path;
+  if (argc < 1 || !GetString(env, args[0], &out_path)) {
+    napi_throw_type_error(env, nullptr, "exportCsv expects (path[, options])");
+    return nullptr;
+  }
+  CsvExportOptions options;
+  if (!ParseCsvExportOptions(env, argc >= 2 ? args[1] : nullptr, &options)) {
+    return nullptr;
+  }
+
+  CsvExportStats stats;
+  std::string error;
+  if (!ExportHistoryCsv(*handle->history, out_path, options, &stats, &error)) {
+    napi_throw_error(env, nullptr, error.c_str());
+    return nullptr;
+  }
+  return MakeCsvExportStats(env, stats);
+}
+
+napi_value HistoryGetSize(napi_env env, napi_callback_info info)
+{
+  HistoryHandle* handle = UnwrapThis<HistoryHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  return MakeDouble(env, static_cast<double>(handle->history->size()));
+}
+
+napi_value HistoryClear(napi_env env, napi_callback_info info)
+{
+  HistoryHandle* handle = UnwrapThis<HistoryHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  handle->history->Clear();
+  return GetUndefined(env);
+}
+
+napi_value HistoryClose(napi_env env, napi_callback_info info)
+{
+  HistoryHandle* handle = UnwrapThis<HistoryHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  handle->Detach();
+  return GetUndefined(env);
+}
+
+}  // namespace
+
+napi_value RegisterHistory(napi_env env, napi_value exports)
+{
+  napi_property_descriptor methods[] = {
+    {"getSeries", nullptr, HistoryGetSeries, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"downsample", nullptr, HistoryDownsample, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"exportCsv", nullptr, HistoryExportCsv, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getSize", nullptr, HistoryGetSize, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"clear", nullptr, HistoryClear, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"close", nullptr, HistoryClose, nullptr, nullptr, nullptr, napi_default, nullptr}
+  };
+
+  napi_value constructor = nullptr;
+  NAPI_CALL(env, napi_define_class(env, "History", NAPI_AUTO_LENGTH, HistoryConstructor, nullptr,
+                                   sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "History", constructor));
+  return exports;
+}
+
+}  // namespace irsdk_node
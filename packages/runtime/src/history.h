@@ -0,0 +1,49 @@
+// Ring buffers of recent live telemetry, keyed by SessionTime.
+
+#ifndef IRSDK_NODE_HISTORY_H_
+#define IRSDK_NODE_HISTORY_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "telemetry_source.h"
+#include "tick_hub.h"
+
+namespace irsdk_node {
+
+class History : public TickListener {
+ public:
+  // Storage grows with the data up to `capacity` ticks, then wraps.
+  History(std::vector<std::string> channels, size_t capacity);
+
+  void OnTick(const TelemetrySource& source, const TickStamp& stamp) override;
+
+  size_t size() const { return size_; }
+  void Clear();
+
+  // Copy a channel and its times in chronological order. Returns false for
+  // channels the history does not record.
+  bool Series(const std::string& name, std::vector<double>* times, std::vector<double>* values) const;
+
+  // The series' parts on their own, in the same order.
+  const std::vector<std::string>& channels() const { return names_; }
+  void Times(std::vector<double>* times) const;
+  bool Values(const std::string& name, std::vector<double>* values) const;
+
+ private:
+  size_t Physical(size_t index) const { return (start_ + index) % capacity_; }
+
+  std::vector<std::string> names_;
+  std::vector<VarHandle> vars_;
+  size_t capacity_;
+  size_t start_ = 0;
+  size_t size_ = 0;
+  std::vector<double> times_;
+  std::vector<std::vector<double>> values_;
+  int last_session_tick_ = -1;
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_HISTORY_H_
@@ -0,0 +1,616 @@
+// Alignment of several .ibt files of one session onto a shared grid.
+
+#include "ibt_align.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "async_job.h"
+#include "bindings.h"
+#include "ibt_file.h"
+#include "irsdk_defines.h"
+#include "napi_util.h"
+
+namespace irsdk_node {
+
+namespace {
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+// Same tolerance as the resampler's grid.
+constexpr double kGridEpsilon = 1e-9;
+
+// Time alignments longer than this many rows are refused.
+constexpr double kMaxRows = 1 << 26;
+
+// LapDistPct between these is unambiguous about which lap it belongs to;
+// near the line the Lap counter and the distance do not change together.
+constexpr double kMidLapLow = 0.1;
+constexpr double kMidLapHigh = 0.9;
+
+// Run task(i) for every file on up to `threads` workers. Returns the error
+// of the first failing file in path order.
+bool ForEachFile(size_t count, int threads, const std::function<bool(size_t i, std::string* error)>& task,
+                 std::string* error)
+{
+  size_t workers = threads > 0 ? static_cast<size_t>(threads) : std::max(1u, std::thread::hardware_concurrency());
+  workers = std::max<size_t>(1, std::min(workers, count));
+  std::vector<std::string> errors(count);
+  std::vector<char> failed(count, 0);
+  std::atomic<size_t> next{0};
+  auto work = [&]() {
+    for (size_t i = next++; i < count; i = next++) {
+      failed[i] = task(i, &errors[i]) ? 0 : 1;
+    }
+  };
+  std::vector<std::thread> pool;
+  for (size_t i = 1; i < workers; ++i) {
+    pool.emplace_back(work);
+  }
+  work();
+  for (std::thread& thread : pool) {
+    thread.join();
+  }
+  for (size_t i = 0; i < count; ++i) {
+    if (failed[i]) {
+      *error = errors[i];
+      return false;
+    }
+  }
+  return true;
+}
+
+// Folds the progress of files decoded side by side into one count of files
+// for the job's control.
+class FileProgress {
+ public:
+  FileProgress(JobControl* control, size_t files) : control_(control), fractions_(files, 0.0)
+  {
+    for (size_t i = 0; i < files; ++i) {
+      shares_.push_back(Share(this, i));
+    }
+  }
+
+  // Control for file i, or null when the job is not observed.
+  JobControl* file(size_t i) { return control_ ? &shares_[i] : nullptr; }
+
+ private:
+  class Share : public JobControl {
+   public:
+    Share(FileProgress* owner, size_t index) : owner_(owner), index_(index) {}
+    bool Update(double done, double total) override
+    {
+      return owner_->Set(index_, total > 0.0 ? done / total : 1.0);
+    }
+
+   private:
+    FileProgress* owner_;
+    size_t index_;
+  };
+
+  bool Set(size_t index, double fraction)
+  {
+    double sum = 0.0;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      sum_ += fraction - fractions_[index];
+      fractions_[index] = fraction;
+      sum = sum_;
+    }
+    return control_->Update(sum, static_cast<double>(fractions_.size()));
+  }
+
+  JobControl* control_;
+  std::mutex mutex_;
+  std::vector<double> fractions_;
+  double sum_ = 0.0;
+  std::vector<Share> shares_;
+};
+
+bool IsBlendable(int type)
+{
+  return type == irsdk_float || type == irsdk_double;
+}
+
+// Resample the channels a file carries onto the shared time grid. column_of
+// maps each requested channel to its offset in the series row, or -1.
+bool ResampleFile(const std::string& path,
+                  const AlignOptions& options,
+                  ResampledSeries* series,
+                  std::vector<int>* column_of,
+                  std::string* error,
+                  JobControl* control)
+{
+  IbtFile file;
+  if (!file.Open(path, error)) {
+    return false;
+  }
+  ResampleOptions present = options.resample;
+  present.channels.clear();
+  std::vector<size_t> requested;
+  for (size_t i = 0; i < options.resample.channels.size(); ++i) {
+    if (file.FindVar(options.resample.channels[i].name) >= 0) {
+      present.channels.push_back(options.resample.channels[i]);
+      requested.push_back(i);
+    }
+  }
+  present.drop_gaps = false;
+  if (!ResampleIbt(file, present, series, error, control)) {
+    *error = path + ": " + *error;
+    return false;
+  }
+  column_of->assign(options.resample.channels.size(), -1);
+  for (size_t i = 0; i < requested.size(); ++i) {
+    (*column_of)[requested[i]] = static_cast<int>(series->offsets[i]);
+  }
+  return true;
+}
+
+bool AlignByTime(const std::vector<std::string>& paths, const AlignOptions& options, AlignedFrame* out,
+                 std::string* error, FileProgress* progress)
+{
+  const size_t files = paths.size();
+  const double rate = options.resample.rate_hz;
+  std::vector<ResampledSeries> series(files);
+  std::vector<std::vector<int>> column_of(files);
+  auto resample = [&](size_t i, std::string* file_error) {
+    return ResampleFile(paths[i], options, &series[i], &column_of[i], file_error, progress->file(i));
+  };
+  if (!ForEachFile(files, options.threads, resample, error)) {
+    return false;
+  }
+
+  // The grid spans every file unless narrowed by start/end. Grid points are
+  // k / rate for integer k, the same points each file was resampled onto.
+  double low = std::numeric_limits<double>::infinity();
+  double high = -std::numeric_limits<double>::infinity();
+  for (size_t i = 0; i < files; ++i) {
+    AlignedFile& file = out->files[i];
+    if (series[i].rows() > 0) {
+      file.start = series[i].times.front();
+      file.end = series[i].times.back();
+      low = std::min(low, file.start);
+      high = std::max(high, file.end);
+    }
+  }
+  low = std::max(low, options.start);
+  high = std::min(high, options.end);
+  int64_t first_k = 0;
+  size_t rows = 0;
+  if (low <= high) {
+    first_k = static_cast<int64_t>(std::ceil(low * rate - kGridEpsilon));
+    int64_t last_k = static_cast<int64_t>(std::floor(high * rate + kGridEpsilon));
+    if (static_cast<double>(last_k - first_k + 1) > kMaxRows) {
+      *error = "alignment range is too long for rateHz";
+      return false;
+    }
+    rows = last_k >= first_k ? static_cast<size_t>(last_k - first_k + 1) : 0;
+  }
+  out->x.resize(rows);
+  for (size_t row = 0; row < rows; ++row) {
+    out->x[row] = static_cast<double>(first_k + static_cast<int64_t>(row)) / rate;
+  }
+
+  // Scatter each file's rows into its columns; grid points the file does not
+  // cover stay NaN.
+  auto scatter = [&](size_t i, std::string* file_error) {
+    (void)file_error;
+    AlignedFile& file = out->files[i];
+    const ResampledSeries& rows_in = series[i];
+    for (size_t c = 0; c < column_of[i].size(); ++c) {
+      if (column_of[i][c] >= 0) {
+        file.columns[c].assign(rows, kNaN);
+      }
+    }
+    for (size_t r = 0; r < rows_in.rows(); ++r) {
+      int64_t row = std::llround(rows_in.times[r] * rate) - first_k;
+      if (row < 0 || static_cast<size_t>(row) >= rows) {
+        continue;
+      }
+      const double* values = rows_in.values.data() + r * rows_in.width;
+      for (size_t c = 0; c < column_of[i].size(); ++c) {
+        if (column_of[i][c] >= 0) {
+          file.columns[c][static_cast<size_t>(row)] = values[column_of[i][c]];
+        }
+      }
+    }
+    std::vector<double>().swap(series[i].values);
+    return true;
+  };
+  return ForEachFile(files, options.threads, scatter, error);
+}
+
+// Position of gx among ascending xs: the bracketing index and fraction.
+// Returns false outside the samples.
+bool Locate(const std::vector<double>& xs, double gx, size_t* index, double* fraction)
+{
+  auto it = std::upper_bound(xs.begin(), xs.end(), gx);
+  if (it == xs.begin()) {
+    return false;
+  }
+  size_t j = static_cast<size_t>(it - xs.begin()) - 1;
+  if (j + 1 >= xs.size()) {
+    if (xs[j] != gx) {
+      return false;
+    }
+    *index = j;
+    *fraction = 0.0;
+    return true;
+  }
+  *index = j;
+  *fraction = (gx - xs[j]) / (xs[j + 1] - xs[j]);
+  return true;
+}
+
+// Align one lap of a file on distance. LapDistPct is unwrapped across the
+// laps either side of the chosen one so the grid can interpolate over the
+// line, then mapped so the chosen lap runs from 0 to 1.
+bool AlignFileByDistance(const std::string& path,
+                         int lap,
+                         const AlignOptions& options,
+                         const std::vector<double>& grid,
+                         AlignedFile* out,
+                         std::string* error,
+                         JobControl* control)
+{
+  IbtFile file;
+  if (!file.Open(path, error)) {
+    return false;
+  }
+  int time_idx = file.FindVar("SessionTime");
+  int lap_idx = file.FindVar("Lap");
+  int pct_idx = file.FindVar("LapDistPct");
+  if (time_idx < 0 || lap_idx < 0 || pct_idx < 0) {
+    *error = path + ": distance alignment needs SessionTime, Lap and LapDistPct";
+    return false;
+  }
+
+  const std::vector<ChannelSpec>& channels = options.resample.channels;
+  std::vector<int> vars;
+  std::vector<bool> hold;
+  for (const ChannelSpec& channel : channels) {
+    int idx = file.FindVar(channel.name);
+    vars.push_back(idx);
+    hold.push_back(idx < 0 || options.resample.mode == ResampleMode::kHold ||
+                   !IsBlendable(file.vars()[idx].type));
+  }
+  const size_t width = channels.size();
+
+  // Samples from the first run of records around the lap, in record order.
+  std::vector<double> totals;
+  std::vector<double> times;
+  std::vector<double> values;
+  int wraps = 0;
+  double prev_pct = kNaN;
+  int lap_wraps = 0;
+  bool seen = false;
+  bool ok = ForEachIbtRecord(file, 0, file.record_count(), [&](const IbtRecordSource& source, int index) {
+    (void)index;
+    int current = source.GetInt(lap_idx, 0, -1);
+    int64_t from_lap = static_cast<int64_t>(current) - lap;
+    if (from_lap < -1 || from_lap > 1) {
+      if (seen) {
+        return false;
+      }
+      // A run that never reached the lap, e.g. an earlier session.
+      totals.clear();
+      times.clear();
+      values.clear();
+      prev_pct = kNaN;
+      return true;
+    }
+    double pct = source.GetDouble(pct_idx, 0);
+    if (!(pct >= 0.0 && pct <= 1.0)) {
+      return true;  // Not in the world.
+    }
+    if (!std::isnan(prev_pct)) {
+      if (pct - prev_pct < -0.5) {
+        ++wraps;
+      } else if (pct - prev_pct > 0.5) {
+        --wraps;
+      }
+    }
+    prev_pct = pct;
+    if (current == lap && !seen && pct > kMidLapLow && pct < kMidLapHigh) {
+      lap_wraps = wraps;
+      seen = true;
+    }
+    totals.push_back(wraps + pct);
+    times.push_back(source.GetDouble(time_idx, 0));
+    for (size_t c = 0; c < width; ++c) {
+      values.push_back(vars[c] >= 0 ? source.GetDouble(vars[c], 0) : kNaN);
+    }
+    return true;
+  }, control);
+  if (!ok) {
+    *error = path + ": failed to read records";
+    return false;
+  }
+  if (!seen) {
+    *error = path + ": lap " + std::to_string(lap) + " not found";
+    return false;
+  }
+
+  // Keep the samples that advance along the lap, dropping resets and
+  // reversing.
+  std::vector<double> xs;
+  std::vector<size_t> kept;
+  for (size_t i = 0; i < totals.size(); ++i) {
+    double x = totals[i] - lap_wraps;
+    if (x > -0.5 && x < 1.5 && (xs.empty() || x > xs.back())) {
+      xs.push_back(x);
+      kept.push_back(i);
+    }
+  }
+
+  const double max_gap = options.resample.max_gap_s;
+  auto time_at = [&](double gx) {
+    size_t j = 0;
+    double fraction = 0.0;
+    if (!Locate(xs, gx, &j, &fraction)) {
+      return kNaN;
+    }
+    if (fraction == 0.0) {
+      return times[kept[j]];
+    }
+    double t0 = times[kept[j]];
+    double t1 = times[kept[j + 1]];
+    return t1 - t0 > max_gap ? kNaN : t0 + (t1 - t0) * fraction;
+  };
+  out->start = time_at(0.0);
+  out->end = time_at(1.0);
+
+  out->time.assign(grid.size(), kNaN);
+  for (size_t c = 0; c < width; ++c) {
+    if (vars[c] >= 0) {
+      out->columns[c].assign(grid.size(), kNaN);
+    }
+  }
+  for (size_t g = 0; g < grid.size(); ++g) {
+    size_t j = 0;
+    double fraction = 0.0;
+    if (!Locate(xs, grid[g], &j, &fraction)) {
+      continue;
+    }
+    const double* a = values.data() + kept[j] * width;
+    if (fraction == 0.0) {
+      out->time[g] = times[kept[j]] - out->start;
+      for (size_t c = 0; c < width; ++c) {
+        if (vars[c] >= 0) {
+          out->columns[c][g] = a[c];
+        }
+      }
+      continue;
+    }
+    double t0 = times[kept[j]];
+    double t1 = times[kept[j + 1]];
+    if (t1 - t0 > max_gap) {
+      continue;  // Do not interpolate across a recording gap.
+    }
+    const double* b = values.data() + kept[j + 1] * width;
+    out->time[g] = t0 + (t1 - t0) * fraction - out->start;
+    for (size_t c = 0; c < width; ++c) {
+      if (vars[c] >= 0) {
+        out->columns[c][g] = hold[c] ? a[c] : BlendChannel(channels[c].kind, a[c], b[c], fraction);
+      }
+    }
+  }
+  return true;
+}
+
+bool AlignByDistance(const std::vector<std::string>& paths, const AlignOptions& options, AlignedFrame* out,
+                     std::string* error, FileProgress* progress)
+{
+  if (options.laps.size() != paths.size()) {
+    *error = "distance alignment needs one lap per file";
+    return false;
+  }
+  out->x.resize(static_cast<size_t>(options.points));
+  for (int i = 0; i < options.points; ++i) {
+    out->x[static_cast<size_t>(i)] = static_cast<double>(i) / options.points;
+  }
+  auto align = [&](size_t i, std::string* file_error) {
+    JobControl* control = progress->file(i);
+    if (!AlignFileByDistance(paths[i], options.laps[i], options, out->x, &out->files[i], file_error, control)) {
+      return false;
+    }
+    // The lap usually ends well before the file does.
+    return !control || control->Update(1.0, 1.0);
+  };
+  return ForEachFile(paths.size(), options.threads, align, error);
+}
+
+}  // namespace
+
+bool AlignIbtFiles(const std::vector<std::string>& paths, const AlignOptions& options, AlignedFrame* out,
+                   std::string* error, JobControl* control)
+{
+  *out = AlignedFrame();
+  out->by = options.by;
+  for (const ChannelSpec& channel : options.resample.channels) {
+    out->names.push_back(channel.name);
+  }
+  out->files.resize(paths.size());
+  for (size_t i = 0; i < paths.size(); ++i) {
+    out->files[i].path = paths[i];
+    out->files[i].columns.resize(options.resample.channels.size());
+  }
+  FileProgress progress(control, paths.size());
+  return options.by == AlignBy::kTime ? AlignByTime(paths, options, out, error, &progress)
+                                      : AlignByDistance(paths, options, out, error, &progress);
+}
+
+namespace {
+
+napi_value MakeAlignedFrame(napi_env env, const AlignedFrame& frame)
+{
+  napi_value result = nullptr;
+  napi_value files = nullptr;
+  napi_value columns = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_create_array_with_length(env, frame.files.size(), &files));
+  NAPI_CALL(env, napi_create_object(env, &columns));
+
+  for (size_t i = 0; i < frame.files.size(); ++i) {
+    const AlignedFile& file = frame.files[i];
+    napi_value entry = nullptr;
+    NAPI_CALL(env, napi_create_object(env, &entry));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "path", MakeString(env, file.path)));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "start", MakeDouble(env, file.start)));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "end", MakeDouble(env, file.end)));
+    if (frame.by == AlignBy::kDistance) {
+      NAPI_CALL(env, napi_set_named_property(env, entry, "lapTime", MakeDouble(env, file.end - file.start)));
+      NAPI_CALL(env, napi_set_named_property(env, entry, "time", MakeFloat64Array(env, file.time)));
+    }
+    NAPI_CALL(env, napi_set_element(env, files, static_cast<uint32_t>(i), entry));
+  }
+
+  for (size_t c = 0; c < frame.names.size(); ++c) {
+    napi_value per_file = nullptr;
+    NAPI_CALL(env, napi_create_array_with_length(env, frame.files.size(), &per_file));
+    for (size_t i = 0; i < frame.files.size(); ++i) {
+      const std::vector<double>& column = frame.files[i].columns[c];
+      // Columns of carried channels always have a row per grid point.
+      bool missing = column.empty() && !frame.x.empty();
+      NAPI_CALL(env, napi_set_element(env, per_file, static_cast<uint32_t>(i),
+                                      missing ? GetNull(env) : MakeFloat64Array(env, column)));
+    }
+    NAPI_CALL(env, napi_set_named_property(env, columns, frame.names[c].c_str(), per_file));
+  }
+
+  NAPI_CALL(env, napi_set_named_property(env, result, "by",
+                                         MakeString(env, frame.by == AlignBy::kTime ? "time" : "distance")));
+  NAPI_CALL(env, napi_set_named_property(env, result, "x", MakeFloat64Array(env, frame.x)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "files", files));
+  NAPI_CALL(env, napi_set_named_property(env, result, "columns", columns));
+  return result;
+}
+
+// alignIbt(paths, { channels, by?, rateHz?, mode?, maxGapS?, start?, end?, laps?, points?, threads? })
+bool ParseAlignArgs(napi_env env, size_t argc, napi_value* args, std::vector<std::string>* paths,
+                    AlignOptions* options)
+{
+  if (argc < 2) {
+    napi_throw_type_error(env, nullptr, "alignIbt expects (paths, { channels, by?, ... })");
+    return false;
+  }
+  if (!GetStringArray(env, args[0], paths) || !ParseResampleOptions(env, args[1], &options->resample)) {
+    return false;
+  }
+
+  std::string by;
+  napi_value laps_value = nullptr;
+  if (!GetOptionalString(env, args[1], "by", &by) ||
+      !GetOptionalDouble(env, args[1], "start", &options->start) ||
+      !GetOptionalDouble(env, args[1], "end", &options->end) ||
+      !GetOptionalInt(env, args[1], "points", &options->points) ||
+      !GetOptionalInt(env, args[1], "threads", &options->threads)) {
+    return false;
+  }
+  if (by.empty() || by == "time") {
+    options->by = AlignBy::kTime;
+  } else if (by == "distance") {
+    options->by = AlignBy::kDistance;
+  } else {
+    napi_throw_type_error(env, nullptr, "by must be 'time' or 'distance'");
+    return false;
+  }
+  if (GetOptionalProperty(env, args[1], "laps", &laps_value)) {
+    bool is_array = false;
+    uint32_t length = 0;
+    if (!CheckNapi(env, napi_is_array(env, laps_value, &is_array))) {
+      return false;
+    }
+    if (!is_array) {
+      napi_throw_type_error(env, nullptr, "laps must be an array of lap numbers");
+      return false;
+    }
+    if (!CheckNapi(env, napi_get_array_length(env, laps_value, &length))) {
+      return false;
+    }
+    for (uint32_t i = 0; i < length; ++i) {
+      napi_value element = nullptr;
+      int32_t lap = 0;
+      if (!CheckNapi(env, napi_get_element(env, laps_value, i, &element))) {
+        return false;
+      }
+      if (napi_get_value_int32(env, element, &lap) != napi_ok) {
+        napi_throw_type_error(env, nullptr, "laps must be an array of lap numbers");
+        return false;
+      }
+      options->laps.push_back(lap);
+    }
+  }
+  if (options->by == AlignBy::kDistance && options->laps.size() != paths->size()) {
+    napi_throw_type_error(env, nullptr, "distance alignment needs laps with one lap number per file");
+    return false;
+  }
+  if (options->points < 2) {
+    napi_throw_range_error(env, nullptr, "points must be at least 2");
+    return false;
+  }
+  return true;
+}
+
+napi_value AlignIbt(napi_env env, napi_callback_info info)
+{
+  size_t argc = 2;
+  napi_value args[2];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+  std::vector<std::string> paths;
+  AlignOptions options;
+  if (!ParseAlignArgs(env, argc, args, &paths, &options)) {
+    return nullptr;
+  }
+
+  AlignedFrame frame;
+  std::string error;
+  if (!AlignIbtFiles(paths, options, &frame, &error)) {
+    napi_throw_error(env, nullptr, error.c_str());
+    return nullptr;
+  }
+  return MakeAlignedFrame(env, frame);
+}
+
+// alignIbtAsync(paths, { ..., signal?, onProgress? }) aligns on the thread
+// pool, reporting progress in files.
+napi_value AlignIbtAsync(napi_env env, napi_callback_info info)
+{
+  size_t argc = 2;
+  napi_value args[2];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+  auto paths = std::make_shared<std::vector<std::string>>();
+  auto options = std::make_shared<AlignOptions>();
+  if (!ParseAlignArgs(env, argc, args, paths.get(), options.get())) {
+    return nullptr;
+  }
+
+  auto frame = std::make_shared<AlignedFrame>();
+  JobExecute execute = [paths, options, frame](JobControl* control, std::string* error) {
+    return AlignIbtFiles(*paths, *options, frame.get(), error, control);
+  };
+  JobComplete complete = [frame](napi_env env, bool ok) -> napi_value {
+    return ok ? MakeAlignedFrame(env, *frame) : nullptr;
+  };
+  return QueueJob(env, "alignIbtAsync", nullptr, args[1], execute, complete);
+}
+
+}  // namespace
+
+napi_value RegisterIbtAlign(napi_env env, napi_value exports)
+{
+  napi_value fn = nullptr;
+  NAPI_CALL(env, napi_create_function(env, "alignIbt", NAPI_AUTO_LENGTH, AlignIbt, nullptr, &fn));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "alignIbt", fn));
+  NAPI_CALL(env, napi_create_function(env, "alignIbtAsync", NAPI_AUTO_LENGTH, AlignIbtAsync, nullptr, &fn));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "alignIbtAsync", fn));
+  return exports;
+}
+
+}  // namespace irsdk_node
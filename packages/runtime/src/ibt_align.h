@@ -0,0 +1,59 @@
+// Alignment of several .ibt files of one session onto a shared grid, either
+// SessionTime or distance around a chosen lap, for comparing drivers. Each
+// file is decoded on its own worker into the frame's columns.
+
+#ifndef IRSDK_NODE_IBT_ALIGN_H_
+#define IRSDK_NODE_IBT_ALIGN_H_
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "job_control.h"
+#include "resampler.h"
+
+namespace irsdk_node {
+
+enum class AlignBy {
+  kTime,      // SessionTime, on the resampler's grid.
+  kDistance,  // Fraction of a lap, one chosen lap per file.
+};
+
+struct AlignOptions {
+  // Channels, rate and gap handling; rate_hz only applies to time alignment.
+  ResampleOptions resample;
+  AlignBy by = AlignBy::kTime;
+  // SessionTime range of a time alignment; defaults to every file's span.
+  double start = -std::numeric_limits<double>::infinity();
+  double end = std::numeric_limits<double>::infinity();
+  std::vector<int> laps;  // Distance alignment: the Lap to use from each file.
+  int points = 1000;      // Distance alignment: grid points per lap.
+  int threads = 0;        // 0 picks one per core.
+};
+
+struct AlignedFile {
+  std::string path;
+  // SessionTime span covered: the whole file, or the chosen lap.
+  double start = std::numeric_limits<double>::quiet_NaN();
+  double end = std::numeric_limits<double>::quiet_NaN();
+  // Distance alignment: seconds into the lap at each grid point.
+  std::vector<double> time;
+  // One per channel, holding entry 0 of array variables; empty when the
+  // file does not carry the channel.
+  std::vector<std::vector<double>> columns;
+};
+
+struct AlignedFrame {
+  AlignBy by = AlignBy::kTime;
+  std::vector<double> x;  // SessionTime or lap fraction of each row.
+  std::vector<std::string> names;
+  std::vector<AlignedFile> files;
+};
+
+// Progress is reported in files, counting partly decoded ones by fraction.
+bool AlignIbtFiles(const std::vector<std::string>& paths, const AlignOptions& options, AlignedFrame* out,
+                   std::string* error, JobControl* control = nullptr);
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_IBT_ALIGN_H_
@@ -0,0 +1,874 @@
+// Index over a directory tree of .ibt files.
+
+#include "ibt_catalog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+
+#include "async_job.h"
+#include "bindings.h"
+#include "byte_io.h"
+#include "checksum.h"
+#include "file_util.h"
+#include "ibt_file.h"
+#include "napi_util.h"
+#include "session_yaml.h"
+#include "tick_clock.h"
+
+namespace irsdk_node {
+
+namespace {
+
+constexpr char kMagic[8] = {'I', 'R', 'S', 'D', 'K', 'C', 'A', 'T'};
+constexpr uint32_t kVersion = 2;
+constexpr size_t kHeaderBytes = sizeof(kMagic) + sizeof(uint32_t);
+enum RecordKind : uint8_t { kRecordFile = 1, kRecordRemove = 2 };
+
+// The content hash covers the start of the file, where the headers and
+// session info live, plus evenly spaced samples up to its last byte.
+constexpr int64_t kHashHeadBytes = 64 * 1024;
+constexpr int64_t kHashSampleBytes = 4096;
+constexpr int64_t kHashSamples = 16;
+// The journal is rewritten once superseded records outnumber live ones.
+constexpr size_t kMinCompactRecords = 64;
+
+// Recording gaps longer than this (s) void the lap they fall in.
+constexpr double kMaxRecordGap = 1.0;
+
+// Top speeds a corrupt file stores beyond float range are clamped to this.
+constexpr double kMaxFloat = std::numeric_limits<float>::max();
+
+std::string EncodeEntry(const CatalogEntry& entry)
+{
+  std::string out;
+  Put<uint8_t>(&out, kRecordFile);
+  PutString(&out, entry.path);
+  Put(&out, entry.size);
+  Put(&out, entry.mtime);
+  Put(&out, entry.hash);
+  PutString(&out, entry.error);
+  Put(&out, entry.start_date);
+  PutString(&out, entry.track);
+  PutString(&out, entry.track_config);
+  PutString(&out, entry.car);
+  PutString(&out, entry.driver);
+  Put<uint32_t>(&out, static_cast<uint32_t>(entry.session_types.size()));
+  for (const std::string& type : entry.session_types) {
+    PutString(&out, type);
+  }
+  Put<uint32_t>(&out, static_cast<uint32_t>(entry.laps.size()));
+  for (const CatalogLap& lap : entry.laps) {
+    Put(&out, lap.session_type);
+    Put(&out, lap.session_num);
+    Put(&out, lap.lap);
+    Put(&out, lap.lap_time);
+    Put(&out, lap.top_speed);
+    Put(&out, lap.incidents);
+    Put<uint8_t>(&out, lap.pit ? 1 : 0);
+  }
+  return out;
+}
+
+std::string EncodeRemove(const std::string& path)
+{
+  std::string out;
+  Put<uint8_t>(&out, kRecordRemove);
+  PutString(&out, path);
+  return out;
+}
+
+bool DecodeRecord(const char* data, size_t size, uint8_t* kind, CatalogEntry* entry)
+{
+  Cursor cursor(data, size);
+  if (!cursor.Get(kind) || !cursor.GetString(&entry->path)) {
+    return false;
+  }
+  if (*kind == kRecordRemove) {
+    return cursor.done();
+  }
+  uint32_t count = 0;
+  bool ok = *kind == kRecordFile && cursor.Get(&entry->size) && cursor.Get(&entry->mtime) &&
+            cursor.Get(&entry->hash) && cursor.GetString(&entry->error) && cursor.Get(&entry->start_date) &&
+            cursor.GetString(&entry->track) && cursor.GetString(&entry->track_config) &&
+            cursor.GetString(&entry->car) && cursor.GetString(&entry->driver) && cursor.Get(&count) &&
+            cursor.Fits(count, 4);
+  entry->session_types.resize(ok ? count : 0);
+  for (std::string& type : entry->session_types) {
+    ok = ok && cursor.GetString(&type);
+  }
+  ok = ok && cursor.Get(&count) && cursor.Fits(count, 25);
+  entry->laps.resize(ok ? count : 0);
+  for (CatalogLap& lap : entry->laps) {
+    uint8_t pit = 0;
+    ok = ok && cursor.Get(&lap.session_type) && cursor.Get(&lap.session_num) && cursor.Get(&lap.lap) &&
+         cursor.Get(&lap.lap_time) && cursor.Get(&lap.top_speed) && cursor.Get(&lap.incidents) &&
+         cursor.Get(&pit) && lap.session_type < entry->session_types.size();
+    lap.pit = pit != 0;
+  }
+  return ok && cursor.done();
+}
+
+bool SampledHash(const std::string& path, int64_t size, uint64_t* hash)
+{
+  std::FILE* file = OpenFile(path, "rb");
+  if (!file) {
+    return false;
+  }
+  uint64_t value = Fnv1a64(&size, sizeof(size));
+  std::vector<char> buffer;
+  auto add = [&](int64_t offset, int64_t length) {
+    buffer.resize(static_cast<size_t>(length));
+    if (!ReadAt(file, offset, buffer.data(), buffer.size())) {
+      return false;
+    }
+    value = Fnv1a64(buffer.data(), buffer.size(), value);
+    return true;
+  };
+  bool ok = add(0, std::min(size, kHashHeadBytes));
+  int64_t rest = size - kHashHeadBytes;
+  if (ok && rest > 0) {
+    if (rest <= kHashSampleBytes * kHashSamples) {
+      ok = add(kHashHeadBytes, rest);
+    } else {
+      for (int64_t i = 0; ok && i < kHashSamples; ++i) {
+        ok = add(kHashHeadBytes + (rest - kHashSampleBytes) * i / (kHashSamples - 1), kHashSampleBytes);
+      }
+    }
+  }
+  std::fclose(file);
+  *hash = value;
+  return ok;
+}
+
+// Lap currently being driven while walking the records.
+struct OpenLap {
+  bool active = false;
+  bool complete = false;  // Started at the line with no gap since.
+  int session_num = 0;
+  int lap = 0;
+  double start = 0.0;
+  double top_speed = 0.0;
+  bool pit = false;
+  double incidents_at_start = 0.0;
+};
+
+uint32_t SessionTypeIndex(CatalogEntry* entry, const std::string& type)
+{
+  auto it = std::find(entry->session_types.begin(), entry->session_types.end(), type);
+  if (it != entry->session_types.end()) {
+    return static_cast<uint32_t>(it - entry->session_types.begin());
+  }
+  entry->session_types.push_back(type);
+  return static_cast<uint32_t>(entry->session_types.size() - 1);
+}
+
+void ScanFile(const ListedFile& listed, uint64_t hash, CatalogEntry* out)
+{
+  *out = CatalogEntry();
+  out->path = listed.path;
+  out->size = listed.size;
+  out->mtime = listed.mtime;
+  out->hash = hash;
+
+  IbtFile file;
+  if (!file.Open(listed.path, &out->error)) {
+    return;
+  }
+  out->start_date = file.header().session_start_date;
+
+  YamlNode yaml = ParseSessionYaml(file.session_info());
+  std::string car_idx = YamlString(yaml, "DriverInfo:DriverCarIdx:");
+  std::string driver_path = "DriverInfo:Drivers:CarIdx:{" + car_idx + "}";
+  out->track = YamlString(yaml, "WeekendInfo:TrackDisplayName:");
+  if (out->track.empty()) {
+    out->track = YamlString(yaml, "WeekendInfo:TrackName:");
+  }
+  out->track_config = YamlString(yaml, "WeekendInfo:TrackConfigName:");
+  out->car = YamlString(yaml, driver_path + "CarScreenName:");
+  out->driver = YamlString(yaml, driver_path + "UserName:");
+
+  int time_idx = file.FindVar("SessionTime");
+  int lap_idx = file.FindVar("Lap");
+  if (time_idx < 0 || lap_idx < 0) {
+    return;  // Metadata only.
+  }
+  int session_idx = file.FindVar("SessionNum");
+  int pct_idx = file.FindVar("LapDistPct");
+  int speed_idx = file.FindVar("Speed");
+  int pit_idx = file.FindVar("OnPitRoad");
+  int incident_idx = file.FindVar("PlayerCarMyIncidentCount");
+
+  OpenLap current;
+  double prev_time = 0.0;
+  double prev_pct = -1.0;
+  auto close_lap = [&](double end, double incidents) {
+    if (!current.complete) {
+      return;
+    }
+    CatalogLap lap;
+    lap.session_type = SessionTypeIndex(
+        out, YamlString(yaml, "SessionInfo:Sessions:SessionNum:{" + std::to_string(current.session_num) +
+                                  "}SessionType:"));
+    lap.session_num = current.session_num;
+    lap.lap = current.lap;
+    lap.lap_time = static_cast<float>(end - current.start);
+    lap.top_speed = static_cast<float>(std::min(current.top_speed, kMaxFloat));
+    // A count that went backwards or out of range is treated as unknown.
+    double added = incidents - current.incidents_at_start;
+    lap.incidents = incident_idx >= 0 && added >= 0.0 && added <= INT32_MAX ? static_cast<int32_t>(added) : -1;
+    lap.pit = current.pit;
+    out->laps.push_back(lap);
+  };
+
+  bool ok = ForEachIbtRecord(file, 0, file.record_count(), [&](const IbtRecordSource& source, int index) {
+    (void)index;
+    double time = source.GetDouble(time_idx, 0);
+    int lap = source.GetInt(lap_idx, 0, -1);
+    int session_num = session_idx >= 0 ? source.GetInt(session_idx, 0, 0) : 0;
+    double pct = pct_idx >= 0 ? source.GetDouble(pct_idx, 0) : -1.0;
+    double incidents = incident_idx >= 0 ? source.GetDouble(incident_idx, 0) : 0.0;
+
+    bool continuous = current.active && session_num == current.session_num && time >= prev_time &&
+                      time - prev_time <= kMaxRecordGap;
+    if (continuous && lap == static_cast<int64_t>(current.lap) + 1) {
+      // Interpolate the line crossing between the two records.
+      double crossing = time;
+      if (prev_pct > 0.5 && pct >= 0.0 && pct < 0.5) {
+        double f = (1.0 - prev_pct) / ((1.0 - prev_pct) + pct);
+        crossing = prev_time + f * (time - prev_time);
+      }
+      close_lap(crossing, incidents);
+      current = OpenLap();
+      current.complete = true;
+      current.start = crossing;
+    } else if (!continuous || lap != current.lap) {
+      // Joined mid-lap, or the recording skipped: wait for the next line.
+      current = OpenLap();
+    }
+    if (!current.active) {
+      current.active = true;
+      current.lap = lap;
+      current.session_num = session_num;
+      current.incidents_at_start = incidents;
+    }
+    if (speed_idx >= 0) {
+      current.top_speed = std::max(current.top_speed, source.GetDouble(speed_idx, 0));
+    }
+    if (pit_idx >= 0 && source.GetDouble(pit_idx, 0) != 0.0) {
+      current.pit = true;
+    }
+    prev_time = time;
+    prev_pct = pct;
+    return true;
+  });
+  if (!ok) {
+    out->error = "failed to read records";
+    out->laps.clear();
+  }
+}
+
+bool ContainsNoCase(const std::string& text, const std::string& needle)
+{
+  auto it = std::search(text.begin(), text.end(), needle.begin(), needle.end(), [](char a, char b) {
+    return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+  });
+  return it != text.end();
+}
+
+enum class ScanAction { kUnchanged, kReused, kScanned };
+
+}  // namespace
+
+uint32_t IbtCatalog::Intern(const std::string& text)
+{
+  auto it = string_ids_.find(text);
+  if (it != string_ids_.end()) {
+    return it->second;
+  }
+  uint32_t id = static_cast<uint32_t>(strings_.size());
+  strings_.push_back(text);
+  string_ids_.emplace(text, id);
+  return id;
+}
+
+void IbtCatalog::BuildTables()
+{
+  strings_.clear();
+  string_ids_.clear();
+  files_.clear();
+  laps_.clear();
+  Intern("");
+  for (const auto& item : entries_) {
+    const CatalogEntry& entry = item.second;
+    if (!entry.error.empty()) {
+      continue;
+    }
+    CatalogFile file;
+    file.entry = &entry;
+    file.track = Intern(entry.track);
+    file.track_config = Intern(entry.track_config);
+    file.car = Intern(entry.car);
+    file.driver = Intern(entry.driver);
+    file.first_lap = static_cast<uint32_t>(laps_.size());
+    file.lap_count = static_cast<uint32_t>(entry.laps.size());
+    for (CatalogLap lap : entry.laps) {
+      lap.file = static_cast<uint32_t>(files_.size());
+      lap.session_type = Intern(entry.session_types[lap.session_type]);
+      laps_.push_back(lap);
+    }
+    files_.push_back(file);
+  }
+}
+
+bool IbtCatalog::Open(const std::string& path, std::string* error)
+{
+  path_ = path;
+  entries_.clear();
+  records_ = 0;
+  on_disk_ = false;
+  needs_compact_ = false;
+
+  std::FILE* file = OpenFile(path, "rb");
+  if (!file) {
+    BuildTables();
+    return true;
+  }
+  std::string data;
+  bool read = ReadWholeFile(file, &data);
+  std::fclose(file);
+
+  uint32_t version = 0;
+  if (read && data.size() >= kHeaderBytes) {
+    version = GetAt<uint32_t>(data.data() + sizeof(kMagic));
+  }
+  if (!read || data.size() < kHeaderBytes || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0 ||
+      version != kVersion) {
+    *error = "invalid catalog index: " + path;
+    return false;
+  }
+
+  size_t pos = kHeaderBytes;
+  const char* payload = nullptr;
+  uint32_t length = 0;
+  bool damaged = false;
+  while (true) {
+    if (!NextFramedRecord(data, &pos, &payload, &length)) {
+      // A damaged record only affects its own file, which the next scan
+      // brings up to date; carry on from the next intact one so compacting
+      // keeps the rest.
+      if (pos < data.size() && SkipToFramedRecord(data, &pos)) {
+        damaged = true;
+        continue;
+      }
+      break;
+    }
+    uint8_t kind = 0;
+    CatalogEntry entry;
+    if (!DecodeRecord(payload, length, &kind, &entry)) {
+      *error = "invalid catalog index: " + path;
+      return false;
+    }
+    if (kind == kRecordRemove) {
+      entries_.erase(entry.path);
+    } else {
+      std::string key = entry.path;
+      entries_[key] = std::move(entry);
+    }
+    ++records_;
+  }
+  on_disk_ = true;
+  BuildTables();
+  // Damaged records, and a last one cut short by a crash, are dropped by
+  // rewriting what was intact.
+  return (pos == data.size() && !damaged) || Compact(error);
+}
+
+bool IbtCatalog::Compact(std::string* error)
+{
+  std::string data(kMagic, sizeof(kMagic));
+  Put<uint32_t>(&data, kVersion);
+  for (const auto& item : entries_) {
+    data.append(FrameRecord(EncodeEntry(item.second)));
+  }
+
+  if (!WriteFileAtomically(path_, data, error)) {
+    needs_compact_ = true;
+    return false;
+  }
+  records_ = entries_.size();
+  on_disk_ = true;
+  needs_compact_ = false;
+  return true;
+}
+
+bool IbtCatalog::Append(const std::vector<std::string>& records, std::string* error)
+{
+  size_t total = records_ + records.size();
+  if (!on_disk_ || needs_compact_ || total > std::max(kMinCompactRecords, 2 * entries_.size())) {
+    return Compact(error);
+  }
+  std::string data;
+  for (const std::string& record : records) {
+    data.append(record);
+  }
+  if (!AppendToFile(path_, data)) {
+    // Whatever reached the disk ends in a torn record; start over next time.
+    *error = "cannot write " + path_;
+    needs_compact_ = true;
+    return false;
+  }
+  records_ = total;
+  return true;
+}
+
+bool IbtCatalog::Scan(const std::string& dir, const CatalogScanOptions& options, CatalogScanStats* stats,
+                      std::string* error, JobControl* control)
+{
+  double start_ms = TickClock::NowMonotonicMs();
+  std::vector<ListedFile> listed;
+  if (!ListFiles(dir, ".ibt", &listed, error)) {
+    return false;
+  }
+
+  // Readable entries by content, to recognise files that were moved.
+  std::unordered_multimap<uint64_t, const CatalogEntry*> by_content;
+  for (const auto& item : entries_) {
+    if (item.second.error.empty()) {
+      by_content.emplace(item.second.hash, &item.second);
+    }
+  }
+
+  std::vector<ScanAction> actions(listed.size(), ScanAction::kUnchanged);
+  std::vector<CatalogEntry> results(listed.size());
+  auto process = [&](size_t i) {
+    const ListedFile& file = listed[i];
+    auto it = entries_.find(file.path);
+    const CatalogEntry* old = it != entries_.end() ? &it->second : nullptr;
+    if (!options.full && old && old->size == file.size && old->mtime == file.mtime) {
+      return;
+    }
+    uint64_t hash = 0;
+    const CatalogEntry* same = nullptr;
+    if (SampledHash(file.path, file.size, &hash) && !options.full) {
+      auto range = by_content.equal_range(hash);
+      for (auto match = range.first; match != range.second && !same; ++match) {
+        if (match->second->size == file.size) {
+          same = match->second;
+        }
+      }
+    }
+    if (same) {
+      results[i] = *same;
+      results[i].path = file.path;
+      results[i].mtime = file.mtime;
+      actions[i] = ScanAction::kReused;
+    } else {
+      ScanFile(file, hash, &results[i]);
+      actions[i] = ScanAction::kScanned;
+    }
+  };
+
+  size_t workers = options.threads > 0 ? static_cast<size_t>(options.threads)
+                                       : std::max(1u, std::thread::hardware_concurrency());
+  workers = std::min(workers, std::max<size_t>(listed.size(), 1));
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> done{0};
+  std::atomic<bool> cancelled{false};
+  auto work = [&]() {
+    for (size_t i = next++; i < listed.size() && !cancelled; i = next++) {
+      process(i);
+      if (control && !control->Update(static_cast<double>(++done), static_cast<double>(listed.size()))) {
+        cancelled = true;
+      }
+    }
+  };
+  std::vector<std::thread> pool;
+  for (size_t i = 1; i < workers; ++i) {
+    pool.emplace_back(work);
+  }
+  work();
+  for (std::thread& thread : pool) {
+    thread.join();
+  }
+  if (cancelled) {
+    *error = "scan was cancelled";
+    return false;
+  }
+
+  *stats = CatalogScanStats();
+  std::vector<std::string> records;
+  std::unordered_set<std::string> present;
+  for (size_t i = 0; i < listed.size(); ++i) {
+    present.insert(listed[i].path);
+    if (actions[i] == ScanAction::kUnchanged) {
+      ++stats->unchanged;
+      continue;
+    }
+    ++(actions[i] == ScanAction::kReused ? stats->reused : stats->scanned);
+    records.push_back(FrameRecord(EncodeEntry(results[i])));
+    entries_[listed[i].path] = std::move(results[i]);
+  }
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (present.count(it->first) == 0) {
+      records.push_back(FrameRecord(EncodeRemove(it->first)));
+      it = entries_.erase(it);
+      ++stats->removed;
+    } else {
+      ++it;
+    }
+  }
+
+  BuildTables();
+  for (const auto& item : entries_) {
+    if (!item.second.error.empty()) {
+      stats->failed.emplace_back(item.first, item.second.error);
+    }
+  }
+  stats->files = static_cast<int>(files_.size());
+  stats->laps = static_cast<int>(laps_.size());
+  bool saved = records.empty() && on_disk_ ? true : Append(records, error);
+  stats->elapsed_ms = TickClock::NowMonotonicMs() - start_ms;
+  return saved;
+}
+
+std::vector<uint32_t> IbtCatalog::Query(const CatalogQuery& query) const
+{
+  // Match each distinct string once instead of once per lap.
+  auto match_strings = [this](const std::string& needle) {
+    std::vector<char> match(strings_.size(), 1);
+    if (!needle.empty()) {
+      for (size_t i = 0; i < strings_.size(); ++i) {
+        match[i] = ContainsNoCase(strings_[i], needle) ? 1 : 0;
+      }
+    }
+    return match;
+  };
+  std::vector<char> track = match_strings(query.track);
+  std::vector<char> car = match_strings(query.car);
+  std::vector<char> driver = match_strings(query.driver);
+  std::vector<char> session_type = match_strings(query.session_type);
+
+  std::vector<char> file_match(files_.size());
+  for (size_t i = 0; i < files_.size(); ++i) {
+    const CatalogFile& file = files_[i];
+    double date = static_cast<double>(file.entry->start_date);
+    file_match[i] = (track[file.track] || track[file.track_config]) && car[file.car] && driver[file.driver] &&
+                    date >= query.from_date && date <= query.to_date;
+  }
+
+  std::vector<uint32_t> result;
+  for (size_t i = 0; i < laps_.size(); ++i) {
+    const CatalogLap& lap = laps_[i];
+    if (file_match[lap.file] && session_type[lap.session_type] && lap.lap_time >= query.min_lap_time &&
+        lap.lap_time <= query.max_lap_time && (query.include_pit || !lap.pit) &&
+        (query.max_incidents < 0 || (lap.incidents >= 0 && lap.incidents <= query.max_incidents))) {
+      result.push_back(static_cast<uint32_t>(i));
+    }
+  }
+  if (query.sort_by_time) {
+    auto faster = [this](uint32_t a, uint32_t b) { return laps_[a].lap_time < laps_[b].lap_time; };
+    if (query.limit < result.size()) {
+      std::partial_sort(result.begin(), result.begin() + static_cast<std::ptrdiff_t>(query.limit), result.end(),
+                        faster);
+    } else {
+      std::stable_sort(result.begin(), result.end(), faster);
+    }
+  }
+  if (query.limit < result.size()) {
+    result.resize(query.limit);
+  }
+  return result;
+}
+
+namespace {
+
+struct IbtCatalogHandle {
+  std::unique_ptr<IbtCatalog> catalog;
+  bool busy = false;  // A scanAsync owns the catalog until it settles.
+};
+
+void FinalizeIbtCatalog(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  delete static_cast<IbtCatalogHandle*>(data);
+}
+
+IbtCatalogHandle* UnwrapOpenCatalog(napi_env env, napi_callback_info info, size_t* argc, napi_value* args)
+{
+  IbtCatalogHandle* handle = UnwrapThis<IbtCatalogHandle>(env, info, argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  if (!handle->catalog) {
+    napi_throw_error(env, nullptr, "IbtCatalog is closed");
+    return nullptr;
+  }
+  if (handle->busy) {
+    napi_throw_error(env, nullptr, "IbtCatalog is busy with a scan");
+    return nullptr;
+  }
+  return handle;
+}
+
+// new IbtCatalog(indexPath)
+napi_value IbtCatalogConstructor(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value self = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+  std::string path;
+  if (argc < 1 || !GetString(env, args[0], &path)) {
+    napi_throw_type_error(env, nullptr, "IbtCatalog expects (indexPath)");
+    return nullptr;
+  }
+  std::unique_ptr<IbtCatalogHandle> handle(new IbtCatalogHandle());
+  handle->catalog.reset(new IbtCatalog());
+  std::string error;
+  if (!handle->catalog->Open(path, &error)) {
+    napi_throw_error(env, nullptr, error.c_str());
+    return nullptr;
+  }
+
+  NAPI_CALL(env, napi_wrap(env, self, handle.get(), FinalizeIbtCatalog, nullptr, nullptr));
+  handle.release();
+  return self;
+}
+
+bool ParseScanArgs(napi_env env, size_t argc, napi_value* args, std::string* dir, CatalogScanOptions* options)
+{
+  if (argc < 1 || !GetString(env, args[0], dir)) {
+    napi_throw_type_error(env, nullptr, "scan expects (dir[, { threads, full }])");
+    return false;
+  }
+  napi_value options_value = argc >= 2 ? args[1] : nullptr;
+  return GetOptionalInt(env, options_value, "threads", &options->threads) &&
+         GetOptionalBool(env, options_value, "full", &options->full);
+}
+
+napi_value MakeScanResult(napi_env env, const CatalogScanStats& stats)
+{
+  napi_value result = nullptr;
+  napi_value failed = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_create_array_with_length(env, stats.failed.size(), &failed));
+  for (size_t i = 0; i < stats.failed.size(); ++i) {
+    napi_value item = nullptr;
+    NAPI_CALL(env, napi_create_object(env, &item));
+    NAPI_CALL(env, napi_set_named_property(env, item, "path", MakeString(env, stats.failed[i].first)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "error", MakeString(env, stats.failed[i].second)));
+    NAPI_CALL(env, napi_set_element(env, failed, static_cast<uint32_t>(i), item));
+  }
+  NAPI_CALL(env, napi_set_named_property(env, result, "files", MakeInt(env, stats.files)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "laps", MakeInt(env, stats.laps)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "scanned", MakeInt(env, stats.scanned)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "reused", MakeInt(env, stats.reused)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "unchanged", MakeInt(env, stats.unchanged)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "removed", MakeInt(env, stats.removed)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "failed", failed));
+  NAPI_CALL(env, napi_set_named_property(env, result, "elapsedMs", MakeDouble(env, stats.elapsed_ms)));
+  return result;
+}
+
+// scan(dir, { threads?, full? }) brings the catalog in line with dir.
+napi_value IbtCatalogScan(napi_env env, napi_callback_info info)
+{
+  size_t argc = 2;
+  napi_value args[2];
+  IbtCatalogHandle* handle = UnwrapOpenCatalog(env, info, &argc, args);
+  std::string dir;
+  CatalogScanOptions options;
+  if (!handle || !ParseScanArgs(env, argc, args, &dir, &options)) {
+    return nullptr;
+  }
+
+  CatalogScanStats stats;
+  std::string error;
+  if (!handle->catalog->Scan(dir, options, &stats, &error)) {
+    napi_throw_error(env, nullptr, error.c_str());
+    return nullptr;
+  }
+  return MakeScanResult(env, stats);
+}
+
+// scanAsync(dir, { threads?, full?, signal?, onProgress? }) scans on the
+// thread pool, reporting progress in files. The catalog rejects other calls
+// until the scan settles; a cancelled scan leaves it unchanged.
+napi_value IbtCatalogScanAsync(napi_env env, napi_callback_info info)
+{
+  size_t argc = 2;
+  napi_value args[2];
+  napi_value self = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+  IbtCatalogHandle* handle = UnwrapOpenCatalog(env, info, nullptr, nullptr);
+  std::string dir;
+  auto options = std::make_shared<CatalogScanOptions>();
+  if (!handle || !ParseScanArgs(env, argc, args, &dir, options.get())) {
+    return nullptr;
+  }
+
+  auto stats = std::make_shared<CatalogScanStats>();
+  IbtCatalog* catalog = handle->catalog.get();
+  JobExecute execute = [catalog, dir, options, stats](JobControl* control, std::string* error) {
+    return catalog->Scan(dir, *options, stats.get(), error, control);
+  };
+  JobComplete complete = [handle, stats](napi_env env, bool ok) -> napi_value {
+    handle->busy = false;
+    return ok ? MakeScanResult(env, *stats) : nullptr;
+  };
+  handle->busy = true;
+  napi_value promise = QueueJob(env, "IbtCatalog.scanAsync", self, argc >= 2 ? args[1] : nullptr, execute, complete);
+  if (!promise) {
+    handle->busy = false;
+  }
+  return promise;
+}
+
+bool ParseCatalogQuery(napi_env env, napi_value options, CatalogQuery* query)
+{
+  int limit = -1;
+  std::string sort;
+  if (!GetOptionalString(env, options, "track", &query->track) ||
+      !GetOptionalString(env, options, "car", &query->car) ||
+      !GetOptionalString(env, options, "driver", &query->driver) ||
+      !GetOptionalString(env, options, "sessionType", &query->session_type) ||
+      !GetOptionalDouble(env, options, "from", &query->from_date) ||
+      !GetOptionalDouble(env, options, "to", &query->to_date) ||
+      !GetOptionalDouble(env, options, "minLapTime", &query->min_lap_time) ||
+      !GetOptionalDouble(env, options, "maxLapTime", &query->max_lap_time) ||
+      !GetOptionalInt(env, options, "maxIncidents", &query->max_incidents) ||
+      !GetOptionalBool(env, options, "includePit", &query->include_pit) ||
+      !GetOptionalString(env, options, "sort", &sort) ||
+      !GetOptionalInt(env, options, "limit", &limit)) {
+    return false;
+  }
+  if (!sort.empty() && sort != "lapTime" && sort != "file") {
+    napi_throw_type_error(env, nullptr, "sort must be 'lapTime' or 'file'");
+    return false;
+  }
+  query->sort_by_time = sort == "lapTime";
+  if (limit >= 0) {
+    query->limit = static_cast<size_t>(limit);
+  }
+  return true;
+}
+
+napi_value MakeCatalogFile(napi_env env, const IbtCatalog& catalog, const CatalogFile& file)
+{
+  napi_value item = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &item));
+  NAPI_CALL(env, napi_set_named_property(env, item, "path", MakeString(env, file.entry->path)));
+  NAPI_CALL(env, napi_set_named_property(env, item, "date",
+                                         MakeDouble(env, static_cast<double>(file.entry->start_date))));
+  NAPI_CALL(env, napi_set_named_property(env, item, "track", MakeString(env, catalog.text(file.track))));
+  NAPI_CALL(env, napi_set_named_property(env, item, "trackConfig",
+                                         MakeString(env, catalog.text(file.track_config))));
+  NAPI_CALL(env, napi_set_named_property(env, item, "car", MakeString(env, catalog.text(file.car))));
+  NAPI_CALL(env, napi_set_named_property(env, item, "driver", MakeString(env, catalog.text(file.driver))));
+  return item;
+}
+
+// query({ track?, car?, driver?, sessionType?, from?, to?, minLapTime?,
+//         maxLapTime?, maxIncidents?, includePit?, sort?, limit? })
+napi_value IbtCatalogQuery(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  IbtCatalogHandle* handle = UnwrapOpenCatalog(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  CatalogQuery query;
+  if (!ParseCatalogQuery(env, argc >= 1 ? args[0] : nullptr, &query)) {
+    return nullptr;
+  }
+
+  const IbtCatalog& catalog = *handle->catalog;
+  std::vector<uint32_t> matches = catalog.Query(query);
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_array_with_length(env, matches.size(), &result));
+  for (size_t i = 0; i < matches.size(); ++i) {
+    const CatalogLap& lap = catalog.laps()[matches[i]];
+    napi_value item = MakeCatalogFile(env, catalog, catalog.files()[lap.file]);
+    if (!item) {
+      return nullptr;
+    }
+    NAPI_CALL(env, napi_set_named_property(env, item, "sessionNum", MakeInt(env, lap.session_num)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "sessionType",
+                                           MakeString(env, catalog.text(lap.session_type))));
+    NAPI_CALL(env, napi_set_named_property(env, item, "lap", MakeInt(env, lap.lap)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "lapTime", MakeDouble(env, lap.lap_time)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "topSpeed", MakeDouble(env, lap.top_speed)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "incidents",
+                                           lap.incidents >= 0 ? MakeInt(env, lap.incidents) : GetNull(env)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "pit", MakeBool(env, lap.pit)));
+    NAPI_CALL(env, napi_set_element(env, result, static_cast<uint32_t>(i), item));
+  }
+  return result;
+}
+
+napi_value IbtCatalogGetFiles(napi_env env, napi_callback_info info)
+{
+  IbtCatalogHandle* handle = UnwrapOpenCatalog(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  const IbtCatalog& catalog = *handle->catalog;
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_array_with_length(env, catalog.files().size(), &result));
+  for (size_t i = 0; i < catalog.files().size(); ++i) {
+    const CatalogFile& file = catalog.files()[i];
+    napi_value item = MakeCatalogFile(env, catalog, file);
+    if (!item) {
+      return nullptr;
+    }
+    NAPI_CALL(env, napi_set_named_property(env, item, "size",
+                                           MakeDouble(env, static_cast<double>(file.entry->size))));
+    NAPI_CALL(env, napi_set_named_property(env, item, "laps", MakeInt(env, static_cast<int>(file.lap_count))));
+    NAPI_CALL(env, napi_set_element(env, result, static_cast<uint32_t>(i), item));
+  }
+  return result;
+}
+
+napi_value IbtCatalogClose(napi_env env, napi_callback_info info)
+{
+  IbtCatalogHandle* handle = UnwrapThis<IbtCatalogHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  if (handle->busy) {
+    napi_throw_error(env, nullptr, "IbtCatalog is busy with a scan");
+    return nullptr;
+  }
+  handle->catalog.reset();
+  return GetUndefined(env);
+}
+
+}  // namespace
+
+napi_value RegisterIbtCatalog(napi_env env, napi_value exports)
+{
+  napi_property_descriptor methods[] = {
+    {"scan", nullptr, IbtCatalogScan, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"scanAsync", nullptr, IbtCatalogScanAsync, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"query", nullptr, IbtCatalogQuery, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getFiles", nullptr, IbtCatalogGetFiles, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"close", nullptr, IbtCatalogClose, nullptr, nullptr, nullptr, napi_default, nullptr}
+  };
+
+  napi_value constructor = nullptr;
+  NAPI_CALL(env, napi_define_class(env, "IbtCatalog", NAPI_AUTO_LENGTH, IbtCatalogConstructor, nullptr,
+                                   sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "IbtCatalog", constructor));
+  return exports;
+}
+
+}  // namespace irsdk_node
@@ -0,0 +1,138 @@
+// Index over a directory tree of .ibt files: session metadata and per-lap
+// summaries of every file, kept in a compact on-disk file so queries never
+// have to open the telemetry itself.
+//
+// The index is a journal of checksummed records, one per added, changed or
+// removed file. Re-scans only read files whose fingerprint changed and
+// append their records; a record torn by a crash fails its checksum and is
+// dropped on the next load.
+
+#ifndef IRSDK_NODE_IBT_CATALOG_H_
+#define IRSDK_NODE_IBT_CATALOG_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "job_control.h"
+
+namespace irsdk_node {
+
+struct CatalogLap {
+  uint32_t file = 0;
+  uint32_t session_type = 0;  // String table id; index into the entry's session_types on disk.
+  int32_t session_num = 0;
+  int32_t lap = 0;            // Lap number as counted by the sim.
+  float lap_time = 0.0f;      // Seconds from line to line.
+  float top_speed = 0.0f;     // m/s; 0 when the file has no Speed.
+  int32_t incidents = -1;     // Incident points gained during the lap; -1 when unknown.
+  bool pit = false;           // On pit road at some point of the lap.
+};
+
+// Everything the index stores about one file.
+struct CatalogEntry {
+  std::string path;
+  // Fingerprint: size and mtime are checked first, the sampled content hash
+  // when they differ, so touched or moved files are not read again.
+  int64_t size = 0;
+  int64_t mtime = 0;
+  uint64_t hash = 0;
+  std::string error;       // Why the file could not be read; empty when it was.
+  int64_t start_date = 0;  // Unix seconds, from the disk sub-header.
+  std::string track;
+  std::string track_config;
+  std::string car;
+  std::string driver;
+  std::vector<std::string> session_types;
+  std::vector<CatalogLap> laps;
+};
+
+// Query view of an entry, with strings as string table ids.
+struct CatalogFile {
+  const CatalogEntry* entry = nullptr;
+  uint32_t track = 0;
+  uint32_t track_config = 0;
+  uint32_t car = 0;
+  uint32_t driver = 0;
+  // Range of this file's laps in the lap table.
+  uint32_t first_lap = 0;
+  uint32_t lap_count = 0;
+};
+
+struct CatalogQuery {
+  // Case-insensitive substrings; empty matches everything.
+  std::string track;
+  std::string car;
+  std::string driver;
+  std::string session_type;
+  double from_date = -std::numeric_limits<double>::infinity();
+  double to_date = std::numeric_limits<double>::infinity();
+  double min_lap_time = 0.0;
+  double max_lap_time = std::numeric_limits<double>::infinity();
+  int max_incidents = -1;  // < 0 accepts any count.
+  bool include_pit = true;
+  bool sort_by_time = false;
+  size_t limit = std::numeric_limits<size_t>::max();
+};
+
+struct CatalogScanOptions {
+  int threads = 0;    // 0 picks one per core.
+  bool full = false;  // Read every file again, ignoring fingerprints.
+};
+
+struct CatalogScanStats {
+  int files = 0;
+  int laps = 0;
+  int scanned = 0;    // Read in full.
+  int reused = 0;     // Changed size or mtime, but the same content.
+  int unchanged = 0;
+  int removed = 0;
+  std::vector<std::pair<std::string, std::string>> failed;  // Path and error.
+  double elapsed_ms = 0.0;
+};
+
+class IbtCatalog {
+ public:
+  // Load the index at path; a missing file starts an empty catalog.
+  bool Open(const std::string& path, std::string* error);
+
+  // Bring the catalog in line with every .ibt file under dir and record the
+  // changes in the index. Progress is reported in files; a cancelled scan
+  // leaves the catalog as it was.
+  bool Scan(const std::string& dir, const CatalogScanOptions& options, CatalogScanStats* stats,
+            std::string* error, JobControl* control = nullptr);
+
+  // Indices into laps() matching the query.
+  std::vector<uint32_t> Query(const CatalogQuery& query) const;
+
+  const std::vector<CatalogFile>& files() const { return files_; }
+  const std::vector<CatalogLap>& laps() const { return laps_; }
+  const std::string& text(uint32_t id) const { return strings_[id]; }
+
+ private:
+  // Rewrite the whole index through a temporary file.
+  bool Compact(std::string* error);
+  bool Append(const std::vector<std::string>& records, std::string* error);
+  void BuildTables();
+  uint32_t Intern(const std::string& text);
+
+  std::string path_;
+  std::map<std::string, CatalogEntry> entries_;
+  size_t records_ = 0;          // Records in the journal, live or superseded.
+  bool on_disk_ = false;
+  bool needs_compact_ = false;  // An append failed part way.
+
+  std::vector<std::string> strings_;
+  std::unordered_map<std::string, uint32_t> string_ids_;
+  std::vector<CatalogFile> files_;
+  std::vector<CatalogLap> laps_;
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_IBT_CATALOG_H_
@@ -0,0 +1,330 @@
+// Reader for iRacing .ibt telemetry files.
+
+#include "ibt_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include "file_util.h"
+#include "irsdk_defines.h"
+
+namespace irsdk_node {
+
+namespace {
+
+// On-disk sizes of the SDK structures.
+constexpr int kHeaderSize = 112;
+constexpr int kDiskSubHeaderSize = 32;
+constexpr int kVarHeaderSize = 144;
+constexpr int kVarBufOffset = 48;
+constexpr int kRecordsPerChunk = 1024;
+
+int32_t ReadI32(const char* data)
+{
+  int32_t value = 0;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+int64_t ReadI64(const char* data)
+{
+  int64_t value = 0;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+double ReadF64(const char* data)
+{
+  double value = 0.0;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+// Fixed-size text fields are not guaranteed to be NUL terminated.
+std::string ReadText(const char* data, size_t max_len)
+{
+  size_t len = 0;
+  while (len < max_len && data[len] != '\0') {
+    len += 1;
+  }
+  return std::string(data, len);
+}
+
+int VarTypeSize(int type)
+{
+  switch (type) {
+    case irsdk_char:
+    case irsdk_bool:
+      return 1;
+    case irsdk_int:
+    case irsdk_bitField:
+    case irsdk_float:
+      return 4;
+    case irsdk_double:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+int NextLayoutId()
+{
+  // Live sources use the SDK status id, which counts up from zero; keep
+  // file layouts clear of that range.
+  static std::atomic<int> next{1 << 20};
+  return next.fetch_add(1);
+}
+
+}  // namespace
+
+IbtFile::~IbtFile()
+{
+  Close();
+}
+
+void IbtFile::Close()
+{
+  if (file_) {
+    std::fclose(file_);
+    file_ = nullptr;
+  }
+}
+
+bool IbtFile::Open(const std::string& path, std::string* error)
+{
+  Close();
+  path_ = path;
+  vars_.clear();
+  session_info_.clear();
+  record_count_ = 0;
+
+  file_ = OpenFile(path, "rb");
+  if (!file_) {
+    *error = "cannot open file: " + path;
+    return false;
+  }
+
+  int64_t size = FileSize(file_);
+  char head[kHeaderSize + kDiskSubHeaderSize];
+  if (size < static_cast<int64_t>(sizeof(head)) || !SeekFile(file_, 0) ||
+      std::fread(head, 1, sizeof(head), file_) != sizeof(head)) {
+    *error = "file is too small to be an .ibt file";
+    Close();
+    return false;
+  }
+
+  header_.version = ReadI32(head + 0);
+  header_.status = ReadI32(head + 4);
+  header_.tick_rate = ReadI32(head + 8);
+  header_.session_info_update = ReadI32(head + 12);
+  header_.session_info_len = ReadI32(head + 16);
+  header_.session_info_offset = ReadI32(head + 20);
+  header_.num_vars = ReadI32(head + 24);
+  header_.var_header_offset = ReadI32(head + 28);
+  header_.num_buf = ReadI32(head + 32);
+  header_.buf_len = ReadI32(head + 36);
+  // Disk files carry a single buffer; its offset is the start of the records.
+  header_.buf_offset = ReadI32(head + kVarBufOffset + 4);
+
+  ReadDiskSubHeader(head + kHeaderSize);
+
+  // Every offset and length below comes from the file, so each is checked
+  // in 64-bit arithmetic before use; a corrupt file fails to open instead of
+  // reading out of bounds.
+  if (header_.num_vars <= 0 || header_.var_header_offset < kHeaderSize ||
+      static_cast<int64_t>(header_.var_header_offset) + static_cast<int64_t>(header_.num_vars) * kVarHeaderSize > size) {
+    *error = "invalid .ibt header: variable headers lie outside the file";
+    Close();
+    return false;
+  }
+  if (header_.buf_len <= 0 || header_.buf_offset < kHeaderSize) {
+    *error = "invalid .ibt header: bad record layout";
+    Close();
+    return false;
+  }
+
+  std::vector<char> raw(static_cast<size_t>(header_.num_vars) * kVarHeaderSize);
+  if (!SeekFile(file_, header_.var_header_offset) || std::fread(raw.data(), 1, raw.size(), file_) != raw.size()) {
+    *error = "cannot read variable headers";
+    Close();
+    return false;
+  }
+
+  vars_.reserve(static_cast<size_t>(header_.num_vars));
+  for (int i = 0; i < header_.num_vars; ++i) {
+    const char* entry = raw.data() + static_cast<size_t>(i) * kVarHeaderSize;
+    IbtVar var;
+    var.type = ReadI32(entry + 0);
+    var.offset = ReadI32(entry + 4);
+    var.count = ReadI32(entry + 8);
+    var.count_as_time = entry[12] != 0;
+    var.name = ReadText(entry + 16, IRSDK_MAX_STRING);
+    var.desc = ReadText(entry + 16 + IRSDK_MAX_STRING, IRSDK_MAX_DESC);
+    var.unit = ReadText(entry + 16 + IRSDK_MAX_STRING + IRSDK_MAX_DESC, IRSDK_MAX_STRING);
+    if (VarTypeSize(var.type) == 0 || var.count <= 0) {
+      *error = "variable '" + var.name + "' has an invalid type or count";
+      Close();
+      return false;
+    }
+    int64_t width = static_cast<int64_t>(VarTypeSize(var.type)) * var.count;
+    if (var.offset < 0 || var.offset + width > header_.buf_len) {
+      *error = "variable '" + var.name + "' lies outside the record";
+      Close();
+      return false;
+    }
+    vars_.push_back(var);
+  }
+
+  if (header_.session_info_len > 0 && header_.session_info_offset >= 0 &&
+      static_cast<int64_t>(header_.session_info_offset) + header_.session_info_len <= size) {
+    std::vector<char> text(static_cast<size_t>(header_.session_info_len));
+    if (SeekFile(file_, header_.session_info_offset) &&
+        std::fread(text.data(), 1, text.size(), file_) == text.size()) {
+      session_info_ = ReadText(text.data(), text.size());
+    }
+  }
+
+  UpdateRecordCount(size);
+  layout_id_ = NextLayoutId();
+  return true;
+}
+
+void IbtFile::ReadDiskSubHeader(const char* sub)
+{
+  header_.session_start_date = ReadI64(sub + 0);
+  header_.session_start_time = ReadF64(sub + 8);
+  header_.session_end_time = ReadF64(sub + 16);
+  header_.session_lap_count = ReadI32(sub + 24);
+  header_.session_record_count = ReadI32(sub + 28);
+}
+
+void IbtFile::UpdateRecordCount(int64_t size)
+{
+  // The sub-header record count is only written when the file is closed, so
+  // fall back to what the file size allows for files that were cut short or
+  // are still being written.
+  int64_t available = size > header_.buf_offset ? (size - header_.buf_offset) / header_.buf_len : 0;
+  available = std::min<int64_t>(available, INT32_MAX);
+  record_count_ = header_.session_record_count > 0
+      ? static_cast<int>(std::min<int64_t>(header_.session_record_count, available))
+      : static_cast<int>(available);
+}
+
+bool IbtFile::Refresh()
+{
+  if (!file_) {
+    return false;
+  }
+  int64_t size = FileSize(file_);
+  char sub[kDiskSubHeaderSize];
+  if (size < kHeaderSize + kDiskSubHeaderSize || !SeekFile(file_, kHeaderSize) ||
+      std::fread(sub, 1, sizeof(sub), file_) != sizeof(sub)) {
+    return false;
+  }
+  ReadDiskSubHeader(sub);
+  UpdateRecordCount(size);
+  return true;
+}
+
+int IbtFile::FindVar(const std::string& name) const
+{
+  for (size_t i = 0; i < vars_.size(); ++i) {
+    if (vars_[i].name == name) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+bool IbtFile::ReadRecords(int first, int count, std::vector<char>* out)
+{
+  if (!file_ || first < 0 || count < 0 || first > record_count_ || count > record_count_ - first) {
+    return false;
+  }
+  size_t bytes = static_cast<size_t>(count) * static_cast<size_t>(header_.buf_len);
+  out->resize(bytes);
+  int64_t offset = static_cast<int64_t>(header_.buf_offset) + static_cast<int64_t>(first) * header_.buf_len;
+  if (!SeekFile(file_, offset)) {
+    return false;
+  }
+  return std::fread(out->data(), 1, bytes, file_) == bytes;
+}
+
+bool IbtFile::ReadColumn(int var_idx, int entry, std::vector<double>* out, JobControl* control)
+{
+  if (var_idx < 0 || var_idx >= static_cast<int>(vars_.size()) || entry < 0 || entry >= vars_[var_idx].count) {
+    return false;
+  }
+  out->clear();
+  out->reserve(static_cast<size_t>(record_count_));
+  return ForEachIbtRecord(*this, 0, record_count_, [&](const IbtRecordSource& source, int index) {
+    (void)index;
+    out->push_back(source.GetDouble(var_idx, entry));
+    return true;
+  }, control);
+}
+
+double DecodeVarValue(const char* record, const IbtVar& var, int entry)
+{
+  const char* data = record + var.offset;
+  switch (var.type) {
+    case irsdk_char:
+      return static_cast<double>(static_cast<unsigned char>(data[entry]));
+    case irsdk_bool:
+      return data[entry] != 0 ? 1.0 : 0.0;
+    case irsdk_int:
+    case irsdk_bitField:
+      return static_cast<double>(ReadI32(data + entry * 4));
+    case irsdk_float: {
+      float value = 0.0f;
+      std::memcpy(&value, data + entry * 4, sizeof(value));
+      return static_cast<double>(value);
+    }
+    case irsdk_double:
+      return ReadF64(data + entry * 8);
+    default:
+      return 0.0;
+  }
+}
+
+int IbtRecordSource::GetInt(int idx, int entry, int fallback) const
+{
+  double value = GetDouble(idx, entry);
+  if (!(value >= INT32_MIN && value <= INT32_MAX)) {
+    return fallback;
+  }
+  return static_cast<int>(value);
+}
+
+bool ForEachIbtRecord(IbtFile& file,
+                      int first,
+                      int count,
+                      const std::function<bool(const IbtRecordSource& source, int index)>& visit,
+                      JobControl* control)
+{
+  IbtRecordSource source(file);
+  std::vector<char> chunk;
+  const size_t record_length = static_cast<size_t>(file.record_length());
+  for (int start = first; start < first + count; start += kRecordsPerChunk) {
+    int batch = std::min(kRecordsPerChunk, first + count - start);
+    if (control && !control->Update(start - first, count)) {
+      return false;
+    }
+    if (!file.ReadRecords(start, batch, &chunk)) {
+      return false;
+    }
+    for (int i = 0; i < batch; ++i) {
+      source.set_record(chunk.data() + static_cast<size_t>(i) * record_length);
+      if (!visit(source, start + i)) {
+        return true;
+      }
+    }
+  }
+  if (control) {
+    control->Update(count, count);
+  }
+  return true;
+}
+
+}  // namespace irsdk_node
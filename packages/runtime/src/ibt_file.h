@@ -0,0 +1,132 @@
+// Reader for iRacing .ibt telemetry files.
+// Fields are decoded from their on-disk little-endian layout rather than
+// mapped onto SDK structs, so the reader works the same on every platform.
+
+#ifndef IRSDK_NODE_IBT_FILE_H_
+#define IRSDK_NODE_IBT_FILE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "job_control.h"
+#include "telemetry_source.h"
+
+namespace irsdk_node {
+
+struct IbtVar {
+  std::string name;
+  std::string desc;
+  std::string unit;
+  int type;
+  int offset;
+  int count;
+  bool count_as_time;
+};
+
+struct IbtHeader {
+  int version;
+  int status;
+  int tick_rate;
+  int session_info_update;
+  int session_info_len;
+  int session_info_offset;
+  int num_vars;
+  int var_header_offset;
+  int num_buf;
+  int buf_len;
+  int buf_offset;
+
+  // Disk sub-header written after the main header.
+  int64_t session_start_date;
+  double session_start_time;
+  double session_end_time;
+  int session_lap_count;
+  int session_record_count;
+};
+
+class IbtFile {
+ public:
+  IbtFile() = default;
+  ~IbtFile();
+  IbtFile(const IbtFile&) = delete;
+  IbtFile& operator=(const IbtFile&) = delete;
+
+  bool Open(const std::string& path, std::string* error);
+  void Close();
+
+  // Re-read the file size and the sub-header for files still being written.
+  // Returns false when the file cannot be read.
+  bool Refresh();
+  bool is_open() const { return file_ != nullptr; }
+
+  const std::string& path() const { return path_; }
+  const IbtHeader& header() const { return header_; }
+  const std::vector<IbtVar>& vars() const { return vars_; }
+  const std::string& session_info() const { return session_info_; }
+  int record_count() const { return record_count_; }
+  int record_length() const { return header_.buf_len; }
+
+  // Unique per opened file, for use as a TelemetrySource layout id.
+  int layout_id() const { return layout_id_; }
+
+  int FindVar(const std::string& name) const;
+
+  // Read `count` consecutive records starting at `first` into out.
+  bool ReadRecords(int first, int count, std::vector<char>* out);
+
+  // Decode one entry of a variable across every record.
+  bool ReadColumn(int var_idx, int entry, std::vector<double>* out, JobControl* control = nullptr);
+
+ private:
+  void ReadDiskSubHeader(const char* sub);
+  void UpdateRecordCount(int64_t size);
+
+  std::FILE* file_ = nullptr;
+  std::string path_;
+  IbtHeader header_{};
+  std::vector<IbtVar> vars_;
+  std::string session_info_;
+  int record_count_ = 0;
+  int layout_id_ = 0;
+};
+
+// Decode one entry of a variable from a raw record buffer.
+double DecodeVarValue(const char* record, const IbtVar& var, int entry);
+
+// TelemetrySource over a single record of an .ibt file.
+class IbtRecordSource : public TelemetrySource {
+ public:
+  explicit IbtRecordSource(const IbtFile& file) : file_(file) {}
+
+  void set_record(const char* record) { record_ = record; }
+
+  int FindVar(const char* name) const override { return file_.FindVar(name); }
+  int VarType(int idx) const override { return file_.vars()[idx].type; }
+  int VarCount(int idx) const override { return file_.vars()[idx].count; }
+  double GetDouble(int idx, int entry) const override { return DecodeVarValue(record_, file_.vars()[idx], entry); }
+  int LayoutId() const override { return file_.layout_id(); }
+
+  // An entry as an int, for counters such as Lap. Values a corrupt file
+  // stores out of int range or as NaN come back as fallback.
+  int GetInt(int idx, int entry, int fallback) const;
+
+ private:
+  const IbtFile& file_;
+  const char* record_ = nullptr;
+};
+
+// Visit records [first, first + count) in order, reading them in chunks.
+// The visitor returns false to stop early. Progress is reported to control
+// in records chunk by chunk; cancelling it fails the visit.
+bool ForEachIbtRecord(IbtFile& file,
+                      int first,
+                      int count,
+                      const std::function<bool(const IbtRecordSource& source, int index)>& visit,
+                      JobControl* control = nullptr);
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_IBT_FILE_H_
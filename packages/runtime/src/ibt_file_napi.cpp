@@ -0,0 +1,508 @@
+// JS bindings of the .ibt reader.
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "async_job.h"
+#include "bindings.h"
+#include "csv_export.h"
+#include "downsample.h"
+#include "ibt_file.h"
+#include "napi_util.h"
+#include "resampler.h"
+
+namespace irsdk_node {
+
+namespace {
+
+struct IbtFileHandle {
+  IbtFile file;
+};
+
+// One entry of a variable and SessionTime across every record.
+bool ReadTimeSeries(IbtFile& file,
+                    int time_idx,
+                    int idx,
+                    int entry,
+                    std::vector<double>* times,
+                    std::vector<double>* values,
+                    JobControl* control)
+{
+  int var_count = static_cast<int>(file.vars().size());
+  if (time_idx < 0 || time_idx >= var_count || idx < 0 || idx >= var_count || entry < 0 ||
+      entry >= file.vars()[idx].count) {
+    return false;
+  }
+  times->reserve(static_cast<size_t>(file.record_count()));
+  values->reserve(static_cast<size_t>(file.record_count()));
+  return ForEachIbtRecord(file, 0, file.record_count(), [&](const IbtRecordSource& source, int index) {
+    (void)index;
+    times->push_back(source.GetDouble(time_idx, 0));
+    values->push_back(source.GetDouble(idx, entry));
+    return true;
+  }, control);
+}
+
+void FinalizeIbtFile(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  delete static_cast<IbtFileHandle*>(data);
+}
+
+// Unwrap `this` and make sure the file has not been closed.
+IbtFile* UnwrapOpenFile(napi_env env, napi_callback_info info, size_t* argc, napi_value* args)
+{
+  IbtFileHandle* handle = UnwrapThis<IbtFileHandle>(env, info, argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  if (!handle->file.is_open()) {
+    napi_throw_error(env, nullptr, "IbtFile is closed");
+    return nullptr;
+  }
+  return &handle->file;
+}
+
+napi_value IbtFileConstructor(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value self = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+  std::string path;
+  if (argc < 1 || !GetString(env, args[0], &path)) {
+    napi_throw_type_error(env, nullptr, "IbtFile expects (path)");
+    return nullptr;
+  }
+
+  std::unique_ptr<IbtFileHandle> handle(new IbtFileHandle());
+  std::string error;
+  if (!handle->file.Open(path, &error)) {
+    napi_throw_error(env, nullptr, error.c_str());
+    return nullptr;
+  }
+
+  NAPI_CALL(env, napi_wrap(env, self, handle.get(), FinalizeIbtFile, nullptr, nullptr));
+  handle.release();
+  return self;
+}
+
+napi_value IbtFileGetHeader(napi_env env, napi_callback_info info)
+{
+  IbtFile* file = UnwrapOpenFile(env, info, nullptr, nullptr);
+  if (!file) {
+    return nullptr;
+  }
+
+  const IbtHeader& header = file->header();
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_set_named_property(env, result, "version", MakeInt(env, header.version)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "tickRate", MakeInt(env, header.tick_rate)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "recordCount", MakeInt(env, file->record_count())));
+  NAPI_CALL(env, napi_set_named_property(env, result, "recordLength", MakeInt(env, file->record_length())));
+  NAPI_CALL(env, napi_set_named_property(env, result, "sessionInfoUpdate", MakeInt(env, header.session_info_update)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "sessionStartDate",
+                                         MakeDouble(env, static_cast<double>(header.session_start_date))));
+  NAPI_CALL(env, napi_set_named_property(env, result, "sessionStartTime", MakeDouble(env, header.session_start_time)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "sessionEndTime", MakeDouble(env, header.session_end_time)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "lapCount", MakeInt(env, header.session_lap_count)));
+  return result;
+}
+
+napi_value IbtFileGetVarHeaders(napi_env env, napi_callback_info info)
+{
+  IbtFile* file = UnwrapOpenFile(env, info, nullptr, nullptr);
+  if (!file) {
+    return nullptr;
+  }
+
+  const std::vector<IbtVar>& vars = file->vars();
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_array_with_length(env, vars.size(), &result));
+  for (size_t i = 0; i < vars.size(); ++i) {
+    const IbtVar& var = vars[i];
+    napi_value entry = nullptr;
+    NAPI_CALL(env, napi_create_object(env, &entry));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "name", MakeString(env, var.name)));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "type", MakeInt(env, var.type)));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "count", MakeInt(env, var.count)));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "offset", MakeInt(env, var.offset)));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "countAsTime", MakeBool(env, var.count_as_time)));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "desc", MakeString(env, var.desc)));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "unit", MakeString(env, var.unit)));
+    NAPI_CALL(env, napi_set_element(env, result, static_cast<uint32_t>(i), entry));
+  }
+  return result;
+}
+
+napi_value IbtFileGetSessionInfoString(napi_env env, napi_callback_info info)
+{
+  IbtFile* file = UnwrapOpenFile(env, info, nullptr, nullptr);
+  if (!file) {
+    return nullptr;
+  }
+  return MakeString(env, file->session_info());
+}
+
+// Arguments of readColumn(name[, entry]). idx is -1 for variables the file
+// does not carry. Returns false with an exception pending.
+bool ParseColumnArgs(napi_env env, const IbtFile& file, size_t argc, napi_value* args, int* idx, int* entry)
+{
+  std::string name;
+  if (argc < 1 || !GetString(env, args[0], &name)) {
+    napi_throw_type_error(env, nullptr, "readColumn expects (name[, entry])");
+    return false;
+  }
+  *entry = 0;
+  if (argc >= 2 && !IsNullish(env, args[1]) && !CheckNapi(env, napi_get_value_int32(env, args[1], entry))) {
+    return false;
+  }
+  *idx = file.FindVar(name);
+  if (*idx >= 0 && (*entry < 0 || *entry >= file.vars()[*idx].count)) {
+    napi_throw_range_error(env, nullptr, "entry index out of range");
+    return false;
+  }
+  return true;
+}
+
+// Arguments of downsample(name, options); idx is -1 for unknown variables.
+bool ParseDownsampleArgs(napi_env env,
+                         const IbtFile& file,
+                         size_t argc,
+                         napi_value* args,
+                         DownsampleOptions* options,
+                         std::string* name,
+                         int* idx,
+                         int* entry,
+                         int* time_idx)
+{
+  if (argc < 1 || !GetString(env, args[0], name)) {
+    napi_throw_type_error(env, nullptr, "downsample expects (name, { width, method?, entry?, start?, end? })");
+    return false;
+  }
+  napi_value options_value = argc >= 2 ? args[1] : nullptr;
+  *entry = 0;
+  if (!ParseDownsampleOptions(env, options_value, options) ||
+      !GetOptionalInt(env, options_value, "entry", entry)) {
+    return false;
+  }
+
+  *idx = file.FindVar(*name);
+  if (*idx < 0) {
+    return true;
+  }
+  *time_idx = file.FindVar("SessionTime");
+  if (*time_idx < 0) {
+    napi_throw_error(env, nullptr, "file has no SessionTime channel");
+    return false;
+  }
+  if (*entry < 0 || *entry >= file.vars()[*idx].count) {
+    napi_throw_range_error(env, nullptr, "entry index out of range");
+    return false;
+  }
+  return true;
+}
+
+// Arguments of exportCsv(path[, options]).
+bool ParseExportArgs(napi_env env, size_t argc, napi_value* args, std::string* out_path, CsvExportOptions* options)
+{
+  if (argc < 1 || !GetString(env, args[0], out_path)) {
+    napi_throw_type_error(env, nullptr, "exportCsv expects (path[, options])");
+    return false;
+  }
+  return ParseCsvExportOptions(env, argc >= 2 ? args[1] : nullptr, options);
+}
+
+// Read one entry of a variable across the whole file as a Float64Array.
+napi_value IbtFileReadColumn(napi_env env, napi_callback_info info)
+{
+  size_t argc = 2;
+  napi_value args[2];
+  IbtFile* file = UnwrapOpenFile(env, info, &argc, args);
+  int idx = -1;
+  int entry = 0;
+  if (!file || !ParseColumnArgs(env, *file, argc, args, &idx, &entry)) {
+    return nullptr;
+  }
+  if (idx < 0) {
+    return GetNull(env);
+  }
+
+  std::vector<double> column;
+  if (!file->ReadColumn(idx, entry, &column)) {
+    napi_throw_error(env, nullptr, "failed to read records");
+    return nullptr;
+  }
+  return MakeFloat64Array(env, column);
+}
+
+napi_value IbtFileResample(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  IbtFile* file = UnwrapOpenFile(env, info, &argc, args);
+  if (!file) {
+    return nullptr;
+  }
+
+  ResampleOptions options;
+  if (!ParseResampleOptions(env, argc >= 1 ? args[0] : nullptr, &options)) {
+    return nullptr;
+  }
+
+  ResampledSeries series;
+  std::string error;
+  if (!ResampleIbt(*file, options, &series, &error)) {
+    napi_throw_error(env, nullptr, error.c_str());
+    return nullptr;
+  }
+  return MakeResampledSeries(env, series);
+}
+
+// Downsample one entry of a variable against SessionTime for charting.
+napi_value IbtFileDownsample(napi_env env, napi_callback_info info)
+{
+  size_t argc = 2;
+  napi_value args[2];
+  IbtFile* file = UnwrapOpenFile(env, info, &argc, args);
+  DownsampleOptions options;
+  std::string name;
+  int idx = -1;
+  int entry = 0;
+  int time_idx = -1;
+  if (!file || !ParseDownsampleArgs(env, *file, argc, args, &options, &name, &idx, &entry, &time_idx)) {
+    return nullptr;
+  }
+  if (idx < 0) {
+    return GetNull(env);
+  }
+
+  std::vector<double> times;
+  std::vector<double> values;
+  if (!ReadTimeSeries(*file, time_idx, idx, entry, &times, &values, nullptr)) {
+    napi_throw_error(env, nullptr, "failed to read records");
+    return nullptr;
+  }
+  return MakeDownsampled(env, times.data(), values.data(), times.size(), options);
+}
+
+// Write records to a CSV or TSV file, formatting blocks on worker threads.
+napi_value IbtFileExportCsv(napi_env env, napi_callback_info info)
+{
+  size_t argc = 2;
+  napi_value args[2];
+  IbtFile* file = UnwrapOpenFile(env, info, &argc, args);
+  std::string out_path;
+  CsvExportOptions options;
+  if (!file || !ParseExportArgs(env, argc, args, &out_path, &options)) {
+    return nullptr;
+  }
+
+  CsvExportStats stats;
+  std::string error;
+  if (!ExportIbtCsv(*file, out_path, options, &stats, &error)) {
+    napi_throw_error(env, nullptr, error.c_str());
+    return nullptr;
+  }
+  return MakeCsvExportStats(env, stats);
+}
+
+// The async variants take the options of their synchronous method plus
+// signal and onProgress. Each job opens the file again, so jobs never share a
+// file position with this handle or with each other, and progress is
+// reported in records.
+
+// Find name in the file a job opened. The file may have changed on disk
+// since the call checked the name on this handle, so indices found there
+// are never reused. idx is -1 when the file no longer carries name.
+bool ResolveJobVar(const IbtFile& reader, const std::string& name, int entry, int* idx, std::string* error)
+{
+  *idx = reader.FindVar(name);
+  if (*idx >= 0 && entry >= reader.vars()[*idx].count) {
+    *error = "entry index out of range";
+    return false;
+  }
+  return true;
+}
+
+// readColumnAsync(name[, { entry?, signal?, onProgress? }])
+napi_value IbtFileReadColumnAsync(napi_env env, napi_callback_info info)
+{
+  size_t argc = 2;
+  napi_value args[2];
+  IbtFile* file = UnwrapOpenFile(env, info, &argc, args);
+  if (!file) {
+    return nullptr;
+  }
+  std::string name;
+  if (argc < 1 || !GetString(env, args[0], &name)) {
+    napi_throw_type_error(env, nullptr, "readColumnAsync expects (name[, { entry, signal, onProgress }])");
+    return nullptr;
+  }
+  napi_value options_value = argc >= 2 ? args[1] : nullptr;
+  int entry = 0;
+  if (!GetOptionalInt(env, options_value, "entry", &entry)) {
+    return nullptr;
+  }
+  int idx = file->FindVar(name);
+  if (idx >= 0 && (entry < 0 || entry >= file->vars()[idx].count)) {
+    napi_throw_range_error(env, nullptr, "entry index out of range");
+    return nullptr;
+  }
+
+  std::string path = file->path();
+  auto found = std::make_shared<bool>(false);
+  auto column = std::make_shared<std::vector<double>>();
+  auto execute = [path, name, entry, found, column](JobControl* control, std::string* error) {
+    IbtFile reader;
+    int var_idx = -1;
+    if (!reader.Open(path, error) || !ResolveJobVar(reader, name, entry, &var_idx, error)) {
+      return false;
+    }
+    *found = var_idx >= 0;
+    if (*found && !reader.ReadColumn(var_idx, entry, column.get(), control)) {
+      *error = "failed to read records";
+      return false;
+    }
+    return true;
+  };
+  auto complete = [found, column](napi_env env, bool ok) {
+    return !ok ? nullptr : !*found ? GetNull(env) : MakeFloat64Array(env, *column);
+  };
+  return QueueJob(env, "IbtFile.readColumnAsync", nullptr, options_value, execute, complete);
+}
+
+napi_value IbtFileResampleAsync(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  IbtFile* file = UnwrapOpenFile(env, info, &argc, args);
+  auto options = std::make_shared<ResampleOptions>();
+  if (!file || !ParseResampleOptions(env, argc >= 1 ? args[0] : nullptr, options.get())) {
+    return nullptr;
+  }
+
+  std::string path = file->path();
+  auto series = std::make_shared<ResampledSeries>();
+  auto execute = [path, options, series](JobControl* control, std::string* error) {
+    IbtFile reader;
+    return reader.Open(path, error) && ResampleIbt(reader, *options, series.get(), error, control);
+  };
+  auto complete = [series](napi_env env, bool ok) {
+    return ok ? MakeResampledSeries(env, *series) : nullptr;
+  };
+  return QueueJob(env, "IbtFile.resampleAsync", nullptr, argc >= 1 ? args[0] : nullptr, execute, complete);
+}
+
+napi_value IbtFileDownsampleAsync(napi_env env, napi_callback_info info)
+{
+  size_t argc = 2;
+  napi_value args[2];
+  IbtFile* file = UnwrapOpenFile(env, info, &argc, args);
+  DownsampleOptions options;
+  std::string name;
+  int idx = -1;
+  int entry = 0;
+  int time_idx = -1;
+  if (!file || !ParseDownsampleArgs(env, *file, argc, args, &options, &name, &idx, &entry, &time_idx)) {
+    return nullptr;
+  }
+
+  std::string path = file->path();
+  auto found = std::make_shared<bool>(false);
+  auto times = std::make_shared<std::vector<double>>();
+  auto values = std::make_shared<std::vector<double>>();
+  auto execute = [path, name, entry, found, times, values](JobControl* control, std::string* error) {
+    IbtFile reader;
+    int var_idx = -1;
+    if (!reader.Open(path, error) || !ResolveJobVar(reader, name, entry, &var_idx, error)) {
+      return false;
+    }
+    *found = var_idx >= 0;
+    if (!*found) {
+      return true;
+    }
+    int session_time_idx = reader.FindVar("SessionTime");
+    if (session_time_idx < 0) {
+      *error = "file has no SessionTime channel";
+      return false;
+    }
+    if (!ReadTimeSeries(reader, session_time_idx, var_idx, entry, times.get(), values.get(), control)) {
+      *error = "failed to read records";
+      return false;
+    }
+    return true;
+  };
+  auto complete = [found, options, times, values](napi_env env, bool ok) {
+    if (!ok) {
+      return static_cast<napi_value>(nullptr);
+    }
+    return !*found ? GetNull(env) : MakeDownsampled(env, times->data(), values->data(), times->size(), options);
+  };
+  return QueueJob(env, "IbtFile.downsampleAsync", nullptr, argc >= 2 ? args[1] : nullptr, execute, complete);
+}
+
+napi_value IbtFileExportCsvAsync(napi_env env, napi_callback_info info)
+{
+  size_t argc = 2;
+  napi_value args[2];
+  IbtFile* file = UnwrapOpenFile(env, info, &argc, args);
+  std::string out_path;
+  auto options = std::make_shared<CsvExportOptions>();
+  if (!file || !ParseExportArgs(env, argc, args, &out_path, options.get())) {
+    return nullptr;
+  }
+
+  std::string path = file->path();
+  auto stats = std::make_shared<CsvExportStats>();
+  auto execute = [path, out_path, options, stats](JobControl* control, std::string* error) {
+    IbtFile reader;
+    return reader.Open(path, error) && ExportIbtCsv(reader, out_path, *options, stats.get(), error, control);
+  };
+  auto complete = [stats](napi_env env, bool ok) {
+    return ok ? MakeCsvExportStats(env, *stats) : nullptr;
+  };
+  return QueueJob(env, "IbtFile.exportCsvAsync", nullptr, argc >= 2 ? args[1] : nullptr, execute, complete);
+}
+
+napi_value IbtFileClose(napi_env env, napi_callback_info info)
+{
+  IbtFileHandle* handle = UnwrapThis<IbtFileHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  handle->file.Close();
+  return GetUndefined(env);
+}
+
+}  // namespace
+
+napi_value RegisterIbtFile(napi_env env, napi_value exports)
+{
+  napi_property_descriptor methods[] = {
+    {"getHeader", nullptr, IbtFileGetHeader, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getVarHeaders", nullptr, IbtFileGetVarHeaders, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getSessionInfoString", nullptr, IbtFileGetSessionInfoString, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"readColumn", nullptr, IbtFileReadColumn, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"resample", nullptr, IbtFileResample, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"downsample", nullptr, IbtFileDownsample, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"exportCsv", nullptr, IbtFileExportCsv, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"readColumnAsync", nullptr, IbtFileReadColumnAsync, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"resampleAsync", nullptr, IbtFileResampleAsync, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"downsampleAsync", nullptr, IbtFileDownsampleAsync, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"exportCsvAsync", nullptr, IbtFileExportCsvAsync, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"close", nullptr, IbtFileClose, nullptr, nullptr, nullptr, napi_default, nullptr}
+  };
+
+  napi_value constructor = nullptr;
+  NAPI_CALL(env, napi_define_class(env, "IbtFile", NAPI_AUTO_LENGTH, IbtFileConstructor, nullptr,
+                                   sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "IbtFile", constructor));
+  return exports;
+}
+
+}  // namespace irsdk_node
@@ -0,0 +1,456 @@
+// Follows an .ibt file while the sim is still writing it.
+
+#include "ibt_tail.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "bindings.h"
+#include "napi_util.h"
+
+namespace irsdk_node {
+
+namespace {
+
+// Records read per pass, so Take() is never held up by a long read.
+constexpr int kChunkRecords = 1024;
+
+}  // namespace
+
+IbtTail::IbtTail(std::string path, const IbtTailOptions& options) : path_(std::move(path)), options_(options)
+{
+#ifdef __linux__
+  if (pipe2(wake_pipe_, O_NONBLOCK | O_CLOEXEC) != 0) {
+    wake_pipe_[0] = wake_pipe_[1] = -1;
+  }
+#endif
+  worker_ = std::thread([this]() { Run(); });
+}
+
+IbtTail::~IbtTail()
+{
+  Stop();
+#ifdef __linux__
+  for (int fd : wake_pipe_) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+#endif
+}
+
+void IbtTail::Stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  Wake();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+void IbtTail::Wake()
+{
+  wake_.notify_all();
+#ifdef __linux__
+  if (wake_pipe_[1] >= 0) {
+    char byte = 0;
+    (void)!write(wake_pipe_[1], &byte, 1);
+  }
+#endif
+}
+
+bool IbtTail::Layout(std::vector<IbtVar>* vars, int* record_length) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!status_.open) {
+    return false;
+  }
+  *vars = vars_;
+  *record_length = record_length_;
+  return true;
+}
+
+int IbtTail::Take(int max_records, std::vector<char>* out, int* first)
+{
+  bool wake = false;
+  int count = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    count = std::min(std::max(max_records, 0), status_.buffered);
+    *first = buffer_first_;
+    size_t bytes = static_cast<size_t>(count) * static_cast<size_t>(record_length_);
+    if (count == status_.buffered) {
+      out->swap(buffer_);
+      buffer_.clear();
+    } else {
+      out->assign(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(bytes));
+      buffer_.erase(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(bytes));
+    }
+    buffer_first_ += count;
+    status_.buffered -= count;
+    if (paused_ && count > 0) {
+      paused_ = false;
+      taken_ = true;
+      wake = true;
+    }
+  }
+  if (wake) {
+    Wake();
+  }
+  return count;
+}
+
+IbtTailStatus IbtTail::Status() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  IbtTailStatus status = status_;
+  status.finished = complete_ && status_.buffered == 0;
+  return status;
+}
+
+void IbtTail::Run()
+{
+  for (;;) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_ || complete_) {
+        break;
+      }
+    }
+    if (!file_.is_open() && !OpenFile()) {
+      Wait();
+      continue;
+    }
+    if (!ReadNew()) {
+      Wait();
+    }
+  }
+  CloseWatch();
+  file_.Close();
+}
+
+bool IbtTail::OpenFile()
+{
+  // The sim writes the header before the first record, so a failed open
+  // usually just means the file is not there yet.
+  std::string error;
+  if (!file_.Open(path_, &error)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    status_.error = error;
+    return false;
+  }
+  OpenWatch();
+  std::lock_guard<std::mutex> lock(mutex_);
+  vars_ = file_.vars();
+  record_length_ = file_.record_length();
+  next_record_ = options_.from_end ? file_.record_count() : 0;
+  buffer_first_ = next_record_;
+  status_.open = true;
+  status_.error.clear();
+  status_.file_records = file_.record_count();
+  status_.next_record = next_record_;
+  return true;
+}
+
+bool IbtTail::ReadNew()
+{
+  if (!file_.Refresh()) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    status_.error = "failed to read " + path_;
+    return false;
+  }
+  int available = file_.record_count();
+  int next = 0;
+  int count = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    status_.file_records = available;
+    next = next_record_;
+    int room = options_.max_buffered - status_.buffered;
+    count = std::min(std::min(available - next, room), kChunkRecords);
+    paused_ = room <= 0 && available > next;
+    if (count <= 0) {
+      // The record count in the sub-header is only written on close.
+      complete_ = file_.header().session_record_count > 0 && next >= available;
+      return false;
+    }
+  }
+
+  if (!file_.ReadRecords(next, count, &chunk_)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    status_.error = "failed to read records";
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (status_.buffered == 0) {
+    buffer_first_ = next;
+  }
+  buffer_.insert(buffer_.end(), chunk_.begin(), chunk_.end());
+  status_.buffered += count;
+  next_record_ = next + count;
+  status_.next_record = next_record_;
+  status_.error.clear();
+  paused_ = status_.buffered >= options_.max_buffered && next_record_ < available;
+  return next_record_ < available && !paused_;
+}
+
+void IbtTail::Wait()
+{
+  int timeout_ms = static_cast<int>(std::max(options_.poll_ms, 1.0));
+#ifdef __linux__
+  if (wake_pipe_[0] >= 0) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) {
+        return;
+      }
+    }
+    pollfd fds[2] = {{wake_pipe_[0], POLLIN, 0}, {watch_fd_, POLLIN, 0}};
+    nfds_t count = watch_fd_ >= 0 ? 2 : 1;
+    if (poll(fds, count, timeout_ms) > 0) {
+      // Drain both; the next pass re-reads the file whatever woke it.
+      char drain[256];
+      while (read(wake_pipe_[0], drain, sizeof(drain)) > 0) {
+      }
+      if (watch_fd_ >= 0) {
+        while (read(watch_fd_, drain, sizeof(drain)) > 0) {
+        }
+      }
+    }
+    return;
+  }
+#endif
+  std::unique_lock<std::mutex> lock(mutex_);
+  wake_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this]() { return stopping_ || taken_; });
+  taken_ = false;
+}
+
+void IbtTail::OpenWatch()
+{
+#ifdef __linux__
+  // Not fatal when it fails: inotify does not see writes made on another
+  // machine through a network share, which polling still picks up.
+  watch_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (watch_fd_ >= 0 && inotify_add_watch(watch_fd_, path_.c_str(), IN_MODIFY | IN_CLOSE_WRITE) < 0) {
+    CloseWatch();
+  }
+#endif
+}
+
+void IbtTail::CloseWatch()
+{
+#ifdef __linux__
+  if (watch_fd_ >= 0) {
+    close(watch_fd_);
+    watch_fd_ = -1;
+  }
+#endif
+}
+
+namespace {
+
+struct IbtTailHandle {
+  std::unique_ptr<IbtTail> tail;
+  std::vector<std::string> channels;  // Empty selects every variable.
+  // Cached once the header is known; the layout never changes after that.
+  bool has_layout = false;
+  std::vector<IbtVar> vars;
+  int record_length = 0;
+  std::vector<int> columns;  // Index into vars per channel, -1 when missing.
+  std::vector<char> records;
+};
+
+void FinalizeIbtTail(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  delete static_cast<IbtTailHandle*>(data);
+}
+
+IbtTailHandle* UnwrapOpenTail(napi_env env, napi_callback_info info, size_t* argc, napi_value* args)
+{
+  IbtTailHandle* handle = UnwrapThis<IbtTailHandle>(env, info, argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  if (!handle->tail) {
+    napi_throw_error(env, nullptr, "IbtTail is closed");
+    return nullptr;
+  }
+  return handle;
+}
+
+bool ResolveLayout(IbtTailHandle* handle)
+{
+  if (handle->has_layout) {
+    return true;
+  }
+  if (!handle->tail->Layout(&handle->vars, &handle->record_length)) {
+    return false;
+  }
+  if (handle->channels.empty()) {
+    for (const IbtVar& var : handle->vars) {
+      handle->channels.push_back(var.name);
+    }
+  }
+  for (const std::string& name : handle->channels) {
+    int column = -1;
+    for (size_t i = 0; i < handle->vars.size(); ++i) {
+      if (handle->vars[i].name == name) {
+        column = static_cast<int>(i);
+        break;
+      }
+    }
+    handle->columns.push_back(column);
+  }
+  handle->has_layout = true;
+  return true;
+}
+
+// new IbtTail(path, { channels?, pollMs?, maxBufferedRecords?, fromEnd? })
+napi_value IbtTailConstructor(napi_env env, napi_callback_info info)
+{
+  size_t argc = 2;
+  napi_value args[2];
+  napi_value self = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+  std::string path;
+  if (argc < 1 || !GetString(env, args[0], &path)) {
+    napi_throw_type_error(env, nullptr, "IbtTail expects (path[, options])");
+    return nullptr;
+  }
+  napi_value options_value = argc >= 2 ? args[1] : nullptr;
+  std::unique_ptr<IbtTailHandle> handle(new IbtTailHandle());
+  IbtTailOptions options;
+  napi_value channels = nullptr;
+  if (!GetOptionalDouble(env, options_value, "pollMs", &options.poll_ms) ||
+      !GetOptionalInt(env, options_value, "maxBufferedRecords", &options.max_buffered) ||
+      !GetOptionalBool(env, options_value, "fromEnd", &options.from_end)) {
+    return nullptr;
+  }
+  if (GetOptionalProperty(env, options_value, "channels", &channels) &&
+      !GetStringArray(env, channels, &handle->channels)) {
+    return nullptr;
+  }
+  if (!(options.poll_ms > 0.0) || options.max_buffered < 1) {
+    napi_throw_range_error(env, nullptr, "pollMs and maxBufferedRecords must be positive");
+    return nullptr;
+  }
+
+  handle->tail.reset(new IbtTail(path, options));
+  NAPI_CALL(env, napi_wrap(env, self, handle.get(), FinalizeIbtTail, nullptr, nullptr));
+  handle.release();
+  return self;
+}
+
+// Take buffered records as { first, count, channels: { [name]: Float64Array } },
+// or null before the file's header has been read. Arrays hold count * entries
+// values, record-major.
+napi_value IbtTailRead(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  IbtTailHandle* handle = UnwrapOpenTail(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  int max_records = INT32_MAX;
+  if (argc >= 1 && !IsNullish(env, args[0])) {
+    NAPI_CALL(env, napi_get_value_int32(env, args[0], &max_records));
+  }
+  if (!ResolveLayout(handle)) {
+    return GetNull(env);
+  }
+
+  int first = 0;
+  int count = handle->tail->Take(max_records, &handle->records, &first);
+  napi_value result = nullptr;
+  napi_value channels = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_create_object(env, &channels));
+  NAPI_CALL(env, napi_set_named_property(env, result, "first", MakeInt(env, first)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "count", MakeInt(env, count)));
+  for (size_t c = 0; c < handle->channels.size(); ++c) {
+    napi_value column = nullptr;
+    if (handle->columns[c] < 0) {
+      column = GetNull(env);
+    } else {
+      const IbtVar& var = handle->vars[static_cast<size_t>(handle->columns[c])];
+      std::vector<double> values(static_cast<size_t>(count) * static_cast<size_t>(var.count));
+      size_t out = 0;
+      for (int r = 0; r < count; ++r) {
+        const char* record = handle->records.data() + static_cast<size_t>(r) * handle->record_length;
+        for (int entry = 0; entry < var.count; ++entry) {
+          values[out++] = DecodeVarValue(record, var, entry);
+        }
+      }
+      column = MakeFloat64Array(env, values);
+    }
+    NAPI_CALL(env, napi_set_named_property(env, channels, handle->channels[c].c_str(), column));
+  }
+  NAPI_CALL(env, napi_set_named_property(env, result, "channels", channels));
+  return result;
+}
+
+napi_value IbtTailGetStatus(napi_env env, napi_callback_info info)
+{
+  IbtTailHandle* handle = UnwrapOpenTail(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  IbtTailStatus tail_status = handle->tail->Status();
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_set_named_property(env, result, "open", MakeBool(env, tail_status.open)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "finished", MakeBool(env, tail_status.finished)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "fileRecords", MakeInt(env, tail_status.file_records)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "nextRecord", MakeInt(env, tail_status.next_record)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "buffered", MakeInt(env, tail_status.buffered)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "error",
+                                         tail_status.error.empty() ? GetNull(env) : MakeString(env, tail_status.error)));
+  return result;
+}
+
+napi_value IbtTailClose(napi_env env, napi_callback_info info)
+{
+  IbtTailHandle* handle = UnwrapThis<IbtTailHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  handle->tail.reset();
+  return GetUndefined(env);
+}
+
+}  // namespace
+
+napi_value RegisterIbtTail(napi_env env, napi_value exports)
+{
+  napi_property_descriptor methods[] = {
+    {"read", nullptr, IbtTailRead, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getStatus", nullptr, IbtTailGetStatus, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"close", nullptr, IbtTailClose, nullptr, nullptr, nullptr, napi_default, nullptr}
+  };
+
+  napi_value constructor = nullptr;
+  NAPI_CALL(env, napi_define_class(env, "IbtTail", NAPI_AUTO_LENGTH, IbtTailConstructor, nullptr,
+                                   sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "IbtTail", constructor));
+  return exports;
+}
+
+}  // namespace irsdk_node
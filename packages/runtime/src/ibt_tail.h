@@ -0,0 +1,88 @@
+// Follows an .ibt file while the sim is still writing it. A worker thread
+// waits for the file to grow (inotify on Linux, polling elsewhere and as a
+// fallback for network shares), re-reads the record count and buffers each
+// complete new record until JS takes it.
+
+#ifndef IRSDK_NODE_IBT_TAIL_H_
+#define IRSDK_NODE_IBT_TAIL_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ibt_file.h"
+
+namespace irsdk_node {
+
+struct IbtTailOptions {
+  double poll_ms = 250.0;    // Longest wait between checks without a change notification.
+  int max_buffered = 36000;  // Reading pauses while this many records are waiting.
+  bool from_end = false;     // Skip the records already in the file when it is opened.
+};
+
+struct IbtTailStatus {
+  bool open = false;      // Header read; the variable layout is known.
+  bool finished = false;  // The sim closed the file and every record was taken.
+  int file_records = 0;   // Complete records in the file at the last check.
+  int next_record = 0;    // Index of the next record to be buffered.
+  int buffered = 0;
+  std::string error;      // Last open or read failure, empty when none.
+};
+
+class IbtTail {
+ public:
+  IbtTail(std::string path, const IbtTailOptions& options);
+  ~IbtTail();
+  IbtTail(const IbtTail&) = delete;
+  IbtTail& operator=(const IbtTail&) = delete;
+
+  void Stop();
+
+  // Variables of the file; false until its header has been read.
+  bool Layout(std::vector<IbtVar>* vars, int* record_length) const;
+
+  // Move up to max_records buffered records into out and return how many;
+  // *first is the file index of the first of them.
+  int Take(int max_records, std::vector<char>* out, int* first);
+
+  IbtTailStatus Status() const;
+
+ private:
+  void Run();
+  void Wake();
+  bool OpenFile();
+  // Buffer what the file holds beyond next_record_; true when there is more.
+  bool ReadNew();
+  // Sleep until the file changes, room frees up, Stop() or the poll timeout.
+  void Wait();
+  void OpenWatch();
+  void CloseWatch();
+
+  std::string path_;
+  IbtTailOptions options_;
+  IbtFile file_;  // Only touched by the worker.
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+  bool paused_ = false;    // The buffer is full and records are waiting in the file.
+  bool taken_ = false;     // Take() freed room while paused.
+  bool complete_ = false;  // The sim closed the file and every record is buffered.
+  std::vector<IbtVar> vars_;
+  int record_length_ = 0;
+  int next_record_ = 0;
+  std::vector<char> buffer_;
+  int buffer_first_ = 0;  // File index of the first buffered record.
+  IbtTailStatus status_;
+  std::vector<char> chunk_;  // Worker scratch.
+
+  int watch_fd_ = -1;  // inotify instance, -1 when unavailable.
+  int wake_pipe_[2] = {-1, -1};
+  std::thread worker_;
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_IBT_TAIL_H_
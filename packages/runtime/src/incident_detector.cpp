@@ -0,0 +1,336 @@
+// Incident and off-track events detected from live telemetry.
+
+#include "incident_detector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include "bindings.h"
+#include "irsdk_defines.h"
+#include "napi_util.h"
+
+namespace irsdk_node {
+
+namespace {
+
+constexpr double kCruiseAlpha = 0.05;
+// LapDistPct steps larger than this between ticks are resets, not driving.
+constexpr double kMaxStep = 0.05;
+constexpr double kRadToDeg = 57.29577951308232;
+
+const char* IncidentKindName(IncidentKind kind)
+{
+  switch (kind) {
+    case IncidentKind::kOffTrack:
+      return "offTrack";
+    case IncidentKind::kRejoin:
+      return "rejoin";
+    case IncidentKind::kStop:
+      return "stop";
+    case IncidentKind::kSpin:
+      return "spin";
+    case IncidentKind::kIncident:
+    default:
+      return "incident";
+  }
+}
+
+}  // namespace
+
+IncidentDetector::IncidentDetector(const IncidentOptions& options) : options_(options) {}
+
+void IncidentDetector::OnTick(const TelemetrySource& source, const TickStamp& stamp)
+{
+  double dt = has_prev_ ? stamp.session_time - prev_time_ : 0.0;
+  if (dt < 0.0) {
+    // New session: excursions and speeds do not carry over.
+    has_prev_ = false;
+    dt = 0.0;
+    positions_.Reset();
+    cars_.clear();
+  }
+  if (has_prev_ && dt == 0.0) {
+    return;
+  }
+  if (!positions_.Update(source, dt)) {
+    return;
+  }
+  has_prev_ = true;
+  prev_time_ = stamp.session_time;
+
+  session_num_ = session_num_var_.Resolve(source) ? static_cast<int>(session_num_var_.Get(source)) : 0;
+  replay_frame_ = frame_var_.Resolve(source) ? static_cast<int>(frame_var_.Get(source)) : -1;
+  player_ = player_var_.Resolve(source) ? static_cast<int>(player_var_.Get(source)) : -1;
+  if (player_ >= positions_.count()) {
+    player_ = -1;
+  }
+
+  DetectCars(source, stamp, dt);
+  DetectSpin(source, stamp);
+  DetectIncidents(source, stamp);
+}
+
+void IncidentDetector::DetectCars(const TelemetrySource& source, const TickStamp& stamp, double dt_s)
+{
+  int count = positions_.count();
+  if (static_cast<int>(cars_.size()) != count) {
+    cars_.assign(static_cast<size_t>(count), CarState());
+  }
+  bool has_pit = pit_var_.Resolve(source);
+  double now = stamp.session_time;
+
+  for (int car = 0; car < count; ++car) {
+    CarState& state = cars_[static_cast<size_t>(car)];
+    int surface = positions_.surface(car);
+    bool racing = surface == irsdk_OnTrack || surface == irsdk_OffTrack;
+    if (!racing || (has_pit && pit_var_.Get(source, car) != 0.0)) {
+      // Pits and garage: nothing here is an incident.
+      state.off_since = -1.0;
+      state.fast_time = -1.0;
+      state.stopped = false;
+      continue;
+    }
+
+    if (surface == irsdk_OffTrack && state.off_since < 0.0) {
+      state.off_since = now;
+      Emit(IncidentKind::kOffTrack, car, stamp, 0.0);
+    } else if (surface == irsdk_OnTrack && state.off_since >= 0.0) {
+      Emit(IncidentKind::kRejoin, car, stamp, now - state.off_since);
+      state.off_since = -1.0;
+    }
+
+    double prev = positions_.prev_pct(car);
+    if (prev < 0.0 || dt_s <= 0.0) {
+      continue;
+    }
+    double step = positions_.pct(car) - prev;
+    if (step < -0.5) {
+      step += 1.0;
+    }
+    if (step > kMaxStep) {
+      continue;
+    }
+    // Reversing counts as stopped.
+    double rate = std::max(0.0, step) / dt_s;
+
+    // The cruise rate only follows the car at racing speed, so slow corners
+    // do not drag it down and a stop is measured against the speed before it.
+    if (rate > 0.0 && rate >= 0.5 * state.cruise_rate) {
+      state.cruise_rate =
+          state.cruise_rate > 0.0 ? state.cruise_rate + kCruiseAlpha * (rate - state.cruise_rate) : rate;
+      state.fast_time = now;
+      state.stopped = false;
+    } else if (!state.stopped && state.fast_time >= 0.0 && rate < options_.stop_ratio * state.cruise_rate &&
+               now - state.fast_time <= options_.stop_window_s) {
+      state.stopped = true;
+      Emit(IncidentKind::kStop, car, stamp, state.cruise_rate);
+    }
+  }
+}
+
+void IncidentDetector::DetectSpin(const TelemetrySource& source, const TickStamp& stamp)
+{
+  // Heading is only available for the player's car: VelocityX/Y are in the
+  // car's frame, so their angle is the slip between heading and travel.
+  if (player_ < 0 || !velocity_x_var_.Resolve(source) || !velocity_y_var_.Resolve(source)) {
+    spinning_ = false;
+    return;
+  }
+  int surface = positions_.surface(player_);
+  double vx = velocity_x_var_.Get(source);
+  double vy = velocity_y_var_.Get(source);
+  double speed = std::hypot(vx, vy);
+  if (speed < options_.spin_min_speed || (surface != irsdk_OnTrack && surface != irsdk_OffTrack)) {
+    spinning_ = false;
+    return;
+  }
+  double slip = std::atan2(std::fabs(vy), vx) * kRadToDeg;
+  if (!spinning_ && slip > options_.spin_slip_deg) {
+    spinning_ = true;
+    Emit(IncidentKind::kSpin, player_, stamp, slip);
+  } else if (spinning_ && slip < 0.5 * options_.spin_slip_deg) {
+    spinning_ = false;
+  }
+}
+
+void IncidentDetector::DetectIncidents(const TelemetrySource& source, const TickStamp& stamp)
+{
+  if (!incident_var_.Resolve(source)) {
+    return;
+  }
+  int incidents = static_cast<int>(incident_var_.Get(source));
+  if (incident_count_ >= 0 && incidents > incident_count_) {
+    Emit(IncidentKind::kIncident, player_, stamp, incidents - incident_count_);
+  }
+  incident_count_ = incidents;
+}
+
+void IncidentDetector::Emit(IncidentKind kind, int car_idx, const TickStamp& stamp, double value)
+{
+  IncidentEvent event;
+  event.kind = kind;
+  event.car_idx = car_idx;
+  event.session_num = session_num_;
+  event.session_time = stamp.session_time;
+  event.replay_frame = replay_frame_;
+  event.monotonic_ms = stamp.monotonic_ms;
+  bool known = car_idx >= 0 && positions_.pct(car_idx) >= 0.0;
+  event.lap = known ? static_cast<int>(std::floor(positions_.distance(car_idx))) : -1;
+  event.lap_dist_pct = known ? positions_.pct(car_idx) : -1.0;
+  event.value = value;
+
+  ++counts_[static_cast<size_t>(kind)];
+  if (events_.size() >= std::max<size_t>(1, options_.max_events)) {
+    events_.pop_front();
+    ++dropped_;
+  }
+  events_.push_back(event);
+}
+
+void IncidentDetector::Take(std::vector<IncidentEvent>* events)
+{
+  events->assign(events_.begin(), events_.end());
+  events_.clear();
+}
+
+namespace {
+
+// JS wrapper that keeps the detector attached to the live tick stream until
+// close() or garbage collection.
+struct IncidentDetectorHandle {
+  std::unique_ptr<IncidentDetector> detector;
+  bool attached = false;
+
+  void Detach()
+  {
+    if (attached) {
+      TickHub::Instance().Remove(detector.get());
+      attached = false;
+    }
+  }
+};
+
+void FinalizeIncidentDetector(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  IncidentDetectorHandle* handle = static_cast<IncidentDetectorHandle*>(data);
+  handle->Detach();
+  delete handle;
+}
+
+napi_value IncidentDetectorConstructor(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value self = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+  napi_value options = argc >= 1 ? args[0] : nullptr;
+  IncidentOptions parsed;
+  int max_events = static_cast<int>(parsed.max_events);
+  if (!GetOptionalDouble(env, options, "stopRatio", &parsed.stop_ratio) ||
+      !GetOptionalDouble(env, options, "stopWindowS", &parsed.stop_window_s) ||
+      !GetOptionalDouble(env, options, "spinSlipDeg", &parsed.spin_slip_deg) ||
+      !GetOptionalDouble(env, options, "spinMinSpeed", &parsed.spin_min_speed) ||
+      !GetOptionalInt(env, options, "maxEvents", &max_events)) {
+    return nullptr;
+  }
+  if (max_events <= 0) {
+    napi_throw_range_error(env, nullptr, "maxEvents must be positive");
+    return nullptr;
+  }
+  parsed.max_events = static_cast<size_t>(max_events);
+
+  auto* handle = new IncidentDetectorHandle();
+  handle->detector.reset(new IncidentDetector(parsed));
+  napi_status status = napi_wrap(env, self, handle, FinalizeIncidentDetector, nullptr, nullptr);
+  if (status != napi_ok) {
+    delete handle;
+    CheckNapi(env, status);
+    return nullptr;
+  }
+
+  TickHub::Instance().Add(handle->detector.get());
+  handle->attached = true;
+  return self;
+}
+
+napi_value IncidentDetectorTakeEvents(napi_env env, napi_callback_info info)
+{
+  IncidentDetectorHandle* handle = UnwrapThis<IncidentDetectorHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  std::vector<IncidentEvent> events;
+  handle->detector->Take(&events);
+
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_array_with_length(env, events.size(), &result));
+  for (size_t i = 0; i < events.size(); ++i) {
+    const IncidentEvent& event = events[i];
+    napi_value item = nullptr;
+    NAPI_CALL(env, napi_create_object(env, &item));
+    NAPI_CALL(env, napi_set_named_property(env, item, "kind", MakeString(env, IncidentKindName(event.kind))));
+    NAPI_CALL(env, napi_set_named_property(env, item, "carIdx", MakeInt(env, event.car_idx)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "sessionNum", MakeInt(env, event.session_num)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "sessionTime", MakeDouble(env, event.session_time)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "replayFrame",
+                                           event.replay_frame >= 0 ? MakeInt(env, event.replay_frame) : GetNull(env)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "monotonicMs", MakeDouble(env, event.monotonic_ms)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "lap", MakeInt(env, event.lap)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "lapDistPct", MakeDouble(env, event.lap_dist_pct)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "value", MakeDouble(env, event.value)));
+    NAPI_CALL(env, napi_set_element(env, result, static_cast<uint32_t>(i), item));
+  }
+  return result;
+}
+
+napi_value IncidentDetectorGetCounts(napi_env env, napi_callback_info info)
+{
+  IncidentDetectorHandle* handle = UnwrapThis<IncidentDetectorHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  const IncidentDetector& detector = *handle->detector;
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  for (size_t kind = 0; kind < static_cast<size_t>(IncidentKind::kCount); ++kind) {
+    IncidentKind value = static_cast<IncidentKind>(kind);
+    NAPI_CALL(env, napi_set_named_property(env, result, IncidentKindName(value),
+                                           MakeDouble(env, static_cast<double>(detector.count(value)))));
+  }
+  NAPI_CALL(env, napi_set_named_property(env, result, "dropped",
+                                         MakeDouble(env, static_cast<double>(detector.dropped()))));
+  return result;
+}
+
+napi_value IncidentDetectorClose(napi_env env, napi_callback_info info)
+{
+  IncidentDetectorHandle* handle = UnwrapThis<IncidentDetectorHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  handle->Detach();
+  return GetUndefined(env);
+}
+
+}  // namespace
+
+napi_value RegisterIncidentDetector(napi_env env, napi_value exports)
+{
+  napi_property_descriptor methods[] = {
+    {"takeEvents", nullptr, IncidentDetectorTakeEvents, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getCounts", nullptr, IncidentDetectorGetCounts, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"close", nullptr, IncidentDetectorClose, nullptr, nullptr, nullptr, napi_default, nullptr}
+  };
+
+  napi_value constructor = nullptr;
+  NAPI_CALL(env, napi_define_class(env, "IncidentDetector", NAPI_AUTO_LENGTH, IncidentDetectorConstructor, nullptr,
+                                   sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "IncidentDetector", constructor));
+  return exports;
+}
+
+}  // namespace irsdk_node
@@ -0,0 +1,99 @@
+// Per-car incident events from live telemetry: off-track excursions, sudden
+// stops, player spins and player incident count jumps.
+
+#ifndef IRSDK_NODE_INCIDENT_DETECTOR_H_
+#define IRSDK_NODE_INCIDENT_DETECTOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "telemetry_source.h"
+#include "tick_hub.h"
+#include "track_order.h"
+
+namespace irsdk_node {
+
+struct IncidentOptions {
+  // A stop is a car dropping below this fraction of its racing speed...
+  double stop_ratio = 0.1;
+  // ...within this many seconds of last being at half of it.
+  double stop_window_s = 3.0;
+  // Player spin: slip angle between heading and travel, above a minimum speed.
+  double spin_slip_deg = 70.0;
+  double spin_min_speed = 5.0;  // m/s
+  // Events kept until taken; older ones are dropped first.
+  size_t max_events = 1024;
+};
+
+enum class IncidentKind { kOffTrack, kRejoin, kStop, kSpin, kIncident, kCount };
+
+struct IncidentEvent {
+  IncidentKind kind;
+  int car_idx;
+  int session_num;
+  double session_time;
+  int replay_frame;  // -1 when ReplayFrameNum is not available.
+  double monotonic_ms;
+  int lap;
+  double lap_dist_pct;
+  // Rejoin: seconds off track. Stop: LapDistPct/s before the stop. Spin:
+  // slip angle in degrees when detected. Incident: count added.
+  double value;
+};
+
+class IncidentDetector : public TickListener {
+ public:
+  explicit IncidentDetector(const IncidentOptions& options);
+
+  void OnTick(const TelemetrySource& source, const TickStamp& stamp) override;
+
+  // Move out the events queued since the last call, oldest first.
+  void Take(std::vector<IncidentEvent>* events);
+
+  uint64_t count(IncidentKind kind) const { return counts_[static_cast<size_t>(kind)]; }
+  uint64_t dropped() const { return dropped_; }
+
+ private:
+  // Detection state of one car.
+  struct CarState {
+    double off_since = -1.0;  // SessionTime the excursion began, -1 on track.
+    double cruise_rate = 0.0;  // Smoothed LapDistPct/s while at racing speed.
+    double fast_time = -1.0;   // Last SessionTime at half the cruise rate.
+    bool stopped = false;
+  };
+
+  void DetectCars(const TelemetrySource& source, const TickStamp& stamp, double dt_s);
+  void DetectSpin(const TelemetrySource& source, const TickStamp& stamp);
+  void DetectIncidents(const TelemetrySource& source, const TickStamp& stamp);
+  void Emit(IncidentKind kind, int car_idx, const TickStamp& stamp, double value);
+
+  IncidentOptions options_;
+  TrackPositions positions_;
+  std::vector<CarState> cars_;
+
+  VarHandle pit_var_{"CarIdxOnPitRoad"};
+  VarHandle player_var_{"PlayerCarIdx"};
+  VarHandle incident_var_{"PlayerCarMyIncidentCount"};
+  VarHandle velocity_x_var_{"VelocityX"};
+  VarHandle velocity_y_var_{"VelocityY"};
+  VarHandle session_num_var_{"SessionNum"};
+  VarHandle frame_var_{"ReplayFrameNum"};
+
+  bool has_prev_ = false;
+  double prev_time_ = 0.0;
+  int session_num_ = 0;
+  int replay_frame_ = -1;
+  int player_ = -1;
+  int incident_count_ = -1;
+  bool spinning_ = false;
+
+  std::deque<IncidentEvent> events_;
+  uint64_t counts_[static_cast<size_t>(IncidentKind::kCount)] = {};
+  uint64_t dropped_ = 0;
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_INCIDENT_DETECTOR_H_
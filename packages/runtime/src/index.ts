@@ -7,11 +7,68 @@ import type {
   TelemetryVarHeader,
   SessionInfoObject,
   SessionUpdate,
-  IRacingConstants
+  TickTiming,
+  ClockFit,
+  IRacingConstants,
+  BroadcastQueueOptions,
+  BroadcastStats,
+  BroadcastAck,
+  BroadcastAckCondition,
+  BroadcastAckOptions,
+  Interpolator as InterpolatorClass,
+  Resampler as ResamplerClass,
+  IbtFile as IbtFileClass,
+  LapDelta as LapDeltaClass,
+  History as HistoryClass,
+  downsample as downsampleFn,
+  setSanityFilter as setSanityFilterFn,
+  getSanityFilterStats as getSanityFilterStatsFn,
+  BroadcastDispatcher as BroadcastDispatcherClass,
+  BroadcastAcks as BroadcastAcksClass,
+  BroadcastTimeline as BroadcastTimelineClass,
+  CameraDirector as CameraDirectorClass,
+  Relative as RelativeClass,
+  IncidentDetector as IncidentDetectorClass,
+  CornerAnalyzer as CornerAnalyzerClass,
+  LapStats as LapStatsClass,
+  PositionFilter as PositionFilterClass,
+  IbtTail as IbtTailClass,
+  IbtCatalog as IbtCatalogClass,
+  SessionLog as SessionLogClass,
+  VideoSync as VideoSyncClass,
+  Recorder as RecorderClass,
+  RecordingFile as RecordingFileClass,
+  alignIbt as alignIbtFn,
+  alignIbtAsync as alignIbtAsyncFn
 } from 'node-iracing-sdk-types';
 
 interface NativeBinding {
   constants?: IRacingConstants;
+  Interpolator: typeof InterpolatorClass;
+  Resampler: typeof ResamplerClass;
+  IbtFile: typeof IbtFileClass;
+  LapDelta: typeof LapDeltaClass;
+  History: typeof HistoryClass;
+  BroadcastDispatcher: typeof BroadcastDispatcherClass;
+  BroadcastAcks: typeof BroadcastAcksClass;
+  BroadcastTimeline: typeof BroadcastTimelineClass;
+  CameraDirector: typeof CameraDirectorClass;
+  Relative: typeof RelativeClass;
+  IncidentDetector: typeof IncidentDetectorClass;
+  CornerAnalyzer: typeof CornerAnalyzerClass;
+  LapStats: typeof LapStatsClass;
+  PositionFilter: typeof PositionFilterClass;
+  IbtTail: typeof IbtTailClass;
+  IbtCatalog: typeof IbtCatalogClass;
+  SessionLog: typeof SessionLogClass;
+  VideoSync: typeof VideoSyncClass;
+  Recorder: typeof RecorderClass;
+  RecordingFile: typeof RecordingFileClass;
+  downsample: typeof downsampleFn;
+  setSanityFilter: typeof setSanityFilterFn;
+  getSanityFilterStats: typeof getSanityFilterStatsFn;
+  alignIbt: typeof alignIbtFn;
+  alignIbtAsync: typeof alignIbtAsyncFn;
   waitForData(timeoutMs: number): boolean;
   isConnected(): boolean;
   getStatusId(): number;
@@ -23,6 +80,12 @@ interface NativeBinding {
   getVarHeaders(): TelemetryVarHeader[];
   getVarValue(name: string, entry?: number | null): TelemetryValue;
   broadcastMsg(msg: number, var1: number | string, var2: number, var3?: number): void;
+  getTickTiming(): TickTiming | null;
+  getClockFit(): ClockFit | null;
+  sessionTimeToMonotonic(sessionTime: number): number | null;
+  monotonicToSessionTime(monotonicMs: number): number | null;
+  sessionTimeToWall(sessionTime: number): number | null;
+  nowMonotonic(): number;
 }
 
 /**
@@ -72,6 +135,155 @@ const constants: IRacingConstants = binding.constants ?? {
   CameraFocusMode: emptyEnum()
 };
 
+/**
+ * Native sub-tick interpolator. Instances are fed by every tick a client
+ * polls, so they only update while a client is started.
+ */
+const Interpolator: typeof InterpolatorClass = binding.Interpolator;
+
+/**
+ * Native fixed-rate resampler over the live tick stream. Like Interpolator,
+ * it is fed by the ticks a started client polls.
+ */
+const Resampler: typeof ResamplerClass = binding.Resampler;
+
+/**
+ * Native reader for .ibt telemetry files; works without the sim running.
+ */
+const IbtFile: typeof IbtFileClass = binding.IbtFile;
+
+/**
+ * Native lap traces and live delta time for the player car, fed by the
+ * ticks a started client polls.
+ */
+const LapDelta: typeof LapDeltaClass = binding.LapDelta;
+
+/**
+ * Native ring buffers of recent telemetry for charting, fed by the ticks a
+ * started client polls.
+ */
+const History: typeof HistoryClass = binding.History;
+
+/**
+ * Native queued, rate-limited broadcast dispatcher. Sends on its own thread
+ * to the sim, or records to a mock sink for tests.
+ */
+const BroadcastDispatcher: typeof BroadcastDispatcherClass = binding.BroadcastDispatcher;
+
+/**
+ * Native confirmation of camera and replay broadcasts against telemetry.
+ * Conditions are matched on every tick a client polls.
+ */
+const BroadcastAcks: typeof BroadcastAcksClass = binding.BroadcastAcks;
+
+/**
+ * Native camera/replay scripts sent at SessionTime or replay positions.
+ * Cues are timed from the ticks a client polls.
+ */
+const BroadcastTimeline: typeof BroadcastTimelineClass = binding.BroadcastTimeline;
+
+/**
+ * Native automatic camera director: scores battles and incidents every tick
+ * and switches the broadcast camera through a debounced policy.
+ */
+const CameraDirector: typeof CameraDirectorClass = binding.CameraDirector;
+
+/**
+ * Native relative/radar query: cars ahead and behind a car with their gaps,
+ * from a track order kept sorted tick to tick.
+ */
+const Relative: typeof RelativeClass = binding.Relative;
+
+/**
+ * Native incident detector: off-track excursions, sudden stops, player spins and
+ * incident count jumps, queued as compact events with replay frame numbers.
+ */
+const IncidentDetector: typeof IncidentDetectorClass = binding.IncidentDetector;
+
+/**
+ * Native corner analysis of the player car: corners segmented from a reference
+ * lap, with entry/min/exit speed, brake point and time per corner every lap.
+ */
+const CornerAnalyzer: typeof CornerAnalyzerClass = binding.CornerAnalyzer;
+
+/**
+ * Native per-lap speed traps and channel min/max for every car, kept up to date
+ * tick by tick so lap crossings cost nothing.
+ */
+const LapStats: typeof LapStatsClass = binding.LapStats;
+
+/**
+ * Native Kalman smoothing of every car's CarIdxLapDistPct, with lap wrap handled,
+ * for steady map positions and gaps.
+ */
+const PositionFilter: typeof PositionFilterClass = binding.PositionFilter;
+
+/**
+ * Native follower of an .ibt file the sim is still writing, delivering
+ * new records as they land.
+ */
+const IbtTail: typeof IbtTailClass = binding.IbtTail;
+
+/**
+ * Native index of a directory tree of .ibt files: session metadata and per-lap
+ * summaries in a compact on-disk file with fast filtered queries.
+ */
+const IbtCatalog: typeof IbtCatalogClass = binding.IbtCatalog;
+
+/**
+ * Native change log of the session info YAML: every revision with its
+ * SessionTime and update count, stored as line deltas in an optional journal,
+ * with the session info at any point of a session on request.
+ */
+const SessionLog: typeof SessionLogClass = binding.SessionLog;
+
+/**
+ * Native timecode sidecar for video captures: every tick's monotonic stamp
+ * and video frame next to SessionTick, SessionTime and ReplayFrameNum, with
+ * interpolated lookups from any of them to the rest.
+ */
+const VideoSync: typeof VideoSyncClass = binding.VideoSync;
+
+/**
+ * Native crash-safe recorder: channels of every tick in fixed-size chunks,
+ * each with its own header, tick range and CRC-32.
+ */
+const Recorder: typeof RecorderClass = binding.Recorder;
+
+/**
+ * Native reader for recordings, seeking by time through the chunk headers
+ * and skipping damaged chunks.
+ */
+const RecordingFile: typeof RecordingFileClass = binding.RecordingFile;
+
+/**
+ * Native LTTB and min/max downsampling of any x/y series.
+ */
+const downsample: typeof downsampleFn = binding.downsample;
+
+/**
+ * Configure the native sanity filter that clamps or masks NaNs, out-of-range
+ * values and implausible jumps in live telemetry; null disables it.
+ */
+const setSanityFilter: typeof setSanityFilterFn = binding.setSanityFilter;
+
+/**
+ * Counts of the samples the sanity filter replaced, per channel.
+ */
+const getSanityFilterStats: typeof getSanityFilterStatsFn = binding.getSanityFilterStats;
+
+/**
+ * Align several .ibt files of one session on SessionTime or lap distance,
+ * decoded in parallel into a shared columnar frame.
+ */
+const alignIbt: typeof alignIbtFn = binding.alignIbt;
+
+/**
+ * alignIbt on the libuv thread pool, with progress in files and cancellation
+ * through an AbortSignal.
+ */
+const alignIbtAsync: typeof alignIbtAsyncFn = binding.alignIbtAsync;
+
 class IRacingClient extends EventEmitter {
   private _pollIntervalMs: number;
   private _waitTimeoutMs: number;
@@ -81,6 +293,10 @@ class IRacingClient extends EventEmitter {
   private _timer: NodeJS.Timeout | null;
   private _connected: boolean;
   private _lastSessionUpdate: number;
+  private _broadcastQueue: BroadcastQueueOptions | null;
+  private _dispatcher: BroadcastDispatcherClass | null;
+  private _acks: BroadcastAcksClass | null;
+  private _ackTimer: NodeJS.Timeout | null;
 
   /**
    * Create a new telemetry client with optional polling configuration.
@@ -88,6 +304,7 @@ class IRacingClient extends EventEmitter {
    * @param options.waitTimeoutMs Wait timeout in milliseconds passed to the native wait.
    * @param options.telemetryVariables Names of telemetry variables to read on each tick.
    * @param options.emitSessionOnConnect Emit session payload immediately on connect.
+   * @param options.broadcastQueue Send broadcast messages through a native rate-limited queue.
    * @returns A new IRacingClient instance.
    */
   constructor(options: IRacingClientOptions = {}) {
@@ -97,7 +314,8 @@ class IRacingClient extends EventEmitter {
       pollIntervalMs = 16,
       waitTimeoutMs = 0,
       telemetryVariables,
-      emitSessionOnConnect = true
+      emitSessionOnConnect = true,
+      broadcastQueue = false
     } = options;
     const hasTelemetryOptions = Object.prototype.hasOwnProperty.call(options, 'telemetryVariables');
 
@@ -107,11 +325,15 @@ class IRacingClient extends EventEmitter {
     this._telemetryVars = Array.isArray(telemetryVariables) ? telemetryVariables.slice() : [];
     this._useAllTelemetry = !hasTelemetryOptions;
     this._emitSessionOnConnect = emitSessionOnConnect !== false;
+    this._broadcastQueue = broadcastQueue === true ? {} : broadcastQueue || null;
 
     // Initialize runtime state.
     this._timer = null;
     this._connected = false;
     this._lastSessionUpdate = -1;
+    this._dispatcher = null;
+    this._acks = null;
+    this._ackTimer = null;
   }
 
   /**
@@ -186,6 +408,58 @@ class IRacingClient extends EventEmitter {
     return binding.getVarValue(name, entry);
   }
 
+  /**
+   * Get timing for the most recent telemetry tick, stamped natively when the
+   * sim signalled that the data was ready.
+   * @returns Tick timing or null before the first tick.
+   */
+  getTickTiming(): TickTiming | null {
+    return binding.getTickTiming();
+  }
+
+  /**
+   * Get the running fit between SessionTime and the monotonic clock.
+   * @returns Fit parameters or null until enough ticks have been stamped.
+   */
+  getClockFit(): ClockFit | null {
+    return binding.getClockFit();
+  }
+
+  /**
+   * Map a SessionTime to the monotonic clock used for tick stamps.
+   * @param sessionTime Session time in seconds.
+   * @returns Monotonic time in milliseconds or null without a fit.
+   */
+  sessionTimeToMonotonic(sessionTime: number): number | null {
+    return binding.sessionTimeToMonotonic(sessionTime);
+  }
+
+  /**
+   * Map a monotonic timestamp to SessionTime.
+   * @param monotonicMs Monotonic time in milliseconds.
+   * @returns Session time in seconds or null without a fit.
+   */
+  monotonicToSessionTime(monotonicMs: number): number | null {
+    return binding.monotonicToSessionTime(monotonicMs);
+  }
+
+  /**
+   * Map a SessionTime to wall-clock time.
+   * @param sessionTime Session time in seconds.
+   * @returns Unix epoch milliseconds or null without a fit.
+   */
+  sessionTimeToWall(sessionTime: number): number | null {
+    return binding.sessionTimeToWall(sessionTime);
+  }
+
+  /**
+   * Read the monotonic clock used for tick stamps.
+   * @returns Monotonic time in milliseconds.
+   */
+  nowMonotonic(): number {
+    return binding.nowMonotonic();
+  }
+
   /**
    * Send a raw broadcast message with optional third parameter.
    * @param msg Broadcast message id.
@@ -195,12 +469,13 @@ class IRacingClient extends EventEmitter {
    * @returns void
    */
   broadcastMsg(msg: number, var1: number | string, var2: number, var3?: number): void {
+    const send = this._broadcastSender();
     // Use the 3-argument native call only when a valid third value is provided.
     if (Number.isFinite(var3)) {
-      binding.broadcastMsg(msg, var1, var2, var3);
+      send(msg, var1, var2, var3);
       return;
     }
-    binding.broadcastMsg(msg, var1, var2);
+    send(msg, var1, var2);
   }
 
   /**
@@ -211,7 +486,15 @@ class IRacingClient extends EventEmitter {
    * @returns void
    */
   broadcastMsgFloat(msg: number, var1: number | string, value: number): void {
-    binding.broadcastMsg(msg, var1, value);
+    this._broadcastSender()(msg, var1, value);
+  }
+
+  /**
+   * Read the counters of the broadcast queue.
+   * @returns Queue statistics, or null when the client sends directly.
+   */
+  getBroadcastStats(): BroadcastStats | null {
+    return this._dispatcher ? this._dispatcher.getStats() : null;
   }
 
   /**
@@ -357,6 +640,103 @@ class IRacingClient extends EventEmitter {
     this.broadcastMsg(constants.BroadcastMsg.VideoCapture, mode, 0);
   }
 
+  /**
+   * Switch camera by car position and wait until the sim shows it.
+   * @param carPos Car position index.
+   * @param group Camera group.
+   * @param camera Camera index.
+   * @param options.timeoutMs Reject when telemetry does not confirm the switch in time.
+   * @returns Promise resolved with the confirming tick.
+   */
+  switchCameraByPosAsync(carPos: number, group: number, camera: number, options: BroadcastAckOptions = {}): Promise<BroadcastAck> {
+    return this._sendAcknowledged(() => this.switchCameraByPos(carPos, group, camera), {
+      kind: 'camera',
+      carPos,
+      group,
+      camera,
+      timeoutMs: options.timeoutMs
+    });
+  }
+
+  /**
+   * Switch camera by driver number and wait until the sim shows it.
+   * @param driverNum Driver number or string identifier.
+   * @param group Camera group.
+   * @param camera Camera index.
+   * @param options.timeoutMs Reject when telemetry does not confirm the switch in time.
+   * @returns Promise resolved with the confirming tick.
+   */
+  switchCameraByNumAsync(driverNum: number | string, group: number, camera: number, options: BroadcastAckOptions = {}): Promise<BroadcastAck> {
+    return this._sendAcknowledged(() => this.switchCameraByNum(driverNum, group, camera), {
+      kind: 'camera',
+      carIdx: this._carIdxForNumber(driverNum),
+      group,
+      camera,
+      timeoutMs: options.timeoutMs
+    });
+  }
+
+  /**
+   * Set replay playback speed and wait until the sim reports it.
+   * @param speed Playback speed.
+   * @param slowMotion Slow motion flag value.
+   * @param options.timeoutMs Reject when telemetry does not confirm the change in time.
+   * @returns Promise resolved with the confirming tick.
+   */
+  replaySetPlaySpeedAsync(speed: number, slowMotion: number = 0, options: BroadcastAckOptions = {}): Promise<BroadcastAck> {
+    return this._sendAcknowledged(() => this.replaySetPlaySpeed(speed, slowMotion), {
+      kind: 'replaySpeed',
+      speed,
+      slowMotion,
+      timeoutMs: options.timeoutMs
+    });
+  }
+
+  /**
+   * Set replay position by frame number and wait until the replay gets there.
+   * @param mode Position mode enum value.
+   * @param frameNumber Frame number.
+   * @param options.timeoutMs Reject when telemetry does not confirm the seek in time.
+   * @returns Promise resolved with the confirming tick.
+   */
+  replaySetPlayPositionAsync(mode: number, frameNumber: number, options: BroadcastAckOptions = {}): Promise<BroadcastAck> {
+    return this._sendAcknowledged(() => this.replaySetPlayPosition(mode, frameNumber), {
+      kind: 'replayFrame',
+      mode,
+      frame: frameNumber,
+      timeoutMs: options.timeoutMs
+    });
+  }
+
+  /**
+   * Search the replay and wait until the replay jumps.
+   * @param mode Replay search mode enum value.
+   * @param options.timeoutMs Reject when the replay does not jump in time.
+   * @returns Promise resolved with the confirming tick.
+   */
+  replaySearchAsync(mode: number, options: BroadcastAckOptions = {}): Promise<BroadcastAck> {
+    return this._sendAcknowledged(() => this.replaySearch(mode), {
+      kind: 'replayJump',
+      timeoutMs: options.timeoutMs
+    });
+  }
+
+  /**
+   * Search replay by session time and wait until the replay gets there.
+   * @param sessionNum Session number.
+   * @param sessionTimeMs Session time in milliseconds.
+   * @param options.timeoutMs Reject when telemetry does not confirm the seek in time.
+   * @returns Promise resolved with the confirming tick.
+   */
+  replaySearchSessionTimeAsync(sessionNum: number, sessionTimeMs: number, options: BroadcastAckOptions = {}): Promise<BroadcastAck> {
+    return this._sendAcknowledged(() => this.replaySearchSessionTime(sessionNum, sessionTimeMs), {
+      kind: 'replaySessionTime',
+      sessionNum,
+      sessionTime: sessionTimeMs / 1000,
+      timeoutMs: options.timeoutMs
+    });
+  }
+
   /**
    * Start the polling loop if not already running.
    * @returns void
@@ -385,12 +765,90 @@ class IRacingClient extends EventEmitter {
     }
   }
 
+  /**
+   * Pick the native path for broadcast messages: the queued dispatcher when
+   * the client was created with broadcastQueue, otherwise a direct send.
+   * @returns Function that sends or queues one broadcast message.
+   */
+  private _broadcastSender(): (msg: number, var1: number | string, var2: number, var3?: number) => unknown {
+    if (!this._broadcastQueue) {
+      return binding.broadcastMsg;
+    }
+    // Created on first use so clients that never broadcast start no thread.
+    if (!this._dispatcher) {
+      this._dispatcher = new BroadcastDispatcher({ ...this._broadcastQueue, sink: 'sim' });
+    }
+    const dispatcher = this._dispatcher;
+    return (msg, var1, var2, var3) => dispatcher.send(msg, var1, var2, var3);
+  }
+
+  /**
+   * Send a broadcast and watch telemetry for its effect.
+   * @param send Sends the broadcast.
+   * @param condition Telemetry that confirms it.
+   * @returns Promise settled by the native matcher.
+   */
+  private _sendAcknowledged(send: () => void, condition: BroadcastAckCondition): Promise<BroadcastAck> {
+    try {
+      send();
+    } catch (error) {
+      return Promise.reject(error);
+    }
+    // Created on first use; the matcher then runs on every polled tick.
+    if (!this._acks) {
+      this._acks = new BroadcastAcks();
+    }
+    const ack = this._acks.expect(condition);
+    this._scheduleAckExpiry();
+    return ack;
+  }
+
+  /**
+   * Time out acknowledgements on their own timer, so they settle even when
+   * polling stops. The timer is unref'd and rearmed for the next deadline.
+   * @returns void
+   */
+  private _scheduleAckExpiry(): void {
+    if (this._ackTimer) {
+      clearTimeout(this._ackTimer);
+      this._ackTimer = null;
+    }
+    const nextMs = this._acks ? this._acks.expire() : null;
+    if (nextMs === null) {
+      return;
+    }
+    // The extra millisecond covers timers firing on a clock rounded down.
+    this._ackTimer = setTimeout(() => this._scheduleAckExpiry(), Math.ceil(nextMs) + 1);
+    this._ackTimer.unref();
+  }
+
+  /**
+   * Look up the car index of a driver number in the session info.
+   * @param driverNum Car number, as a number or a string with leading zeros.
+   * @returns Car index, or -1 when it cannot be found.
+   */
+  private _carIdxForNumber(driverNum: number | string): number {
+    const driverInfo = binding.getSessionInfoObj()?.DriverInfo as SessionInfoObject | undefined;
+    const drivers = (driverInfo?.Drivers ?? []) as SessionInfoObject[];
+    const match = drivers.find((driver) =>
+      typeof driverNum === 'string'
+        ? String(driver.CarNumber) === driverNum
+        : Number(driver.CarNumberRaw) === driverNum
+    );
+    return match ? Number(match.CarIdx) : -1;
+  }
+
   /**
    * Poll native state and emit events.
    * @returns void
    */
   private _tick(): void {
     try {
+      // Time out acknowledgements even when no ticks arrive.
+      if (this._acks) {
+        this._acks.expire();
+      }
+
       // Wait for new data and read connection state.
       const hadData = binding.waitForData(this._waitTimeoutMs);
       const isConnected = binding.isConnected();
@@ -420,15 +878,17 @@ class IRacingClient extends EventEmitter {
           this._emitSessionUpdate();
         }
 
-        // Emit all telemetry variables, or only the configured subset.
+        // Emit all telemetry variables, or only the configured subset,
+        // along with the native timing for this tick.
+        const timing = binding.getTickTiming();
         if (this._useAllTelemetry) {
           const telemetry = binding.readAllVars();
           if (telemetry) {
-            this.emit('telemetry', telemetry);
+            this.emit('telemetry', telemetry, timing);
           }
         } else if (this._telemetryVars.length > 0) {
           const telemetry = binding.readVars(this._telemetryVars);
-          this.emit('telemetry', telemetry);
+          this.emit('telemetry', telemetry, timing);
         }
       }
     } catch (error) {
@@ -456,4 +916,4 @@ class IRacingClient extends EventEmitter {
   }
 }
 
-export { IRacingClient, constants };
+export { IRacingClient, Interpolator, Resampler, IbtFile, LapDelta, History, downsample, BroadcastDispatcher, BroadcastAcks, BroadcastTimeline, CameraDirector, Relative, IncidentDetector, CornerAnalyzer, LapStats, setSanityFilter, getSanityFilterStats, PositionFilter, IbtTail, IbtCatalog, SessionLog, VideoSync, Recorder, RecordingFile, alignIbt, alignIbtAsync, constants };
@@ -0,0 +1,337 @@
+// Sub-tick interpolation and extrapolation of telemetry channels.
+
+#include "interpolator.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include "bindings.h"
+#include "napi_util.h"
+
+namespace irsdk_node {
+
+Interpolator::Interpolator(std::vector<ChannelSpec> channels, double max_extrapolation_ms, size_t history)
+    : channels_(std::move(channels)),
+      max_extrapolation_ms_(std::max(0.0, max_extrapolation_ms)),
+      capacity_(std::max<size_t>(2, history))
+{
+  for (const ChannelSpec& channel : channels_) {
+    vars_.emplace_back(channel.name);
+  }
+  times_.assign(capacity_, 0.0);
+}
+
+void Interpolator::ResetLayout(const TelemetrySource& source)
+{
+  slots_.clear();
+  total_entries_ = 0;
+  for (size_t i = 0; i < channels_.size(); ++i) {
+    // Missing variables keep a single NaN slot so the layout stays stable.
+    int count = vars_[i].Resolve(source) ? std::max(1, vars_[i].count()) : 1;
+    slots_.push_back(Slot{channels_[i].name, total_entries_, count});
+    total_entries_ += static_cast<size_t>(count);
+  }
+  values_.assign(capacity_ * total_entries_, 0.0);
+  head_ = 0;
+  size_ = 0;
+  last_session_tick_ = -1;
+}
+
+void Interpolator::OnTick(const TelemetrySource& source, const TickStamp& stamp)
+{
+  bool layout_changed = slots_.empty();
+  for (size_t i = 0; i < vars_.size() && !layout_changed; ++i) {
+    int before = vars_[i].count();
+    vars_[i].Resolve(source);
+    layout_changed = vars_[i].count() != before;
+  }
+  if (layout_changed) {
+    ResetLayout(source);
+  }
+
+  // Repeated ticks (paused sim, duplicate reads) carry no new motion.
+  if (size_ > 0 && stamp.session_tick == last_session_tick_) {
+    return;
+  }
+  last_session_tick_ = stamp.session_tick;
+
+  times_[head_] = stamp.monotonic_ms;
+  double* row = &values_[head_ * total_entries_];
+  for (size_t i = 0; i < vars_.size(); ++i) {
+    const Slot& slot = slots_[i];
+    for (int entry = 0; entry < slot.count; ++entry) {
+      row[slot.offset + static_cast<size_t>(entry)] = vars_[i].valid()
+          ? vars_[i].Get(source, entry)
+          : std::numeric_limits<double>::quiet_NaN();
+    }
+  }
+
+  head_ = (head_ + 1) % capacity_;
+  size_ = std::min(size_ + 1, capacity_);
+}
+
+const double* Interpolator::ValuesAt(size_t age) const
+{
+  size_t index = (head_ + capacity_ - 1 - age) % capacity_;
+  return &values_[index * total_entries_];
+}
+
+double Interpolator::TimeAt(size_t age) const
+{
+  return times_[(head_ + capacity_ - 1 - age) % capacity_];
+}
+
+double Interpolator::LastTickMs() const
+{
+  return size_ > 0 ? TimeAt(0) : 0.0;
+}
+
+bool Interpolator::Sample(double render_ms, double* out) const
+{
+  if (size_ == 0) {
+    return false;
+  }
+
+  const double* newest = ValuesAt(0);
+  size_t from_age = 0;
+  size_t to_age = 0;
+  double fraction = 1.0;
+
+  double newest_ms = TimeAt(0);
+  if (size_ == 1) {
+    std::copy(newest, newest + total_entries_, out);
+    return true;
+  }
+
+  if (render_ms >= newest_ms) {
+    // Extrapolate from the last two ticks, holding after the horizon.
+    double span = newest_ms - TimeAt(1);
+    if (span <= 0.0) {
+      std::copy(newest, newest + total_entries_, out);
+      return true;
+    }
+    double ahead = std::min(render_ms - newest_ms, max_extrapolation_ms_);
+    from_age = 1;
+    to_age = 0;
+    fraction = 1.0 + ahead / span;
+  } else {
+    size_t age = 0;
+    while (age + 1 < size_ && TimeAt(age + 1) > render_ms) {
+      age += 1;
+    }
+    if (age + 1 >= size_) {
+      // Older than anything retained; hold the oldest tick.
+      const double* oldest = ValuesAt(size_ - 1);
+      std::copy(oldest, oldest + total_entries_, out);
+      return true;
+    }
+    from_age = age + 1;
+    to_age = age;
+    double span = TimeAt(to_age) - TimeAt(from_age);
+    fraction = span > 0.0 ? (render_ms - TimeAt(from_age)) / span : 1.0;
+  }
+
+  const double* from = ValuesAt(from_age);
+  const double* to = ValuesAt(to_age);
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    const Slot& slot = slots_[i];
+    ChannelKind kind = channels_[i].kind;
+    for (int entry = 0; entry < slot.count; ++entry) {
+      size_t k = slot.offset + static_cast<size_t>(entry);
+      out[k] = BlendChannel(kind, from[k], to[k], fraction);
+    }
+  }
+  return true;
+}
+
+namespace {
+
+// JS wrapper that keeps the interpolator attached to the live tick stream
+// until close() or garbage collection.
+struct InterpolatorHandle {
+  std::unique_ptr<Interpolator> interpolator;
+  bool attached = false;
+
+  void Detach()
+  {
+    if (attached) {
+      TickHub::Instance().Remove(interpolator.get());
+      attached = false;
+    }
+  }
+};
+
+void FinalizeInterpolator(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  InterpolatorHandle* handle = static_cast<InterpolatorHandle*>(data);
+  handle->Detach();
+  delete handle;
+}
+
+napi_value InterpolatorConstructor(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value self = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+  napi_value options = argc >= 1 ? args[0] : nullptr;
+  napi_value channels_value = nullptr;
+  if (!GetOptionalProperty(env, options, "channels", &channels_value)) {
+    napi_throw_type_error(env, nullptr, "Interpolator expects ({ channels, maxExtrapolationMs?, history? })");
+    return nullptr;
+  }
+
+  std::vector<ChannelSpec> channels;
+  if (!ParseChannelSpecs(env, channels_value, &channels)) {
+    return nullptr;
+  }
+
+  double max_extrapolation_ms = 50.0;
+  int history = 4;
+  if (!GetOptionalDouble(env, options, "maxExtrapolationMs", &max_extrapolation_ms) ||
+      !GetOptionalInt(env, options, "history", &history)) {
+    return nullptr;
+  }
+
+  auto* handle = new InterpolatorHandle();
+  handle->interpolator.reset(
+      new Interpolator(std::move(channels), max_extrapolation_ms, static_cast<size_t>(std::max(2, history))));
+  napi_status status = napi_wrap(env, self, handle, FinalizeInterpolator, nullptr, nullptr);
+  if (status != napi_ok) {
+    delete handle;
+    CheckNapi(env, status);
+    return nullptr;
+  }
+
+  TickHub::Instance().Add(handle->interpolator.get());
+  handle->attached = true;
+  return self;
+}
+
+napi_value InterpolatorSample(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  InterpolatorHandle* handle = UnwrapThis<InterpolatorHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  if (argc < 1) {
+    napi_throw_type_error(env, nullptr, "sample expects (renderTimeMs)");
+    return nullptr;
+  }
+  double render_ms = 0.0;
+  NAPI_CALL(env, napi_get_value_double(env, args[0], &render_ms));
+
+  const Interpolator& interpolator = *handle->interpolator;
+  std::vector<double> values(interpolator.TotalEntries());
+  if (!interpolator.Sample(render_ms, values.data())) {
+    return GetNull(env);
+  }
+
+  // Scalars come back as numbers and array channels as Float64Arrays.
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  for (const Interpolator::Slot& slot : interpolator.Layout()) {
+    napi_value value = slot.count == 1
+        ? MakeDouble(env, values[slot.offset])
+        : MakeFloat64Array(env, values.data() + slot.offset, static_cast<size_t>(slot.count));
+    NAPI_CALL(env, napi_set_named_property(env, result, slot.name.c_str(), value));
+  }
+  return result;
+}
+
+napi_value InterpolatorSampleInto(napi_env env, napi_callback_info info)
+{
+  size_t argc = 2;
+  napi_value args[2];
+  InterpolatorHandle* handle = UnwrapThis<InterpolatorHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  if (argc < 2) {
+    napi_throw_type_error(env, nullptr, "sampleInto expects (renderTimeMs, Float64Array)");
+    return nullptr;
+  }
+  double render_ms = 0.0;
+  NAPI_CALL(env, napi_get_value_double(env, args[0], &render_ms));
+
+  bool is_typedarray = false;
+  NAPI_CALL(env, napi_is_typedarray(env, args[1], &is_typedarray));
+  napi_typedarray_type type = napi_int8_array;
+  size_t length = 0;
+  void* data = nullptr;
+  if (is_typedarray) {
+    NAPI_CALL(env, napi_get_typedarray_info(env, args[1], &type, &length, &data, nullptr, nullptr));
+  }
+  if (!is_typedarray || type != napi_float64_array) {
+    napi_throw_type_error(env, nullptr, "sampleInto expects a Float64Array");
+    return nullptr;
+  }
+
+  const Interpolator& interpolator = *handle->interpolator;
+  if (length < interpolator.TotalEntries()) {
+    napi_throw_range_error(env, nullptr, "output array is smaller than the interpolator layout");
+    return nullptr;
+  }
+  if (!interpolator.Sample(render_ms, static_cast<double*>(data))) {
+    return MakeInt(env, 0);
+  }
+  return MakeInt(env, static_cast<int>(interpolator.TotalEntries()));
+}
+
+napi_value InterpolatorGetLayout(napi_env env, napi_callback_info info)
+{
+  InterpolatorHandle* handle = UnwrapThis<InterpolatorHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+
+  const std::vector<Interpolator::Slot>& layout = handle->interpolator->Layout();
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_array_with_length(env, layout.size(), &result));
+  for (size_t i = 0; i < layout.size(); ++i) {
+    napi_value entry = nullptr;
+    NAPI_CALL(env, napi_create_object(env, &entry));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "name", MakeString(env, layout[i].name)));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "offset", MakeInt(env, static_cast<int>(layout[i].offset))));
+    NAPI_CALL(env, napi_set_named_property(env, entry, "count", MakeInt(env, layout[i].count)));
+    NAPI_CALL(env, napi_set_element(env, result, static_cast<uint32_t>(i), entry));
+  }
+  return result;
+}
+
+napi_value InterpolatorClose(napi_env env, napi_callback_info info)
+{
+  InterpolatorHandle* handle = UnwrapThis<InterpolatorHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  handle->Detach();
+  return GetUndefined(env);
+}
+
+}  // namespace
+
+napi_value RegisterInterpolator(napi_env env, napi_value exports)
+{
+  napi_property_descriptor methods[] = {
+    {"sample", nullptr, InterpolatorSample, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"sampleInto", nullptr, InterpolatorSampleInto, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getLayout", nullptr, InterpolatorGetLayout, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"close", nullptr, InterpolatorClose, nullptr, nullptr, nullptr, napi_default, nullptr}
+  };
+
+  napi_value constructor = nullptr;
+  NAPI_CALL(env, napi_define_class(env, "Interpolator", NAPI_AUTO_LENGTH, InterpolatorConstructor, nullptr,
+                                   sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "Interpolator", constructor));
+  return exports;
+}
+
+}  // namespace irsdk_node
@@ -0,0 +1,62 @@
+// Sub-tick interpolation and extrapolation of telemetry channels for
+// overlays that render faster than the 60 Hz telemetry rate.
+
+#ifndef IRSDK_NODE_INTERPOLATOR_H_
+#define IRSDK_NODE_INTERPOLATOR_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "channel_spec.h"
+#include "telemetry_source.h"
+#include "tick_hub.h"
+
+namespace irsdk_node {
+
+class Interpolator : public TickListener {
+ public:
+  struct Slot {
+    std::string name;
+    size_t offset;
+    int count;
+  };
+
+  Interpolator(std::vector<ChannelSpec> channels, double max_extrapolation_ms, size_t history);
+
+  void OnTick(const TelemetrySource& source, const TickStamp& stamp) override;
+
+  // Write values for render_ms into out, which must hold TotalEntries()
+  // doubles. Times before the newest tick interpolate between the bracketing
+  // ticks; later times extrapolate with the latest velocity for at most
+  // max_extrapolation_ms. Returns false until the first tick arrived.
+  bool Sample(double render_ms, double* out) const;
+
+  size_t TotalEntries() const { return total_entries_; }
+  const std::vector<Slot>& Layout() const { return slots_; }
+  size_t SampleCount() const { return size_; }
+  double LastTickMs() const;
+
+ private:
+  void ResetLayout(const TelemetrySource& source);
+  const double* ValuesAt(size_t age) const;
+  double TimeAt(size_t age) const;
+
+  std::vector<ChannelSpec> channels_;
+  std::vector<VarHandle> vars_;
+  std::vector<Slot> slots_;
+  size_t total_entries_ = 0;
+  double max_extrapolation_ms_;
+
+  // Ring of the last `capacity_` ticks, newest at age 0.
+  size_t capacity_;
+  size_t head_ = 0;
+  size_t size_ = 0;
+  std::vector<double> times_;
+  std::vector<double> values_;
+  int last_session_tick_ = -1;
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_INTERPOLATOR_H_
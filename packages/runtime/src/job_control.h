@@ -0,0 +1,22 @@
+// Progress and cancellation hook for long-running .ibt work. Work that takes
+// a JobControl reports as it advances and stops when told to; a null control
+// runs to completion unobserved.
+
+#ifndef IRSDK_NODE_JOB_CONTROL_H_
+#define IRSDK_NODE_JOB_CONTROL_H_
+
+namespace irsdk_node {
+
+class JobControl {
+ public:
+  virtual ~JobControl() = default;
+
+  // Work advanced to done out of total, in units chosen by the work. May be
+  // called from several worker threads at once. Returns false once the job
+  // has been cancelled; the work should then stop and fail.
+  virtual bool Update(double done, double total) = 0;
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_JOB_CONTROL_H_
@@ -0,0 +1,436 @@
+// Distance-aligned lap traces of the player car and live delta time.
+
+#include "lap_delta.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include "bindings.h"
+#include "napi_util.h"
+
+namespace irsdk_node {
+
+namespace {
+
+// Largest forward LapDistPct step between ticks still treated as driving;
+// bigger jumps are tows, resets or replay seeks and void the lap.
+constexpr double kMaxStep = 0.05;
+// Backward steps smaller than this are position noise while stationary.
+constexpr double kJitter = 0.001;
+// Smoothing factor for the delta rate.
+constexpr double kRateAlpha = 0.1;
+
+}  // namespace
+
+LapDelta::LapDelta(std::vector<ChannelSpec> channels, int grid_points)
+    : channels_(std::move(channels)),
+      grid_points_(std::max(10, grid_points))
+{
+  for (const ChannelSpec& channel : channels_) {
+    vars_.emplace_back(channel.name);
+  }
+  prev_values_.assign(channels_.size(), 0.0);
+  sample_.assign(channels_.size(), 0.0);
+  scratch_.assign(channels_.size(), 0.0);
+}
+
+const LapTrace* LapDelta::reference() const
+{
+  return reference_source_ == ReferenceSource::kFixed ? &fixed_ : best();
+}
+
+void LapDelta::SetReference(LapTrace trace)
+{
+  fixed_ = std::move(trace);
+  reference_source_ = ReferenceSource::kFixed;
+}
+
+bool LapDelta::GetStatus(LapDeltaStatus* out) const
+{
+  if (!status_valid_) {
+    return false;
+  }
+  *out = status_;
+  return true;
+}
+
+void LapDelta::ReadChannels(const TelemetrySource& source, double* out)
+{
+  for (size_t i = 0; i < vars_.size(); ++i) {
+    out[i] = vars_[i].Resolve(source) ? vars_[i].Get(source) : std::numeric_limits<double>::quiet_NaN();
+  }
+}
+
+void LapDelta::StartLap(double time, int lap, const double* values)
+{
+  recording_ = true;
+  lap_start_ = time;
+  current_.lap = lap;
+  current_.lap_time = 0.0;
+  current_.times.assign(static_cast<size_t>(grid_points_), 0.0);
+  current_.values.assign(static_cast<size_t>(grid_points_) * channels_.size(), 0.0);
+  std::copy(values, values + channels_.size(), current_.values.begin());
+  next_grid_ = 1;
+}
+
+void LapDelta::FillGrid(double from_pct, double from_t, const double* from,
+                        double to_pct, double to_t, const double* to)
+{
+  double span = to_pct - from_pct;
+  size_t width = channels_.size();
+  while (next_grid_ < grid_points_) {
+    double grid = static_cast<double>(next_grid_) / grid_points_;
+    if (grid > to_pct) {
+      break;
+    }
+    double fraction = span > 0.0 ? (grid - from_pct) / span : 1.0;
+    current_.times[static_cast<size_t>(next_grid_)] = from_t + (to_t - from_t) * fraction - lap_start_;
+    double* row = &current_.values[static_cast<size_t>(next_grid_) * width];
+    for (size_t i = 0; i < width; ++i) {
+      row[i] = BlendChannel(channels_[i].kind, from[i], to[i], fraction);
+    }
+    next_grid_ += 1;
+  }
+}
+
+void LapDelta::FinishLap(double time)
+{
+  // Laps joined mid-way or interrupted never reach here with every point.
+  if (next_grid_ < grid_points_) {
+    return;
+  }
+  current_.lap_time = time - lap_start_;
+  last_ = current_;
+  if (!best() || current_.lap_time < best_.lap_time) {
+    best_ = current_;
+  }
+}
+
+double LapDelta::ReferenceTimeAt(const LapTrace& reference, double pct) const
+{
+  double position = std::min(std::max(pct, 0.0), 1.0) * grid_points_;
+  int index = std::min(static_cast<int>(position), grid_points_ - 1);
+  double fraction = position - index;
+  double from = reference.times[static_cast<size_t>(index)];
+  double to = index + 1 < grid_points_ ? reference.times[static_cast<size_t>(index) + 1] : reference.lap_time;
+  return from + (to - from) * fraction;
+}
+
+void LapDelta::UpdateDelta(double t, double pct)
+{
+  const LapTrace* ref = reference();
+  if (!recording_ || !ref || static_cast<int>(ref->times.size()) != grid_points_) {
+    status_valid_ = false;
+    return;
+  }
+
+  double elapsed = t - lap_start_;
+  double delta = elapsed - ReferenceTimeAt(*ref, pct);
+  double rate = 0.0;
+  // A new lap restarts the delta near zero; do not read that as a rate.
+  if (status_valid_ && status_.lap == current_.lap && elapsed > status_.elapsed && t > prev_t_) {
+    double instant = (delta - status_.delta) / (t - prev_t_);
+    rate = status_.delta_rate + kRateAlpha * (instant - status_.delta_rate);
+  }
+
+  status_.lap = current_.lap;
+  status_.lap_dist_pct = pct;
+  status_.elapsed = elapsed;
+  status_.delta = delta;
+  status_.delta_rate = rate;
+  status_.reference_lap_time = ref->lap_time;
+  status_valid_ = true;
+}
+
+void LapDelta::OnTick(const TelemetrySource& source, const TickStamp& stamp)
+{
+  if (!pct_var_.Resolve(source)) {
+    recording_ = false;
+    status_valid_ = false;
+    has_prev_ = false;
+    return;
+  }
+
+  double t = stamp.session_time;
+  double pct = pct_var_.Get(source);
+  int lap = lap_var_.Resolve(source) ? static_cast<int>(lap_var_.Get(source)) : -1;
+  ReadChannels(source, sample_.data());
+
+  if (has_prev_ && t == prev_t_) {
+    return;
+  }
+
+  if (!has_prev_ || t < prev_t_ || pct < 0.0 || prev_pct_ < 0.0) {
+    // Start of data, new session or car not in the world.
+    recording_ = false;
+  } else {
+    double step = pct - prev_pct_;
+    if (step < -0.5) {
+      // Crossed the start/finish line; place the crossing between the ticks.
+      double span = pct + 1.0 - prev_pct_;
+      double fraction = span > 0.0 ? (1.0 - prev_pct_) / span : 0.0;
+      double cross_t = prev_t_ + (t - prev_t_) * fraction;
+      for (size_t i = 0; i < scratch_.size(); ++i) {
+        scratch_[i] = BlendChannel(channels_[i].kind, prev_values_[i], sample_[i], fraction);
+      }
+      if (recording_) {
+        FillGrid(prev_pct_, prev_t_, prev_values_.data(), 1.0, cross_t, scratch_.data());
+        FinishLap(cross_t);
+      }
+      StartLap(cross_t, lap, scratch_.data());
+      FillGrid(0.0, cross_t, scratch_.data(), pct, t, sample_.data());
+    } else if (step > kMaxStep || step < -kJitter) {
+      recording_ = false;
+    } else if (recording_ && step > 0.0) {
+      FillGrid(prev_pct_, prev_t_, prev_values_.data(), pct, t, sample_.data());
+    }
+  }
+
+  UpdateDelta(t, pct);
+
+  has_prev_ = true;
+  prev_t_ = t;
+  prev_pct_ = pct;
+  prev_values_ = sample_;
+}
+
+namespace {
+
+// JS wrapper that keeps the engine attached to the live tick stream until
+// close() or garbage collection.
+struct LapDeltaHandle {
+  std::unique_ptr<LapDelta> engine;
+  bool attached = false;
+
+  void Detach()
+  {
+    if (attached) {
+      TickHub::Instance().Remove(engine.get());
+      attached = false;
+    }
+  }
+};
+
+void FinalizeLapDelta(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  LapDeltaHandle* handle = static_cast<LapDeltaHandle*>(data);
+  handle->Detach();
+  delete handle;
+}
+
+napi_value MakeLapTrace(napi_env env, const LapDelta& engine, const LapTrace* trace)
+{
+  if (!trace) {
+    return GetNull(env);
+  }
+
+  size_t points = trace->times.size();
+  size_t width = engine.channels().size();
+  napi_value result = nullptr;
+  napi_value channels = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_create_object(env, &channels));
+  NAPI_CALL(env, napi_set_named_property(env, result, "lap", MakeInt(env, trace->lap)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "lapTime", MakeDouble(env, trace->lap_time)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "time", MakeFloat64Array(env, trace->times)));
+
+  // Pinned references loaded from JS may carry no channel data.
+  if (trace->values.size() == points * width) {
+    std::vector<double> column(points);
+    for (size_t i = 0; i < width; ++i) {
+      for (size_t p = 0; p < points; ++p) {
+        column[p] = trace->values[p * width + i];
+      }
+      NAPI_CALL(env, napi_set_named_property(env, channels, engine.channels()[i].name.c_str(),
+                                             MakeFloat64Array(env, column)));
+    }
+  }
+  NAPI_CALL(env, napi_set_named_property(env, result, "channels", channels));
+  return result;
+}
+
+napi_value LapDeltaConstructor(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value self = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+  napi_value options = argc >= 1 ? args[0] : nullptr;
+  std::vector<ChannelSpec> channels;
+  napi_value channels_value = nullptr;
+  if (GetOptionalProperty(env, options, "channels", &channels_value) &&
+      !ParseChannelSpecs(env, channels_value, &channels)) {
+    return nullptr;
+  }
+  int grid_points = 1000;
+  if (!GetOptionalInt(env, options, "gridPoints", &grid_points)) {
+    return nullptr;
+  }
+
+  auto* handle = new LapDeltaHandle();
+  handle->engine.reset(new LapDelta(std::move(channels), grid_points));
+  napi_status status = napi_wrap(env, self, handle, FinalizeLapDelta, nullptr, nullptr);
+  if (status != napi_ok) {
+    delete handle;
+    CheckNapi(env, status);
+    return nullptr;
+  }
+
+  TickHub::Instance().Add(handle->engine.get());
+  handle->attached = true;
+  return self;
+}
+
+napi_value LapDeltaGetDelta(napi_env env, napi_callback_info info)
+{
+  LapDeltaHandle* handle = UnwrapThis<LapDeltaHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+
+  LapDeltaStatus delta;
+  if (!handle->engine->GetStatus(&delta)) {
+    return GetNull(env);
+  }
+
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_set_named_property(env, result, "lap", MakeInt(env, delta.lap)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "lapDistPct", MakeDouble(env, delta.lap_dist_pct)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "elapsed", MakeDouble(env, delta.elapsed)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "delta", MakeDouble(env, delta.delta)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "deltaRate", MakeDouble(env, delta.delta_rate)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "referenceLapTime",
+                                         MakeDouble(env, delta.reference_lap_time)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "predictedLapTime",
+                                         MakeDouble(env, delta.reference_lap_time + delta.delta)));
+  return result;
+}
+
+napi_value LapDeltaGetLap(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  LapDeltaHandle* handle = UnwrapThis<LapDeltaHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+
+  std::string which;
+  if (argc < 1 || !GetString(env, args[0], &which)) {
+    napi_throw_type_error(env, nullptr, "getLap expects ('best' | 'last' | 'reference')");
+    return nullptr;
+  }
+
+  const LapDelta& engine = *handle->engine;
+  if (which == "best") {
+    return MakeLapTrace(env, engine, engine.best());
+  }
+  if (which == "last") {
+    return MakeLapTrace(env, engine, engine.last());
+  }
+  if (which == "reference") {
+    return MakeLapTrace(env, engine, engine.reference());
+  }
+  napi_throw_type_error(env, nullptr, "getLap expects ('best' | 'last' | 'reference')");
+  return nullptr;
+}
+
+// setReference('best' | 'last' | { lapTime, time })
+napi_value LapDeltaSetReference(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  LapDeltaHandle* handle = UnwrapThis<LapDeltaHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  LapDelta& engine = *handle->engine;
+  if (argc < 1) {
+    napi_throw_type_error(env, nullptr, "setReference expects ('best' | 'last' | { lapTime, time })");
+    return nullptr;
+  }
+
+  napi_valuetype type = napi_undefined;
+  NAPI_CALL(env, napi_typeof(env, args[0], &type));
+  if (type == napi_string) {
+    std::string which;
+    GetString(env, args[0], &which);
+    if (which == "best") {
+      engine.FollowBest();
+      return MakeBool(env, true);
+    }
+    if (which == "last") {
+      if (!engine.last()) {
+        return MakeBool(env, false);
+      }
+      engine.SetReference(*engine.last());
+      return MakeBool(env, true);
+    }
+  } else if (type == napi_object) {
+    LapTrace trace;
+    napi_value time_value = nullptr;
+    if (!GetOptionalDouble(env, args[0], "lapTime", &trace.lap_time) ||
+        !GetOptionalInt(env, args[0], "lap", &trace.lap)) {
+      return nullptr;
+    }
+    bool is_typedarray = false;
+    if (GetOptionalProperty(env, args[0], "time", &time_value)) {
+      NAPI_CALL(env, napi_is_typedarray(env, time_value, &is_typedarray));
+    }
+    napi_typedarray_type array_type = napi_int8_array;
+    size_t length = 0;
+    void* data = nullptr;
+    if (is_typedarray) {
+      NAPI_CALL(env, napi_get_typedarray_info(env, time_value, &array_type, &length, &data, nullptr, nullptr));
+    }
+    if (!is_typedarray || array_type != napi_float64_array ||
+        length != static_cast<size_t>(engine.grid_points()) || !(trace.lap_time > 0.0)) {
+      napi_throw_type_error(env, nullptr, "reference needs lapTime and a Float64Array time of gridPoints entries");
+      return nullptr;
+    }
+    const double* times = static_cast<const double*>(data);
+    trace.times.assign(times, times + length);
+    engine.SetReference(std::move(trace));
+    return MakeBool(env, true);
+  }
+
+  napi_throw_type_error(env, nullptr, "setReference expects ('best' | 'last' | { lapTime, time })");
+  return nullptr;
+}
+
+napi_value LapDeltaClose(napi_env env, napi_callback_info info)
+{
+  LapDeltaHandle* handle = UnwrapThis<LapDeltaHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  handle->Detach();
+  return GetUndefined(env);
+}
+
+}  // namespace
+
+napi_value RegisterLapDelta(napi_env env, napi_value exports)
+{
+  napi_property_descriptor methods[] = {
+    {"getDelta", nullptr, LapDeltaGetDelta, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getLap", nullptr, LapDeltaGetLap, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"setReference", nullptr, LapDeltaSetReference, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"close", nullptr, LapDeltaClose, nullptr, nullptr, nullptr, napi_default, nullptr}
+  };
+
+  napi_value constructor = nullptr;
+  NAPI_CALL(env, napi_define_class(env, "LapDelta", NAPI_AUTO_LENGTH, LapDeltaConstructor, nullptr,
+                                   sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "LapDelta", constructor));
+  return exports;
+}
+
+}  // namespace irsdk_node
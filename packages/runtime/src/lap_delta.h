@@ -0,0 +1,94 @@
+// Distance-aligned lap traces of the player car and live delta time against
+// a reference lap.
+
+#ifndef IRSDK_NODE_LAP_DELTA_H_
+#define IRSDK_NODE_LAP_DELTA_H_
+
+#include <string>
+#include <vector>
+
+#include "channel_spec.h"
+#include "telemetry_source.h"
+#include "tick_hub.h"
+
+namespace irsdk_node {
+
+// One lap resampled onto grid points at LapDistPct = i / grid_points.
+struct LapTrace {
+  int lap = -1;
+  double lap_time = 0.0;
+  std::vector<double> times;   // Elapsed lap time at each grid point.
+  std::vector<double> values;  // One row of channel values per grid point.
+};
+
+struct LapDeltaStatus {
+  int lap;
+  double lap_dist_pct;
+  double elapsed;
+  double delta;
+  double delta_rate;  // Smoothed change of delta per second.
+  double reference_lap_time;
+};
+
+class LapDelta : public TickListener {
+ public:
+  enum class ReferenceSource { kBest, kFixed };
+
+  LapDelta(std::vector<ChannelSpec> channels, int grid_points);
+
+  void OnTick(const TelemetrySource& source, const TickStamp& stamp) override;
+
+  int grid_points() const { return grid_points_; }
+  const std::vector<ChannelSpec>& channels() const { return channels_; }
+
+  // Valid while the current lap is being recorded and a reference exists.
+  bool GetStatus(LapDeltaStatus* out) const;
+
+  const LapTrace* best() const { return best_.lap_time > 0.0 ? &best_ : nullptr; }
+  const LapTrace* last() const { return last_.lap_time > 0.0 ? &last_ : nullptr; }
+  const LapTrace* reference() const;
+
+  // Follow the best lap of the session as it improves (the default).
+  void FollowBest() { reference_source_ = ReferenceSource::kBest; }
+  // Pin the reference; the trace must have grid_points() times.
+  void SetReference(LapTrace trace);
+
+ private:
+  void ReadChannels(const TelemetrySource& source, double* out);
+  void StartLap(double time, int lap, const double* values);
+  void FillGrid(double from_pct, double from_t, const double* from, double to_pct, double to_t, const double* to);
+  void FinishLap(double time);
+  void UpdateDelta(double t, double pct);
+  double ReferenceTimeAt(const LapTrace& reference, double pct) const;
+
+  std::vector<ChannelSpec> channels_;
+  std::vector<VarHandle> vars_;
+  VarHandle pct_var_{"LapDistPct"};
+  VarHandle lap_var_{"Lap"};
+  int grid_points_;
+
+  bool has_prev_ = false;
+  double prev_t_ = 0.0;
+  double prev_pct_ = -1.0;
+  std::vector<double> prev_values_;
+  std::vector<double> sample_;
+  std::vector<double> scratch_;
+
+  // Lap in progress; recording_ is false until the car crosses the line.
+  bool recording_ = false;
+  double lap_start_ = 0.0;
+  int next_grid_ = 0;
+  LapTrace current_;
+
+  LapTrace best_;
+  LapTrace last_;
+  LapTrace fixed_;
+  ReferenceSource reference_source_ = ReferenceSource::kBest;
+
+  bool status_valid_ = false;
+  LapDeltaStatus status_{};
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_LAP_DELTA_H_
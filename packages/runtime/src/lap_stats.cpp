@@ -0,0 +1,406 @@
+// Per-lap speed traps and channel extremes for every car.
+
+#include "lap_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include "bindings.h"
+#include "napi_util.h"
+
+namespace irsdk_node {
+
+namespace {
+
+// LapDistPct steps larger than this between ticks are resets, not driving.
+constexpr double kMaxStep = 0.05;
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+}  // namespace
+
+LapStats::LapStats(LapStatsOptions options) : options_(std::move(options))
+{
+  for (const std::string& name : options_.channels) {
+    vars_.emplace_back(name);
+  }
+}
+
+const LapRecord* LapStats::current(int car) const
+{
+  return car >= 0 && car < car_count() && cars_[static_cast<size_t>(car)].started
+             ? &cars_[static_cast<size_t>(car)].current
+             : nullptr;
+}
+
+const LapRecord* LapStats::last(int car) const
+{
+  return car >= 0 && car < car_count() && cars_[static_cast<size_t>(car)].has_last
+             ? &cars_[static_cast<size_t>(car)].last
+             : nullptr;
+}
+
+const std::vector<double>* LapStats::best(int car) const
+{
+  return car >= 0 && car < car_count() ? &cars_[static_cast<size_t>(car)].best : nullptr;
+}
+
+void LapStats::StartLap(CarStats* stats, int lap)
+{
+  stats->started = true;
+  stats->current.lap = lap;
+  stats->current.traps.assign(options_.traps.size(), kNaN);
+  stats->current.min.assign(vars_.size(), kNaN);
+  stats->current.max.assign(vars_.size(), kNaN);
+}
+
+void LapStats::CrossTraps(CarStats* stats, double from, double to, double from_speed, double to_speed,
+                          bool from_line)
+{
+  for (size_t i = 0; i < options_.traps.size(); ++i) {
+    double trap = options_.traps[i];
+    if (trap < from || (trap == from && !from_line) || trap > to) {
+      continue;
+    }
+    double fraction = to > from ? (trap - from) / (to - from) : 1.0;
+    double speed = from_speed + (to_speed - from_speed) * fraction;
+    if (std::isnan(speed)) {
+      continue;
+    }
+    stats->current.traps[i] = speed;
+    if (!(stats->best[i] >= speed)) {
+      stats->best[i] = speed;
+    }
+  }
+}
+
+void LapStats::UpdateExtremes(const TelemetrySource& source, CarStats* stats, int car, bool player)
+{
+  for (size_t i = 0; i < vars_.size(); ++i) {
+    VarHandle& var = vars_[i];
+    if (!var.Resolve(source)) {
+      continue;
+    }
+    // Arrays are indexed by CarIdx; scalars describe the player's car.
+    double value = kNaN;
+    if (var.count() > 1) {
+      value = car < var.count() ? var.Get(source, car) : kNaN;
+    } else if (player) {
+      value = var.Get(source);
+    }
+    if (std::isnan(value)) {
+      continue;
+    }
+    double& low = stats->current.min[i];
+    double& high = stats->current.max[i];
+    low = std::isnan(low) ? value : std::min(low, value);
+    high = std::isnan(high) ? value : std::max(high, value);
+  }
+}
+
+void LapStats::OnTick(const TelemetrySource& source, const TickStamp& stamp)
+{
+  double dt = has_prev_ ? stamp.session_time - prev_time_ : 0.0;
+  if (dt < 0.0) {
+    // New session: laps and bests start over.
+    has_prev_ = false;
+    dt = 0.0;
+    positions_.Reset();
+    cars_.clear();
+  }
+  if (has_prev_ && dt == 0.0) {
+    return;
+  }
+  if (!positions_.Update(source, dt)) {
+    return;
+  }
+  has_prev_ = true;
+  prev_time_ = stamp.session_time;
+
+  int count = positions_.count();
+  if (car_count() != count) {
+    cars_.assign(static_cast<size_t>(count), CarStats());
+    for (CarStats& stats : cars_) {
+      stats.best.assign(options_.traps.size(), kNaN);
+    }
+  }
+  int player = player_var_.Resolve(source) ? static_cast<int>(player_var_.Get(source)) : -1;
+  double player_speed = speed_var_.Resolve(source) ? speed_var_.Get(source) : -1.0;
+
+  for (int car = 0; car < count; ++car) {
+    CarStats& stats = cars_[static_cast<size_t>(car)];
+    double pct = positions_.pct(car);
+    if (pct < 0.0) {
+      continue;
+    }
+    int lap = static_cast<int>(std::floor(positions_.distance(car)));
+    double prev = positions_.prev_pct(car);
+    if (!stats.started || prev < 0.0 || dt <= 0.0) {
+      StartLap(&stats, lap);
+      UpdateExtremes(source, &stats, car, car == player);
+      continue;
+    }
+
+    double step = pct - prev;
+    bool wrapped = step < -0.5;
+    if (wrapped) {
+      step += 1.0;
+    }
+    bool driving = step >= 0.0 && step <= kMaxStep;
+
+    // The player's own Speed is exact; other cars' speed is the LapDistPct
+    // step over the tick, which needs the track length.
+    double from_speed = kNaN;
+    double to_speed = kNaN;
+    if (car == player && player_speed >= 0.0) {
+      from_speed = prev_speed_ >= 0.0 ? prev_speed_ : player_speed;
+      to_speed = player_speed;
+    } else if (options_.track_length_m > 0.0) {
+      from_speed = to_speed = step / dt * options_.track_length_m;
+    }
+
+    if (wrapped) {
+      // Traps before the line belong to the lap that just ended.
+      if (driving) {
+        double at_line = from_speed + (to_speed - from_speed) * (1.0 - prev) / step;
+        CrossTraps(&stats, prev, 1.0, from_speed, at_line, false);
+        stats.last = stats.current;
+        stats.has_last = true;
+        StartLap(&stats, lap);
+        CrossTraps(&stats, 0.0, pct, at_line, to_speed, true);
+      } else {
+        stats.last = stats.current;
+        stats.has_last = true;
+        StartLap(&stats, lap);
+      }
+    } else if (driving) {
+      CrossTraps(&stats, prev, pct, from_speed, to_speed, false);
+    }
+    UpdateExtremes(source, &stats, car, car == player);
+  }
+  prev_speed_ = player_speed;
+}
+
+namespace {
+
+// JS wrapper that keeps the tracker attached to the live tick stream until
+// close() or garbage collection.
+struct LapStatsHandle {
+  std::unique_ptr<LapStats> stats;
+  bool attached = false;
+
+  void Detach()
+  {
+    if (attached) {
+      TickHub::Instance().Remove(stats.get());
+      attached = false;
+    }
+  }
+};
+
+void FinalizeLapStats(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  LapStatsHandle* handle = static_cast<LapStatsHandle*>(data);
+  handle->Detach();
+  delete handle;
+}
+
+bool ParseTraps(napi_env env, napi_value value, std::vector<double>* out)
+{
+  bool is_array = false;
+  if (napi_is_array(env, value, &is_array) != napi_ok || !is_array) {
+    napi_throw_type_error(env, nullptr, "traps must be an array of LapDistPct values");
+    return false;
+  }
+  uint32_t length = 0;
+  if (!CheckNapi(env, napi_get_array_length(env, value, &length))) {
+    return false;
+  }
+  for (uint32_t i = 0; i < length; ++i) {
+    napi_value element = nullptr;
+    double trap = 0.0;
+    if (!CheckNapi(env, napi_get_element(env, value, i, &element))) {
+      return false;
+    }
+    if (napi_get_value_double(env, element, &trap) != napi_ok || !(trap >= 0.0 && trap < 1.0)) {
+      napi_throw_range_error(env, nullptr, "traps must be LapDistPct values in [0, 1)");
+      return false;
+    }
+    out->push_back(trap);
+  }
+  return true;
+}
+
+napi_value LapStatsConstructor(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value self = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+  napi_value options = argc >= 1 ? args[0] : nullptr;
+  LapStatsOptions parsed;
+  napi_value traps = nullptr;
+  napi_value channels = nullptr;
+  if (GetOptionalProperty(env, options, "traps", &traps) && !ParseTraps(env, traps, &parsed.traps)) {
+    return nullptr;
+  }
+  if (GetOptionalProperty(env, options, "channels", &channels) &&
+      !GetStringArray(env, channels, &parsed.channels)) {
+    return nullptr;
+  }
+  if (!GetOptionalDouble(env, options, "trackLengthM", &parsed.track_length_m)) {
+    return nullptr;
+  }
+
+  auto* handle = new LapStatsHandle();
+  handle->stats.reset(new LapStats(std::move(parsed)));
+  napi_status status = napi_wrap(env, self, handle, FinalizeLapStats, nullptr, nullptr);
+  if (status != napi_ok) {
+    delete handle;
+    CheckNapi(env, status);
+    return nullptr;
+  }
+
+  TickHub::Instance().Add(handle->stats.get());
+  handle->attached = true;
+  return self;
+}
+
+// { name: value } for the channels seen on the lap.
+napi_value MakeExtremes(napi_env env, const LapStats& stats, const std::vector<double>& values)
+{
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  for (size_t i = 0; i < values.size(); ++i) {
+    if (!std::isnan(values[i])) {
+      NAPI_CALL(env, napi_set_named_property(env, result, stats.options().channels[i].c_str(),
+                                             MakeDouble(env, values[i])));
+    }
+  }
+  return result;
+}
+
+napi_value LapStatsGetLap(napi_env env, napi_callback_info info)
+{
+  size_t argc = 2;
+  napi_value args[2];
+  LapStatsHandle* handle = UnwrapThis<LapStatsHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  int car_idx = 0;
+  std::string which = "last";
+  if (argc < 1 || napi_get_value_int32(env, args[0], &car_idx) != napi_ok ||
+      (argc >= 2 && !IsNullish(env, args[1]) && !GetString(env, args[1], &which)) ||
+      (which != "last" && which != "current")) {
+    napi_throw_type_error(env, nullptr, "getLap expects (carIdx, 'last' | 'current')");
+    return nullptr;
+  }
+
+  const LapStats& stats = *handle->stats;
+  const LapRecord* record = which == "last" ? stats.last(car_idx) : stats.current(car_idx);
+  if (!record) {
+    return GetNull(env);
+  }
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_set_named_property(env, result, "lap", MakeInt(env, record->lap)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "traps", MakeFloat64Array(env, record->traps)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "min", MakeExtremes(env, stats, record->min)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "max", MakeExtremes(env, stats, record->max)));
+  return result;
+}
+
+napi_value LapStatsGetBestTraps(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  LapStatsHandle* handle = UnwrapThis<LapStatsHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  int car_idx = 0;
+  if (argc < 1 || napi_get_value_int32(env, args[0], &car_idx) != napi_ok) {
+    napi_throw_type_error(env, nullptr, "getBestTraps expects (carIdx)");
+    return nullptr;
+  }
+  const std::vector<double>* best = handle->stats->best(car_idx);
+  return best ? MakeFloat64Array(env, *best) : GetNull(env);
+}
+
+// Session bests through one trap, fastest first.
+napi_value LapStatsGetTrapBoard(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  LapStatsHandle* handle = UnwrapThis<LapStatsHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  const LapStats& stats = *handle->stats;
+  int trap = 0;
+  if (argc < 1 || napi_get_value_int32(env, args[0], &trap) != napi_ok || trap < 0 ||
+      trap >= static_cast<int>(stats.options().traps.size())) {
+    napi_throw_range_error(env, nullptr, "getTrapBoard expects the index of a trap");
+    return nullptr;
+  }
+
+  std::vector<std::pair<double, int>> board;
+  for (int car = 0; car < stats.car_count(); ++car) {
+    double speed = (*stats.best(car))[static_cast<size_t>(trap)];
+    if (!std::isnan(speed)) {
+      board.emplace_back(speed, car);
+    }
+  }
+  std::sort(board.begin(), board.end(), [](const std::pair<double, int>& a, const std::pair<double, int>& b) {
+    return a.first > b.first;
+  });
+
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_array_with_length(env, board.size(), &result));
+  for (size_t i = 0; i < board.size(); ++i) {
+    napi_value item = nullptr;
+    NAPI_CALL(env, napi_create_object(env, &item));
+    NAPI_CALL(env, napi_set_named_property(env, item, "carIdx", MakeInt(env, board[i].second)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "speed", MakeDouble(env, board[i].first)));
+    NAPI_CALL(env, napi_set_element(env, result, static_cast<uint32_t>(i), item));
+  }
+  return result;
+}
+
+napi_value LapStatsClose(napi_env env, napi_callback_info info)
+{
+  LapStatsHandle* handle = UnwrapThis<LapStatsHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  handle->Detach();
+  return GetUndefined(env);
+}
+
+}  // namespace
+
+napi_value RegisterLapStats(napi_env env, napi_value exports)
+{
+  napi_property_descriptor methods[] = {
+    {"getLap", nullptr, LapStatsGetLap, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getBestTraps", nullptr, LapStatsGetBestTraps, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getTrapBoard", nullptr, LapStatsGetTrapBoard, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"close", nullptr, LapStatsClose, nullptr, nullptr, nullptr, napi_default, nullptr}
+  };
+
+  napi_value constructor = nullptr;
+  NAPI_CALL(env, napi_define_class(env, "LapStats", NAPI_AUTO_LENGTH, LapStatsConstructor, nullptr,
+                                   sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "LapStats", constructor));
+  return exports;
+}
+
+}  // namespace irsdk_node
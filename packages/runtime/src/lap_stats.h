@@ -0,0 +1,72 @@
+// Per-lap speed traps and channel extremes for every car, updated tick by
+// tick so nothing has to be scanned when a lap ends.
+
+#ifndef IRSDK_NODE_LAP_STATS_H_
+#define IRSDK_NODE_LAP_STATS_H_
+
+#include <string>
+#include <vector>
+
+#include "telemetry_source.h"
+#include "tick_hub.h"
+#include "track_order.h"
+
+namespace irsdk_node {
+
+struct LapStatsOptions {
+  std::vector<double> traps;          // LapDistPct of each speed trap.
+  std::vector<std::string> channels;  // CarIdx* arrays for every car, scalars for the player.
+  double track_length_m = 0.0;        // Needed for trap speeds of cars other than the player.
+};
+
+struct LapRecord {
+  int lap = -1;                // Laps completed when the lap began; -1 before the first.
+  std::vector<double> traps;   // m/s at each trap; NaN when not crossed.
+  std::vector<double> min;     // Per channel; NaN when not seen.
+  std::vector<double> max;
+};
+
+class LapStats : public TickListener {
+ public:
+  explicit LapStats(LapStatsOptions options);
+
+  void OnTick(const TelemetrySource& source, const TickStamp& stamp) override;
+
+  const LapStatsOptions& options() const { return options_; }
+  int car_count() const { return static_cast<int>(cars_.size()); }
+  // Null for cars not seen on track yet, or for the last lap before one has
+  // finished.
+  const LapRecord* current(int car) const;
+  const LapRecord* last(int car) const;
+  // Fastest speed through each trap this session; NaN when not crossed.
+  const std::vector<double>* best(int car) const;
+
+ private:
+  struct CarStats {
+    LapRecord current;
+    LapRecord last;
+    bool started = false;
+    bool has_last = false;
+    std::vector<double> best;
+  };
+
+  void StartLap(CarStats* stats, int lap);
+  // Traps in (from, to], or [from, to] from the line.
+  void CrossTraps(CarStats* stats, double from, double to, double from_speed, double to_speed, bool from_line);
+  void UpdateExtremes(const TelemetrySource& source, CarStats* stats, int car, bool player);
+
+  LapStatsOptions options_;
+  TrackPositions positions_;
+  std::vector<VarHandle> vars_;
+  VarHandle player_var_{"PlayerCarIdx"};
+  VarHandle speed_var_{"Speed"};
+
+  bool has_prev_ = false;
+  double prev_time_ = 0.0;
+  double prev_speed_ = -1.0;  // Player Speed on the previous tick.
+  std::vector<CarStats> cars_;
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_LAP_STATS_H_
@@ -0,0 +1,273 @@
+// N-API helpers shared by the addon translation units.
+
+#ifndef IRSDK_NODE_NAPI_UTIL_H_
+#define IRSDK_NODE_NAPI_UTIL_H_
+
+#include <node_api.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Helper macro to convert N-API status codes into JS exceptions.
+#define NAPI_CALL(env, call)                                    \
+  do {                                                          \
+    napi_status status = (call);                                \
+    if (status != napi_ok) {                                    \
+      const napi_extended_error_info* error_info = nullptr;     \
+      napi_get_last_error_info((env), &error_info);             \
+      const char* msg = error_info && error_info->error_message \
+                            ? error_info->error_message         \
+                            : "napi error";                    \
+      napi_throw_error((env), nullptr, msg);                    \
+      return nullptr;                                           \
+    }                                                           \
+  } while (0)
+
+namespace irsdk_node {
+
+inline bool CheckNapi(napi_env env, napi_status status)
+{
+  if (status == napi_ok) {
+    return true;
+  }
+
+  const napi_extended_error_info* error_info = nullptr;
+  napi_get_last_error_info(env, &error_info);
+  const char* msg = error_info && error_info->error_message ? error_info->error_message : "napi error";
+  napi_throw_error(env, nullptr, msg);
+  return false;
+}
+
+// Basic N-API value constructors used across the bindings.
+inline napi_value MakeBool(napi_env env, bool value)
+{
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_get_boolean(env, value, &result));
+  return result;
+}
+
+inline napi_value MakeInt(napi_env env, int value)
+{
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_int32(env, value, &result));
+  return result;
+}
+
+inline napi_value MakeDouble(napi_env env, double value)
+{
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_double(env, value, &result));
+  return result;
+}
+
+inline napi_value MakeString(napi_env env, const std::string& value)
+{
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_string_utf8(env, value.c_str(), value.size(), &result));
+  return result;
+}
+
+inline napi_value GetNull(napi_env env)
+{
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_get_null(env, &result));
+  return result;
+}
+
+inline napi_value GetUndefined(napi_env env)
+{
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_get_undefined(env, &result));
+  return result;
+}
+
+// Copy doubles into a new Float64Array.
+inline napi_value MakeFloat64Array(napi_env env, const double* values, size_t count)
+{
+  void* data = nullptr;
+  napi_value buffer = nullptr;
+  NAPI_CALL(env, napi_create_arraybuffer(env, count * sizeof(double), &data, &buffer));
+  if (count > 0) {
+    std::memcpy(data, values, count * sizeof(double));
+  }
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_typedarray(env, napi_float64_array, count, buffer, 0, &result));
+  return result;
+}
+
+inline napi_value MakeFloat64Array(napi_env env, const std::vector<double>& values)
+{
+  return MakeFloat64Array(env, values.data(), values.size());
+}
+
+// Borrow the storage of a Float64Array. Returns false for any other value.
+inline bool GetFloat64Array(napi_env env, napi_value value, double** data, size_t* length)
+{
+  bool is_typedarray = false;
+  if (napi_is_typedarray(env, value, &is_typedarray) != napi_ok || !is_typedarray) {
+    return false;
+  }
+  napi_typedarray_type type = napi_int8_array;
+  void* raw = nullptr;
+  if (napi_get_typedarray_info(env, value, &type, length, &raw, nullptr, nullptr) != napi_ok ||
+      type != napi_float64_array) {
+    return false;
+  }
+  *data = static_cast<double*>(raw);
+  return true;
+}
+
+// Extract a UTF-8 string from a JS value.
+inline bool GetString(napi_env env, napi_value value, std::string* out)
+{
+  size_t len = 0;
+  napi_status status = napi_get_value_string_utf8(env, value, nullptr, 0, &len);
+  if (status != napi_ok) {
+    return false;
+  }
+
+  std::string temp;
+  temp.resize(len + 1);
+  status = napi_get_value_string_utf8(env, value, &temp[0], len + 1, &len);
+  if (status != napi_ok) {
+    return false;
+  }
+
+  *out = std::string(temp.c_str(), len);
+  return true;
+}
+
+inline bool IsNullish(napi_env env, napi_value value)
+{
+  napi_valuetype type = napi_undefined;
+  if (napi_typeof(env, value, &type) != napi_ok) {
+    return true;
+  }
+  return type == napi_undefined || type == napi_null;
+}
+
+// Look up an optional property on an options object. Returns false when the
+// object is nullish or the property is missing/undefined.
+inline bool GetOptionalProperty(napi_env env, napi_value object, const char* name, napi_value* out)
+{
+  if (!object || IsNullish(env, object)) {
+    return false;
+  }
+  bool has = false;
+  if (napi_has_named_property(env, object, name, &has) != napi_ok || !has) {
+    return false;
+  }
+  if (napi_get_named_property(env, object, name, out) != napi_ok) {
+    return false;
+  }
+  return !IsNullish(env, *out);
+}
+
+// Read an optional numeric option, leaving out untouched when absent.
+inline bool GetOptionalDouble(napi_env env, napi_value object, const char* name, double* out)
+{
+  napi_value value = nullptr;
+  if (!GetOptionalProperty(env, object, name, &value)) {
+    return true;
+  }
+  if (napi_get_value_double(env, value, out) != napi_ok) {
+    std::string message = std::string("option '") + name + "' must be a number";
+    napi_throw_type_error(env, nullptr, message.c_str());
+    return false;
+  }
+  return true;
+}
+
+inline bool GetOptionalInt(napi_env env, napi_value object, const char* name, int* out)
+{
+  double value = static_cast<double>(*out);
+  if (!GetOptionalDouble(env, object, name, &value)) {
+    return false;
+  }
+  *out = static_cast<int>(value);
+  return true;
+}
+
+inline bool GetOptionalBool(napi_env env, napi_value object, const char* name, bool* out)
+{
+  napi_value value = nullptr;
+  if (!GetOptionalProperty(env, object, name, &value)) {
+    return true;
+  }
+  if (napi_get_value_bool(env, value, out) != napi_ok) {
+    std::string message = std::string("option '") + name + "' must be a boolean";
+    napi_throw_type_error(env, nullptr, message.c_str());
+    return false;
+  }
+  return true;
+}
+
+inline bool GetOptionalString(napi_env env, napi_value object, const char* name, std::string* out)
+{
+  napi_value value = nullptr;
+  if (!GetOptionalProperty(env, object, name, &value)) {
+    return true;
+  }
+  if (!GetString(env, value, out)) {
+    std::string message = std::string("option '") + name + "' must be a string";
+    napi_throw_type_error(env, nullptr, message.c_str());
+    return false;
+  }
+  return true;
+}
+
+// Read a JS array of strings.
+inline bool GetStringArray(napi_env env, napi_value value, std::vector<std::string>* out)
+{
+  bool is_array = false;
+  if (!CheckNapi(env, napi_is_array(env, value, &is_array))) {
+    return false;
+  }
+  if (!is_array) {
+    napi_throw_type_error(env, nullptr, "expected an array of strings");
+    return false;
+  }
+
+  uint32_t length = 0;
+  if (!CheckNapi(env, napi_get_array_length(env, value, &length))) {
+    return false;
+  }
+  out->clear();
+  out->reserve(length);
+  for (uint32_t i = 0; i < length; ++i) {
+    napi_value element = nullptr;
+    if (!CheckNapi(env, napi_get_element(env, value, i, &element))) {
+      return false;
+    }
+    std::string text;
+    if (!GetString(env, element, &text)) {
+      napi_throw_type_error(env, nullptr, "expected an array of strings");
+      return false;
+    }
+    out->push_back(text);
+  }
+  return true;
+}
+
+// Fetch the call arguments and the native object wrapped by `this`.
+template <typename T>
+T* UnwrapThis(napi_env env, napi_callback_info info, size_t* argc, napi_value* args)
+{
+  napi_value self = nullptr;
+  size_t no_args = 0;
+  if (!CheckNapi(env, napi_get_cb_info(env, info, argc ? argc : &no_args, args, &self, nullptr))) {
+    return nullptr;
+  }
+  void* native = nullptr;
+  if (!CheckNapi(env, napi_unwrap(env, self, &native))) {
+    return nullptr;
+  }
+  return static_cast<T*>(native);
+}
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_NAPI_UTIL_H_
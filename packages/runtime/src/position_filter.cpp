@@ -0,0 +1,241 @@
+// Kalman smoothing of CarIdxLapDistPct for every car.
+
+#include "position_filter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+
+#include "bindings.h"
+#include "napi_util.h"
+
+namespace irsdk_node {
+
+namespace {
+
+// Speed variance of a car that just appeared: anything up to ~0.02 laps/s.
+constexpr double kInitialSpeedVar = 1e-4;
+// Remote cars' LapDistPct is not refreshed every tick; repeats are skipped
+// as measurements until this many in a row, which means the car stopped.
+constexpr int kMaxRepeats = 3;
+// Estimates are never extrapolated further than this past the last tick.
+constexpr double kMaxAheadS = 0.25;
+
+double Wrap(double pct)
+{
+  return pct - std::floor(pct);
+}
+
+}  // namespace
+
+PositionFilter::PositionFilter(const PositionFilterOptions& options) : options_(options) {}
+
+void PositionFilter::Start(CarState* car, double z) const
+{
+  car->valid = true;
+  car->x = z;
+  car->v = 0.0;
+  car->p00 = options_.measurement_noise * options_.measurement_noise;
+  car->p01 = 0.0;
+  car->p11 = kInitialSpeedVar;
+  car->last_raw = z;
+  car->repeats = 0;
+}
+
+void PositionFilter::Step(CarState* car, double z, double dt) const
+{
+  // Predict with constant velocity; acceleration is the process noise.
+  double q = options_.process_noise * options_.process_noise;
+  double dt2 = dt * dt;
+  car->x += car->v * dt;
+  car->p00 += dt * (2.0 * car->p01 + dt * car->p11) + q * dt2 * dt2 / 4.0;
+  car->p01 += dt * car->p11 + q * dt2 * dt / 2.0;
+  car->p11 += q * dt2;
+
+  if (z == car->last_raw && ++car->repeats < kMaxRepeats) {
+    car->x = Wrap(car->x);
+    return;
+  }
+  car->repeats = 0;
+  car->last_raw = z;
+
+  // Innovation the short way round the line.
+  double innovation = std::remainder(z - car->x, 1.0);
+  if (std::fabs(innovation) > options_.reset_gap) {
+    Start(car, z);
+    return;
+  }
+  double s = car->p00 + options_.measurement_noise * options_.measurement_noise;
+  double k0 = car->p00 / s;
+  double k1 = car->p01 / s;
+  car->x = Wrap(car->x + k0 * innovation);
+  car->v += k1 * innovation;
+  car->p11 -= k1 * car->p01;
+  car->p01 *= 1.0 - k0;
+  car->p00 *= 1.0 - k0;
+}
+
+void PositionFilter::OnTick(const TelemetrySource& source, const TickStamp& stamp)
+{
+  if (!pct_var_.Resolve(source)) {
+    return;
+  }
+  double dt = has_prev_ ? stamp.session_time - prev_time_ : 0.0;
+  if (dt < 0.0) {
+    // New session: every car starts over.
+    cars_.clear();
+    dt = 0.0;
+  }
+  if (has_prev_ && dt == 0.0) {
+    return;
+  }
+  has_prev_ = true;
+  prev_time_ = stamp.session_time;
+  tick_ms_ = stamp.monotonic_ms;
+
+  size_t count = static_cast<size_t>(pct_var_.count());
+  if (cars_.size() != count) {
+    cars_.assign(count, CarState());
+  }
+  for (size_t i = 0; i < count; ++i) {
+    CarState& car = cars_[i];
+    double z = pct_var_.Get(source, static_cast<int>(i));
+    if (z < 0.0) {
+      car.valid = false;
+    } else if (!car.valid || dt <= 0.0) {
+      Start(&car, z);
+    } else {
+      Step(&car, z, dt);
+    }
+  }
+}
+
+void PositionFilter::Estimate(double ahead_s, std::vector<double>* pct, std::vector<double>* speed) const
+{
+  double ahead = std::min(std::max(ahead_s, 0.0), kMaxAheadS);
+  pct->resize(cars_.size());
+  speed->resize(cars_.size());
+  for (size_t i = 0; i < cars_.size(); ++i) {
+    const CarState& car = cars_[i];
+    (*pct)[i] = car.valid ? Wrap(car.x + car.v * ahead) : -1.0;
+    (*speed)[i] = car.valid ? car.v : 0.0;
+  }
+}
+
+namespace {
+
+// JS wrapper that keeps the filter attached to the live tick stream until
+// close() or garbage collection.
+struct PositionFilterHandle {
+  std::unique_ptr<PositionFilter> filter;
+  bool attached = false;
+
+  void Detach()
+  {
+    if (attached) {
+      TickHub::Instance().Remove(filter.get());
+      attached = false;
+    }
+  }
+};
+
+void FinalizePositionFilter(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  PositionFilterHandle* handle = static_cast<PositionFilterHandle*>(data);
+  handle->Detach();
+  delete handle;
+}
+
+napi_value PositionFilterConstructor(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value self = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+  napi_value options = argc >= 1 ? args[0] : nullptr;
+  PositionFilterOptions parsed;
+  if (!GetOptionalDouble(env, options, "processNoise", &parsed.process_noise) ||
+      !GetOptionalDouble(env, options, "measurementNoise", &parsed.measurement_noise) ||
+      !GetOptionalDouble(env, options, "resetGapPct", &parsed.reset_gap)) {
+    return nullptr;
+  }
+  if (!(parsed.process_noise > 0.0) || !(parsed.measurement_noise > 0.0)) {
+    napi_throw_range_error(env, nullptr, "processNoise and measurementNoise must be positive");
+    return nullptr;
+  }
+
+  auto* handle = new PositionFilterHandle();
+  handle->filter.reset(new PositionFilter(parsed));
+  napi_status status = napi_wrap(env, self, handle, FinalizePositionFilter, nullptr, nullptr);
+  if (status != napi_ok) {
+    delete handle;
+    CheckNapi(env, status);
+    return nullptr;
+  }
+
+  TickHub::Instance().Add(handle->filter.get());
+  handle->attached = true;
+  return self;
+}
+
+// getState(renderTimeMs?) -> { pct, speed }
+napi_value PositionFilterGetState(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  PositionFilterHandle* handle = UnwrapThis<PositionFilterHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  const PositionFilter& filter = *handle->filter;
+  if (!filter.has_tick()) {
+    return GetNull(env);
+  }
+  double ahead_s = 0.0;
+  if (argc >= 1 && !IsNullish(env, args[0])) {
+    double render_ms = 0.0;
+    NAPI_CALL(env, napi_get_value_double(env, args[0], &render_ms));
+    ahead_s = (render_ms - filter.tick_ms()) / 1000.0;
+  }
+
+  std::vector<double> pct;
+  std::vector<double> speed;
+  filter.Estimate(ahead_s, &pct, &speed);
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_set_named_property(env, result, "pct", MakeFloat64Array(env, pct)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "speed", MakeFloat64Array(env, speed)));
+  return result;
+}
+
+napi_value PositionFilterClose(napi_env env, napi_callback_info info)
+{
+  PositionFilterHandle* handle = UnwrapThis<PositionFilterHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  handle->Detach();
+  return GetUndefined(env);
+}
+
+}  // namespace
+
+napi_value RegisterPositionFilter(napi_env env, napi_value exports)
+{
+  napi_property_descriptor methods[] = {
+    {"getState", nullptr, PositionFilterGetState, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"close", nullptr, PositionFilterClose, nullptr, nullptr, nullptr, napi_default, nullptr}
+  };
+
+  napi_value constructor = nullptr;
+  NAPI_CALL(env, napi_define_class(env, "PositionFilter", NAPI_AUTO_LENGTH, PositionFilterConstructor, nullptr,
+                                   sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "PositionFilter", constructor));
+  return exports;
+}
+
+}  // namespace irsdk_node
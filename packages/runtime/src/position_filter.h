@@ -0,0 +1,60 @@
+// Kalman-smoothed track position and speed of every car, from the quantized
+// and irregularly updated CarIdxLapDistPct.
+
+#ifndef IRSDK_NODE_POSITION_FILTER_H_
+#define IRSDK_NODE_POSITION_FILTER_H_
+
+#include <vector>
+
+#include "telemetry_source.h"
+#include "tick_hub.h"
+
+namespace irsdk_node {
+
+struct PositionFilterOptions {
+  double process_noise = 0.002;       // Acceleration std dev, laps/s^2.
+  double measurement_noise = 0.0002;  // LapDistPct std dev.
+  double reset_gap = 0.05;            // Innovations larger than this restart a car.
+};
+
+class PositionFilter : public TickListener {
+ public:
+  explicit PositionFilter(const PositionFilterOptions& options);
+
+  void OnTick(const TelemetrySource& source, const TickStamp& stamp) override;
+
+  bool has_tick() const { return has_prev_; }
+  int count() const { return static_cast<int>(cars_.size()); }
+  double tick_ms() const { return tick_ms_; }
+
+  // Smoothed LapDistPct (-1 for cars not in the world) and LapDistPct/s,
+  // extrapolated ahead_s past the last tick.
+  void Estimate(double ahead_s, std::vector<double>* pct, std::vector<double>* speed) const;
+
+ private:
+  // Constant-velocity state of one car; x is kept in [0, 1).
+  struct CarState {
+    bool valid = false;
+    double x = 0.0;
+    double v = 0.0;
+    double p00 = 0.0;
+    double p01 = 0.0;
+    double p11 = 0.0;
+    double last_raw = -1.0;
+    int repeats = 0;  // Ticks the raw value has not changed.
+  };
+
+  void Start(CarState* car, double z) const;
+  void Step(CarState* car, double z, double dt) const;
+
+  PositionFilterOptions options_;
+  VarHandle pct_var_{"CarIdxLapDistPct"};
+  std::vector<CarState> cars_;
+  bool has_prev_ = false;
+  double prev_time_ = 0.0;
+  double tick_ms_ = 0.0;
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_POSITION_FILTER_H_
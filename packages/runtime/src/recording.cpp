@@ -0,0 +1,911 @@
+// Chunked telemetry recordings that survive crashes.
+
+#include "recording.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include "bindings.h"
+#include "byte_io.h"
+#include "checksum.h"
+#include "file_util.h"
+#include "irsdk_defines.h"
+#include "napi_util.h"
+
+namespace irsdk_node {
+
+namespace {
+
+constexpr char kMagic[8] = {'I', 'R', 'S', 'D', 'K', 'R', 'E', 'C'};
+constexpr uint32_t kVersion = 1;
+// Magic, version, header size, chunk size and channel count; the channel
+// table and the header's CRC-32 follow.
+constexpr size_t kHeaderFixedBytes = sizeof(kMagic) + 4 * sizeof(uint32_t);
+constexpr int64_t kMaxHeaderBytes = 16 * 1024 * 1024;
+
+// Chunk header: magic, CRC-32 of everything after it up to the end of the
+// records, sequence number, record count, record bytes, reserved, first and
+// last SessionTick, first and last SessionTime.
+constexpr char kChunkMagic[4] = {'C', 'H', 'N', 'K'};
+constexpr size_t kChunkHeaderBytes = 48;
+constexpr size_t kChunkCrcStart = 8;
+constexpr size_t kMinChunkBytes = 4096;
+constexpr size_t kMaxChunkBytes = 64 * 1024 * 1024;
+
+// Each record is its SessionTick and SessionTime, then the channel values.
+constexpr size_t kRecordPrefixBytes = sizeof(int32_t) + sizeof(double);
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+// Beyond a day, only full chunks and Flush write to disk.
+constexpr double kMaxTimedFlushMs = 24 * 60 * 60 * 1000.0;
+
+// Doubles beyond float range become infinities rather than undefined casts.
+float ToFloat(double value)
+{
+  if (std::isfinite(value) && std::fabs(value) > std::numeric_limits<float>::max()) {
+    return std::copysign(std::numeric_limits<float>::infinity(), static_cast<float>(value));
+  }
+  return static_cast<float>(value);
+}
+
+}  // namespace
+
+RecordingWriter::RecordingWriter(std::vector<std::string> channels, size_t chunk_bytes, double flush_ms)
+    : names_(std::move(channels)),
+      chunk_bytes_(chunk_bytes),
+      flush_ms_(flush_ms)
+{
+  for (const std::string& name : names_) {
+    vars_.emplace_back(name);
+    channels_.push_back(RecordingChannel{name, 8});
+  }
+  values_.resize(names_.size(), kNaN);
+}
+
+RecordingWriter::~RecordingWriter()
+{
+  std::string error;
+  Close(&error);
+}
+
+bool RecordingWriter::Open(const std::string& path, std::string* error)
+{
+  path_ = path;
+  file_ = OpenFile(path, "wb+");
+  if (!file_) {
+    *error = "cannot create " + path;
+    return false;
+  }
+  open_ = true;
+  worker_ = std::thread(&RecordingWriter::Run, this);
+  return true;
+}
+
+void RecordingWriter::EncodeHeader()
+{
+  header_.assign(kMagic, sizeof(kMagic));
+  Put<uint32_t>(&header_, kVersion);
+  Put<uint32_t>(&header_, 0);  // Header size, filled in below.
+  Put<uint32_t>(&header_, static_cast<uint32_t>(chunk_bytes_));
+  Put<uint32_t>(&header_, static_cast<uint32_t>(channels_.size()));
+  record_bytes_ = kRecordPrefixBytes;
+  for (const RecordingChannel& channel : channels_) {
+    Put<uint8_t>(&header_, static_cast<uint8_t>(channel.width));
+    Put<uint32_t>(&header_, static_cast<uint32_t>(channel.name.size()));
+    header_.append(channel.name);
+    record_bytes_ += static_cast<size_t>(channel.width);
+  }
+  PutAt<uint32_t>(&header_[sizeof(kMagic) + sizeof(uint32_t)],
+                  static_cast<uint32_t>(header_.size() + sizeof(uint32_t)));
+  Put<uint32_t>(&header_, Crc32(header_.data(), header_.size()));
+  header_bytes_ = static_cast<int64_t>(header_.size());
+  chunk_.assign(chunk_bytes_, '\0');
+}
+
+void RecordingWriter::OnTick(const TelemetrySource& source, const TickStamp& stamp)
+{
+  for (size_t i = 0; i < vars_.size(); ++i) {
+    bool found = vars_[i].Resolve(source);
+    values_[i] = found ? vars_[i].Get(source) : kNaN;
+    if (header_bytes_ == 0) {
+      channels_[i].width = found && source.VarType(vars_[i].index()) == irsdk_double ? 8 : 4;
+    }
+  }
+  std::string error;
+  if (!Append(stamp.session_tick, stamp.session_time, values_.data(), &error)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    write_error_ = error;
+  }
+}
+
+bool RecordingWriter::Append(int session_tick, double session_time, const double* values, std::string* error)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!open_) {
+    *error = "recording is closed";
+    return false;
+  }
+  if (header_bytes_ == 0) {
+    EncodeHeader();
+  }
+  if (kChunkHeaderBytes + payload_bytes_ + record_bytes_ > chunk_bytes_) {
+    // The full chunk is final; hand it to the writer thread and start the
+    // next one empty.
+    full_.push_back(PendingChunk{sequence_, chunk_records_, payload_bytes_, std::move(chunk_)});
+    ++sequence_;
+    chunk_records_ = 0;
+    payload_bytes_ = 0;
+    chunk_.assign(chunk_bytes_, '\0');
+    wake_pending_ = true;
+  }
+
+  char* chunk = &chunk_[0];
+  char* out = chunk + kChunkHeaderBytes + payload_bytes_;
+  PutAt<int32_t>(out, session_tick);
+  PutAt<double>(out + sizeof(int32_t), session_time);
+  out += kRecordPrefixBytes;
+  for (size_t i = 0; i < channels_.size(); ++i) {
+    if (channels_[i].width == 4) {
+      PutAt<float>(out, ToFloat(values[i]));
+    } else {
+      PutAt<double>(out, values[i]);
+    }
+    out += channels_[i].width;
+  }
+  if (chunk_records_ == 0) {
+    PutAt<int32_t>(chunk + 24, session_tick);
+    PutAt<double>(chunk + 32, session_time);
+  }
+  PutAt<int32_t>(chunk + 28, session_tick);
+  PutAt<double>(chunk + 40, session_time);
+  payload_bytes_ += record_bytes_;
+  ++chunk_records_;
+  ++records_;
+  dirty_ = true;
+
+  if (flush_ms_ <= 0.0) {
+    wake_pending_ = true;
+  }
+  if (wake_pending_) {
+    wake_.notify_one();
+  }
+  return true;
+}
+
+void RecordingWriter::Run()
+{
+  bool timed = flush_ms_ > 0.0 && flush_ms_ < kMaxTimedFlushMs;
+  auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double, std::milli>(timed ? flush_ms_ : 0.0));
+  auto woken = [this]() { return stopping_ || wake_pending_; };
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    if (timed) {
+      wake_.wait_for(lock, period, woken);
+    } else {
+      wake_.wait(lock, woken);
+    }
+    if (stopping_) {
+      break;
+    }
+    wake_pending_ = false;
+    lock.unlock();
+    std::string error;
+    WritePending(&error);
+    lock.lock();
+  }
+}
+
+bool RecordingWriter::WritePending(std::string* error)
+{
+  std::lock_guard<std::mutex> io_lock(io_mutex_);
+  std::string header;
+  std::vector<PendingChunk> chunks;
+  bool has_open = false;
+  {
+    // Copy the open chunk so appends carry on while it is written.
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!header_written_) {
+      header = header_;
+    }
+    chunks.swap(full_);
+    if (dirty_) {
+      chunks.push_back(PendingChunk{sequence_, chunk_records_, payload_bytes_, chunk_});
+      dirty_ = false;
+      has_open = true;
+    }
+  }
+  if (header.empty() && chunks.empty()) {
+    return true;
+  }
+
+  bool ok = header.empty() ||
+            (SeekFile(file_, 0) && std::fwrite(header.data(), 1, header.size(), file_) == header.size());
+  for (size_t i = 0; ok && i < chunks.size(); ++i) {
+    PendingChunk& pending = chunks[i];
+    char* chunk = &pending.data[0];
+    std::memcpy(chunk, kChunkMagic, sizeof(kChunkMagic));
+    PutAt<uint32_t>(chunk + 8, pending.sequence);
+    PutAt<uint32_t>(chunk + 12, pending.records);
+    PutAt<uint32_t>(chunk + 16, static_cast<uint32_t>(pending.payload_bytes));
+    PutAt<uint32_t>(chunk + 4,
+                    Crc32(chunk + kChunkCrcStart, kChunkHeaderBytes - kChunkCrcStart + pending.payload_bytes));
+
+    // A torn write is repaired by the next one, which rewrites the whole chunk.
+    int64_t offset = header_bytes_ + static_cast<int64_t>(pending.sequence) * static_cast<int64_t>(chunk_bytes_);
+    ok = SeekFile(file_, offset) &&
+         std::fwrite(pending.data.data(), 1, pending.data.size(), file_) == pending.data.size();
+  }
+  ok = ok && FlushFile(file_);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (ok) {
+    header_written_ = true;
+    return true;
+  }
+  // Nothing counts as written until it is on disk. The open chunk is copied
+  // afresh next time; full chunks go back ahead of any filled meanwhile.
+  if (has_open) {
+    chunks.pop_back();
+    dirty_ = true;
+  }
+  full_.insert(full_.begin(), std::make_move_iterator(chunks.begin()), std::make_move_iterator(chunks.end()));
+  write_error_ = "cannot write " + path_;
+  *error = write_error_;
+  return false;
+}
+
+bool RecordingWriter::Flush(std::string* error)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!open_) {
+      return true;
+    }
+  }
+  return WritePending(error);
+}
+
+bool RecordingWriter::Close(std::string* error)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!open_) {
+      return true;
+    }
+    open_ = false;
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+  bool ok = WritePending(error);
+  if (std::fclose(file_) != 0 && ok) {
+    *error = "cannot write " + path_;
+    ok = false;
+  }
+  file_ = nullptr;
+  return ok;
+}
+
+RecordingStats RecordingWriter::stats() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  RecordingStats stats;
+  stats.chunks = header_bytes_ > 0 ? sequence_ + (chunk_records_ > 0 ? 1 : 0) : 0;
+  stats.records = records_;
+  stats.bytes = header_bytes_ + static_cast<int64_t>(stats.chunks) * static_cast<int64_t>(chunk_bytes_);
+  return stats;
+}
+
+std::string RecordingWriter::write_error() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return write_error_;
+}
+
+RecordingReader::~RecordingReader()
+{
+  Close();
+}
+
+void RecordingReader::Close()
+{
+  if (file_) {
+    std::fclose(file_);
+    file_ = nullptr;
+  }
+}
+
+bool RecordingReader::Open(const std::string& path, std::string* error)
+{
+  Close();
+  channels_.clear();
+  chunks_.clear();
+  *error = "invalid recording: " + path;
+  file_ = OpenFile(path, "rb");
+  if (!file_) {
+    *error = "cannot open " + path;
+    return false;
+  }
+  file_size_ = FileSize(file_);
+
+  char fixed[kHeaderFixedBytes];
+  if (file_size_ < static_cast<int64_t>(kHeaderFixedBytes) || !ReadAt(file_, 0, fixed, sizeof(fixed)) ||
+      std::memcmp(fixed, kMagic, sizeof(kMagic)) != 0 || GetAt<uint32_t>(fixed + 8) != kVersion) {
+    return false;
+  }
+  header_bytes_ = GetAt<uint32_t>(fixed + 12);
+  chunk_bytes_ = GetAt<uint32_t>(fixed + 16);
+  uint32_t count = GetAt<uint32_t>(fixed + 20);
+  if (header_bytes_ < static_cast<int64_t>(kHeaderFixedBytes + sizeof(uint32_t)) || header_bytes_ > file_size_ ||
+      header_bytes_ > kMaxHeaderBytes || chunk_bytes_ < kMinChunkBytes || chunk_bytes_ > kMaxChunkBytes) {
+    return false;
+  }
+  std::string header(static_cast<size_t>(header_bytes_), '\0');
+  size_t table_end = header.size() - sizeof(uint32_t);
+  if (!ReadAt(file_, 0, &header[0], header.size()) ||
+      Crc32(header.data(), table_end) != GetAt<uint32_t>(header.data() + table_end)) {
+    return false;
+  }
+
+  // Every channel takes at least its width byte and name length.
+  size_t pos = kHeaderFixedBytes;
+  if (count > (table_end - pos) / 5) {
+    return false;
+  }
+  record_bytes_ = kRecordPrefixBytes;
+  for (uint32_t i = 0; i < count; ++i) {
+    if (table_end - pos < 5) {
+      return false;
+    }
+    RecordingChannel channel;
+    channel.width = static_cast<uint8_t>(header[pos]);
+    uint32_t length = GetAt<uint32_t>(header.data() + pos + 1);
+    pos += 5;
+    if ((channel.width != 4 && channel.width != 8) || table_end - pos < length) {
+      return false;
+    }
+    channel.name.assign(header.data() + pos, length);
+    pos += length;
+    record_bytes_ += static_cast<size_t>(channel.width);
+    channels_.push_back(std::move(channel));
+  }
+  if (pos != table_end || kChunkHeaderBytes + record_bytes_ > chunk_bytes_) {
+    return false;
+  }
+
+  // A trailing partial chunk is kept and marked invalid unless its records
+  // all made it to disk.
+  int64_t body = file_size_ - header_bytes_;
+  int64_t count_chunks = (body + static_cast<int64_t>(chunk_bytes_) - 1) / static_cast<int64_t>(chunk_bytes_);
+  chunks_.resize(static_cast<size_t>(count_chunks));
+  for (int64_t i = 0; i < count_chunks; ++i) {
+    int64_t offset = header_bytes_ + i * static_cast<int64_t>(chunk_bytes_);
+    char head[kChunkHeaderBytes];
+    if (file_size_ - offset < static_cast<int64_t>(kChunkHeaderBytes) || !ReadAt(file_, offset, head, sizeof(head)) ||
+        std::memcmp(head, kChunkMagic, sizeof(kChunkMagic)) != 0 || GetAt<uint32_t>(head + 8) != i) {
+      continue;
+    }
+    RecordingChunk& chunk = chunks_[static_cast<size_t>(i)];
+    chunk.records = GetAt<uint32_t>(head + 12);
+    uint32_t payload = GetAt<uint32_t>(head + 16);
+    chunk.first_tick = GetAt<int32_t>(head + 24);
+    chunk.last_tick = GetAt<int32_t>(head + 28);
+    chunk.start_time = GetAt<double>(head + 32);
+    chunk.end_time = GetAt<double>(head + 40);
+    chunk.valid = chunk.records > 0 && payload <= chunk_bytes_ - kChunkHeaderBytes &&
+                  payload == static_cast<uint64_t>(chunk.records) * record_bytes_ &&
+                  file_size_ - offset >= static_cast<int64_t>(kChunkHeaderBytes + payload);
+  }
+  error->clear();
+  return true;
+}
+
+bool RecordingReader::ReadChunk(size_t index, const std::vector<size_t>& selected, RecordingColumns* out) const
+{
+  if (!file_ || index >= chunks_.size() || !chunks_[index].valid) {
+    return false;
+  }
+  const RecordingChunk& chunk = chunks_[index];
+  size_t payload = static_cast<size_t>(chunk.records) * record_bytes_;
+  std::string data(kChunkHeaderBytes + payload, '\0');
+  int64_t offset = header_bytes_ + static_cast<int64_t>(index) * static_cast<int64_t>(chunk_bytes_);
+  if (!ReadAt(file_, offset, &data[0], data.size()) ||
+      Crc32(data.data() + kChunkCrcStart, data.size() - kChunkCrcStart) != GetAt<uint32_t>(data.data() + 4)) {
+    return false;
+  }
+
+  std::vector<size_t> offsets(channels_.size());
+  size_t at = kRecordPrefixBytes;
+  for (size_t i = 0; i < channels_.size(); ++i) {
+    offsets[i] = at;
+    at += static_cast<size_t>(channels_[i].width);
+  }
+  out->values.resize(selected.size());
+  for (uint32_t r = 0; r < chunk.records; ++r) {
+    const char* record = data.data() + kChunkHeaderBytes + static_cast<size_t>(r) * record_bytes_;
+    out->ticks.push_back(GetAt<int32_t>(record));
+    out->times.push_back(GetAt<double>(record + sizeof(int32_t)));
+    for (size_t k = 0; k < selected.size(); ++k) {
+      const char* value = record + offsets[selected[k]];
+      out->values[k].push_back(channels_[selected[k]].width == 4 ? GetAt<float>(value) : GetAt<double>(value));
+    }
+  }
+  return true;
+}
+
+namespace {
+
+constexpr size_t kDefaultChunkBytes = 64 * 1024;
+constexpr double kDefaultFlushMs = 1000.0;
+
+// JS wrapper that keeps a live writer attached to the tick stream until
+// close() or garbage collection.
+struct RecorderHandle {
+  std::unique_ptr<RecordingWriter> writer;
+  bool attached = false;
+
+  void Detach()
+  {
+    if (attached) {
+      TickHub::Instance().Remove(writer.get());
+      attached = false;
+    }
+  }
+};
+
+void FinalizeRecorder(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  RecorderHandle* handle = static_cast<RecorderHandle*>(data);
+  handle->Detach();
+  delete handle;
+}
+
+napi_value RecorderConstructor(napi_env env, napi_callback_info info)
+{
+  size_t argc = 2;
+  napi_value args[2];
+  napi_value self = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+  const char* usage = "Recorder expects (path, { channels, chunkBytes?, flushMs?, live? })";
+  std::string path;
+  napi_value options = argc >= 2 ? args[1] : nullptr;
+  napi_value channels_value = nullptr;
+  if (argc < 1 || !GetString(env, args[0], &path) || !GetOptionalProperty(env, options, "channels", &channels_value)) {
+    napi_throw_type_error(env, nullptr, usage);
+    return nullptr;
+  }
+  std::vector<std::string> channels;
+  if (!GetStringArray(env, channels_value, &channels)) {
+    return nullptr;
+  }
+  double chunk_bytes = static_cast<double>(kDefaultChunkBytes);
+  double flush_ms = kDefaultFlushMs;
+  bool live = true;
+  if (!GetOptionalDouble(env, options, "chunkBytes", &chunk_bytes) ||
+      !GetOptionalDouble(env, options, "flushMs", &flush_ms) || !GetOptionalBool(env, options, "live", &live)) {
+    return nullptr;
+  }
+  if (!(chunk_bytes >= static_cast<double>(kMinChunkBytes) && chunk_bytes <= static_cast<double>(kMaxChunkBytes))) {
+    napi_throw_range_error(env, nullptr, "chunkBytes must be between 4 KiB and 64 MiB");
+    return nullptr;
+  }
+  // Sized for every channel stored as a double.
+  if (kChunkHeaderBytes + kRecordPrefixBytes + channels.size() * sizeof(double) > static_cast<size_t>(chunk_bytes)) {
+    napi_throw_range_error(env, nullptr, "chunkBytes is too small for one record");
+    return nullptr;
+  }
+  if (!(flush_ms >= 0.0)) {
+    napi_throw_range_error(env, nullptr, "flushMs must not be negative");
+    return nullptr;
+  }
+
+  std::unique_ptr<RecorderHandle> handle(new RecorderHandle());
+  handle->writer.reset(new RecordingWriter(std::move(channels), static_cast<size_t>(chunk_bytes), flush_ms));
+  std::string error;
+  if (!handle->writer->Open(path, &error)) {
+    napi_throw_error(env, nullptr, error.c_str());
+    return nullptr;
+  }
+  napi_status status = napi_wrap(env, self, handle.get(), FinalizeRecorder, nullptr, nullptr);
+  if (status != napi_ok) {
+    CheckNapi(env, status);
+    return nullptr;
+  }
+  RecorderHandle* wrapped = handle.release();
+  if (live) {
+    TickHub::Instance().Add(wrapped->writer.get());
+    wrapped->attached = true;
+  }
+  return self;
+}
+
+napi_value RecorderAppend(napi_env env, napi_callback_info info)
+{
+  size_t argc = 3;
+  napi_value args[3];
+  RecorderHandle* handle = UnwrapThis<RecorderHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  const char* usage = "append expects (sessionTick, sessionTime, values: Float64Array)";
+  int32_t session_tick = 0;
+  double session_time = 0.0;
+  double* values = nullptr;
+  size_t count = 0;
+  if (argc < 3 || napi_get_value_int32(env, args[0], &session_tick) != napi_ok ||
+      napi_get_value_double(env, args[1], &session_time) != napi_ok ||
+      !GetFloat64Array(env, args[2], &values, &count)) {
+    napi_throw_type_error(env, nullptr, usage);
+    return nullptr;
+  }
+  if (count != handle->writer->channels().size()) {
+    napi_throw_range_error(env, nullptr, "append expects one value per channel");
+    return nullptr;
+  }
+  std::string error;
+  if (!handle->writer->Append(session_tick, session_time, values, &error)) {
+    napi_throw_error(env, nullptr, error.c_str());
+    return nullptr;
+  }
+  return GetUndefined(env);
+}
+
+napi_value RecorderFlush(napi_env env, napi_callback_info info)
+{
+  RecorderHandle* handle = UnwrapThis<RecorderHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  std::string error;
+  if (!handle->writer->Flush(&error)) {
+    napi_throw_error(env, nullptr, error.c_str());
+    return nullptr;
+  }
+  return GetUndefined(env);
+}
+
+napi_value RecorderGetStats(napi_env env, napi_callback_info info)
+{
+  RecorderHandle* handle = UnwrapThis<RecorderHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  RecordingStats stats = handle->writer->stats();
+  std::string write_error = handle->writer->write_error();
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_set_named_property(env, result, "chunks", MakeDouble(env, static_cast<double>(stats.chunks))));
+  NAPI_CALL(env, napi_set_named_property(env, result, "records", MakeDouble(env, static_cast<double>(stats.records))));
+  NAPI_CALL(env, napi_set_named_property(env, result, "bytes", MakeDouble(env, static_cast<double>(stats.bytes))));
+  NAPI_CALL(env, napi_set_named_property(env, result, "writeError",
+                                         write_error.empty() ? GetNull(env) : MakeString(env, write_error)));
+  return result;
+}
+
+napi_value RecorderClose(napi_env env, napi_callback_info info)
+{
+  RecorderHandle* handle = UnwrapThis<RecorderHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  handle->Detach();
+  std::string error;
+  if (!handle->writer->Close(&error)) {
+    napi_throw_error(env, nullptr, error.c_str());
+    return nullptr;
+  }
+  return GetUndefined(env);
+}
+
+struct RecordingFileHandle {
+  RecordingReader reader;
+};
+
+void FinalizeRecordingFile(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  delete static_cast<RecordingFileHandle*>(data);
+}
+
+// Resolve the channels option to indices; every channel when absent.
+bool ParseSelection(napi_env env, const RecordingReader& reader, napi_value options, std::vector<size_t>* out)
+{
+  const std::vector<RecordingChannel>& channels = reader.channels();
+  napi_value value = nullptr;
+  if (!GetOptionalProperty(env, options, "channels", &value)) {
+    for (size_t i = 0; i < channels.size(); ++i) {
+      out->push_back(i);
+    }
+    return true;
+  }
+  std::vector<std::string> names;
+  if (!GetStringArray(env, value, &names)) {
+    return false;
+  }
+  for (const std::string& name : names) {
+    auto found = std::find_if(channels.begin(), channels.end(),
+                              [&](const RecordingChannel& channel) { return channel.name == name; });
+    if (found == channels.end()) {
+      std::string message = "channel not recorded: " + name;
+      napi_throw_error(env, nullptr, message.c_str());
+      return false;
+    }
+    out->push_back(static_cast<size_t>(found - channels.begin()));
+  }
+  return true;
+}
+
+// { sessionTick, sessionTime, channels: { name: Float64Array } }.
+napi_value MakeColumns(napi_env env, const RecordingReader& reader, const std::vector<size_t>& selected,
+                       const RecordingColumns& columns)
+{
+  napi_value result = nullptr;
+  napi_value channels = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_create_object(env, &channels));
+  NAPI_CALL(env, napi_set_named_property(env, result, "sessionTick", MakeFloat64Array(env, columns.ticks)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "sessionTime", MakeFloat64Array(env, columns.times)));
+  for (size_t k = 0; k < selected.size(); ++k) {
+    NAPI_CALL(env, napi_set_named_property(env, channels, reader.channels()[selected[k]].name.c_str(),
+                                           MakeFloat64Array(env, columns.values[k])));
+  }
+  NAPI_CALL(env, napi_set_named_property(env, result, "channels", channels));
+  return result;
+}
+
+napi_value MakeIndexArray(napi_env env, const std::vector<size_t>& indices)
+{
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_array_with_length(env, indices.size(), &result));
+  for (size_t i = 0; i < indices.size(); ++i) {
+    NAPI_CALL(env, napi_set_element(env, result, static_cast<uint32_t>(i), MakeDouble(env, static_cast<double>(indices[i]))));
+  }
+  return result;
+}
+
+napi_value RecordingFileConstructor(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value self = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+  std::string path;
+  if (argc < 1 || !GetString(env, args[0], &path)) {
+    napi_throw_type_error(env, nullptr, "RecordingFile expects (path)");
+    return nullptr;
+  }
+  std::unique_ptr<RecordingFileHandle> handle(new RecordingFileHandle());
+  std::string error;
+  if (!handle->reader.Open(path, &error)) {
+    napi_throw_error(env, nullptr, error.c_str());
+    return nullptr;
+  }
+  napi_status status = napi_wrap(env, self, handle.get(), FinalizeRecordingFile, nullptr, nullptr);
+  if (status != napi_ok) {
+    CheckNapi(env, status);
+    return nullptr;
+  }
+  handle.release();
+  return self;
+}
+
+napi_value RecordingFileGetChannels(napi_env env, napi_callback_info info)
+{
+  RecordingFileHandle* handle = UnwrapThis<RecordingFileHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  const std::vector<RecordingChannel>& channels = handle->reader.channels();
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_array_with_length(env, channels.size(), &result));
+  for (size_t i = 0; i < channels.size(); ++i) {
+    NAPI_CALL(env, napi_set_element(env, result, static_cast<uint32_t>(i), MakeString(env, channels[i].name)));
+  }
+  return result;
+}
+
+napi_value RecordingFileGetChunks(napi_env env, napi_callback_info info)
+{
+  RecordingFileHandle* handle = UnwrapThis<RecordingFileHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  const std::vector<RecordingChunk>& chunks = handle->reader.chunks();
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_array_with_length(env, chunks.size(), &result));
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    const RecordingChunk& chunk = chunks[i];
+    napi_value item = nullptr;
+    NAPI_CALL(env, napi_create_object(env, &item));
+    NAPI_CALL(env, napi_set_named_property(env, item, "valid", MakeBool(env, chunk.valid)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "records", MakeDouble(env, chunk.records)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "firstTick", MakeInt(env, chunk.first_tick)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "lastTick", MakeInt(env, chunk.last_tick)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "startTime", MakeDouble(env, chunk.start_time)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "endTime", MakeDouble(env, chunk.end_time)));
+    NAPI_CALL(env, napi_set_element(env, result, static_cast<uint32_t>(i), item));
+  }
+  return result;
+}
+
+napi_value RecordingFileReadChunk(napi_env env, napi_callback_info info)
+{
+  size_t argc = 2;
+  napi_value args[2];
+  RecordingFileHandle* handle = UnwrapThis<RecordingFileHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  uint32_t index = 0;
+  if (argc < 1 || napi_get_value_uint32(env, args[0], &index) != napi_ok) {
+    napi_throw_type_error(env, nullptr, "readChunk expects (index[, { channels? }])");
+    return nullptr;
+  }
+  if (index >= handle->reader.chunks().size()) {
+    napi_throw_range_error(env, nullptr, "chunk index out of range");
+    return nullptr;
+  }
+  std::vector<size_t> selected;
+  if (!ParseSelection(env, handle->reader, argc >= 2 ? args[1] : nullptr, &selected)) {
+    return nullptr;
+  }
+  RecordingColumns columns;
+  if (!handle->reader.ReadChunk(index, selected, &columns)) {
+    return GetNull(env);
+  }
+  return MakeColumns(env, handle->reader, selected, columns);
+}
+
+napi_value RecordingFileRead(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  RecordingFileHandle* handle = UnwrapThis<RecordingFileHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  napi_value options = argc >= 1 ? args[0] : nullptr;
+  double start = -std::numeric_limits<double>::infinity();
+  double end = std::numeric_limits<double>::infinity();
+  std::vector<size_t> selected;
+  if (!GetOptionalDouble(env, options, "start", &start) || !GetOptionalDouble(env, options, "end", &end) ||
+      !ParseSelection(env, handle->reader, options, &selected)) {
+    return nullptr;
+  }
+
+  // Seek through the chunk headers: read the chunks whose range overlaps,
+  // and report damaged chunks among or next to them as skipped, since their
+  // range is unknown.
+  const std::vector<RecordingChunk>& chunks = handle->reader.chunks();
+  auto overlaps = [&](const RecordingChunk& chunk) {
+    return chunk.valid && chunk.end_time >= start && chunk.start_time <= end;
+  };
+  size_t first = std::find_if(chunks.begin(), chunks.end(), overlaps) - chunks.begin();
+  size_t last = first;
+  for (size_t i = first; i < chunks.size(); ++i) {
+    if (overlaps(chunks[i])) {
+      last = i + 1;
+    }
+  }
+  while (first > 0 && !chunks[first - 1].valid) {
+    --first;
+  }
+  while (last < chunks.size() && !chunks[last].valid) {
+    ++last;
+  }
+  RecordingColumns columns;
+  columns.values.resize(selected.size());
+  std::vector<size_t> skipped;
+  for (size_t i = first; i < last; ++i) {
+    if (chunks[i].valid && !overlaps(chunks[i])) {
+      continue;
+    }
+    RecordingColumns chunk;
+    if (!handle->reader.ReadChunk(i, selected, &chunk)) {
+      skipped.push_back(i);
+      continue;
+    }
+    for (size_t r = 0; r < chunk.times.size(); ++r) {
+      if (chunk.times[r] < start || chunk.times[r] > end) {
+        continue;
+      }
+      columns.ticks.push_back(chunk.ticks[r]);
+      columns.times.push_back(chunk.times[r]);
+      for (size_t k = 0; k < selected.size(); ++k) {
+        columns.values[k].push_back(chunk.values[k][r]);
+      }
+    }
+  }
+
+  napi_value result = MakeColumns(env, handle->reader, selected, columns);
+  if (!result) {
+    return nullptr;
+  }
+  NAPI_CALL(env, napi_set_named_property(env, result, "skipped", MakeIndexArray(env, skipped)));
+  return result;
+}
+
+napi_value RecordingFileVerify(napi_env env, napi_callback_info info)
+{
+  RecordingFileHandle* handle = UnwrapThis<RecordingFileHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  const std::vector<RecordingChunk>& chunks = handle->reader.chunks();
+  std::vector<size_t> damaged;
+  int64_t records = 0;
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    RecordingColumns columns;
+    if (handle->reader.ReadChunk(i, {}, &columns)) {
+      records += static_cast<int64_t>(columns.times.size());
+    } else {
+      damaged.push_back(i);
+    }
+  }
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_set_named_property(env, result, "chunks", MakeDouble(env, static_cast<double>(chunks.size()))));
+  NAPI_CALL(env, napi_set_named_property(env, result, "records", MakeDouble(env, static_cast<double>(records))));
+  NAPI_CALL(env, napi_set_named_property(env, result, "damaged", MakeIndexArray(env, damaged)));
+  return result;
+}
+
+napi_value RecordingFileClose(napi_env env, napi_callback_info info)
+{
+  RecordingFileHandle* handle = UnwrapThis<RecordingFileHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  handle->reader.Close();
+  return GetUndefined(env);
+}
+
+}  // namespace
+
+napi_value RegisterRecording(napi_env env, napi_value exports)
+{
+  napi_property_descriptor recorder_methods[] = {
+    {"append", nullptr, RecorderAppend, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"flush", nullptr, RecorderFlush, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getStats", nullptr, RecorderGetStats, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"close", nullptr, RecorderClose, nullptr, nullptr, nullptr, napi_default, nullptr}
+  };
+  napi_property_descriptor file_methods[] = {
+    {"getChannels", nullptr, RecordingFileGetChannels, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getChunks", nullptr, RecordingFileGetChunks, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"readChunk", nullptr, RecordingFileReadChunk, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"read", nullptr, RecordingFileRead, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"verify", nullptr, RecordingFileVerify, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"close", nullptr, RecordingFileClose, nullptr, nullptr, nullptr, napi_default, nullptr}
+  };
+
+  napi_value recorder = nullptr;
+  NAPI_CALL(env, napi_define_class(env, "Recorder", NAPI_AUTO_LENGTH, RecorderConstructor, nullptr,
+                                   sizeof(recorder_methods) / sizeof(recorder_methods[0]), recorder_methods,
+                                   &recorder));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "Recorder", recorder));
+
+  napi_value file = nullptr;
+  NAPI_CALL(env, napi_define_class(env, "RecordingFile", NAPI_AUTO_LENGTH, RecordingFileConstructor, nullptr,
+                                   sizeof(file_methods) / sizeof(file_methods[0]), file_methods, &file));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "RecordingFile", file));
+  return exports;
+}
+
+}  // namespace irsdk_node
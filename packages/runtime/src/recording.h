@@ -0,0 +1,172 @@
+// Chunked telemetry recordings that survive crashes: a checksummed header
+// naming the channels, then fixed-size chunks that each carry their record
+// count, SessionTick and SessionTime range and a CRC-32 of their contents.
+//
+// A writer thread rewrites the open chunk in place about once a second, so
+// a crash loses the records since then, or at most that chunk when the crash
+// tears it. Chunks sit at fixed offsets, so readers seek by time through the
+// chunk headers alone and skip a damaged chunk without scanning the rest.
+
+#ifndef IRSDK_NODE_RECORDING_H_
+#define IRSDK_NODE_RECORDING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "telemetry_source.h"
+#include "tick_hub.h"
+
+namespace irsdk_node {
+
+struct RecordingChannel {
+  std::string name;
+  int width = 8;  // Bytes per value: 4 stores a float, 8 a double.
+};
+
+struct RecordingChunk {
+  bool valid = false;  // Header intact; the contents are checked when read.
+  uint32_t records = 0;
+  int32_t first_tick = 0;
+  int32_t last_tick = 0;
+  double start_time = 0.0;
+  double end_time = 0.0;
+};
+
+struct RecordingColumns {
+  std::vector<double> ticks;
+  std::vector<double> times;
+  std::vector<std::vector<double>> values;  // One per selected channel.
+};
+
+struct RecordingStats {
+  size_t chunks = 0;
+  int64_t records = 0;
+  int64_t bytes = 0;
+};
+
+class RecordingWriter : public TickListener {
+ public:
+  // Chunks hold chunk_bytes each. The writer thread puts full chunks on disk
+  // as they fill and rewrites the open one every flush_ms, so a short
+  // flush_ms costs one chunk_bytes write and fsync per period, off the thread
+  // that appends.
+  RecordingWriter(std::vector<std::string> channels, size_t chunk_bytes, double flush_ms);
+  ~RecordingWriter() override;
+
+  RecordingWriter(const RecordingWriter&) = delete;
+  RecordingWriter& operator=(const RecordingWriter&) = delete;
+
+  // Create or truncate the file at path and start the writer thread.
+  bool Open(const std::string& path, std::string* error);
+
+  // Record the channels of every live tick. Channels the sim stores as
+  // doubles keep full precision; the rest are stored as floats.
+  void OnTick(const TelemetrySource& source, const TickStamp& stamp) override;
+
+  // Add a record with one value per channel, in channel order. The header
+  // is written with the first record; records appended before any live
+  // tick keep every channel as a double. Only copies the record: write
+  // errors show in write_error() and the next Flush.
+  bool Append(int session_tick, double session_time, const double* values, std::string* error);
+
+  // Put every record appended so far on disk, waiting for the write.
+  bool Flush(std::string* error);
+  // Stop the writer thread, then flush and close the file.
+  bool Close(std::string* error);
+
+  const std::vector<std::string>& channels() const { return names_; }
+  RecordingStats stats() const;
+
+  // The last error writing records, from the writer thread or live ticks.
+  std::string write_error() const;
+
+ private:
+  // A chunk waiting to be written, before its header is filled in.
+  struct PendingChunk {
+    uint32_t sequence;
+    uint32_t records;
+    size_t payload_bytes;
+    std::string data;
+  };
+
+  void EncodeHeader();
+  void Run();
+  // Write the header, the chunks filled since the last pass and a copy of the
+  // open chunk, then put them on disk. Anything not on disk is kept for the
+  // next pass.
+  bool WritePending(std::string* error);
+
+  std::vector<std::string> names_;
+  std::vector<VarHandle> vars_;
+  std::vector<RecordingChannel> channels_;
+  std::vector<double> values_;
+  size_t chunk_bytes_;
+  double flush_ms_;
+  std::string path_;
+  std::FILE* file_ = nullptr;
+
+  // Held while writing to file_, by the writer thread or Flush.
+  std::mutex io_mutex_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  bool open_ = false;
+  bool stopping_ = false;
+  bool wake_pending_ = false;
+  std::string header_;
+  int64_t header_bytes_ = 0;  // 0 until the first record.
+  bool header_written_ = false;
+  size_t record_bytes_ = 0;
+  std::vector<PendingChunk> full_;
+  std::string chunk_;
+  uint32_t sequence_ = 0;
+  uint32_t chunk_records_ = 0;
+  size_t payload_bytes_ = 0;
+  bool dirty_ = false;
+  int64_t records_ = 0;
+  std::string write_error_;
+
+  std::thread worker_;
+};
+
+class RecordingReader {
+ public:
+  RecordingReader() = default;
+  ~RecordingReader();
+
+  RecordingReader(const RecordingReader&) = delete;
+  RecordingReader& operator=(const RecordingReader&) = delete;
+
+  // Read the header and every chunk header. Fails only when the header
+  // itself is damaged; damaged chunks are marked invalid.
+  bool Open(const std::string& path, std::string* error);
+  void Close();
+
+  const std::vector<RecordingChannel>& channels() const { return channels_; }
+  const std::vector<RecordingChunk>& chunks() const { return chunks_; }
+  size_t chunk_bytes() const { return chunk_bytes_; }
+
+  // Validate a chunk against its checksum and append its records to out,
+  // keeping the channels at the given indices. Returns false, leaving out
+  // untouched, when the chunk is damaged.
+  bool ReadChunk(size_t index, const std::vector<size_t>& selected, RecordingColumns* out) const;
+
+ private:
+  std::FILE* file_ = nullptr;
+  std::vector<RecordingChannel> channels_;
+  std::vector<RecordingChunk> chunks_;
+  size_t chunk_bytes_ = 0;
+  int64_t header_bytes_ = 0;
+  int64_t file_size_ = 0;
+  size_t record_bytes_ = 0;
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_RECORDING_H_
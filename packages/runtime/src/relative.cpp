@@ -0,0 +1,236 @@
+// Cars around a given car on track, for relative overlays and spotters.
+
+#include "relative.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+
+#include "bindings.h"
+#include "napi_util.h"
+
+namespace irsdk_node {
+
+void Relative::OnTick(const TelemetrySource& source, const TickStamp& stamp)
+{
+  double dt = has_prev_ ? stamp.session_time - prev_time_ : 0.0;
+  if (dt < 0.0) {
+    positions_.Reset();
+    dt = 0.0;
+  }
+  if (has_prev_ && dt == 0.0) {
+    return;
+  }
+  if (!positions_.Update(source, dt)) {
+    return;
+  }
+  has_prev_ = true;
+  prev_time_ = stamp.session_time;
+
+  bool has_pit = pit_var_.Resolve(source);
+  pit_.assign(static_cast<size_t>(positions_.count()), false);
+  for (int car = 0; has_pit && car < positions_.count(); ++car) {
+    pit_[static_cast<size_t>(car)] = pit_var_.Get(source, car) != 0.0;
+  }
+}
+
+RelativeEntry Relative::Entry(int car_idx, int other, double gap_pct) const
+{
+  double rate = positions_.rate(car_idx) > 0.0 ? positions_.rate(car_idx) : positions_.rate(other);
+  RelativeEntry entry;
+  entry.car_idx = other;
+  entry.gap_pct = gap_pct;
+  entry.gap_s = rate > 0.0 ? gap_pct / rate : std::numeric_limits<double>::quiet_NaN();
+  entry.lap_delta =
+      static_cast<int>(std::lround(positions_.distance(other) - positions_.distance(car_idx) - gap_pct));
+  entry.on_pit_road = pit_[static_cast<size_t>(other)];
+  return entry;
+}
+
+bool Relative::Query(int car_idx, const RelativeQuery& query, std::vector<RelativeEntry>* ahead,
+                     std::vector<RelativeEntry>* behind) const
+{
+  ahead->clear();
+  behind->clear();
+  const TrackOrder& track = positions_.order();
+  int rank = track.RankOf(car_idx);
+  if (rank < 0) {
+    return false;
+  }
+
+  // Walk outwards from the car in the sorted order; gaps only grow, so the
+  // first car past a limit ends the walk.
+  const std::vector<int>& order = track.order();
+  int n = static_cast<int>(order.size());
+  double max_pct = std::min(query.max_gap_pct, 0.5);
+  for (int step = 1; step < n && static_cast<int>(ahead->size()) < query.ahead; ++step) {
+    int other = order[static_cast<size_t>((rank + step) % n)];
+    double gap = positions_.ForwardGap(car_idx, other);
+    RelativeEntry entry = Entry(car_idx, other, gap);
+    if (gap > max_pct || (query.max_gap_s > 0.0 && entry.gap_s > query.max_gap_s)) {
+      break;
+    }
+    ahead->push_back(entry);
+  }
+  for (int step = 1; step < n && static_cast<int>(behind->size()) < query.behind; ++step) {
+    int other = order[static_cast<size_t>((rank - step + n) % n)];
+    double gap = positions_.ForwardGap(other, car_idx);
+    RelativeEntry entry = Entry(car_idx, other, -gap);
+    // A car half a lap away is listed ahead only.
+    if (gap > max_pct || gap >= 0.5 || (query.max_gap_s > 0.0 && -entry.gap_s > query.max_gap_s)) {
+      break;
+    }
+    behind->push_back(entry);
+  }
+  return true;
+}
+
+namespace {
+
+// JS wrapper that keeps the relative attached to the live tick stream until
+// close() or garbage collection.
+struct RelativeHandle {
+  std::unique_ptr<Relative> relative;
+  double track_length_m = 0.0;
+  bool attached = false;
+
+  void Detach()
+  {
+    if (attached) {
+      TickHub::Instance().Remove(relative.get());
+      attached = false;
+    }
+  }
+};
+
+void FinalizeRelative(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  RelativeHandle* handle = static_cast<RelativeHandle*>(data);
+  handle->Detach();
+  delete handle;
+}
+
+napi_value RelativeConstructor(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value self = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+  double track_length_m = 0.0;
+  if (!GetOptionalDouble(env, argc >= 1 ? args[0] : nullptr, "trackLengthM", &track_length_m)) {
+    return nullptr;
+  }
+
+  auto* handle = new RelativeHandle();
+  handle->relative.reset(new Relative());
+  handle->track_length_m = std::max(0.0, track_length_m);
+  napi_status status = napi_wrap(env, self, handle, FinalizeRelative, nullptr, nullptr);
+  if (status != napi_ok) {
+    delete handle;
+    CheckNapi(env, status);
+    return nullptr;
+  }
+
+  TickHub::Instance().Add(handle->relative.get());
+  handle->attached = true;
+  return self;
+}
+
+napi_value MakeRelativeEntries(napi_env env, const std::vector<RelativeEntry>& entries, double track_length_m)
+{
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_array_with_length(env, entries.size(), &result));
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const RelativeEntry& entry = entries[i];
+    napi_value item = nullptr;
+    NAPI_CALL(env, napi_create_object(env, &item));
+    NAPI_CALL(env, napi_set_named_property(env, item, "carIdx", MakeInt(env, entry.car_idx)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "gapPct", MakeDouble(env, entry.gap_pct)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "gapS",
+                                           std::isnan(entry.gap_s) ? GetNull(env) : MakeDouble(env, entry.gap_s)));
+    if (track_length_m > 0.0) {
+      NAPI_CALL(env, napi_set_named_property(env, item, "gapM", MakeDouble(env, entry.gap_pct * track_length_m)));
+    }
+    NAPI_CALL(env, napi_set_named_property(env, item, "lapDelta", MakeInt(env, entry.lap_delta)));
+    NAPI_CALL(env, napi_set_named_property(env, item, "onPitRoad", MakeBool(env, entry.on_pit_road)));
+    NAPI_CALL(env, napi_set_element(env, result, static_cast<uint32_t>(i), item));
+  }
+  return result;
+}
+
+napi_value RelativeQueryCars(napi_env env, napi_callback_info info)
+{
+  size_t argc = 2;
+  napi_value args[2];
+  RelativeHandle* handle = UnwrapThis<RelativeHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  int car_idx = 0;
+  if (argc < 1 || napi_get_value_int32(env, args[0], &car_idx) != napi_ok) {
+    napi_throw_type_error(env, nullptr, "query expects (carIdx, { ahead?, behind?, maxGapS?, maxDistanceM? })");
+    return nullptr;
+  }
+
+  napi_value options = argc >= 2 ? args[1] : nullptr;
+  RelativeQuery query;
+  double max_distance_m = 0.0;
+  if (!GetOptionalInt(env, options, "ahead", &query.ahead) ||
+      !GetOptionalInt(env, options, "behind", &query.behind) ||
+      !GetOptionalDouble(env, options, "maxGapS", &query.max_gap_s) ||
+      !GetOptionalDouble(env, options, "maxDistanceM", &max_distance_m)) {
+    return nullptr;
+  }
+  if (max_distance_m > 0.0) {
+    if (handle->track_length_m <= 0.0) {
+      napi_throw_error(env, nullptr, "maxDistanceM needs the trackLengthM option");
+      return nullptr;
+    }
+    query.max_gap_pct = max_distance_m / handle->track_length_m;
+  }
+
+  std::vector<RelativeEntry> ahead;
+  std::vector<RelativeEntry> behind;
+  if (!handle->relative->Query(car_idx, query, &ahead, &behind)) {
+    return GetNull(env);
+  }
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_set_named_property(env, result, "ahead", MakeRelativeEntries(env, ahead, handle->track_length_m)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "behind",
+                                         MakeRelativeEntries(env, behind, handle->track_length_m)));
+  return result;
+}
+
+napi_value RelativeClose(napi_env env, napi_callback_info info)
+{
+  RelativeHandle* handle = UnwrapThis<RelativeHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  handle->Detach();
+  return GetUndefined(env);
+}
+
+}  // namespace
+
+napi_value RegisterRelative(napi_env env, napi_value exports)
+{
+  napi_property_descriptor methods[] = {
+    {"query", nullptr, RelativeQueryCars, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"close", nullptr, RelativeClose, nullptr, nullptr, nullptr, napi_default, nullptr}
+  };
+
+  napi_value constructor = nullptr;
+  NAPI_CALL(env, napi_define_class(env, "Relative", NAPI_AUTO_LENGTH, RelativeConstructor, nullptr,
+                                   sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "Relative", constructor));
+  return exports;
+}
+
+}  // namespace irsdk_node
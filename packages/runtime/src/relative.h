@@ -0,0 +1,49 @@
+// Cars around a given car on track, for relative overlays and spotters.
+
+#ifndef IRSDK_NODE_RELATIVE_H_
+#define IRSDK_NODE_RELATIVE_H_
+
+#include <vector>
+
+#include "telemetry_source.h"
+#include "tick_hub.h"
+#include "track_order.h"
+
+namespace irsdk_node {
+
+struct RelativeQuery {
+  int ahead = 3;              // Most cars returned each way.
+  int behind = 3;
+  double max_gap_s = 0.0;     // <= 0: no time limit.
+  double max_gap_pct = 0.5;   // Half a lap each way at most.
+};
+
+struct RelativeEntry {
+  int car_idx;
+  double gap_pct;  // Positive ahead, negative behind.
+  double gap_s;    // Same sign as gap_pct; NaN until speeds are known.
+  int lap_delta;   // Laps the other car is ahead (+) or behind (-) in the race.
+  bool on_pit_road;
+};
+
+class Relative : public TickListener {
+ public:
+  void OnTick(const TelemetrySource& source, const TickStamp& stamp) override;
+
+  // Nearest first. Returns false when the car is not on track.
+  bool Query(int car_idx, const RelativeQuery& query, std::vector<RelativeEntry>* ahead,
+             std::vector<RelativeEntry>* behind) const;
+
+ private:
+  RelativeEntry Entry(int car_idx, int other, double gap_pct) const;
+
+  TrackPositions positions_;
+  VarHandle pit_var_{"CarIdxOnPitRoad"};
+  std::vector<bool> pit_;
+  bool has_prev_ = false;
+  double prev_time_ = 0.0;
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_RELATIVE_H_
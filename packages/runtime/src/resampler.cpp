@@ -0,0 +1,299 @@
+// Conversion of irregular telemetry samples into uniform fixed-rate series.
+
+#include "resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "ibt_file.h"
+#include "irsdk_defines.h"
+
+namespace irsdk_node {
+
+namespace {
+
+// Tolerance for treating a sample time as landing on a grid point.
+constexpr double kGridEpsilon = 1e-9;
+
+// Jumps that would need more fill rows than this restart the grid instead.
+constexpr double kMaxGapRows = 1 << 22;
+
+// Sample times whose grid index would not be exact in a double are dropped.
+constexpr double kMaxGridIndex = 9007199254740992.0;  // 2^53
+
+// .ibt resampling: rows reserved up front, and rows allowed beyond one per
+// record for recording gaps.
+constexpr size_t kMaxReservedRows = 1 << 22;
+constexpr double kMaxFillRows = 1 << 24;
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+bool IsBlendable(int type)
+{
+  return type == irsdk_float || type == irsdk_double;
+}
+
+// Resolve the channels against a source and describe the row layout. Missing
+// variables keep a single NaN entry so the layout stays stable.
+void BuildLayout(const TelemetrySource& source,
+                 const ResampleOptions& options,
+                 std::vector<VarHandle>* vars,
+                 ResampledSeries* series,
+                 std::vector<ChannelKind>* kinds,
+                 std::vector<bool>* hold)
+{
+  series->rate_hz = options.rate_hz;
+  series->names.clear();
+  series->counts.clear();
+  series->offsets.clear();
+  series->width = 0;
+  series->ClearRows();
+  kinds->clear();
+  hold->clear();
+
+  for (size_t i = 0; i < options.channels.size(); ++i) {
+    VarHandle& var = (*vars)[i];
+    bool found = var.Resolve(source);
+    int count = found ? std::max(1, var.count()) : 1;
+    // Integer, boolean and bitfield channels (gear, flags) only make sense held.
+    bool held = options.mode == ResampleMode::kHold || !found ||
+        !IsBlendable(source.VarType(source.FindVar(var.name().c_str())));
+    series->names.push_back(options.channels[i].name);
+    series->counts.push_back(count);
+    series->offsets.push_back(series->width);
+    series->width += static_cast<size_t>(count);
+    for (int entry = 0; entry < count; ++entry) {
+      kinds->push_back(options.channels[i].kind);
+      hold->push_back(held);
+    }
+  }
+}
+
+void ReadSample(const TelemetrySource& source,
+                const std::vector<VarHandle>& vars,
+                const ResampledSeries& series,
+                double* out)
+{
+  for (size_t i = 0; i < vars.size(); ++i) {
+    for (int entry = 0; entry < series.counts[i]; ++entry) {
+      out[series.offsets[i] + static_cast<size_t>(entry)] = vars[i].valid() ? vars[i].Get(source, entry) : kNaN;
+    }
+  }
+}
+
+}  // namespace
+
+void ResampledSeries::ClearRows()
+{
+  times.clear();
+  values.clear();
+}
+
+UniformResampler::UniformResampler(std::vector<ChannelKind> kinds,
+                                   std::vector<bool> hold,
+                                   const ResampleOptions& options)
+    : kinds_(std::move(kinds)),
+      hold_(std::move(hold)),
+      rate_hz_(options.rate_hz),
+      max_gap_s_(options.max_gap_s),
+      drop_gaps_(options.drop_gaps)
+{
+  prev_.assign(kinds_.size(), 0.0);
+  scratch_.assign(kinds_.size(), 0.0);
+}
+
+void UniformResampler::Reset()
+{
+  started_ = false;
+}
+
+void UniformResampler::Start(double t, const double* values, ResampledSeries* out)
+{
+  started_ = true;
+  next_k_ = static_cast<int64_t>(std::ceil(t * rate_hz_ - kGridEpsilon));
+  prev_t_ = t;
+  std::copy(values, values + kinds_.size(), prev_.begin());
+  if (std::fabs(GridTime(next_k_) - t) <= kGridEpsilon) {
+    EmitRow(GridTime(next_k_), values, out);
+    next_k_ += 1;
+  }
+}
+
+void UniformResampler::Push(double t, const double* values, ResampledSeries* out)
+{
+  if (!std::isfinite(t) || std::fabs(t * rate_hz_) > kMaxGridIndex) {
+    return;
+  }
+  if (!started_ || t < prev_t_) {
+    Start(t, values, out);
+    return;
+  }
+  if (t == prev_t_) {
+    // Repeated sample (paused sim); nothing new to place on the grid.
+    return;
+  }
+
+  double span = t - prev_t_;
+  bool gap = max_gap_s_ > 0.0 && span > max_gap_s_;
+  if (span * rate_hz_ > kMaxGapRows) {
+    Start(t, values, out);
+    return;
+  }
+  if (gap && drop_gaps_) {
+    next_k_ = std::max(next_k_, static_cast<int64_t>(std::ceil(t * rate_hz_ - kGridEpsilon)));
+  }
+
+  while (GridTime(next_k_) <= t + kGridEpsilon) {
+    double grid = GridTime(next_k_);
+    if (grid >= t - kGridEpsilon) {
+      EmitRow(grid, values, out);
+    } else if (gap) {
+      EmitGapRow(grid, out);
+    } else {
+      double fraction = (grid - prev_t_) / span;
+      for (size_t i = 0; i < kinds_.size(); ++i) {
+        scratch_[i] = hold_[i] ? prev_[i] : BlendChannel(kinds_[i], prev_[i], values[i], fraction);
+      }
+      EmitRow(grid, scratch_.data(), out);
+    }
+    next_k_ += 1;
+  }
+
+  prev_t_ = t;
+  std::copy(values, values + kinds_.size(), prev_.begin());
+}
+
+void UniformResampler::EmitRow(double time, const double* values, ResampledSeries* out) const
+{
+  out->times.push_back(time);
+  out->values.insert(out->values.end(), values, values + kinds_.size());
+}
+
+void UniformResampler::EmitGapRow(double time, ResampledSeries* out) const
+{
+  out->times.push_back(time);
+  out->values.insert(out->values.end(), kinds_.size(), kNaN);
+}
+
+Resampler::Resampler(ResampleOptions options, bool session_clock, size_t max_rows)
+    : options_(std::move(options)),
+      session_clock_(session_clock),
+      max_rows_(std::max<size_t>(1, max_rows))
+{
+  for (const ChannelSpec& channel : options_.channels) {
+    vars_.emplace_back(channel.name);
+  }
+  series_.rate_hz = options_.rate_hz;
+}
+
+void Resampler::ResetLayout(const TelemetrySource& source)
+{
+  // Rows buffered under the old layout can no longer be described; count
+  // them as dropped rather than mixing widths.
+  size_t dropped = series_.dropped + series_.rows();
+  std::vector<ChannelKind> kinds;
+  std::vector<bool> hold;
+  BuildLayout(source, options_, &vars_, &series_, &kinds, &hold);
+  series_.dropped = dropped;
+  resampler_.reset(new UniformResampler(std::move(kinds), std::move(hold), options_));
+  sample_.assign(series_.width, 0.0);
+}
+
+void Resampler::OnTick(const TelemetrySource& source, const TickStamp& stamp)
+{
+  bool layout_changed = !resampler_;
+  for (size_t i = 0; i < vars_.size() && !layout_changed; ++i) {
+    int before = vars_[i].count();
+    vars_[i].Resolve(source);
+    layout_changed = vars_[i].count() != before;
+  }
+  if (layout_changed) {
+    ResetLayout(source);
+  }
+
+  ReadSample(source, vars_, series_, sample_.data());
+  double t = session_clock_ ? stamp.session_time : stamp.monotonic_ms / 1000.0;
+  resampler_->Push(t, sample_.data(), &series_);
+
+  // Trim with some slack so the oldest rows are not shifted out every tick.
+  if (series_.rows() > max_rows_ + max_rows_ / 4) {
+    TrimRows(max_rows_);
+  }
+}
+
+void Resampler::TrimRows(size_t limit)
+{
+  if (series_.rows() <= limit) {
+    return;
+  }
+  size_t excess = series_.rows() - limit;
+  series_.times.erase(series_.times.begin(), series_.times.begin() + static_cast<std::ptrdiff_t>(excess));
+  series_.values.erase(series_.values.begin(),
+                       series_.values.begin() + static_cast<std::ptrdiff_t>(excess * series_.width));
+  series_.dropped += excess;
+}
+
+void Resampler::Drain(ResampledSeries* out)
+{
+  TrimRows(max_rows_);
+  *out = series_;
+  series_.ClearRows();
+  series_.dropped = 0;
+}
+
+bool ResampleIbt(IbtFile& file, const ResampleOptions& options, ResampledSeries* out, std::string* error,
+                 JobControl* control)
+{
+  IbtRecordSource probe(file);
+  VarHandle time_var("SessionTime");
+  if (!time_var.Resolve(probe)) {
+    *error = "file has no SessionTime channel";
+    return false;
+  }
+
+  std::vector<VarHandle> vars;
+  for (const ChannelSpec& channel : options.channels) {
+    vars.emplace_back(channel.name);
+    if (!vars.back().Resolve(probe)) {
+      *error = "unknown channel '" + channel.name + "'";
+      return false;
+    }
+  }
+
+  std::vector<ChannelKind> kinds;
+  std::vector<bool> hold;
+  BuildLayout(probe, options, &vars, out, &kinds, &hold);
+  out->dropped = 0;
+  // SessionTime comes from the file, so the grid is capped at what the record
+  // count allows plus room for recording gaps; a corrupt time channel then
+  // fails the call instead of exhausting memory.
+  const double records = static_cast<double>(file.record_count());
+  const double ticks = file.header().tick_rate > 0 ? file.header().tick_rate : 60.0;
+  const double max_rows = records * std::max(1.0, options.rate_hz / ticks) + kMaxFillRows;
+  size_t expected = static_cast<size_t>(std::min(records * (options.rate_hz / ticks) + 1.0, max_rows));
+  expected = std::min(expected, kMaxReservedRows);
+  out->times.reserve(expected);
+  out->values.reserve(expected * out->width);
+
+  UniformResampler resampler(std::move(kinds), std::move(hold), options);
+  std::vector<double> sample(out->width);
+  bool too_long = false;
+  bool ok = ForEachIbtRecord(file, 0, file.record_count(), [&](const IbtRecordSource& source, int index) {
+    (void)index;
+    ReadSample(source, vars, *out, sample.data());
+    resampler.Push(time_var.Get(source), sample.data(), out);
+    too_long = static_cast<double>(out->rows()) > max_rows;
+    return !too_long;
+  }, control);
+  if (too_long) {
+    *error = "SessionTime spans far more than the file's records; the file is corrupt";
+    out->ClearRows();
+  } else if (!ok) {
+    *error = "failed to read records";
+  }
+  return ok;
+}
+
+}  // namespace irsdk_node
@@ -0,0 +1,121 @@
+// Conversion of irregular telemetry samples into uniform fixed-rate series,
+// both from the live tick stream and from .ibt files.
+
+#ifndef IRSDK_NODE_RESAMPLER_H_
+#define IRSDK_NODE_RESAMPLER_H_
+
+#include <node_api.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "channel_spec.h"
+#include "job_control.h"
+#include "telemetry_source.h"
+#include "tick_hub.h"
+
+namespace irsdk_node {
+
+class IbtFile;
+
+enum class ResampleMode {
+  kLinear,  // Blend float channels between the bracketing samples.
+  kHold,    // Repeat the last sample at or before each grid point.
+};
+
+struct ResampleOptions {
+  std::vector<ChannelSpec> channels;
+  double rate_hz = 60.0;
+  ResampleMode mode = ResampleMode::kLinear;
+  // Grid points inside a gap longer than this are not interpolated across.
+  double max_gap_s = 0.5;
+  // Leave gap grid points out instead of emitting NaN rows.
+  bool drop_gaps = false;
+};
+
+// Uniform rows stored row-major; row i is at times[i] = k / rate_hz.
+struct ResampledSeries {
+  double rate_hz = 0.0;
+  std::vector<std::string> names;
+  std::vector<int> counts;
+  std::vector<size_t> offsets;
+  size_t width = 0;
+  std::vector<double> times;
+  std::vector<double> values;
+  size_t dropped = 0;
+
+  size_t rows() const { return times.size(); }
+  void ClearRows();
+};
+
+// Streaming resampler over flat rows of `width` entries. Grid points are
+// integer multiples of 1 / rate_hz so separate runs line up exactly.
+class UniformResampler {
+ public:
+  // kinds holds one entry per value; entries with hold set are never blended.
+  UniformResampler(std::vector<ChannelKind> kinds, std::vector<bool> hold, const ResampleOptions& options);
+
+  // Feed a sample at time t in seconds and append the grid rows it completes.
+  // Time going backwards (new session, replay seek) restarts the grid.
+  void Push(double t, const double* values, ResampledSeries* out);
+  void Reset();
+
+ private:
+  double GridTime(int64_t k) const { return static_cast<double>(k) / rate_hz_; }
+  void Start(double t, const double* values, ResampledSeries* out);
+  void EmitRow(double time, const double* values, ResampledSeries* out) const;
+  void EmitGapRow(double time, ResampledSeries* out) const;
+
+  std::vector<ChannelKind> kinds_;
+  std::vector<bool> hold_;
+  double rate_hz_;
+  double max_gap_s_;
+  bool drop_gaps_;
+
+  bool started_ = false;
+  int64_t next_k_ = 0;
+  double prev_t_ = 0.0;
+  std::vector<double> prev_;
+  mutable std::vector<double> scratch_;
+};
+
+// Resamples the live tick stream into a bounded buffer drained from JS.
+class Resampler : public TickListener {
+ public:
+  Resampler(ResampleOptions options, bool session_clock, size_t max_rows);
+
+  void OnTick(const TelemetrySource& source, const TickStamp& stamp) override;
+
+  // Move the buffered rows into out and start a new buffer.
+  void Drain(ResampledSeries* out);
+
+ private:
+  void ResetLayout(const TelemetrySource& source);
+  void TrimRows(size_t limit);
+
+  ResampleOptions options_;
+  bool session_clock_;
+  size_t max_rows_;
+  std::vector<VarHandle> vars_;
+  std::unique_ptr<UniformResampler> resampler_;
+  ResampledSeries series_;
+  std::vector<double> sample_;
+};
+
+// Resample every record of an .ibt file against its SessionTime channel.
+bool ResampleIbt(IbtFile& file, const ResampleOptions& options, ResampledSeries* out, std::string* error,
+                 JobControl* control = nullptr);
+
+// Parse { channels, rateHz?, mode?, maxGapS?, dropGaps? }.
+bool ParseResampleOptions(napi_env env, napi_value value, ResampleOptions* out);
+
+// { rateHz, time, columns: { name: Float64Array }, counts: { name: n }, dropped }.
+// Array channels are laid out row-major within their column.
+napi_value MakeResampledSeries(napi_env env, const ResampledSeries& series);
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_RESAMPLER_H_
@@ -0,0 +1,179 @@
+// JS bindings of the resamplers.
+
+#include <cmath>
+#include <memory>
+#include <string>
+
+#include "bindings.h"
+#include "napi_util.h"
+#include "resampler.h"
+
+namespace irsdk_node {
+
+bool ParseResampleOptions(napi_env env, napi_value value, ResampleOptions* out)
+{
+  napi_value channels_value = nullptr;
+  if (!GetOptionalProperty(env, value, "channels", &channels_value)) {
+    napi_throw_type_error(env, nullptr, "expected ({ channels, rateHz?, mode?, maxGapS?, dropGaps? })");
+    return false;
+  }
+  if (!ParseChannelSpecs(env, channels_value, &out->channels)) {
+    return false;
+  }
+
+  std::string mode;
+  if (!GetOptionalDouble(env, value, "rateHz", &out->rate_hz) ||
+      !GetOptionalString(env, value, "mode", &mode) ||
+      !GetOptionalDouble(env, value, "maxGapS", &out->max_gap_s) ||
+      !GetOptionalBool(env, value, "dropGaps", &out->drop_gaps)) {
+    return false;
+  }
+  if (!(out->rate_hz > 0.0) || !std::isfinite(out->rate_hz)) {
+    napi_throw_range_error(env, nullptr, "rateHz must be a positive number");
+    return false;
+  }
+  if (mode.empty() || mode == "linear") {
+    out->mode = ResampleMode::kLinear;
+  } else if (mode == "hold") {
+    out->mode = ResampleMode::kHold;
+  } else {
+    napi_throw_type_error(env, nullptr, "mode must be 'linear' or 'hold'");
+    return false;
+  }
+  return true;
+}
+
+napi_value MakeResampledSeries(napi_env env, const ResampledSeries& series)
+{
+  size_t rows = series.rows();
+  napi_value result = nullptr;
+  napi_value columns = nullptr;
+  napi_value counts = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_create_object(env, &columns));
+  NAPI_CALL(env, napi_create_object(env, &counts));
+
+  // Transpose the row-major buffer into one typed array per channel.
+  std::vector<double> column;
+  for (size_t i = 0; i < series.names.size(); ++i) {
+    size_t count = static_cast<size_t>(series.counts[i]);
+    column.resize(rows * count);
+    for (size_t row = 0; row < rows; ++row) {
+      const double* src = &series.values[row * series.width + series.offsets[i]];
+      std::copy(src, src + count, &column[row * count]);
+    }
+    NAPI_CALL(env, napi_set_named_property(env, columns, series.names[i].c_str(), MakeFloat64Array(env, column)));
+    NAPI_CALL(env, napi_set_named_property(env, counts, series.names[i].c_str(), MakeInt(env, series.counts[i])));
+  }
+
+  NAPI_CALL(env, napi_set_named_property(env, result, "rateHz", MakeDouble(env, series.rate_hz)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "time", MakeFloat64Array(env, series.times)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "columns", columns));
+  NAPI_CALL(env, napi_set_named_property(env, result, "counts", counts));
+  NAPI_CALL(env, napi_set_named_property(env, result, "dropped", MakeDouble(env, static_cast<double>(series.dropped))));
+  return result;
+}
+
+namespace {
+
+// JS wrapper that keeps the resampler attached to the live tick stream
+// until close() or garbage collection.
+struct ResamplerHandle {
+  std::unique_ptr<Resampler> resampler;
+  bool attached = false;
+
+  void Detach()
+  {
+    if (attached) {
+      TickHub::Instance().Remove(resampler.get());
+      attached = false;
+    }
+  }
+};
+
+void FinalizeResampler(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  ResamplerHandle* handle = static_cast<ResamplerHandle*>(data);
+  handle->Detach();
+  delete handle;
+}
+
+napi_value ResamplerConstructor(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value self = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+  napi_value options_value = argc >= 1 ? args[0] : nullptr;
+  ResampleOptions options;
+  if (!ParseResampleOptions(env, options_value, &options)) {
+    return nullptr;
+  }
+
+  std::string time_base = "session";
+  int max_rows = 1 << 16;
+  if (!GetOptionalString(env, options_value, "timeBase", &time_base) ||
+      !GetOptionalInt(env, options_value, "maxRows", &max_rows)) {
+    return nullptr;
+  }
+  if (time_base != "session" && time_base != "monotonic") {
+    napi_throw_type_error(env, nullptr, "timeBase must be 'session' or 'monotonic'");
+    return nullptr;
+  }
+
+  auto* handle = new ResamplerHandle();
+  handle->resampler.reset(
+      new Resampler(std::move(options), time_base == "session", static_cast<size_t>(std::max(1, max_rows))));
+  napi_status status = napi_wrap(env, self, handle, FinalizeResampler, nullptr, nullptr);
+  if (status != napi_ok) {
+    delete handle;
+    CheckNapi(env, status);
+    return nullptr;
+  }
+
+  TickHub::Instance().Add(handle->resampler.get());
+  handle->attached = true;
+  return self;
+}
+
+napi_value ResamplerDrain(napi_env env, napi_callback_info info)
+{
+  ResamplerHandle* handle = UnwrapThis<ResamplerHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  ResampledSeries series;
+  handle->resampler->Drain(&series);
+  return MakeResampledSeries(env, series);
+}
+
+napi_value ResamplerClose(napi_env env, napi_callback_info info)
+{
+  ResamplerHandle* handle = UnwrapThis<ResamplerHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  handle->Detach();
+  return GetUndefined(env);
+}
+
+}  // namespace
+
+napi_value RegisterResampler(napi_env env, napi_value exports)
+{
+  napi_property_descriptor methods[] = {
+    {"drain", nullptr, ResamplerDrain, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"close", nullptr, ResamplerClose, nullptr, nullptr, nullptr, napi_default, nullptr}
+  };
+
+  napi_value constructor = nullptr;
+  NAPI_CALL(env, napi_define_class(env, "Resampler", NAPI_AUTO_LENGTH, ResamplerConstructor, nullptr,
+                                   sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "Resampler", constructor));
+  return exports;
+}
+
+}  // namespace irsdk_node
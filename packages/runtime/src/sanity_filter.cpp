@@ -0,0 +1,231 @@
+// Per-tick NaN, range and spike suppression for live telemetry.
+
+#include "sanity_filter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "bindings.h"
+#include "irsdk_defines.h"
+#include "napi_util.h"
+
+namespace irsdk_node {
+
+namespace {
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+constexpr double kTwoPi = 6.283185307179586;
+
+// Change from one value to the next, the short way round for wrapping kinds.
+double Step(ChannelKind kind, double from, double to)
+{
+  double step = to - from;
+  double period = kind == ChannelKind::kLapDistPct ? 1.0 : kind == ChannelKind::kAngle ? kTwoPi : 0.0;
+  if (period > 0.0) {
+    step = std::remainder(step, period);
+  }
+  return step;
+}
+
+}  // namespace
+
+SanityFilter& SanityFilter::Instance()
+{
+  static SanityFilter filter;
+  return filter;
+}
+
+void SanityFilter::Configure(std::vector<SanityRule> rules)
+{
+  channels_.clear();
+  channels_.reserve(rules.size());
+  for (SanityRule& rule : rules) {
+    Channel channel;
+    channel.kind = InferChannelKind(rule.name);
+    channel.var = VarHandle(rule.name);
+    channel.rule = std::move(rule);
+    channels_.push_back(std::move(channel));
+  }
+}
+
+void SanityFilter::FilterEntry(Channel* channel, size_t entry, double raw, double session_time)
+{
+  const SanityRule& rule = channel->rule;
+  double& out = channel->value[entry];
+  double& good = channel->good[entry];
+
+  if (channel->kind == ChannelKind::kLapDistPct && raw < 0.0) {
+    // Not in the world: pass the marker through and start over.
+    out = raw;
+    good = kNaN;
+    channel->held[entry] = 0;
+    return;
+  }
+  if (!std::isfinite(raw)) {
+    ++channel->counts.non_finite;
+    out = rule.mask ? kNaN : good;
+    return;
+  }
+  if (raw < rule.min || raw > rule.max) {
+    ++channel->counts.out_of_range;
+    out = rule.mask ? kNaN : std::min(std::max(raw, rule.min), rule.max);
+    return;
+  }
+  if (rule.max_rate > 0.0 && !std::isnan(good) && channel->held[entry] < rule.max_hold) {
+    double elapsed = session_time - channel->good_time[entry];
+    if (elapsed > 0.0 && std::fabs(Step(channel->kind, good, raw)) > rule.max_rate * elapsed) {
+      ++channel->counts.spikes;
+      ++channel->held[entry];
+      out = rule.mask ? kNaN : good;
+      return;
+    }
+  }
+  out = raw;
+  good = raw;
+  channel->good_time[entry] = session_time;
+  channel->held[entry] = 0;
+}
+
+void SanityFilter::Apply(const TelemetrySource& source, double session_time)
+{
+  if (channels_.empty()) {
+    return;
+  }
+  bool restart = session_time < prev_time_;
+  prev_time_ = session_time;
+
+  for (Channel& channel : channels_) {
+    channel.active = false;
+    if (!channel.var.Resolve(source)) {
+      continue;
+    }
+    int type = source.VarType(channel.var.index());
+    if (type != irsdk_float && type != irsdk_double) {
+      continue;
+    }
+    channel.active = true;
+    size_t count = static_cast<size_t>(channel.var.count());
+    if (restart || channel.value.size() != count) {
+      channel.value.assign(count, kNaN);
+      channel.good.assign(count, kNaN);
+      channel.good_time.assign(count, 0.0);
+      channel.held.assign(count, 0);
+    }
+    for (size_t entry = 0; entry < count; ++entry) {
+      FilterEntry(&channel, entry, channel.var.Get(source, static_cast<int>(entry)), session_time);
+    }
+  }
+}
+
+bool SanityFilter::Lookup(int idx, int entry, double* value) const
+{
+  for (const Channel& channel : channels_) {
+    if (channel.active && channel.var.index() == idx) {
+      if (entry < 0 || entry >= static_cast<int>(channel.value.size())) {
+        return false;
+      }
+      *value = channel.value[static_cast<size_t>(entry)];
+      return true;
+    }
+  }
+  return false;
+}
+
+namespace {
+
+bool ParseSanityRule(napi_env env, napi_value options, SanityRule* rule)
+{
+  rule->min = -std::numeric_limits<double>::infinity();
+  rule->max = std::numeric_limits<double>::infinity();
+  std::string action = "hold";
+  if (!GetOptionalDouble(env, options, "min", &rule->min) ||
+      !GetOptionalDouble(env, options, "max", &rule->max) ||
+      !GetOptionalDouble(env, options, "maxRate", &rule->max_rate) ||
+      !GetOptionalInt(env, options, "maxHoldTicks", &rule->max_hold) ||
+      !GetOptionalString(env, options, "action", &action)) {
+    return false;
+  }
+  if (action != "hold" && action != "mask") {
+    napi_throw_type_error(env, nullptr, "action must be 'hold' or 'mask'");
+    return false;
+  }
+  if (rule->min > rule->max) {
+    napi_throw_range_error(env, nullptr, "min must not exceed max");
+    return false;
+  }
+  rule->mask = action == "mask";
+  return true;
+}
+
+// setSanityFilter({ [channel]: { min, max, maxRate, action, maxHoldTicks } } | null)
+napi_value SetSanityFilter(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+  std::vector<SanityRule> rules;
+  if (argc >= 1 && !IsNullish(env, args[0])) {
+    napi_valuetype type = napi_undefined;
+    NAPI_CALL(env, napi_typeof(env, args[0], &type));
+    if (type != napi_object) {
+      napi_throw_type_error(env, nullptr, "setSanityFilter expects ({ [channel]: rule } | null)");
+      return nullptr;
+    }
+    napi_value names = nullptr;
+    uint32_t length = 0;
+    NAPI_CALL(env, napi_get_property_names(env, args[0], &names));
+    NAPI_CALL(env, napi_get_array_length(env, names, &length));
+    for (uint32_t i = 0; i < length; ++i) {
+      napi_value key = nullptr;
+      napi_value options = nullptr;
+      SanityRule rule;
+      NAPI_CALL(env, napi_get_element(env, names, i, &key));
+      NAPI_CALL(env, napi_get_property(env, args[0], key, &options));
+      if (!GetString(env, key, &rule.name) || !ParseSanityRule(env, options, &rule)) {
+        return nullptr;
+      }
+      rules.push_back(std::move(rule));
+    }
+  }
+  SanityFilter::Instance().Configure(std::move(rules));
+  return GetUndefined(env);
+}
+
+napi_value GetSanityFilterStats(napi_env env, napi_callback_info info)
+{
+  (void)info;
+  const SanityFilter& filter = SanityFilter::Instance();
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  for (size_t i = 0; i < filter.channel_count(); ++i) {
+    const SanityCounts& counts = filter.counts(i);
+    napi_value item = nullptr;
+    NAPI_CALL(env, napi_create_object(env, &item));
+    NAPI_CALL(env, napi_set_named_property(env, item, "nonFinite",
+                                           MakeDouble(env, static_cast<double>(counts.non_finite))));
+    NAPI_CALL(env, napi_set_named_property(env, item, "outOfRange",
+                                           MakeDouble(env, static_cast<double>(counts.out_of_range))));
+    NAPI_CALL(env, napi_set_named_property(env, item, "spikes", MakeDouble(env, static_cast<double>(counts.spikes))));
+    NAPI_CALL(env, napi_set_named_property(env, result, filter.channel_name(i).c_str(), item));
+  }
+  return result;
+}
+
+}  // namespace
+
+napi_value RegisterSanityFilter(napi_env env, napi_value exports)
+{
+  napi_value set_fn = nullptr;
+  napi_value stats_fn = nullptr;
+  NAPI_CALL(env, napi_create_function(env, "setSanityFilter", NAPI_AUTO_LENGTH, SetSanityFilter, nullptr, &set_fn));
+  NAPI_CALL(env, napi_create_function(env, "getSanityFilterStats", NAPI_AUTO_LENGTH, GetSanityFilterStats, nullptr,
+                                      &stats_fn));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "setSanityFilter", set_fn));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "getSanityFilterStats", stats_fn));
+  return exports;
+}
+
+}  // namespace irsdk_node
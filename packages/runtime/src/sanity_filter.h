@@ -0,0 +1,92 @@
+// Optional per-tick filter over live telemetry that clamps or masks
+// non-finite values, out-of-range values and implausible jumps before native
+// consumers and JS read them.
+
+#ifndef IRSDK_NODE_SANITY_FILTER_H_
+#define IRSDK_NODE_SANITY_FILTER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "channel_spec.h"
+#include "telemetry_source.h"
+
+namespace irsdk_node {
+
+struct SanityRule {
+  std::string name;
+  double min;
+  double max;
+  double max_rate = 0.0;  // Largest plausible change per second; 0 disables.
+  bool mask = false;      // Replace bad values with NaN instead of holding/clamping.
+  int max_hold = 5;       // A jump that persists this many ticks is accepted.
+};
+
+struct SanityCounts {
+  uint64_t non_finite = 0;
+  uint64_t out_of_range = 0;
+  uint64_t spikes = 0;
+};
+
+class SanityFilter {
+ public:
+  static SanityFilter& Instance();
+
+  // Replace the rules and reset the counts; no rules disables the filter.
+  void Configure(std::vector<SanityRule> rules);
+  bool enabled() const { return !channels_.empty(); }
+
+  // Filter the configured channels of a new sample.
+  void Apply(const TelemetrySource& source, double session_time);
+
+  // Filtered value of a variable of the last sample; false when the
+  // variable is not filtered.
+  bool Lookup(int idx, int entry, double* value) const;
+
+  size_t channel_count() const { return channels_.size(); }
+  const std::string& channel_name(size_t i) const { return channels_[i].rule.name; }
+  const SanityCounts& counts(size_t i) const { return channels_[i].counts; }
+
+ private:
+  struct Channel {
+    SanityRule rule;
+    ChannelKind kind;
+    VarHandle var;
+    bool active = false;            // Resolved to a float or double variable.
+    std::vector<double> value;      // Filtered value per entry.
+    std::vector<double> good;       // Last accepted value, NaN when none.
+    std::vector<double> good_time;  // SessionTime it was accepted at.
+    std::vector<int> held;          // Consecutive rejected jumps.
+    SanityCounts counts;
+  };
+
+  void FilterEntry(Channel* channel, size_t entry, double raw, double session_time);
+
+  std::vector<Channel> channels_;
+  double prev_time_ = 0.0;
+};
+
+// Live source with the filtered values of the last Apply() in place.
+class SanitizedSource : public TelemetrySource {
+ public:
+  SanitizedSource(const TelemetrySource& base, const SanityFilter& filter) : base_(base), filter_(filter) {}
+
+  int FindVar(const char* name) const override { return base_.FindVar(name); }
+  int VarType(int idx) const override { return base_.VarType(idx); }
+  int VarCount(int idx) const override { return base_.VarCount(idx); }
+  double GetDouble(int idx, int entry) const override
+  {
+    double value = 0.0;
+    return filter_.Lookup(idx, entry, &value) ? value : base_.GetDouble(idx, entry);
+  }
+  int LayoutId() const override { return base_.LayoutId(); }
+
+ private:
+  const TelemetrySource& base_;
+  const SanityFilter& filter_;
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_SANITY_FILTER_H_
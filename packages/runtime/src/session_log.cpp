@@ -0,0 +1,589 @@
+// Change log of the session info YAML.
+
+#include "session_log.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include "bindings.h"
+#include "byte_io.h"
+#include "file_util.h"
+#include "napi_util.h"
+
+namespace irsdk_node {
+
+namespace {
+
+constexpr char kMagic[8] = {'I', 'R', 'S', 'D', 'K', 'S', 'E', 'S'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderBytes = sizeof(kMagic) + sizeof(uint32_t);
+enum RecordKind : uint8_t { kRecordFull = 1, kRecordDelta = 2 };
+
+// Every revision past this many deltas is stored in full, bounding the work
+// of rebuilding any one of them.
+constexpr size_t kKeyframeInterval = 32;
+
+// Delta ops, in the low bit of the varint that also holds their line count.
+// A copy names its first line in the previous revision; an insert is
+// followed by its lines, each length-prefixed.
+constexpr uint64_t kOpCopy = 0;
+constexpr uint64_t kOpInsert = 1;
+
+// Repeated lines, common in driver and result lists, are only matched at
+// this many of their positions around where the previous match ended.
+constexpr size_t kMaxCandidates = 16;
+
+using Lines = std::vector<std::string_view>;
+
+std::string EncodeRevision(const SessionRevision& revision, const std::string& data)
+{
+  std::string out;
+  Put<int32_t>(&out, revision.update);
+  Put<double>(&out, revision.session_time);
+  Put<uint8_t>(&out, revision.keyframe ? kRecordFull : kRecordDelta);
+  out.append(data);
+  return out;
+}
+
+// Split on '\n', keeping a trailing empty line so joining restores the text.
+Lines SplitLines(std::string_view text)
+{
+  Lines lines;
+  size_t start = 0;
+  for (;;) {
+    size_t end = text.find('\n', start);
+    if (end == std::string_view::npos) {
+      lines.push_back(text.substr(start));
+      return lines;
+    }
+    lines.push_back(text.substr(start, end - start));
+    start = end + 1;
+  }
+}
+
+void FlushInsert(std::string* out, Lines* pending)
+{
+  if (pending->empty()) {
+    return;
+  }
+  PutVarint(out, (static_cast<uint64_t>(pending->size()) << 1) | kOpInsert);
+  for (std::string_view line : *pending) {
+    PutVarint(out, line.size());
+    out->append(line.data(), line.size());
+  }
+  pending->clear();
+}
+
+// Greedy line diff: continue where the last copied run ended when the line
+// matches there, otherwise take the longest run among nearby occurrences.
+std::string EncodeDelta(const Lines& prev, const Lines& next)
+{
+  std::unordered_map<std::string_view, std::vector<uint32_t>> positions;
+  for (size_t i = 0; i < prev.size(); ++i) {
+    positions[prev[i]].push_back(static_cast<uint32_t>(i));
+  }
+  auto run_length = [&](size_t from, size_t at) {
+    size_t length = 0;
+    while (from + length < prev.size() && at + length < next.size() && prev[from + length] == next[at + length]) {
+      ++length;
+    }
+    return length;
+  };
+
+  std::string out;
+  Lines pending;
+  size_t expected = 0;
+  size_t j = 0;
+  while (j < next.size()) {
+    size_t best_start = expected;
+    size_t best_length = expected < prev.size() ? run_length(expected, j) : 0;
+    auto found = positions.find(next[j]);
+    if (best_length == 0 && found != positions.end()) {
+      const std::vector<uint32_t>& list = found->second;
+      size_t middle = std::lower_bound(list.begin(), list.end(), expected) - list.begin();
+      size_t first = middle - std::min(middle, kMaxCandidates / 2);
+      size_t last = std::min(list.size(), first + kMaxCandidates);
+      for (size_t k = first; k < last; ++k) {
+        size_t length = run_length(list[k], j);
+        if (length > best_length) {
+          best_start = list[k];
+          best_length = length;
+        }
+      }
+    }
+    if (best_length == 0) {
+      pending.push_back(next[j++]);
+      continue;
+    }
+    FlushInsert(&out, &pending);
+    PutVarint(&out, (static_cast<uint64_t>(best_length) << 1) | kOpCopy);
+    PutVarint(&out, best_start);
+    j += best_length;
+    expected = best_start + best_length;
+  }
+  FlushInsert(&out, &pending);
+  return out;
+}
+
+bool ApplyDelta(const Lines& prev, const std::string& delta, std::string* out)
+{
+  Cursor cursor(delta.data(), delta.size());
+  std::string text;
+  bool first = true;
+  auto append = [&](std::string_view line) {
+    if (!first) {
+      text.push_back('\n');
+    }
+    text.append(line.data(), line.size());
+    first = false;
+  };
+  while (!cursor.done()) {
+    uint64_t op = 0;
+    if (!cursor.GetVarint(&op)) {
+      return false;
+    }
+    uint64_t count = op >> 1;
+    if ((op & 1) == kOpCopy) {
+      uint64_t start = 0;
+      if (!cursor.GetVarint(&start) || start > prev.size() || count > prev.size() - start) {
+        return false;
+      }
+      for (uint64_t i = start; i < start + count; ++i) {
+        append(prev[i]);
+      }
+    } else {
+      // Every inserted line takes at least its length byte.
+      if (count > cursor.left()) {
+        return false;
+      }
+      for (uint64_t i = 0; i < count; ++i) {
+        uint64_t length = 0;
+        std::string_view line;
+        if (!cursor.GetVarint(&length) || !cursor.GetView(length, &line)) {
+          return false;
+        }
+        append(line);
+      }
+    }
+  }
+  // Splitting never yields zero lines, so neither may a revision.
+  if (first) {
+    return false;
+  }
+  *out = std::move(text);
+  return true;
+}
+
+}  // namespace
+
+bool SessionLog::Open(const std::string& path, std::string* error)
+{
+  path_ = path;
+  revisions_.clear();
+  data_.clear();
+  latest_.clear();
+  since_keyframe_ = 0;
+  text_bytes_ = 0;
+  needs_rewrite_ = false;
+  cached_ = false;
+  writer_.reset();
+  if (path.empty()) {
+    return true;
+  }
+  writer_.reset(new BackgroundWriter(path));
+
+  std::FILE* file = OpenFile(path, "rb");
+  if (!file) {
+    // Created along with the first revision.
+    needs_rewrite_ = true;
+    return true;
+  }
+  std::string data;
+  bool read = ReadWholeFile(file, &data);
+  std::fclose(file);
+
+  uint32_t version = 0;
+  if (read && data.size() >= kHeaderBytes) {
+    version = GetAt<uint32_t>(data.data() + sizeof(kMagic));
+  }
+  if (!read || data.size() < kHeaderBytes || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0 ||
+      version != kVersion) {
+    *error = "invalid session log: " + path;
+    return false;
+  }
+
+  size_t pos = kHeaderBytes;
+  const char* payload = nullptr;
+  uint32_t length = 0;
+  while (NextFramedRecord(data, &pos, &payload, &length)) {
+    Cursor cursor(payload, length);
+    SessionRevision revision;
+    int32_t update = 0;
+    uint8_t kind = 0;
+    bool ok = cursor.Get(&update) && cursor.Get(&revision.session_time) && cursor.Get(&kind) &&
+              (kind == kRecordFull || (kind == kRecordDelta && !revisions_.empty()));
+    revision.update = update;
+    revision.keyframe = kind == kRecordFull;
+    std::string body;
+    std::string text;
+    if (ok) {
+      size_t header = length - cursor.left();
+      body.assign(payload + header, cursor.left());
+      if (revision.keyframe) {
+        text = body;
+      } else {
+        ok = ApplyDelta(SplitLines(latest_), body, &text);
+      }
+    }
+    if (!ok) {
+      *error = "invalid session log: " + path;
+      return false;
+    }
+    since_keyframe_ = revision.keyframe ? 0 : since_keyframe_ + 1;
+    text_bytes_ += static_cast<int64_t>(text.size());
+    latest_ = std::move(text);
+    revisions_.push_back(revision);
+    data_.push_back(std::move(body));
+  }
+  if (pos == data.size()) {
+    return true;
+  }
+  // A record cut short by a crash is dropped by rewriting what was intact.
+  needs_rewrite_ = true;
+  Queue();
+  return writer_->Wait(error);
+}
+
+void SessionLog::OnTick(const TelemetrySource& source, const TickStamp& stamp)
+{
+  (void)source;
+  const TickHub& hub = TickHub::Instance();
+  if (hub.session_version() == seen_version_) {
+    return;
+  }
+  seen_version_ = hub.session_version();
+  if (hub.session_update() < 0) {
+    return;
+  }
+  Record(hub.session_info(), hub.session_update(), stamp.session_time);
+}
+
+bool SessionLog::Record(const std::string& yaml, int update, double session_time)
+{
+  if (!revisions_.empty() && yaml == latest_) {
+    return false;
+  }
+
+  std::string data;
+  bool keyframe = revisions_.empty() || since_keyframe_ + 1 >= kKeyframeInterval;
+  if (!keyframe) {
+    data = EncodeDelta(SplitLines(latest_), SplitLines(yaml));
+    keyframe = data.size() >= yaml.size();
+  }
+  if (keyframe) {
+    data = yaml;
+  }
+  since_keyframe_ = keyframe ? 0 : since_keyframe_ + 1;
+  text_bytes_ += static_cast<int64_t>(yaml.size());
+  latest_ = yaml;
+
+  SessionRevision revision;
+  revision.update = update;
+  revision.session_time = session_time;
+  revision.keyframe = keyframe;
+  revisions_.push_back(revision);
+  data_.push_back(std::move(data));
+  if (writer_) {
+    Queue();
+  }
+  return true;
+}
+
+bool SessionLog::Flush(std::string* error)
+{
+  if (!writer_) {
+    return true;
+  }
+  if (writer_->failed()) {
+    Queue();
+  }
+  return writer_->Wait(error);
+}
+
+void SessionLog::Queue()
+{
+  // Whatever reached the disk may end in a torn record; start over.
+  if (!needs_rewrite_ && !writer_->failed()) {
+    writer_->Append(FrameRecord(EncodeRevision(revisions_.back(), data_.back())));
+    return;
+  }
+  std::string data(kMagic, sizeof(kMagic));
+  Put<uint32_t>(&data, kVersion);
+  for (size_t i = 0; i < revisions_.size(); ++i) {
+    data.append(FrameRecord(EncodeRevision(revisions_[i], data_[i])));
+  }
+  writer_->Replace(std::move(data));
+  needs_rewrite_ = false;
+}
+
+std::string SessionLog::write_error() const
+{
+  return writer_ ? writer_->last_error() : std::string();
+}
+
+SessionLogStats SessionLog::stats() const
+{
+  SessionLogStats stats;
+  stats.revisions = revisions_.size();
+  for (size_t i = 0; i < revisions_.size(); ++i) {
+    stats.keyframes += revisions_[i].keyframe ? 1 : 0;
+    stats.bytes += static_cast<int64_t>(data_[i].size());
+  }
+  stats.text_bytes = text_bytes_;
+  return stats;
+}
+
+int SessionLog::Find(double session_time) const
+{
+  for (size_t i = revisions_.size(); i-- > 0;) {
+    if (revisions_[i].session_time <= session_time) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+bool SessionLog::Text(size_t index, std::string* out) const
+{
+  if (index >= revisions_.size()) {
+    return false;
+  }
+  size_t keyframe = index;
+  while (!revisions_[keyframe].keyframe) {
+    --keyframe;
+  }
+  size_t from = keyframe;
+  std::string text;
+  if (cached_ && cached_index_ >= keyframe && cached_index_ <= index) {
+    from = cached_index_;
+    text = cached_text_;
+  } else {
+    text = data_[keyframe];
+  }
+  for (size_t i = from + 1; i <= index; ++i) {
+    std::string next;
+    if (!ApplyDelta(SplitLines(text), data_[i], &next)) {
+      return false;
+    }
+    text = std::move(next);
+  }
+  cached_index_ = index;
+  cached_text_ = text;
+  cached_ = true;
+  *out = std::move(text);
+  return true;
+}
+
+namespace {
+
+// JS wrapper that keeps a live log attached to the tick stream until close()
+// or garbage collection.
+struct SessionLogHandle {
+  std::unique_ptr<SessionLog> log;
+  bool attached = false;
+
+  void Detach()
+  {
+    if (attached) {
+      TickHub::Instance().Remove(log.get());
+      attached = false;
+    }
+  }
+};
+
+void FinalizeSessionLog(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  SessionLogHandle* handle = static_cast<SessionLogHandle*>(data);
+  handle->Detach();
+  delete handle;
+}
+
+napi_value MakeRevision(napi_env env, const SessionRevision& revision)
+{
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_set_named_property(env, result, "update", MakeInt(env, revision.update)));
+  NAPI_CALL(env, napi_set_named_property(env, result, "sessionTime", MakeDouble(env, revision.session_time)));
+  return result;
+}
+
+napi_value SessionLogConstructor(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value self = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+  napi_value options = argc >= 1 ? args[0] : nullptr;
+  std::string path;
+  bool live = true;
+  if (!GetOptionalString(env, options, "path", &path) || !GetOptionalBool(env, options, "live", &live)) {
+    return nullptr;
+  }
+
+  std::unique_ptr<SessionLogHandle> handle(new SessionLogHandle());
+  handle->log.reset(new SessionLog());
+  std::string error;
+  if (!handle->log->Open(path, &error)) {
+    napi_throw_error(env, nullptr, error.c_str());
+    return nullptr;
+  }
+  napi_status status = napi_wrap(env, self, handle.get(), FinalizeSessionLog, nullptr, nullptr);
+  if (status != napi_ok) {
+    CheckNapi(env, status);
+    return nullptr;
+  }
+  SessionLogHandle* wrapped = handle.release();
+  if (live) {
+    TickHub::Instance().Add(wrapped->log.get());
+    wrapped->attached = true;
+  }
+  return self;
+}
+
+napi_value SessionLogRecord(napi_env env, napi_callback_info info)
+{
+  size_t argc = 3;
+  napi_value args[3];
+  SessionLogHandle* handle = UnwrapThis<SessionLogHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  const char* usage = "record expects (yaml, sessionTime[, update])";
+  std::string yaml;
+  double session_time = 0.0;
+  if (argc < 2 || !GetString(env, args[0], &yaml) || napi_get_value_double(env, args[1], &session_time) != napi_ok) {
+    napi_throw_type_error(env, nullptr, usage);
+    return nullptr;
+  }
+  const std::vector<SessionRevision>& revisions = handle->log->revisions();
+  int update = revisions.empty() ? 0 : revisions.back().update + 1;
+  if (argc >= 3 && !IsNullish(env, args[2]) && napi_get_value_int32(env, args[2], &update) != napi_ok) {
+    napi_throw_type_error(env, nullptr, usage);
+    return nullptr;
+  }
+
+  return MakeBool(env, handle->log->Record(yaml, update, session_time));
+}
+
+napi_value SessionLogGetAt(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  SessionLogHandle* handle = UnwrapThis<SessionLogHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  double session_time = 0.0;
+  if (argc < 1 || napi_get_value_double(env, args[0], &session_time) != napi_ok) {
+    napi_throw_type_error(env, nullptr, "getAt expects (sessionTime)");
+    return nullptr;
+  }
+
+  int index = handle->log->Find(session_time);
+  if (index < 0) {
+    return GetNull(env);
+  }
+  std::string yaml;
+  if (!handle->log->Text(static_cast<size_t>(index), &yaml)) {
+    napi_throw_error(env, nullptr, "session log revision is corrupt");
+    return nullptr;
+  }
+  napi_value result = MakeRevision(env, handle->log->revisions()[static_cast<size_t>(index)]);
+  if (!result) {
+    return nullptr;
+  }
+  NAPI_CALL(env, napi_set_named_property(env, result, "yaml", MakeString(env, yaml)));
+  return result;
+}
+
+napi_value SessionLogGetRevisions(napi_env env, napi_callback_info info)
+{
+  SessionLogHandle* handle = UnwrapThis<SessionLogHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  const std::vector<SessionRevision>& revisions = handle->log->revisions();
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_array_with_length(env, revisions.size(), &result));
+  for (size_t i = 0; i < revisions.size(); ++i) {
+    napi_value item = MakeRevision(env, revisions[i]);
+    if (!item) {
+      return nullptr;
+    }
+    NAPI_CALL(env, napi_set_element(env, result, static_cast<uint32_t>(i), item));
+  }
+  return result;
+}
+
+napi_value SessionLogGetStats(napi_env env, napi_callback_info info)
+{
+  SessionLogHandle* handle = UnwrapThis<SessionLogHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  SessionLogStats stats = handle->log->stats();
+  std::string write_error = handle->log->write_error();
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_set_named_property(env, result, "revisions", MakeDouble(env, static_cast<double>(stats.revisions))));
+  NAPI_CALL(env, napi_set_named_property(env, result, "keyframes", MakeDouble(env, static_cast<double>(stats.keyframes))));
+  NAPI_CALL(env, napi_set_named_property(env, result, "bytes", MakeDouble(env, static_cast<double>(stats.bytes))));
+  NAPI_CALL(env, napi_set_named_property(env, result, "textBytes", MakeDouble(env, static_cast<double>(stats.text_bytes))));
+  NAPI_CALL(env, napi_set_named_property(env, result, "writeError",
+                                         write_error.empty() ? GetNull(env) : MakeString(env, write_error)));
+  return result;
+}
+
+napi_value SessionLogClose(napi_env env, napi_callback_info info)
+{
+  SessionLogHandle* handle = UnwrapThis<SessionLogHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  handle->Detach();
+  std::string error;
+  if (!handle->log->Flush(&error)) {
+    napi_throw_error(env, nullptr, error.c_str());
+    return nullptr;
+  }
+  return GetUndefined(env);
+}
+
+}  // namespace
+
+napi_value RegisterSessionLog(napi_env env, napi_value exports)
+{
+  napi_property_descriptor methods[] = {
+    {"record", nullptr, SessionLogRecord, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getAt", nullptr, SessionLogGetAt, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getRevisions", nullptr, SessionLogGetRevisions, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getStats", nullptr, SessionLogGetStats, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"close", nullptr, SessionLogClose, nullptr, nullptr, nullptr, napi_default, nullptr}
+  };
+
+  napi_value constructor = nullptr;
+  NAPI_CALL(env, napi_define_class(env, "SessionLog", NAPI_AUTO_LENGTH, SessionLogConstructor, nullptr,
+                                   sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "SessionLog", constructor));
+  return exports;
+}
+
+}  // namespace irsdk_node
@@ -0,0 +1,92 @@
+// Change log of the session info YAML: every revision with the SessionTime
+// and update count it arrived at, stored as line deltas against the previous
+// revision, so the session state at any point of a recording can be
+// rebuilt.
+//
+// The log can keep a journal next to a recording. Each revision is one
+// checksummed record, written by a writer thread as it arrives; a record
+// torn by a crash fails its checksum and is dropped on the next load.
+
+#ifndef IRSDK_NODE_SESSION_LOG_H_
+#define IRSDK_NODE_SESSION_LOG_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "background_writer.h"
+#include "telemetry_source.h"
+#include "tick_hub.h"
+
+namespace irsdk_node {
+
+struct SessionRevision {
+  int update = 0;  // Session info update count from the sim.
+  double session_time = 0.0;
+  bool keyframe = false;  // Stored in full rather than as a delta.
+};
+
+struct SessionLogStats {
+  size_t revisions = 0;
+  size_t keyframes = 0;
+  int64_t bytes = 0;       // Stored size of every revision.
+  int64_t text_bytes = 0;  // Size of the revisions in full.
+};
+
+class SessionLog : public TickListener {
+ public:
+  // Load the journal at path, creating it with the first revision. Without
+  // a path the log only lives in memory.
+  bool Open(const std::string& path, std::string* error);
+
+  // Record the hub's session info whenever its update count changes.
+  void OnTick(const TelemetrySource& source, const TickStamp& stamp) override;
+
+  // Append a revision unless the text equals the latest one, and return
+  // whether it did. The journal record is handed to the writer thread; the
+  // revision is kept even when it cannot be written.
+  bool Record(const std::string& yaml, int update, double session_time);
+
+  // Wait until every revision is in the journal. After a failed write the
+  // whole journal is rewritten.
+  bool Flush(std::string* error);
+
+  const std::vector<SessionRevision>& revisions() const { return revisions_; }
+  SessionLogStats stats() const;
+
+  // The last error writing the journal.
+  std::string write_error() const;
+
+  // Index of the newest revision recorded at or before session_time, or -1.
+  // Searching newest first keeps lookups meaningful after SessionTime jumps
+  // back, e.g. on a replay.
+  int Find(double session_time) const;
+
+  // Rebuild the text of a revision from its keyframe and the deltas after it.
+  bool Text(size_t index, std::string* out) const;
+
+ private:
+  // Queue the latest revision, or the whole journal after a failed write.
+  void Queue();
+
+  std::string path_;
+  std::vector<SessionRevision> revisions_;
+  std::vector<std::string> data_;  // Full text or delta of each revision.
+  std::string latest_;
+  size_t since_keyframe_ = 0;
+  int64_t text_bytes_ = 0;
+  uint64_t seen_version_ = 0;  // Of the hub's session info.
+  bool needs_rewrite_ = false;
+  std::unique_ptr<BackgroundWriter> writer_;
+
+  // The last rebuilt revision, so scrubbing forward only applies new deltas.
+  mutable size_t cached_index_ = 0;
+  mutable std::string cached_text_;
+  mutable bool cached_ = false;
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_SESSION_LOG_H_
@@ -0,0 +1,199 @@
+// Minimal reader for the session info YAML the sim writes.
+
+#include "session_yaml.h"
+
+#include <cstddef>
+
+namespace irsdk_node {
+
+namespace {
+
+// The sim nests a few levels deep; anything deeper comes from a corrupt file
+// and is skipped rather than parsed recursively.
+constexpr int kMaxDepth = 32;
+
+struct YamlLine {
+  int indent;  // Column of the key.
+  bool item;   // Starts a list entry ("- key: value").
+  std::string key;
+  std::string value;
+};
+
+std::string Trim(const std::string& text, size_t begin, size_t end)
+{
+  while (begin < end && (text[begin] == ' ' || text[begin] == '\t')) {
+    ++begin;
+  }
+  while (end > begin && (text[end - 1] == ' ' || text[end - 1] == '\t' || text[end - 1] == '\r')) {
+    --end;
+  }
+  if (end - begin >= 2 && text[begin] == '"' && text[end - 1] == '"') {
+    ++begin;
+    --end;
+  }
+  return text.substr(begin, end - begin);
+}
+
+std::vector<YamlLine> SplitLines(const std::string& text)
+{
+  std::vector<YamlLine> lines;
+  size_t pos = 0;
+  while (pos < text.size()) {
+    size_t end = text.find('\n', pos);
+    if (end == std::string::npos) {
+      end = text.size();
+    }
+    size_t begin = pos;
+    pos = end + 1;
+
+    size_t start = begin;
+    while (start < end && text[start] == ' ') {
+      ++start;
+    }
+    if (start >= end || text[start] == '\r' || text.compare(start, 3, "---") == 0 ||
+        text.compare(start, 3, "...") == 0) {
+      continue;
+    }
+    YamlLine line;
+    line.item = text[start] == '-' && start + 1 < end && text[start + 1] == ' ';
+    if (line.item) {
+      start += 2;
+    }
+    line.indent = static_cast<int>(start - begin);
+    // Search this line only; searching on through the rest of the text would
+    // make long runs of lines without ": " quadratic.
+    size_t colon = start;
+    while (colon + 1 < end && !(text[colon] == ':' && text[colon + 1] == ' ')) {
+      ++colon;
+    }
+    if (colon + 1 >= end) {
+      // "Key:" opening a block, or a bare list scalar.
+      size_t last = end;
+      while (last > start && (text[last - 1] == ' ' || text[last - 1] == '\r')) {
+        --last;
+      }
+      if (last > start && text[last - 1] == ':') {
+        line.key = Trim(text, start, last - 1);
+      } else {
+        line.value = Trim(text, start, last);
+      }
+    } else {
+      line.key = Trim(text, start, colon);
+      line.value = Trim(text, colon + 2, end);
+    }
+    lines.push_back(std::move(line));
+  }
+  return lines;
+}
+
+void ParseMap(std::vector<YamlLine>& lines, size_t* i, int indent, int depth, YamlNode* out);
+
+void ParseList(std::vector<YamlLine>& lines, size_t* i, int indent, int depth, YamlNode* out)
+{
+  while (*i < lines.size() && lines[*i].item && lines[*i].indent == indent) {
+    YamlNode item;
+    if (lines[*i].key.empty()) {
+      item.value = lines[*i].value;
+      ++*i;
+    } else {
+      // The rest of the entry continues at the key's column.
+      lines[*i].item = false;
+      ParseMap(lines, i, indent, depth, &item);
+    }
+    out->items.push_back(std::move(item));
+  }
+}
+
+void ParseMap(std::vector<YamlLine>& lines, size_t* i, int indent, int depth, YamlNode* out)
+{
+  while (*i < lines.size() && !lines[*i].item && lines[*i].indent == indent) {
+    const YamlLine& line = lines[*i];
+    ++*i;
+    YamlNode child;
+    child.value = line.value;
+    if (line.value.empty() && *i < lines.size()) {
+      const YamlLine& next = lines[*i];
+      if (next.indent > indent && depth >= kMaxDepth) {
+        while (*i < lines.size() && lines[*i].indent > indent) {
+          ++*i;
+        }
+      } else if (next.item && next.indent > indent) {
+        ParseList(lines, i, next.indent, depth + 1, &child);
+      } else if (!next.item && next.indent > indent) {
+        ParseMap(lines, i, next.indent, depth + 1, &child);
+      }
+    }
+    out->keys.push_back(line.key);
+    out->children.push_back(std::move(child));
+  }
+}
+
+}  // namespace
+
+const YamlNode* YamlNode::Get(const std::string& key) const
+{
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (keys[i] == key) {
+      return &children[i];
+    }
+  }
+  return nullptr;
+}
+
+YamlNode ParseSessionYaml(const std::string& text)
+{
+  std::vector<YamlLine> lines = SplitLines(text);
+  YamlNode root;
+  size_t i = 0;
+  while (i < lines.size()) {
+    size_t before = i;
+    ParseMap(lines, &i, lines[i].indent, 0, &root);
+    if (i == before) {
+      ++i;  // A stray list entry at the top level.
+    }
+  }
+  return root;
+}
+
+const YamlNode* FindYaml(const YamlNode& root, const std::string& path)
+{
+  const YamlNode* node = &root;
+  size_t pos = 0;
+  while (node && pos < path.size()) {
+    size_t colon = path.find(':', pos);
+    if (colon == std::string::npos) {
+      colon = path.size();
+    }
+    std::string key = path.substr(pos, colon - pos);
+    pos = colon + 1;
+    if (pos < path.size() && path[pos] == '{') {
+      // "Key:{value}" selects the list entry whose Key equals value.
+      size_t close = path.find('}', pos);
+      if (close == std::string::npos) {
+        return nullptr;
+      }
+      std::string wanted = path.substr(pos + 1, close - pos - 1);
+      pos = close + 1;
+      const YamlNode* match = nullptr;
+      for (const YamlNode& item : node->items) {
+        const YamlNode* value = item.Get(key);
+        if (value && value->value == wanted) {
+          match = &item;
+          break;
+        }
+      }
+      node = match;
+    } else if (!key.empty()) {
+      node = node->Get(key);
+    }
+  }
+  return node;
+}
+
+std::string YamlString(const YamlNode& root, const std::string& path)
+{
+  const YamlNode* node = FindYaml(root, path);
+  return node ? node->value : std::string();
+}
+
+}  // namespace irsdk_node
@@ -0,0 +1,33 @@
+// Minimal reader for the session info YAML the sim writes: nested maps, lists
+// of maps and scalar values, looked up with the SDK's path syntax so it works
+// without the SDK's parser on every platform.
+
+#ifndef IRSDK_NODE_SESSION_YAML_H_
+#define IRSDK_NODE_SESSION_YAML_H_
+
+#include <string>
+#include <vector>
+
+namespace irsdk_node {
+
+struct YamlNode {
+  std::string value;
+  std::vector<std::string> keys;    // Map entries, in file order.
+  std::vector<YamlNode> children;   // Value of each key.
+  std::vector<YamlNode> items;      // List entries.
+
+  const YamlNode* Get(const std::string& key) const;
+};
+
+YamlNode ParseSessionYaml(const std::string& text);
+
+// Look up a path such as "WeekendInfo:TrackName:" or
+// "DriverInfo:Drivers:CarIdx:{3}UserName:"; null when it does not exist.
+const YamlNode* FindYaml(const YamlNode& root, const std::string& path);
+
+// Scalar at a path, or an empty string.
+std::string YamlString(const YamlNode& root, const std::string& path);
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_SESSION_YAML_H_
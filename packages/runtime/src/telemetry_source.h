@@ -0,0 +1,66 @@
+// Read access to one telemetry sample, independent of where it came from.
+
+#ifndef IRSDK_NODE_TELEMETRY_SOURCE_H_
+#define IRSDK_NODE_TELEMETRY_SOURCE_H_
+
+#include <string>
+#include <utility>
+
+namespace irsdk_node {
+
+class TelemetrySource {
+ public:
+  virtual ~TelemetrySource() = default;
+
+  // Index of the named variable, or -1 if the sample does not carry it.
+  virtual int FindVar(const char* name) const = 0;
+  virtual int VarType(int idx) const = 0;
+  virtual int VarCount(int idx) const = 0;
+  virtual double GetDouble(int idx, int entry) const = 0;
+
+  // Identifies the variable layout. Indices returned by FindVar stay valid
+  // for as long as the layout id is unchanged.
+  virtual int LayoutId() const = 0;
+};
+
+// Variable looked up by name that re-resolves its index when the layout of
+// the source changes (reconnects, switching files).
+class VarHandle {
+ public:
+  VarHandle() = default;
+  explicit VarHandle(std::string name) : name_(std::move(name)) {}
+
+  const std::string& name() const { return name_; }
+  bool valid() const { return idx_ >= 0; }
+  int index() const { return idx_; }
+  int count() const { return count_; }
+
+  // Returns true when the variable is available in the source.
+  bool Resolve(const TelemetrySource& source)
+  {
+    int layout = source.LayoutId();
+    if (!resolved_ || layout != layout_id_) {
+      idx_ = source.FindVar(name_.c_str());
+      count_ = idx_ >= 0 ? source.VarCount(idx_) : 0;
+      layout_id_ = layout;
+      resolved_ = true;
+    }
+    return idx_ >= 0;
+  }
+
+  double Get(const TelemetrySource& source, int entry = 0) const
+  {
+    return source.GetDouble(idx_, entry);
+  }
+
+ private:
+  std::string name_;
+  int idx_ = -1;
+  int count_ = 0;
+  int layout_id_ = 0;
+  bool resolved_ = false;
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_TELEMETRY_SOURCE_H_
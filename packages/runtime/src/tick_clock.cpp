@@ -0,0 +1,171 @@
+// Monotonic timestamps for telemetry ticks and a running SessionTime fit.
+
+#include "tick_clock.h"
+
+#include <chrono>
+#include <cmath>
+
+namespace irsdk_node {
+
+double TickClock::NowMonotonicMs()
+{
+  using std::chrono::duration;
+  using std::chrono::steady_clock;
+  return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+double TickClock::NowWallMs()
+{
+  using std::chrono::duration;
+  using std::chrono::system_clock;
+  return duration<double, std::milli>(system_clock::now().time_since_epoch()).count();
+}
+
+void TickClock::RecordSignal(int tick_count)
+{
+  Signal signal{tick_count, NowMonotonicMs(), NowWallMs()};
+  std::lock_guard<std::mutex> lock(signal_mutex_);
+  signals_.push_back(signal);
+  while (signals_.size() > kSignalWindow) {
+    signals_.pop_front();
+  }
+}
+
+TickStamp TickClock::Stamp(int tick_count, double session_time, int session_tick)
+{
+  TickStamp stamp{0.0, 0.0, session_time, session_tick, tick_count, false};
+
+  {
+    // Match the tick to the moment its data-ready signal fired, and discard
+    // signals for ticks that have already been consumed.
+    std::lock_guard<std::mutex> lock(signal_mutex_);
+    for (const Signal& signal : signals_) {
+      if (signal.tick_count == tick_count) {
+        stamp.monotonic_ms = signal.monotonic_ms;
+        stamp.wall_ms = signal.wall_ms;
+        stamp.from_signal = true;
+        break;
+      }
+    }
+    while (!signals_.empty() && signals_.front().tick_count <= tick_count) {
+      signals_.pop_front();
+    }
+  }
+
+  if (!stamp.from_signal) {
+    stamp.monotonic_ms = NowMonotonicMs();
+    stamp.wall_ms = NowWallMs();
+  }
+  wall_offset_ms_ = stamp.wall_ms - stamp.monotonic_ms;
+
+  // SessionTime stands still while the sim is paused; only advancing samples
+  // carry information about the rate.
+  bool advanced = window_.empty() || session_time > window_.back().session_time;
+  if (!window_.empty() && session_time < window_.back().session_time) {
+    window_.clear();
+    fit_.samples = 0;
+    advanced = true;
+  }
+
+  if (advanced) {
+    // Restart the fit when the sample lands far from the prediction, which
+    // happens on session changes, replay seeks, and resuming from pause.
+    if (HasFit()) {
+      double predicted = SessionTimeToMonotonic(session_time);
+      if (std::fabs(predicted - stamp.monotonic_ms) > kDiscontinuityMs) {
+        window_.clear();
+        fit_.samples = 0;
+      }
+    }
+
+    window_.push_back(Sample{session_time, stamp.monotonic_ms});
+    while (window_.size() > kFitWindow) {
+      window_.pop_front();
+    }
+    UpdateFit();
+  }
+
+  last_stamp_ = stamp;
+  has_stamp_ = true;
+  return stamp;
+}
+
+void TickClock::Reset()
+{
+  {
+    std::lock_guard<std::mutex> lock(signal_mutex_);
+    signals_.clear();
+  }
+  window_.clear();
+  fit_ = ClockFit{1000.0, 0.0, 0.0, 0};
+  last_stamp_ = TickStamp{};
+  has_stamp_ = false;
+}
+
+void TickClock::UpdateFit()
+{
+  const size_t n = window_.size();
+  if (n < 2) {
+    fit_.samples = static_cast<int>(n);
+    return;
+  }
+
+  // Center on the first sample to keep the sums well conditioned; monotonic
+  // values are large and SessionTime can run for days.
+  const double s0 = window_.front().session_time;
+  const double m0 = window_.front().monotonic_ms;
+  double mean_s = 0.0;
+  double mean_m = 0.0;
+  for (const Sample& sample : window_) {
+    mean_s += sample.session_time - s0;
+    mean_m += sample.monotonic_ms - m0;
+  }
+  mean_s /= static_cast<double>(n);
+  mean_m /= static_cast<double>(n);
+
+  double sxx = 0.0;
+  double sxy = 0.0;
+  for (const Sample& sample : window_) {
+    double dx = sample.session_time - s0 - mean_s;
+    double dy = sample.monotonic_ms - m0 - mean_m;
+    sxx += dx * dx;
+    sxy += dx * dy;
+  }
+  if (sxx <= 0.0) {
+    return;
+  }
+
+  double slope = sxy / sxx;
+  double intercept = (m0 + mean_m) - slope * (s0 + mean_s);
+
+  double sse = 0.0;
+  for (const Sample& sample : window_) {
+    double residual = sample.monotonic_ms - (intercept + slope * sample.session_time);
+    sse += residual * residual;
+  }
+
+  fit_.slope = slope;
+  fit_.intercept_ms = intercept;
+  fit_.residual_ms = std::sqrt(sse / static_cast<double>(n));
+  fit_.samples = static_cast<int>(n);
+}
+
+double TickClock::SessionTimeToMonotonic(double session_time) const
+{
+  return fit_.intercept_ms + fit_.slope * session_time;
+}
+
+double TickClock::MonotonicToSessionTime(double monotonic_ms) const
+{
+  if (fit_.slope == 0.0) {
+    return 0.0;
+  }
+  return (monotonic_ms - fit_.intercept_ms) / fit_.slope;
+}
+
+double TickClock::SessionTimeToWall(double session_time) const
+{
+  return SessionTimeToMonotonic(session_time) + wall_offset_ms_;
+}
+
+}  // namespace irsdk_node
@@ -0,0 +1,88 @@
+// Monotonic timestamps for telemetry ticks and a running SessionTime fit.
+// Platform independent; the data-ready signal watcher lives in addon.cpp.
+
+#ifndef IRSDK_NODE_TICK_CLOCK_H_
+#define IRSDK_NODE_TICK_CLOCK_H_
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+namespace irsdk_node {
+
+// Timing captured for one delivered telemetry tick.
+struct TickStamp {
+  double monotonic_ms;  // Steady clock when the data-ready signal fired.
+  double wall_ms;       // Wall clock (Unix epoch ms) sampled with monotonic_ms.
+  double session_time;  // SessionTime of the tick in seconds.
+  int session_tick;     // SessionTick of the tick.
+  int tick_count;       // Shared memory buffer tick count.
+  bool from_signal;     // True when monotonic_ms came from the signal watcher.
+};
+
+// Least-squares fit of monotonic_ms = intercept_ms + slope * session_time.
+struct ClockFit {
+  double slope;        // Monotonic milliseconds per session second.
+  double intercept_ms;
+  double residual_ms;  // RMS residual over the fit window.
+  int samples;
+};
+
+class TickClock {
+ public:
+  static double NowMonotonicMs();
+  static double NowWallMs();
+
+  // Record that the data-ready signal fired for the given buffer tick count.
+  // Safe to call from the watcher thread.
+  void RecordSignal(int tick_count);
+
+  // Stamp a tick that was just read. Uses the recorded signal time for
+  // tick_count when available, otherwise the current time.
+  TickStamp Stamp(int tick_count, double session_time, int session_tick);
+
+  // Drop the fit and pending signals, e.g. after a reconnect.
+  void Reset();
+
+  bool HasStamp() const { return has_stamp_; }
+  const TickStamp& LastStamp() const { return last_stamp_; }
+
+  bool HasFit() const { return fit_.samples >= kMinFitSamples; }
+  const ClockFit& Fit() const { return fit_; }
+
+  double SessionTimeToMonotonic(double session_time) const;
+  double MonotonicToSessionTime(double monotonic_ms) const;
+  double SessionTimeToWall(double session_time) const;
+
+ private:
+  struct Sample {
+    double session_time;
+    double monotonic_ms;
+  };
+
+  struct Signal {
+    int tick_count;
+    double monotonic_ms;
+    double wall_ms;
+  };
+
+  static constexpr int kMinFitSamples = 8;
+  static constexpr size_t kFitWindow = 600;
+  static constexpr size_t kSignalWindow = 16;
+  static constexpr double kDiscontinuityMs = 250.0;
+
+  void UpdateFit();
+
+  std::mutex signal_mutex_;
+  std::deque<Signal> signals_;
+
+  std::deque<Sample> window_;
+  ClockFit fit_{1000.0, 0.0, 0.0, 0};
+  TickStamp last_stamp_{};
+  bool has_stamp_ = false;
+  double wall_offset_ms_ = 0.0;
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_TICK_CLOCK_H_
@@ -0,0 +1,45 @@
+// Fan-out of live telemetry ticks to native consumers.
+
+#include "tick_hub.h"
+
+#include <algorithm>
+
+namespace irsdk_node {
+
+TickHub& TickHub::Instance()
+{
+  static TickHub hub;
+  return hub;
+}
+
+void TickHub::Add(TickListener* listener)
+{
+  if (std::find(listeners_.begin(), listeners_.end(), listener) == listeners_.end()) {
+    listeners_.push_back(listener);
+  }
+}
+
+void TickHub::Remove(TickListener* listener)
+{
+  listeners_.erase(std::remove(listeners_.begin(), listeners_.end(), listener), listeners_.end());
+}
+
+void TickHub::DispatchTick(const TelemetrySource& source, const TickStamp& stamp)
+{
+  // Iterate over a copy so listeners may detach themselves while handling a tick.
+  std::vector<TickListener*> listeners = listeners_;
+  for (TickListener* listener : listeners) {
+    if (std::find(listeners_.begin(), listeners_.end(), listener) != listeners_.end()) {
+      listener->OnTick(source, stamp);
+    }
+  }
+}
+
+void TickHub::SetSessionInfo(const char* yaml, int update)
+{
+  session_info_.assign(yaml ? yaml : "");
+  session_update_ = update;
+  ++session_version_;
+}
+
+}  // namespace irsdk_node
@@ -0,0 +1,50 @@
+// Fan-out of live telemetry ticks to native consumers.
+// Dispatch and registration both happen on the JS thread that polls the SDK.
+
+#ifndef IRSDK_NODE_TICK_HUB_H_
+#define IRSDK_NODE_TICK_HUB_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "telemetry_source.h"
+#include "tick_clock.h"
+
+namespace irsdk_node {
+
+class TickListener {
+ public:
+  virtual ~TickListener() = default;
+
+  // Called once for every new telemetry sample.
+  virtual void OnTick(const TelemetrySource& source, const TickStamp& stamp) = 0;
+};
+
+class TickHub {
+ public:
+  static TickHub& Instance();
+
+  void Add(TickListener* listener);
+  void Remove(TickListener* listener);
+
+  void DispatchTick(const TelemetrySource& source, const TickStamp& stamp);
+
+  // Latest session info YAML and its update count, published by the poller
+  // before dispatching the tick it arrived with. The update is -1 until the
+  // first one; the version counts every call, reconnects included.
+  void SetSessionInfo(const char* yaml, int update);
+  const std::string& session_info() const { return session_info_; }
+  int session_update() const { return session_update_; }
+  uint64_t session_version() const { return session_version_; }
+
+ private:
+  std::vector<TickListener*> listeners_;
+  std::string session_info_;
+  int session_update_ = -1;
+  uint64_t session_version_ = 0;
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_TICK_HUB_H_
@@ -0,0 +1,120 @@
+// Cars ordered by track position, kept sorted from tick to tick.
+
+#include "track_order.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#include "irsdk_defines.h"
+
+namespace irsdk_node {
+
+namespace {
+
+constexpr double kRateAlpha = 0.2;
+// LapDistPct steps larger than this between ticks are resets, not driving.
+constexpr double kMaxStep = 0.05;
+
+}  // namespace
+
+void TrackOrder::Update(const double* lap_dist_pct, int count)
+{
+  // Keep the previous order for cars still on track, then add newcomers.
+  std::vector<bool> seen(static_cast<size_t>(count), false);
+  size_t kept = 0;
+  for (int car : order_) {
+    if (car < count && lap_dist_pct[car] >= 0.0) {
+      order_[kept++] = car;
+      seen[static_cast<size_t>(car)] = true;
+    }
+  }
+  order_.resize(kept);
+  for (int car = 0; car < count; ++car) {
+    if (!seen[static_cast<size_t>(car)] && lap_dist_pct[car] >= 0.0) {
+      order_.push_back(car);
+    }
+  }
+
+  // Insertion sort: linear on the nearly sorted order of consecutive ticks.
+  for (size_t i = 1; i < order_.size(); ++i) {
+    int car = order_[i];
+    double key = lap_dist_pct[car];
+    size_t j = i;
+    while (j > 0 && lap_dist_pct[order_[j - 1]] > key) {
+      order_[j] = order_[j - 1];
+      --j;
+    }
+    order_[j] = car;
+  }
+
+  rank_.assign(static_cast<size_t>(count), -1);
+  for (size_t i = 0; i < order_.size(); ++i) {
+    rank_[static_cast<size_t>(order_[i])] = static_cast<int>(i);
+  }
+}
+
+void TrackPositions::Reset()
+{
+  pct_.clear();
+  prev_pct_.clear();
+}
+
+bool TrackPositions::Update(const TelemetrySource& source, double dt_s)
+{
+  if (!pct_var_.Resolve(source)) {
+    return false;
+  }
+  int count = pct_var_.count();
+  size_t n = static_cast<size_t>(count);
+  if (pct_.size() != n) {
+    pct_.assign(n, -1.0);
+    prev_pct_.assign(n, -1.0);
+    distance_.assign(n, 0.0);
+    rate_.assign(n, 0.0);
+    surface_.assign(n, irsdk_NotInWorld);
+  }
+
+  bool has_lap = lap_var_.Resolve(source);
+  bool has_surface = surface_var_.Resolve(source);
+  prev_pct_.swap(pct_);
+  for (int i = 0; i < count; ++i) {
+    size_t car = static_cast<size_t>(i);
+    double pct = pct_var_.Get(source, i);
+    int surface = has_surface ? static_cast<int>(surface_var_.Get(source, i)) : irsdk_OnTrack;
+    if (surface == irsdk_NotInWorld || pct < 0.0) {
+      pct = -1.0;
+      surface = irsdk_NotInWorld;
+    }
+    pct_[car] = pct;
+    surface_[car] = surface;
+    distance_[car] = (has_lap ? lap_var_.Get(source, i) : 0.0) + std::max(0.0, pct);
+
+    double prev = prev_pct_[car];
+    if (pct < 0.0) {
+      rate_[car] = 0.0;
+      continue;
+    }
+    if (prev < 0.0 || dt_s <= 0.0) {
+      continue;
+    }
+    double step = pct - prev;
+    if (step < -0.5) {
+      step += 1.0;
+    }
+    if (step < 0.0 || step > kMaxStep) {
+      continue;
+    }
+    double rate = step / dt_s;
+    rate_[car] = rate_[car] > 0.0 ? rate_[car] + kRateAlpha * (rate - rate_[car]) : rate;
+  }
+  order_.Update(pct_.data(), count);
+  return true;
+}
+
+double TrackPositions::ForwardGap(int from, int to) const
+{
+  double gap = pct_[to] - pct_[from];
+  return gap < 0.0 ? gap + 1.0 : gap;
+}
+
+}  // namespace irsdk_node
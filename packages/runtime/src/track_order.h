@@ -0,0 +1,72 @@
+// Cars ordered by track position, kept sorted from tick to tick, and the
+// per-car track state the ordering is built from.
+
+#ifndef IRSDK_NODE_TRACK_ORDER_H_
+#define IRSDK_NODE_TRACK_ORDER_H_
+
+#include <vector>
+
+#include "telemetry_source.h"
+
+namespace irsdk_node {
+
+class TrackOrder {
+ public:
+  // Re-sort for new LapDistPct values; cars with a negative value (not in
+  // the world) are left out. Starts from the previous order, so the usual
+  // handful of overtakes and line crossings cost close to a linear pass.
+  void Update(const double* lap_dist_pct, int count);
+
+  // Car indices by ascending LapDistPct.
+  const std::vector<int>& order() const { return order_; }
+
+  // Index of a car in order(), or -1 when it is not on track.
+  int RankOf(int car_idx) const
+  {
+    return car_idx >= 0 && car_idx < static_cast<int>(rank_.size()) ? rank_[car_idx] : -1;
+  }
+
+ private:
+  std::vector<int> order_;
+  std::vector<int> rank_;
+};
+
+// CarIdxLapDistPct, CarIdxLapCompleted and CarIdxTrackSurface of every car,
+// with a speed along the lap derived from LapDistPct deltas.
+class TrackPositions {
+ public:
+  // dt_s is the SessionTime step since the previous update; 0 restarts the
+  // speed estimates. Returns false when the source has no CarIdxLapDistPct.
+  bool Update(const TelemetrySource& source, double dt_s);
+  void Reset();
+
+  int count() const { return static_cast<int>(pct_.size()); }
+  // -1 for cars not in the world.
+  double pct(int car) const { return pct_[car]; }
+  double prev_pct(int car) const { return prev_pct_[car]; }
+  // Laps completed plus LapDistPct.
+  double distance(int car) const { return distance_[car]; }
+  // Smoothed LapDistPct per second; 0 until known.
+  double rate(int car) const { return rate_[car]; }
+  int surface(int car) const { return surface_[car]; }
+  const TrackOrder& order() const { return order_; }
+
+  // Forward distance (fraction of a lap, [0, 1)) from one car to another.
+  double ForwardGap(int from, int to) const;
+
+ private:
+  VarHandle pct_var_{"CarIdxLapDistPct"};
+  VarHandle lap_var_{"CarIdxLapCompleted"};
+  VarHandle surface_var_{"CarIdxTrackSurface"};
+
+  std::vector<double> pct_;
+  std::vector<double> prev_pct_;
+  std::vector<double> distance_;
+  std::vector<double> rate_;
+  std::vector<int> surface_;
+  TrackOrder order_;
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_TRACK_ORDER_H_
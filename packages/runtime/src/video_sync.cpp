@@ -0,0 +1,503 @@
+// Timecode sidecar for lining telemetry up with a video capture.
+
+#include "video_sync.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include "bindings.h"
+#include "byte_io.h"
+#include "file_util.h"
+#include "napi_util.h"
+#include "tick_clock.h"
+
+namespace irsdk_node {
+
+namespace {
+
+constexpr char kMagic[8] = {'I', 'R', 'S', 'D', 'K', 'V', 'T', 'C'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderBytes = sizeof(kMagic) + sizeof(uint32_t);
+// Monotonic ms, video frame and SessionTime as doubles, then SessionTick
+// and ReplayFrameNum as int32.
+constexpr size_t kRowBytes = 3 * sizeof(double) + 2 * sizeof(int32_t);
+// Rows are written about once a second at the sim's 60 Hz.
+constexpr size_t kFlushRows = 60;
+
+// A column jumps between two rows when it goes back, or moves this many
+// seconds' worth further than the monotonic clock does at its nominal rate.
+// Pauses, slow motion and fast-forwarded replays stay within it.
+constexpr double kMaxJumpS = 1.0;
+constexpr double kTickRate = 60.0;
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+const char* const kKeyNames[kSyncKeys] = {"monotonicMs", "videoFrame", "sessionTime", "sessionTick", "replayFrame"};
+
+// Integer columns hold -1 when the value is unknown.
+int32_t ToInt32(double value)
+{
+  return std::isfinite(value) && std::fabs(value) <= std::numeric_limits<int32_t>::max()
+             ? static_cast<int32_t>(value)
+             : -1;
+}
+
+}  // namespace
+
+VideoSync::VideoSync(double fps, double start_ms) : fps_(fps), anchor_ms_(start_ms) {}
+
+bool VideoSync::Open(const std::string& path, std::string* error)
+{
+  path_ = path;
+  if (path.empty()) {
+    return true;
+  }
+  writer_.reset(new BackgroundWriter(path));
+
+  std::FILE* file = OpenFile(path, "rb");
+  if (!file) {
+    // Created along with the first rows.
+    needs_rewrite_ = true;
+    return true;
+  }
+  std::string data;
+  bool read = ReadWholeFile(file, &data);
+  std::fclose(file);
+
+  uint32_t version = 0;
+  if (read && data.size() >= kHeaderBytes) {
+    version = GetAt<uint32_t>(data.data() + sizeof(kMagic));
+  }
+  if (!read || data.size() < kHeaderBytes || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0 ||
+      version != kVersion) {
+    *error = "invalid video sync file: " + path;
+    return false;
+  }
+
+  size_t rows = (data.size() - kHeaderBytes) / kRowBytes;
+  Cursor cursor(data.data() + kHeaderBytes, rows * kRowBytes);
+  for (size_t i = 0; i < rows; ++i) {
+    SyncPoint point;
+    int32_t session_tick = 0;
+    int32_t replay_frame = 0;
+    cursor.Get(&point[static_cast<size_t>(SyncKey::kMonotonicMs)]);
+    cursor.Get(&point[static_cast<size_t>(SyncKey::kVideoFrame)]);
+    cursor.Get(&point[static_cast<size_t>(SyncKey::kSessionTime)]);
+    cursor.Get(&session_tick);
+    cursor.Get(&replay_frame);
+    point[static_cast<size_t>(SyncKey::kSessionTick)] = session_tick;
+    point[static_cast<size_t>(SyncKey::kReplayFrame)] = replay_frame;
+    Add(point);
+  }
+  written_ = rows;
+  if (kHeaderBytes + rows * kRowBytes == data.size()) {
+    return true;
+  }
+  // A row cut short by a crash is dropped by rewriting the intact ones.
+  needs_rewrite_ = true;
+  return Flush(error);
+}
+
+void VideoSync::OnTick(const TelemetrySource& source, const TickStamp& stamp)
+{
+  SyncPoint point;
+  point[static_cast<size_t>(SyncKey::kMonotonicMs)] = stamp.monotonic_ms;
+  point[static_cast<size_t>(SyncKey::kVideoFrame)] = VideoFrameAt(stamp.monotonic_ms);
+  point[static_cast<size_t>(SyncKey::kSessionTime)] = stamp.session_time;
+  point[static_cast<size_t>(SyncKey::kSessionTick)] = stamp.session_tick;
+  point[static_cast<size_t>(SyncKey::kReplayFrame)] =
+      replay_frame_.Resolve(source) ? ToInt32(replay_frame_.Get(source)) : -1;
+  Record(point);
+}
+
+void VideoSync::Record(const SyncPoint& point)
+{
+  Add(point);
+  if (writer_ && size() - written_ >= kFlushRows) {
+    Queue();
+  }
+}
+
+void VideoSync::SyncFrame(double frame, double monotonic_ms)
+{
+  anchor_frame_ = frame;
+  anchor_ms_ = monotonic_ms;
+}
+
+double VideoSync::VideoFrameAt(double monotonic_ms) const
+{
+  return anchor_frame_ + (monotonic_ms - anchor_ms_) * fps_ / 1000.0;
+}
+
+void VideoSync::Add(SyncPoint point)
+{
+  size_t video = static_cast<size_t>(SyncKey::kVideoFrame);
+  if (std::isnan(point[video])) {
+    point[video] = VideoFrameAt(point[static_cast<size_t>(SyncKey::kMonotonicMs)]);
+  }
+  // Stored as int32 on disk; keep memory in step with what a reload sees.
+  point[static_cast<size_t>(SyncKey::kSessionTick)] = ToInt32(point[static_cast<size_t>(SyncKey::kSessionTick)]);
+  point[static_cast<size_t>(SyncKey::kReplayFrame)] = ToInt32(point[static_cast<size_t>(SyncKey::kReplayFrame)]);
+
+  size_t row = size();
+  const double rates[kSyncKeys] = {1000.0, fps_, 1.0, kTickRate, kTickRate};
+  double elapsed_s = 0.0;
+  if (row > 0) {
+    elapsed_s = (point[static_cast<size_t>(SyncKey::kMonotonicMs)] -
+                 columns_[static_cast<size_t>(SyncKey::kMonotonicMs)].back()) / 1000.0;
+  }
+  uint8_t jumps = 0;
+  for (size_t key = 0; key < kSyncKeys; ++key) {
+    std::vector<double>& column = columns_[key];
+    // NaN fails the comparison, so it sits in a run of its own.
+    if (row == 0 || !(point[key] >= column.back() &&
+                      point[key] - column.back() <= rates[key] * (std::max(elapsed_s, 0.0) + kMaxJumpS))) {
+      runs_[key].push_back(row);
+      jumps |= static_cast<uint8_t>(1u << key);
+    }
+    column.push_back(point[key]);
+  }
+  jumps_.push_back(jumps);
+}
+
+void VideoSync::EncodeRows(size_t from, std::string* out) const
+{
+  for (size_t row = from; row < size(); ++row) {
+    Put<double>(out, columns_[static_cast<size_t>(SyncKey::kMonotonicMs)][row]);
+    Put<double>(out, columns_[static_cast<size_t>(SyncKey::kVideoFrame)][row]);
+    Put<double>(out, columns_[static_cast<size_t>(SyncKey::kSessionTime)][row]);
+    Put<int32_t>(out, static_cast<int32_t>(columns_[static_cast<size_t>(SyncKey::kSessionTick)][row]));
+    Put<int32_t>(out, static_cast<int32_t>(columns_[static_cast<size_t>(SyncKey::kReplayFrame)][row]));
+  }
+}
+
+bool VideoSync::Flush(std::string* error)
+{
+  if (!writer_) {
+    return true;
+  }
+  Queue();
+  return writer_->Wait(error);
+}
+
+void VideoSync::Queue()
+{
+  // Whatever reached the disk may end in a torn row; start over.
+  if (writer_->failed()) {
+    needs_rewrite_ = true;
+  }
+  std::string data;
+  if (needs_rewrite_) {
+    data.assign(kMagic, sizeof(kMagic));
+    Put<uint32_t>(&data, kVersion);
+    EncodeRows(0, &data);
+    writer_->Replace(std::move(data));
+    needs_rewrite_ = false;
+  } else if (written_ < size()) {
+    EncodeRows(written_, &data);
+    writer_->Append(std::move(data));
+  }
+  written_ = size();
+}
+
+bool VideoSync::Lookup(SyncKey by, double value, SyncPoint* out) const
+{
+  const std::vector<double>& keys = columns_[static_cast<size_t>(by)];
+  const std::vector<size_t>& runs = runs_[static_cast<size_t>(by)];
+  for (size_t run = 0; run < runs.size(); ++run) {
+    size_t begin = runs[run];
+    size_t end = run + 1 < runs.size() ? runs[run + 1] : keys.size();
+    if (!(keys[begin] <= value && value <= keys[end - 1])) {
+      continue;
+    }
+    // Last row at or before the value; the key is non-decreasing in a run.
+    size_t row = std::upper_bound(keys.begin() + begin, keys.begin() + end, value) - keys.begin() - 1;
+    size_t next = std::min(row + 1, end - 1);
+    double fraction = next > row ? (value - keys[row]) / (keys[next] - keys[row]) : 0.0;
+    for (size_t key = 0; key < kSyncKeys; ++key) {
+      double a = columns_[key][row];
+      double b = columns_[key][next];
+      if (next == row || !(jumps_[next] & (1u << key))) {
+        (*out)[key] = a + (b - a) * fraction;
+      } else {
+        (*out)[key] = fraction < 0.5 ? a : b;
+      }
+    }
+    (*out)[static_cast<size_t>(by)] = value;
+    return true;
+  }
+  return false;
+}
+
+namespace {
+
+// JS wrapper that keeps a live sidecar attached to the tick stream until
+// close() or garbage collection.
+struct VideoSyncHandle {
+  std::unique_ptr<VideoSync> sync;
+  bool attached = false;
+
+  void Detach()
+  {
+    if (attached) {
+      TickHub::Instance().Remove(sync.get());
+      attached = false;
+    }
+  }
+};
+
+void FinalizeVideoSync(napi_env env, void* data, void* hint)
+{
+  (void)env;
+  (void)hint;
+  VideoSyncHandle* handle = static_cast<VideoSyncHandle*>(data);
+  handle->Detach();
+  std::string error;
+  handle->sync->Flush(&error);
+  delete handle;
+}
+
+bool ParseSyncKey(napi_env env, napi_value value, SyncKey* out)
+{
+  std::string name;
+  if (GetString(env, value, &name)) {
+    for (size_t key = 0; key < kSyncKeys; ++key) {
+      if (name == kKeyNames[key]) {
+        *out = static_cast<SyncKey>(key);
+        return true;
+      }
+    }
+  }
+  napi_throw_type_error(env, nullptr,
+                        "key must be 'monotonicMs', 'videoFrame', 'sessionTime', 'sessionTick' or 'replayFrame'");
+  return false;
+}
+
+napi_value MakeSyncPoint(napi_env env, const SyncPoint& point)
+{
+  napi_value result = nullptr;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  for (size_t key = 0; key < kSyncKeys; ++key) {
+    NAPI_CALL(env, napi_set_named_property(env, result, kKeyNames[key], MakeDouble(env, point[key])));
+  }
+  return result;
+}
+
+bool FlushOrThrow(napi_env env, VideoSync* sync)
+{
+  std::string error;
+  if (sync->Flush(&error)) {
+    return true;
+  }
+  napi_throw_error(env, nullptr, error.c_str());
+  return false;
+}
+
+napi_value VideoSyncConstructor(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value self = nullptr;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+  napi_value options = argc >= 1 ? args[0] : nullptr;
+  std::string path;
+  double fps = 60.0;
+  double start_ms = TickClock::NowMonotonicMs();
+  bool live = true;
+  if (!GetOptionalString(env, options, "path", &path) || !GetOptionalDouble(env, options, "fps", &fps) ||
+      !GetOptionalDouble(env, options, "startMs", &start_ms) || !GetOptionalBool(env, options, "live", &live)) {
+    return nullptr;
+  }
+  if (!(fps > 0.0) || !std::isfinite(fps)) {
+    napi_throw_range_error(env, nullptr, "fps must be a positive number");
+    return nullptr;
+  }
+
+  std::unique_ptr<VideoSyncHandle> handle(new VideoSyncHandle());
+  handle->sync.reset(new VideoSync(fps, start_ms));
+  std::string error;
+  if (!handle->sync->Open(path, &error)) {
+    napi_throw_error(env, nullptr, error.c_str());
+    return nullptr;
+  }
+  napi_status status = napi_wrap(env, self, handle.get(), FinalizeVideoSync, nullptr, nullptr);
+  if (status != napi_ok) {
+    CheckNapi(env, status);
+    return nullptr;
+  }
+  VideoSyncHandle* wrapped = handle.release();
+  if (live) {
+    TickHub::Instance().Add(wrapped->sync.get());
+    wrapped->attached = true;
+  }
+  return self;
+}
+
+napi_value VideoSyncSyncFrame(napi_env env, napi_callback_info info)
+{
+  size_t argc = 2;
+  napi_value args[2];
+  VideoSyncHandle* handle = UnwrapThis<VideoSyncHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  double frame = 0.0;
+  double monotonic_ms = TickClock::NowMonotonicMs();
+  if (argc < 1 || napi_get_value_double(env, args[0], &frame) != napi_ok ||
+      (argc >= 2 && !IsNullish(env, args[1]) && napi_get_value_double(env, args[1], &monotonic_ms) != napi_ok)) {
+    napi_throw_type_error(env, nullptr, "syncFrame expects (frame[, monotonicMs])");
+    return nullptr;
+  }
+  handle->sync->SyncFrame(frame, monotonic_ms);
+  return GetUndefined(env);
+}
+
+napi_value VideoSyncRecord(napi_env env, napi_callback_info info)
+{
+  size_t argc = 1;
+  napi_value args[1];
+  VideoSyncHandle* handle = UnwrapThis<VideoSyncHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  napi_value monotonic = nullptr;
+  if (argc < 1 || !GetOptionalProperty(env, args[0], "monotonicMs", &monotonic)) {
+    napi_throw_type_error(env, nullptr,
+                          "record expects ({ monotonicMs, sessionTime, sessionTick?, replayFrame?, videoFrame? })");
+    return nullptr;
+  }
+  SyncPoint point;
+  point.fill(kNaN);
+  point[static_cast<size_t>(SyncKey::kSessionTick)] = -1;
+  point[static_cast<size_t>(SyncKey::kReplayFrame)] = -1;
+  for (size_t key = 0; key < kSyncKeys; ++key) {
+    if (!GetOptionalDouble(env, args[0], kKeyNames[key], &point[key])) {
+      return nullptr;
+    }
+  }
+  handle->sync->Record(point);
+  return GetUndefined(env);
+}
+
+napi_value VideoSyncLookup(napi_env env, napi_callback_info info)
+{
+  size_t argc = 2;
+  napi_value args[2];
+  VideoSyncHandle* handle = UnwrapThis<VideoSyncHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  SyncKey by = SyncKey::kMonotonicMs;
+  double value = 0.0;
+  if (argc < 2) {
+    napi_throw_type_error(env, nullptr, "lookup expects (key, value)");
+    return nullptr;
+  }
+  if (!ParseSyncKey(env, args[0], &by)) {
+    return nullptr;
+  }
+  if (napi_get_value_double(env, args[1], &value) != napi_ok) {
+    napi_throw_type_error(env, nullptr, "lookup expects (key, value)");
+    return nullptr;
+  }
+  SyncPoint point;
+  if (!handle->sync->Lookup(by, value, &point)) {
+    return GetNull(env);
+  }
+  return MakeSyncPoint(env, point);
+}
+
+napi_value VideoSyncMap(napi_env env, napi_callback_info info)
+{
+  size_t argc = 3;
+  napi_value args[3];
+  VideoSyncHandle* handle = UnwrapThis<VideoSyncHandle>(env, info, &argc, args);
+  if (!handle) {
+    return nullptr;
+  }
+  if (argc < 3) {
+    napi_throw_type_error(env, nullptr, "map expects (fromKey, toKey, values)");
+    return nullptr;
+  }
+  SyncKey from = SyncKey::kMonotonicMs;
+  SyncKey to = SyncKey::kMonotonicMs;
+  double* values = nullptr;
+  size_t count = 0;
+  if (!ParseSyncKey(env, args[0], &from) || !ParseSyncKey(env, args[1], &to)) {
+    return nullptr;
+  }
+  if (!GetFloat64Array(env, args[2], &values, &count)) {
+    napi_throw_type_error(env, nullptr, "map expects values as a Float64Array");
+    return nullptr;
+  }
+
+  std::vector<double> mapped(count, kNaN);
+  SyncPoint point;
+  for (size_t i = 0; i < count; ++i) {
+    if (handle->sync->Lookup(from, values[i], &point)) {
+      mapped[i] = point[static_cast<size_t>(to)];
+    }
+  }
+  return MakeFloat64Array(env, mapped);
+}
+
+napi_value VideoSyncGetSize(napi_env env, napi_callback_info info)
+{
+  VideoSyncHandle* handle = UnwrapThis<VideoSyncHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  return MakeDouble(env, static_cast<double>(handle->sync->size()));
+}
+
+napi_value VideoSyncFlush(napi_env env, napi_callback_info info)
+{
+  VideoSyncHandle* handle = UnwrapThis<VideoSyncHandle>(env, info, nullptr, nullptr);
+  if (!handle || !FlushOrThrow(env, handle->sync.get())) {
+    return nullptr;
+  }
+  return GetUndefined(env);
+}
+
+napi_value VideoSyncClose(napi_env env, napi_callback_info info)
+{
+  VideoSyncHandle* handle = UnwrapThis<VideoSyncHandle>(env, info, nullptr, nullptr);
+  if (!handle) {
+    return nullptr;
+  }
+  handle->Detach();
+  if (!FlushOrThrow(env, handle->sync.get())) {
+    return nullptr;
+  }
+  return GetUndefined(env);
+}
+
+}  // namespace
+
+napi_value RegisterVideoSync(napi_env env, napi_value exports)
+{
+  napi_property_descriptor methods[] = {
+    {"syncFrame", nullptr, VideoSyncSyncFrame, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"record", nullptr, VideoSyncRecord, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"lookup", nullptr, VideoSyncLookup, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"map", nullptr, VideoSyncMap, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"getSize", nullptr, VideoSyncGetSize, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"flush", nullptr, VideoSyncFlush, nullptr, nullptr, nullptr, napi_default, nullptr},
+    {"close", nullptr, VideoSyncClose, nullptr, nullptr, nullptr, napi_default, nullptr}
+  };
+
+  napi_value constructor = nullptr;
+  NAPI_CALL(env, napi_define_class(env, "VideoSync", NAPI_AUTO_LENGTH, VideoSyncConstructor, nullptr,
+                                   sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+  NAPI_CALL(env, napi_set_named_property(env, exports, "VideoSync", constructor));
+  return exports;
+}
+
+}  // namespace irsdk_node
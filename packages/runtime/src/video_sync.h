@@ -0,0 +1,97 @@
+// Timecode sidecar for lining telemetry up with a video capture: every live
+// tick's monotonic stamp and video frame next to its SessionTick,
+// SessionTime and ReplayFrameNum, with lookups from any of them to the rest.
+//
+// The sidecar is a header followed by fixed-size rows, appended about once a
+// second from a writer thread. A row cut short by a crash is dropped on the
+// next load.
+
+#ifndef IRSDK_NODE_VIDEO_SYNC_H_
+#define IRSDK_NODE_VIDEO_SYNC_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "background_writer.h"
+#include "telemetry_source.h"
+#include "tick_hub.h"
+
+namespace irsdk_node {
+
+enum class SyncKey {
+  kMonotonicMs,
+  kVideoFrame,
+  kSessionTime,
+  kSessionTick,
+  kReplayFrame,
+};
+
+constexpr size_t kSyncKeys = 5;
+
+// One row, or a point interpolated between two, indexed by SyncKey.
+using SyncPoint = std::array<double, kSyncKeys>;
+
+class VideoSync : public TickListener {
+ public:
+  // Frame 0 of the video was captured at start_ms on the tick clock.
+  VideoSync(double fps, double start_ms);
+
+  // Load the sidecar at path and append to it. Without a path the rows only
+  // live in memory.
+  bool Open(const std::string& path, std::string* error);
+
+  void OnTick(const TelemetrySource& source, const TickStamp& stamp) override;
+
+  // Re-anchor the frame clock: frame was captured at monotonic_ms. Later
+  // rows count frames from there, absorbing drift of the capture's clock.
+  void SyncFrame(double frame, double monotonic_ms);
+  double VideoFrameAt(double monotonic_ms) const;
+
+  // Add a row, handing the pending ones to the writer thread about once a
+  // second. The row's kVideoFrame may be NaN to take it from the frame
+  // clock.
+  void Record(const SyncPoint& point);
+
+  // Write the rows added since the last flush and wait until they are on
+  // disk. After a failed write the whole file is rewritten.
+  bool Flush(std::string* error);
+
+  size_t size() const { return columns_[0].size(); }
+
+  // Find value in the by column and interpolate the other columns there.
+  // Where a column jumps between the two rows, e.g. ReplayFrameNum on a
+  // replay seek, it takes the nearer row instead. A value that occurs
+  // several times, like a SessionTime seen again in a replay, resolves to
+  // its first occurrence. Returns false for values never recorded, including
+  // those a jump skipped.
+  bool Lookup(SyncKey by, double value, SyncPoint* out) const;
+
+ private:
+  void Add(SyncPoint point);
+  void EncodeRows(size_t from, std::string* out) const;
+  // Queue the rows added since the last call, or the whole file after a
+  // failed write.
+  void Queue();
+
+  double fps_;
+  double anchor_ms_;
+  double anchor_frame_ = 0.0;
+  std::string path_;
+  std::array<std::vector<double>, kSyncKeys> columns_;
+  // Rows where each column jumps, starting a new run that advances with
+  // the monotonic clock; bit k of jumps_ marks them for column k.
+  std::array<std::vector<size_t>, kSyncKeys> runs_;
+  std::vector<uint8_t> jumps_;
+  size_t written_ = 0;
+  bool needs_rewrite_ = false;
+  std::unique_ptr<BackgroundWriter> writer_;
+  VarHandle replay_frame_{"ReplayFrameNum"};
+};
+
+}  // namespace irsdk_node
+
+#endif  // IRSDK_NODE_VIDEO_SYNC_H_
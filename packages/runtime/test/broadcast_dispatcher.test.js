@@ -0,0 +1,65 @@
+// Delivery rules of the broadcast queue, checked against the mock sink.
+
+const test = require('node:test');
+const assert = require('node:assert');
+const { BroadcastDispatcher, constants } = require('..');
+
+const { BroadcastMsg, ReplayPositionMode } = constants;
+
+// Resolves with the sent log once `expected` commands have reached the sink.
+function sendAll(commands, expected) {
+  // A slow rate keeps everything after the first command queued together.
+  const dispatcher = new BroadcastDispatcher({ sink: 'mock', ratePerSecond: 10, burst: 1 });
+  for (const args of commands) {
+    dispatcher.send(...args);
+  }
+  return new Promise((resolve) => {
+    const wait = () => {
+      if (dispatcher.getStats().sent < expected) {
+        setTimeout(wait, 10);
+        return;
+      }
+      const sent = dispatcher.getSentLog();
+      dispatcher.close();
+      resolve(sent);
+    };
+    wait();
+  });
+}
+
+test('frame steps from the current frame are all sent', async () => {
+  const sent = await sendAll([
+    [BroadcastMsg.ReplaySetPlaySpeed, 0, 0],
+    [BroadcastMsg.ReplaySetPlayPosition, ReplayPositionMode.Current, 10],
+    [BroadcastMsg.ReplaySetPlayPosition, ReplayPositionMode.Current, 10]
+  ], 3);
+  const steps = sent.filter((entry) => entry.msg === BroadcastMsg.ReplaySetPlayPosition);
+  assert.deepStrictEqual(steps.map((entry) => [entry.var1, entry.var2]), [
+    [ReplayPositionMode.Current, 10],
+    [ReplayPositionMode.Current, 10]
+  ]);
+});
+
+test('absolute replay positions coalesce to the latest', async () => {
+  const sent = await sendAll([
+    [BroadcastMsg.ReplaySetPlaySpeed, 0, 0],
+    [BroadcastMsg.ReplaySetPlayPosition, ReplayPositionMode.Begin, 100],
+    [BroadcastMsg.ReplaySetPlayPosition, ReplayPositionMode.Begin, 200]
+  ], 2);
+  const moves = sent.filter((entry) => entry.msg === BroadcastMsg.ReplaySetPlayPosition);
+  assert.deepStrictEqual(moves.map((entry) => entry.var2), [200]);
+});
+
+test('a coalesced command keeps its place after later commands', async () => {
+  const sent = await sendAll([
+    [BroadcastMsg.ReplaySetPlaySpeed, 0, 0],
+    [BroadcastMsg.ReplaySetPlayPosition, ReplayPositionMode.Begin, 100],
+    [BroadcastMsg.ReplaySetPlayPosition, ReplayPositionMode.Current, 10],
+    [BroadcastMsg.ReplaySetPlayPosition, ReplayPositionMode.Begin, 200]
+  ], 3);
+  assert.deepStrictEqual(sent.map((entry) => [entry.msg, entry.var1, entry.var2]), [
+    [BroadcastMsg.ReplaySetPlaySpeed, 0, 0],
+    [BroadcastMsg.ReplaySetPlayPosition, ReplayPositionMode.Current, 10],
+    [BroadcastMsg.ReplaySetPlayPosition, ReplayPositionMode.Begin, 200]
+  ]);
+});
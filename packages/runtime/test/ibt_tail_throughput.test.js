@@ -0,0 +1,127 @@
+// IbtTail against a writer process that grows an .ibt file at a set rate,
+// the way the sim does: header first, records appended (sometimes split
+// across writes), and the record count filled in when the file is closed.
+//
+// IBT_TAIL_RATE and IBT_TAIL_RECORDS set the writer's records per second
+// and total.
+
+const test = require('node:test');
+const assert = require('node:assert');
+const fs = require('node:fs');
+const os = require('node:os');
+const path = require('node:path');
+const { spawn } = require('node:child_process');
+
+const HEADER_BYTES = 112;
+const SUB_HEADER_BYTES = 32;
+const VAR_HEADER_BYTES = 144;
+// SessionTime (double) then SessionTick (int).
+const RECORD_BYTES = 12;
+
+function makeHeader() {
+  const sessionInfo = Buffer.from('---\nWeekendInfo:\n TrackName: test\n...\n\0');
+  const varHeaderOffset = HEADER_BYTES + SUB_HEADER_BYTES;
+  const sessionInfoOffset = varHeaderOffset + 2 * VAR_HEADER_BYTES;
+  const bufOffset = sessionInfoOffset + sessionInfo.length;
+
+  const header = Buffer.alloc(bufOffset);
+  const fields = [2, 1, 60, 1, sessionInfo.length, sessionInfoOffset, 2, varHeaderOffset, 1, RECORD_BYTES, 0, 0];
+  fields.forEach((value, i) => header.writeInt32LE(value, i * 4));
+  header.writeInt32LE(bufOffset, 48 + 4);
+  const vars = [
+    ['SessionTime', 5, 0],
+    ['SessionTick', 2, 8]
+  ];
+  vars.forEach(([name, type, offset], i) => {
+    const at = varHeaderOffset + i * VAR_HEADER_BYTES;
+    header.writeInt32LE(type, at);
+    header.writeInt32LE(offset, at + 4);
+    header.writeInt32LE(1, at + 8);
+    header.write(name, at + 16);
+  });
+  sessionInfo.copy(header, sessionInfoOffset);
+  return header;
+}
+
+function runWriter(file, rate, total) {
+  const fd = fs.openSync(file, 'w');
+  fs.writeSync(fd, makeHeader());
+  const started = Date.now();
+  let written = 0;
+  const timer = setInterval(() => {
+    const due = Math.min(total, Math.floor(((Date.now() - started) * rate) / 1000));
+    if (due > written) {
+      const batch = Buffer.alloc((due - written) * RECORD_BYTES);
+      for (let i = written; i < due; ++i) {
+        batch.writeDoubleLE(i / 60, (i - written) * RECORD_BYTES);
+        batch.writeInt32LE(i, (i - written) * RECORD_BYTES + 8);
+      }
+      // Split the batch mid-record so the reader sees partial records.
+      const split = Math.floor(batch.length / 2) + 5;
+      fs.writeSync(fd, batch.subarray(0, split));
+      fs.writeSync(fd, batch.subarray(split));
+      written = due;
+    }
+    if (written === total) {
+      clearInterval(timer);
+      const sub = Buffer.alloc(SUB_HEADER_BYTES);
+      sub.writeDoubleLE((total - 1) / 60, 16);
+      sub.writeInt32LE(total, 28);
+      fs.writeSync(fd, sub, 0, sub.length, HEADER_BYTES);
+      fs.closeSync(fd);
+    }
+  }, 5);
+}
+
+if (process.argv[2] === 'writer') {
+  runWriter(process.argv[3], Number(process.argv[4]), Number(process.argv[5]));
+} else {
+  const { IbtTail } = require('..');
+
+  test('every record written by another process arrives in order', { timeout: 120000 }, async (t) => {
+    const rate = Number(process.env.IBT_TAIL_RATE || 20000);
+    const total = Number(process.env.IBT_TAIL_RECORDS || 100000);
+    const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'ibt-tail-'));
+    const file = path.join(dir, 'live.ibt');
+    t.after(() => fs.rmSync(dir, { recursive: true, force: true }));
+
+    const tail = new IbtTail(file, { channels: ['SessionTick'], pollMs: 20 });
+    const started = process.hrtime.bigint();
+    const writer = spawn(process.execPath, [__filename, 'writer', file, String(rate), String(total)], {
+      stdio: 'inherit'
+    });
+
+    let next = 0;
+    await new Promise((resolve, reject) => {
+      const timer = setInterval(() => {
+        try {
+          const records = tail.read();
+          if (records && records.count > 0) {
+            assert.strictEqual(records.first, next);
+            const ticks = records.channels.SessionTick;
+            for (let i = 0; i < records.count; ++i) {
+              assert.strictEqual(ticks[i], next + i);
+            }
+            next += records.count;
+          }
+          // error stays set until the writer has created the file.
+          if (tail.getStatus().finished) {
+            clearInterval(timer);
+            resolve();
+          }
+        } catch (error) {
+          clearInterval(timer);
+          writer.kill();
+          reject(error);
+        }
+      }, 10);
+    });
+    tail.close();
+    await new Promise((resolve) => (writer.exitCode !== null ? resolve() : writer.once('exit', resolve)));
+
+    const seconds = Number(process.hrtime.bigint() - started) / 1e9;
+    assert.strictEqual(next, total);
+    t.diagnostic(`${total} records in ${seconds.toFixed(2)} s: ${Math.round(total / seconds)} records/s ` +
+                 `(writer rate ${rate}/s)`);
+  });
+}
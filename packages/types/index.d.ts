@@ -6,6 +6,7 @@ declare module 'node-iracing-sdk' {
     waitTimeoutMs?: number;
     telemetryVariables?: string[];
     emitSessionOnConnect?: boolean;
+    broadcastQueue?: boolean | BroadcastQueueOptions;
   }
 
   export type TelemetryValue = number | boolean | null;
@@ -39,6 +40,605 @@ declare module 'node-iracing-sdk' {
     sessionInfo: SessionInfoObject;
   }
 
+  export interface TickTiming {
+    monotonicMs: number;
+    wallMs: number;
+    sessionTime: number;
+    sessionTick: number;
+    tickCount: number;
+    fromSignal: boolean;
+  }
+
+  export interface ClockFit {
+    slope: number;
+    interceptMs: number;
+    residualMs: number;
+    samples: number;
+  }
+
+  export type InterpolatorChannelKind = 'linear' | 'lapDistPct' | 'angle';
+
+  export interface InterpolatorChannel {
+    name: string;
+    kind?: InterpolatorChannelKind;
+  }
+
+  export interface InterpolatorOptions {
+    channels: Array<string | InterpolatorChannel>;
+    maxExtrapolationMs?: number;
+    history?: number;
+  }
+
+  export interface InterpolatorSlot {
+    name: string;
+    offset: number;
+    count: number;
+  }
+
+  export type InterpolatedValues = Record<string, number | Float64Array>;
+
+  export type ResampleMode = 'linear' | 'hold';
+
+  export interface IbtJobOptions {
+    signal?: AbortSignal;
+    onProgress?: (done: number, total: number) => void;
+  }
+
+  export interface ResampleOptions {
+    channels: Array<string | InterpolatorChannel>;
+    rateHz?: number;
+    mode?: ResampleMode;
+    maxGapS?: number;
+    dropGaps?: boolean;
+  }
+
+  export interface AlignIbtOptions extends ResampleOptions {
+    by?: 'time' | 'distance';
+    start?: number;
+    end?: number;
+    laps?: number[];
+    points?: number;
+    threads?: number;
+  }
+
+  export interface AlignedIbtFile {
+    path: string;
+    start: number;
+    end: number;
+    lapTime?: number;
+    time?: Float64Array;
+  }
+
+  export interface AlignedIbtFrame {
+    by: 'time' | 'distance';
+    x: Float64Array;
+    files: AlignedIbtFile[];
+    columns: Record<string, Array<Float64Array | null>>;
+  }
+
+  export interface ResamplerOptions extends ResampleOptions {
+    timeBase?: 'session' | 'monotonic';
+    maxRows?: number;
+  }
+
+  export interface ResampledSeries {
+    rateHz: number;
+    time: Float64Array;
+    columns: Record<string, Float64Array>;
+    counts: Record<string, number>;
+    dropped: number;
+  }
+
+  export interface IbtHeader {
+    version: number;
+    tickRate: number;
+    recordCount: number;
+    recordLength: number;
+    sessionInfoUpdate: number;
+    sessionStartDate: number;
+    sessionStartTime: number;
+    sessionEndTime: number;
+    lapCount: number;
+  }
+
+  export interface LapDeltaOptions {
+    channels?: Array<string | InterpolatorChannel>;
+    gridPoints?: number;
+  }
+
+  export interface LapTrace {
+    lap: number;
+    lapTime: number;
+    time: Float64Array;
+    channels: Record<string, Float64Array>;
+  }
+
+  export interface LapDeltaReference {
+    lapTime: number;
+    time: Float64Array;
+    lap?: number;
+  }
+
+  export interface LapDeltaStatus {
+    lap: number;
+    lapDistPct: number;
+    elapsed: number;
+    delta: number;
+    deltaRate: number;
+    referenceLapTime: number;
+    predictedLapTime: number;
+  }
+
+  export type DownsampleMethod = 'lttb' | 'minmax';
+
+  export interface DownsampleOptions {
+    width: number;
+    method?: DownsampleMethod;
+    start?: number;
+    end?: number;
+  }
+
+  export interface IbtDownsampleOptions extends DownsampleOptions {
+    entry?: number;
+  }
+
+  export interface DownsampledSeries {
+    x: Float64Array;
+    y: Float64Array;
+  }
+
+  export interface HistoryOptions {
+    channels: string[];
+    capacity?: number;
+  }
+
+  export interface HistorySeries {
+    time: Float64Array;
+    values: Float64Array;
+  }
+
+  export interface CsvExportOptions {
+    channels?: string[];
+    format?: 'csv' | 'tsv';
+    threads?: number;
+    precision?: number;
+    start?: number;
+    end?: number;
+    header?: boolean;
+  }
+
+  export interface CsvExportResult {
+    rows: number;
+    columns: number;
+    bytes: number;
+    elapsedMs: number;
+  }
+
+  export interface BroadcastQueueOptions {
+    ratePerSecond?: number;
+    burst?: number;
+    maxQueue?: number;
+    coalesce?: boolean;
+  }
+
+  export interface BroadcastDispatcherOptions extends BroadcastQueueOptions {
+    sink?: 'sim' | 'mock';
+  }
+
+  export interface BroadcastStats {
+    queued: number;
+    sent: number;
+    coalesced: number;
+    dropped: number;
+  }
+
+  export interface BroadcastLogEntry {
+    msg: number;
+    var1: number;
+    var2?: number;
+    var3?: number;
+    value?: number;
+    timeMs: number;
+  }
+
+  export interface BroadcastAckOptions {
+    timeoutMs?: number;
+  }
+
+  export interface CameraAckCondition extends BroadcastAckOptions {
+    kind: 'camera';
+    carIdx?: number;
+    carPos?: number;
+    group?: number;
+    camera?: number;
+  }
+
+  export interface ReplayFrameAckCondition extends BroadcastAckOptions {
+    kind: 'replayFrame';
+    mode?: number;
+    frame: number;
+    toleranceFrames?: number;
+  }
+
+  export interface ReplaySessionTimeAckCondition extends BroadcastAckOptions {
+    kind: 'replaySessionTime';
+    sessionNum: number;
+    sessionTime: number;
+    toleranceS?: number;
+  }
+
+  export interface ReplaySpeedAckCondition extends BroadcastAckOptions {
+    kind: 'replaySpeed';
+    speed: number;
+    slowMotion?: number;
+  }
+
+  export interface ReplayJumpAckCondition extends BroadcastAckOptions {
+    kind: 'replayJump';
+    minJumpFrames?: number;
+  }
+
+  export type BroadcastAckCondition =
+    | CameraAckCondition
+    | ReplayFrameAckCondition
+    | ReplaySessionTimeAckCondition
+    | ReplaySpeedAckCondition
+    | ReplayJumpAckCondition;
+
+  export interface BroadcastAck {
+    latencyMs: number;
+    sessionTime: number;
+    monotonicMs: number;
+  }
+
+  export interface TimelineCue {
+    at: number;
+    msg: number;
+    var1: number | string;
+    var2: number;
+    var3?: number;
+  }
+
+  export interface BroadcastTimelineOptions {
+    cues: TimelineCue[];
+    timeBase?: 'sessionTime' | 'replaySessionTime' | 'replayFrame';
+    leadMs?: number;
+    maxLate?: number;
+    sink?: 'sim' | 'mock';
+  }
+
+  export interface TimelineCueReport {
+    at: number;
+    state: 'pending' | 'sent' | 'skipped';
+    dueMs: number | null;
+    sentMs: number | null;
+    deviation: number | null;
+  }
+
+  export interface CameraDirectorOptions {
+    battleGapS?: number;
+    incidentWeight?: number;
+    minDwellS?: number;
+    switchFactor?: number;
+    group?: number;
+    camera?: number;
+    enabled?: boolean;
+    sink?: 'sim' | 'mock';
+  }
+
+  export interface DirectorCandidate {
+    kind: 'battle' | 'incident';
+    carIdx: number;
+    frontCarIdx: number;
+    cars: number;
+    gapS: number;
+    score: number;
+  }
+
+  export interface DirectorState {
+    carIdx: number;
+    score: number;
+    sinceMs: number | null;
+    switches: number;
+  }
+
+  export interface RelativeOptions {
+    trackLengthM?: number;
+  }
+
+  export interface RelativeQueryOptions {
+    ahead?: number;
+    behind?: number;
+    maxGapS?: number;
+    maxDistanceM?: number;
+  }
+
+  export interface RelativeCar {
+    carIdx: number;
+    gapPct: number;
+    gapS: number | null;
+    gapM?: number;
+    lapDelta: number;
+    onPitRoad: boolean;
+  }
+
+  export interface RelativeResult {
+    ahead: RelativeCar[];
+    behind: RelativeCar[];
+  }
+
+  export interface IncidentDetectorOptions {
+    stopRatio?: number;
+    stopWindowS?: number;
+    spinSlipDeg?: number;
+    spinMinSpeed?: number;
+    maxEvents?: number;
+  }
+
+  export type IncidentKind = 'offTrack' | 'rejoin' | 'stop' | 'spin' | 'incident';
+
+  export interface IncidentEvent {
+    kind: IncidentKind;
+    carIdx: number;
+    sessionNum: number;
+    sessionTime: number;
+    replayFrame: number | null;
+    monotonicMs: number;
+    lap: number;
+    lapDistPct: number;
+    value: number;
+  }
+
+  export type IncidentCounts = Record<IncidentKind | 'dropped', number>;
+
+  export interface CornerAnalyzerOptions {
+    gridPoints?: number;
+    latAccel?: number;
+    steering?: number;
+    brake?: number;
+    minLengthPct?: number;
+    mergeGapPct?: number;
+  }
+
+  export interface Corner {
+    entryPct: number;
+    apexPct: number;
+    exitPct: number;
+  }
+
+  export interface CornerMetrics {
+    entrySpeed: number;
+    minSpeed: number;
+    minSpeedPct: number;
+    exitSpeed: number;
+    brakePct: number | null;
+    timeS: number;
+    bestTimeS: number;
+  }
+
+  export interface CornerLap {
+    lap: number;
+    lapTime: number;
+    corners: CornerMetrics[];
+  }
+
+  export interface LapStatsOptions {
+    traps?: number[];
+    channels?: string[];
+    trackLengthM?: number;
+  }
+
+  export interface LapStatsLap {
+    lap: number;
+    traps: Float64Array;
+    min: Record<string, number>;
+    max: Record<string, number>;
+  }
+
+  export interface TrapBoardEntry {
+    carIdx: number;
+    speed: number;
+  }
+
+  export type SanityAction = 'hold' | 'mask';
+
+  export interface SanityRule {
+    min?: number;
+    max?: number;
+    maxRate?: number;
+    action?: SanityAction;
+    maxHoldTicks?: number;
+  }
+
+  export interface SanityCounts {
+    nonFinite: number;
+    outOfRange: number;
+    spikes: number;
+  }
+
+  export interface PositionFilterOptions {
+    processNoise?: number;
+    measurementNoise?: number;
+    resetGapPct?: number;
+  }
+
+  export interface PositionFilterState {
+    pct: Float64Array;
+    speed: Float64Array;
+  }
+
+  export interface IbtTailOptions {
+    channels?: string[];
+    pollMs?: number;
+    maxBufferedRecords?: number;
+    fromEnd?: boolean;
+  }
+
+  export interface IbtTailRecords {
+    first: number;
+    count: number;
+    channels: Record<string, Float64Array | null>;
+  }
+
+  export interface IbtTailStatus {
+    open: boolean;
+    finished: boolean;
+    fileRecords: number;
+    nextRecord: number;
+    buffered: number;
+    error: string | null;
+  }
+
+  export interface IbtCatalogScanOptions {
+    threads?: number;
+    full?: boolean;
+  }
+
+  export interface IbtCatalogScanResult {
+    files: number;
+    laps: number;
+    scanned: number;
+    reused: number;
+    unchanged: number;
+    removed: number;
+    failed: Array<{ path: string; error: string }>;
+    elapsedMs: number;
+  }
+
+  export interface IbtCatalogQuery {
+    track?: string;
+    car?: string;
+    driver?: string;
+    sessionType?: string;
+    from?: number;
+    to?: number;
+    minLapTime?: number;
+    maxLapTime?: number;
+    maxIncidents?: number;
+    includePit?: boolean;
+    sort?: 'file' | 'lapTime';
+    limit?: number;
+  }
+
+  export interface IbtCatalogFile {
+    path: string;
+    date: number;
+    track: string;
+    trackConfig: string;
+    car: string;
+    driver: string;
+    size: number;
+    laps: number;
+  }
+
+  export interface IbtCatalogLap {
+    path: string;
+    date: number;
+    track: string;
+    trackConfig: string;
+    car: string;
+    driver: string;
+    sessionNum: number;
+    sessionType: string;
+    lap: number;
+    lapTime: number;
+    topSpeed: number;
+    incidents: number | null;
+    pit: boolean;
+  }
+
+  export interface SessionLogOptions {
+    path?: string;
+    live?: boolean;
+  }
+
+  export interface SessionRevision {
+    update: number;
+    sessionTime: number;
+  }
+
+  export interface SessionInfoAt extends SessionRevision {
+    yaml: string;
+  }
+
+  export interface SessionLogStats {
+    revisions: number;
+    keyframes: number;
+    bytes: number;
+    textBytes: number;
+    writeError: string | null;
+  }
+
+  export interface VideoSyncOptions {
+    path?: string;
+    fps?: number;
+    startMs?: number;
+    live?: boolean;
+  }
+
+  export type VideoSyncKey = 'monotonicMs' | 'videoFrame' | 'sessionTime' | 'sessionTick' | 'replayFrame';
+
+  export interface VideoSyncPoint {
+    monotonicMs: number;
+    videoFrame: number;
+    sessionTime: number;
+    sessionTick: number;
+    replayFrame: number;
+  }
+
+  export interface VideoSyncRow {
+    monotonicMs: number;
+    videoFrame?: number;
+    sessionTime?: number;
+    sessionTick?: number;
+    replayFrame?: number;
+  }
+
+  export interface RecorderOptions {
+    channels: string[];
+    chunkBytes?: number;
+    flushMs?: number;
+    live?: boolean;
+  }
+
+  export interface RecorderStats {
+    chunks: number;
+    records: number;
+    bytes: number;
+    writeError: string | null;
+  }
+
+  export interface RecordingChunk {
+    valid: boolean;
+    records: number;
+    firstTick: number;
+    lastTick: number;
+    startTime: number;
+    endTime: number;
+  }
+
+  export interface RecordingColumns {
+    sessionTick: Float64Array;
+    sessionTime: Float64Array;
+    channels: Record<string, Float64Array>;
+  }
+
+  export interface RecordingReadOptions {
+    start?: number;
+    end?: number;
+    channels?: string[];
+  }
+
+  export interface RecordingRange extends RecordingColumns {
+    skipped: number[];
+  }
+
+  export interface RecordingVerifyResult {
+    chunks: number;
+    records: number;
+    damaged: number[];
+  }
+
   export interface IRacingConstants {
     BroadcastMsg: Record<string, number>;
     ChatCommandMode: Record<string, number>;
@@ -63,6 +663,9 @@ declare module 'node-iracing-sdk' {
     private _timer: NodeJS.Timeout | null;
     private _connected: boolean;
     private _lastSessionUpdate: number;
+    private _broadcastQueue: BroadcastQueueOptions | null;
+    private _dispatcher: BroadcastDispatcher | null;
+    private _acks: BroadcastAcks | null;
 
     constructor(options?: IRacingClientOptions);
 
@@ -78,8 +681,16 @@ declare module 'node-iracing-sdk' {
     getVarHeaders(): TelemetryVarHeader[];
     getVarValue(name: string, entry?: number | null): TelemetryValue;
 
+    getTickTiming(): TickTiming | null;
+    getClockFit(): ClockFit | null;
+    sessionTimeToMonotonic(sessionTime: number): number | null;
+    monotonicToSessionTime(monotonicMs: number): number | null;
+    sessionTimeToWall(sessionTime: number): number | null;
+    nowMonotonic(): number;
+
     broadcastMsg(msg: number, var1: number | string, var2: number, var3?: number): void;
     broadcastMsgFloat(msg: number, var1: number | string, value: number): void;
+    getBroadcastStats(): BroadcastStats | null;
 
     switchCameraByPos(carPos: number, group: number, camera: number): void;
     switchCameraByNum(driverNum: number | string, group: number, camera: number): void;
@@ -98,40 +709,251 @@ declare module 'node-iracing-sdk' {
     replaySearchSessionTime(sessionNum: number, sessionTimeMs: number): void;
     videoCapture(mode: number): void;
 
+    switchCameraByPosAsync(carPos: number, group: number, camera: number, options?: BroadcastAckOptions): Promise<BroadcastAck>;
+    switchCameraByNumAsync(driverNum: number | string, group: number, camera: number, options?: BroadcastAckOptions): Promise<BroadcastAck>;
+    replaySetPlaySpeedAsync(speed: number, slowMotion?: number, options?: BroadcastAckOptions): Promise<BroadcastAck>;
+    replaySetPlayPositionAsync(mode: number, frameNumber: number, options?: BroadcastAckOptions): Promise<BroadcastAck>;
+    replaySearchAsync(mode: number, options?: BroadcastAckOptions): Promise<BroadcastAck>;
+    replaySearchSessionTimeAsync(sessionNum: number, sessionTimeMs: number, options?: BroadcastAckOptions): Promise<BroadcastAck>;
+
     start(): void;
     stop(): void;
 
+    private _broadcastSender(): (msg: number, var1: number | string, var2: number, var3?: number) => unknown;
+    private _sendAcknowledged(send: () => void, condition: BroadcastAckCondition): Promise<BroadcastAck>;
+    private _carIdxForNumber(driverNum: number | string): number;
     private _tick(): void;
     private _emitSessionUpdate(): void;
 
     on(event: 'connect', listener: () => void): this;
     on(event: 'disconnect', listener: () => void): this;
     on(event: 'session', listener: (payload: SessionUpdate) => void): this;
-    on(event: 'telemetry', listener: (data: TelemetryData) => void): this;
+    on(event: 'telemetry', listener: (data: TelemetryData, timing: TickTiming | null) => void): this;
     on(event: 'error', listener: (error: Error) => void): this;
     on(event: string, listener: (...args: unknown[]) => void): this;
 
     once(event: 'connect', listener: () => void): this;
     once(event: 'disconnect', listener: () => void): this;
     once(event: 'session', listener: (payload: SessionUpdate) => void): this;
-    once(event: 'telemetry', listener: (data: TelemetryData) => void): this;
+    once(event: 'telemetry', listener: (data: TelemetryData, timing: TickTiming | null) => void): this;
     once(event: 'error', listener: (error: Error) => void): this;
     once(event: string, listener: (...args: unknown[]) => void): this;
 
     off(event: 'connect', listener: () => void): this;
     off(event: 'disconnect', listener: () => void): this;
     off(event: 'session', listener: (payload: SessionUpdate) => void): this;
-    off(event: 'telemetry', listener: (data: TelemetryData) => void): this;
+    off(event: 'telemetry', listener: (data: TelemetryData, timing: TickTiming | null) => void): this;
     off(event: 'error', listener: (error: Error) => void): this;
     off(event: string, listener: (...args: unknown[]) => void): this;
 
     emit(event: 'connect'): boolean;
     emit(event: 'disconnect'): boolean;
     emit(event: 'session', payload: SessionUpdate): boolean;
-    emit(event: 'telemetry', data: TelemetryData): boolean;
+    emit(event: 'telemetry', data: TelemetryData, timing: TickTiming | null): boolean;
     emit(event: 'error', error: Error): boolean;
     emit(event: string, ...args: unknown[]): boolean;
   }
 
+  export class Interpolator {
+    constructor(options: InterpolatorOptions);
+
+    sample(renderTimeMs: number): InterpolatedValues | null;
+    sampleInto(renderTimeMs: number, out: Float64Array): number;
+    getLayout(): InterpolatorSlot[];
+    close(): void;
+  }
+
+  export class Resampler {
+    constructor(options: ResamplerOptions);
+
+    drain(): ResampledSeries;
+    close(): void;
+  }
+
+  export class IbtFile {
+    constructor(path: string);
+
+    getHeader(): IbtHeader;
+    getVarHeaders(): TelemetryVarHeader[];
+    getSessionInfoString(): string;
+    readColumn(name: string, entry?: number): Float64Array | null;
+    resample(options: ResampleOptions): ResampledSeries;
+    downsample(name: string, options: IbtDownsampleOptions): DownsampledSeries | null;
+    exportCsv(path: string, options?: CsvExportOptions): CsvExportResult;
+    readColumnAsync(name: string, options?: IbtJobOptions & { entry?: number }): Promise<Float64Array | null>;
+    resampleAsync(options: ResampleOptions & IbtJobOptions): Promise<ResampledSeries>;
+    downsampleAsync(name: string, options: IbtDownsampleOptions & IbtJobOptions): Promise<DownsampledSeries | null>;
+    exportCsvAsync(path: string, options?: CsvExportOptions & IbtJobOptions): Promise<CsvExportResult>;
+    close(): void;
+  }
+
+  export class LapDelta {
+    constructor(options?: LapDeltaOptions);
+
+    getDelta(): LapDeltaStatus | null;
+    getLap(which: 'best' | 'last' | 'reference'): LapTrace | null;
+    setReference(reference: 'best' | 'last' | LapDeltaReference): boolean;
+    close(): void;
+  }
+
+  export class History {
+    constructor(options: HistoryOptions);
+
+    getSeries(name: string): HistorySeries | null;
+    downsample(name: string, options: DownsampleOptions): DownsampledSeries | null;
+    exportCsv(path: string, options?: CsvExportOptions): CsvExportResult;
+    getSize(): number;
+    clear(): void;
+    close(): void;
+  }
+
+  export function downsample(x: Float64Array, y: Float64Array, options?: DownsampleOptions): DownsampledSeries;
+
+  export function alignIbt(paths: string[], options: AlignIbtOptions): AlignedIbtFrame;
+
+  export function alignIbtAsync(paths: string[], options: AlignIbtOptions & IbtJobOptions): Promise<AlignedIbtFrame>;
+
+  export function setSanityFilter(rules: Record<string, SanityRule> | null): void;
+
+  export function getSanityFilterStats(): Record<string, SanityCounts>;
+
+  export class BroadcastDispatcher {
+    constructor(options?: BroadcastDispatcherOptions);
+
+    send(msg: number, var1: number | string, var2: number, var3?: number): boolean;
+    getStats(): BroadcastStats;
+    getSentLog(): BroadcastLogEntry[] | null;
+    clear(): void;
+    close(): void;
+  }
+
+  export class BroadcastAcks {
+    constructor();
+
+    expect(condition: BroadcastAckCondition): Promise<BroadcastAck>;
+    expire(): number | null;
+    getPending(): number;
+    close(): void;
+  }
+
+  export class BroadcastTimeline {
+    constructor(options: BroadcastTimelineOptions);
+
+    getReport(): TimelineCueReport[];
+    isDone(): boolean;
+    getSentLog(): BroadcastLogEntry[] | null;
+    close(): void;
+  }
+
+  export class CameraDirector {
+    constructor(options?: CameraDirectorOptions);
+
+    getCandidates(): DirectorCandidate[];
+    getState(): DirectorState;
+    setEnabled(enabled: boolean): void;
+    getSentLog(): BroadcastLogEntry[] | null;
+    close(): void;
+  }
+
+  export class Relative {
+    constructor(options?: RelativeOptions);
+
+    query(carIdx: number, options?: RelativeQueryOptions): RelativeResult | null;
+    close(): void;
+  }
+
+  export class IncidentDetector {
+    constructor(options?: IncidentDetectorOptions);
+
+    takeEvents(): IncidentEvent[];
+    getCounts(): IncidentCounts;
+    close(): void;
+  }
+
+  export class CornerAnalyzer {
+    constructor(options?: CornerAnalyzerOptions);
+
+    getCorners(): Corner[];
+    getLastLap(): CornerLap | null;
+    segment(which: 'best' | 'last'): boolean;
+    close(): void;
+  }
+
+  export class LapStats {
+    constructor(options?: LapStatsOptions);
+
+    getLap(carIdx: number, which?: 'last' | 'current'): LapStatsLap | null;
+    getBestTraps(carIdx: number): Float64Array | null;
+    getTrapBoard(trap: number): TrapBoardEntry[];
+    close(): void;
+  }
+
+  export class PositionFilter {
+    constructor(options?: PositionFilterOptions);
+
+    getState(renderTimeMs?: number): PositionFilterState | null;
+    close(): void;
+  }
+
+  export class IbtTail {
+    constructor(path: string, options?: IbtTailOptions);
+
+    read(maxRecords?: number): IbtTailRecords | null;
+    getStatus(): IbtTailStatus;
+    close(): void;
+  }
+
+  export class IbtCatalog {
+    constructor(indexPath: string);
+
+    scan(dir: string, options?: IbtCatalogScanOptions): IbtCatalogScanResult;
+    scanAsync(dir: string, options?: IbtCatalogScanOptions & IbtJobOptions): Promise<IbtCatalogScanResult>;
+    query(filter?: IbtCatalogQuery): IbtCatalogLap[];
+    getFiles(): IbtCatalogFile[];
+    close(): void;
+  }
+
+  export class SessionLog {
+    constructor(options?: SessionLogOptions);
+
+    record(yaml: string, sessionTime: number, update?: number): boolean;
+    getAt(sessionTime: number): SessionInfoAt | null;
+    getRevisions(): SessionRevision[];
+    getStats(): SessionLogStats;
+    close(): void;
+  }
+
+  export class VideoSync {
+    constructor(options?: VideoSyncOptions);
+
+    syncFrame(frame: number, monotonicMs?: number): void;
+    record(row: VideoSyncRow): void;
+    lookup(key: VideoSyncKey, value: number): VideoSyncPoint | null;
+    map(fromKey: VideoSyncKey, toKey: VideoSyncKey, values: Float64Array): Float64Array;
+    getSize(): number;
+    flush(): void;
+    close(): void;
+  }
+
+  export class Recorder {
+    constructor(path: string, options: RecorderOptions);
+
+    append(sessionTick: number, sessionTime: number, values: Float64Array): void;
+    flush(): void;
+    getStats(): RecorderStats;
+    close(): void;
+  }
+
+  export class RecordingFile {
+    constructor(path: string);
+
+    getChannels(): string[];
+    getChunks(): RecordingChunk[];
+    readChunk(index: number, options?: { channels?: string[] }): RecordingColumns | null;
+    read(options?: RecordingReadOptions): RecordingRange;
+    verify(): RecordingVerifyResult;
+    close(): void;
+  }
+
   export const constants: IRacingConstants;
 }